@@ -125,6 +125,21 @@ public:
 	// greebo: Returns the opened file or NULL if failed.
 	virtual ArchivePtr openArchive(const std::string& name) = 0;
 
+	/**
+	 * Opens the archive using a file table previously returned by getArchiveIndex(),
+	 * such that the archive's directory doesn't need to be read again. The index must
+	 * have been created from the same, unchanged archive file. If the index cannot
+	 * be used, the archive is read as in openArchive(name).
+	 */
+	virtual ArchivePtr openArchive(const std::string& name, const std::string& index) = 0;
+
+	/**
+	 * Returns the file table of an archive opened by this loader, in a flat binary
+	 * form which can be passed to openArchive(name, index) in a later session.
+	 * Returns an empty string if the archive cannot be indexed.
+	 */
+	virtual std::string getArchiveIndex(const ArchivePtr& archive) = 0;
+
     // get the supported file extension
     virtual const std::string& getExtension() = 0;
 };
@@ -119,6 +119,28 @@ public:
 };
 typedef std::shared_ptr<IMapWriter> IMapWriterPtr;
 
+/**
+ * Optional interface of an IMapWriter, allowing the map saving algorithm
+ * to serialise the primitives of an entity concurrently. Each primitive is
+ * written into a separate buffer, the buffers are appended to the map stream
+ * in the order the primitives have been visited.
+ *
+ * The write methods must not modify the writer's state and need to be safe
+ * to call from any thread. Their output must be exactly what the
+ * beginWrite/endWrite call pair of the same primitive would produce, the
+ * number of the primitive within its entity is passed in explicitly.
+ * A FailureException thrown by these methods is handled like the ones
+ * thrown by beginWriteBrush/beginWritePatch.
+ */
+class IConcurrentPrimitiveWriter
+{
+public:
+	virtual ~IConcurrentPrimitiveWriter() {}
+
+	virtual void writeBrush(std::size_t primitiveNum, const IBrush& brush, std::ostream& stream) const = 0;
+	virtual void writePatch(std::size_t primitiveNum, const IPatch& patch, std::ostream& stream) const = 0;
+};
+
 /**
  * An abstract map reader class used to parse map elements
  * from the given input (string) stream. The map reader instance
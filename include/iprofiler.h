@@ -0,0 +1,81 @@
+#pragma once
+
+#include "imodule.h"
+
+namespace profiling
+{
+
+/**
+ * Records the time spent in named zones of code, per thread. Zones can be
+ * nested and are kept for a number of recent frames, to find out where a slow
+ * frame or a slow load went. The recorded zones can be exported to the
+ * Chrome trace event format.
+ *
+ * Zones are usually opened by the PROFILE_ZONE macro below, which compiles to
+ * nothing if DR_DISABLE_PROFILING is defined.
+ */
+class IProfiler :
+	public RegisterableModule
+{
+public:
+	virtual ~IProfiler() {}
+
+	/**
+	 * Opens a zone on the calling thread, to be closed by endZone() on the
+	 * same thread. The name is not copied, it needs to be a string literal.
+	 */
+	virtual void beginZone(const char* name) = 0;
+
+	// Closes the innermost zone opened by the calling thread
+	virtual void endZone() = 0;
+
+	// Marks the end of a frame, zones of old frames are eventually dropped
+	virtual void endFrame() = 0;
+};
+
+} // namespace profiling
+
+const char* const MODULE_PROFILER = "Profiler";
+
+inline profiling::IProfiler& GlobalProfiler()
+{
+	// Cache the reference locally
+	static profiling::IProfiler& _profiler(
+		*std::static_pointer_cast<profiling::IProfiler>(
+			module::GlobalModuleRegistry().getModule(MODULE_PROFILER)
+		)
+	);
+	return _profiler;
+}
+
+namespace profiling
+{
+
+/// Opens a zone for the lifetime of this object
+class ScopedZone
+{
+public:
+	ScopedZone(const char* name)
+	{
+		GlobalProfiler().beginZone(name);
+	}
+
+	~ScopedZone()
+	{
+		GlobalProfiler().endZone();
+	}
+};
+
+} // namespace profiling
+
+#ifdef DR_DISABLE_PROFILING
+	#define PROFILE_ZONE(name)
+	#define PROFILE_END_FRAME()
+#else
+	#define PROFILE_ZONE_CONCAT(a, b) a##b
+	#define PROFILE_ZONE_VARIABLE(line) PROFILE_ZONE_CONCAT(_profileZone, line)
+
+	/// Records the time until the end of the enclosing scope under the given name
+	#define PROFILE_ZONE(name) profiling::ScopedZone PROFILE_ZONE_VARIABLE(__LINE__)(name)
+	#define PROFILE_END_FRAME() GlobalProfiler().endFrame()
+#endif
@@ -4,6 +4,7 @@
 #include <functional>
 
 #include "math/Vector3.h"
+#include "math/AABB.h"
 
 #include "ShaderLayer.h"
 #include <sigc++/signal.h>
@@ -230,6 +231,17 @@ public:
     /// Test if the given light intersects the LitObject
     virtual bool intersectsLight(const RendererLight& light) const = 0;
 
+    /**
+     * Return the world-space bounds of this object. The renderer only calls
+     * intersectsLight() for lights intersecting these bounds. The default
+     * implementation returns an invalid AABB, such objects are tested against
+     * all lights.
+     */
+    virtual AABB getLitObjectBounds() const
+    {
+        return AABB();
+    }
+
     /// Add a light to the set of lights which do intersect this object
     virtual void insertLight(const RendererLight& light) {}
 
@@ -273,11 +285,12 @@ typedef std::function<void(const RendererLight&)> RendererLightCallback;
  * updating, which is true if EITHER this LightList's setDirty() method OR the
  * RenderSystem's lightChanged() has been called since the last calculation. If
  * no update is needed, it returns.
- * 5. If an update IS needed, the LightList iterates over all lights in the
- * scene, and tests if each one intersects its associated lit object (which is
- * the one that just invoked calculateIntersectingLights(), although nothing
- * enforces this). This intersection test is performed by passing the light to
- * the LitObject::intersectsLight() method.
+ * 5. If an update IS needed, the lights located near the lit object's bounds
+ * (or, after a light change, the lit objects near the changed light) are
+ * tested for intersection with the lit object (which is the one that just
+ * invoked calculateIntersectingLights(), although nothing enforces this). This
+ * intersection test is performed by passing the light to the
+ * LitObject::intersectsLight() method.
  * 6. For each light which passes the intersection test, the LightList both adds
  * it to its internal list of "active" (i.e. intersecting) lights for its
  * object, and passes it to the object's insertLight() method. Some object
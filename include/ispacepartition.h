@@ -75,6 +75,8 @@ typedef std::shared_ptr<ISPNode> ISPNodePtr;
  * Note: It's not allowed to call link() for nodes which are already linked into the tree.
  * It's safe to call unlink() for any node at any time, even multiple times in a row.
  * The unlink() method will return true if the node had been linked before.
+ * The relink() method has the same effect as unlink() followed by link(), but
+ * implementations may keep the node where it is if its bounds still fit.
  */
 class ISpacePartitionSystem
 {
@@ -88,6 +90,10 @@ public:
 	// (node had been linked before)
 	virtual bool unlink(const scene::INodePtr& sceneNode) = 0;
 
+	// Updates the location of a linked node after its bounds have changed.
+	// Returns false if the node is not linked into the tree (nothing happens then).
+	virtual bool relink(const scene::INodePtr& sceneNode) = 0;
+
 	// Returns the root node of this SP tree (the largest one, encompassing everything)
 	virtual ISPNodePtr getRoot() const = 0;
 };
@@ -5,7 +5,10 @@
 
 #include "imodule.h"
 #include <cstddef>
+#include <functional>
+#include <istream>
 #include <memory>
+#include <ostream>
 #include <sigc++/signal.h>
 
 class IMapFileChangeTracker;
@@ -19,6 +22,28 @@ class IUndoMemento
 {
 public:
     virtual ~IUndoMemento() {}
+
+	// Returns the number of bytes allocated by this memento alone, excluding the
+	// data reported by foreachSharedData(). Used to report the undo memory usage.
+	virtual std::size_t getMemoryUsage() const
+	{
+		return 0;
+	}
+
+	// Invokes the functor with the address and the size of each block of data
+	// this memento may share with other mementos. The undo system counts each
+	// of these blocks once, as long as any saved memento refers to it.
+	virtual void foreachSharedData(const std::function<void(const void*, std::size_t)>& functor) const
+	{}
+
+	// Writes the state to the given stream, such that old undo history can be moved
+	// out of memory. The data is read back by IUndoable::readState() of the same
+	// Undoable. Mementos referring to other objects instead of holding plain data
+	// return false without writing anything, these are kept in memory.
+	virtual bool writeTo(std::ostream& stream) const
+	{
+		return false;
+	}
 };
 typedef std::shared_ptr<IUndoMemento> IUndoMementoPtr;
 
@@ -37,6 +62,13 @@ public:
     virtual ~IUndoable() {}
 	virtual IUndoMementoPtr exportState() const = 0;
 	virtual void importState(const IUndoMementoPtr& state) = 0;
+
+	// Recreates a memento from the data written by its IUndoMemento::writeTo() method,
+	// returns an empty pointer if the data can't be read
+	virtual IUndoMementoPtr readState(std::istream& stream) const
+	{
+		return IUndoMementoPtr();
+	}
 };
 
 /**
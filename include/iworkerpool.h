@@ -0,0 +1,45 @@
+#pragma once
+
+#include "imodule.h"
+#include <functional>
+
+namespace util
+{
+
+/**
+ * Threads kept alive between calls, running the helper tasks of data-parallel
+ * algorithms like util::parallelFor. There is a single pool for the whole
+ * application, owned by the core module, such that plugins don't start their
+ * own threads. The threads are started by initialiseModule() and joined by
+ * shutdownModule(), a stopped pool reports zero threads.
+ */
+class IWorkerPool :
+	public RegisterableModule
+{
+public:
+	virtual ~IWorkerPool() {}
+
+	// The number of pool threads, not counting the thread posting the tasks
+	virtual std::size_t getNumThreads() const = 0;
+
+	/**
+	 * Queues the given task, which is run by the next idle pool thread.
+	 * Tasks are started in the order they were posted.
+	 */
+	virtual void post(const std::function<void()>& task) = 0;
+};
+
+} // namespace util
+
+const char* const MODULE_WORKERPOOL = "WorkerPool";
+
+inline util::IWorkerPool& GlobalWorkerPool()
+{
+	// Cache the reference locally
+	static util::IWorkerPool& _workerPool(
+		*std::static_pointer_cast<util::IWorkerPool>(
+			module::GlobalModuleRegistry().getModule(MODULE_WORKERPOOL)
+		)
+	);
+	return _workerPool;
+}
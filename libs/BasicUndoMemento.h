@@ -1,10 +1,41 @@
 #pragma once
 
 #include "iundo.h"
+#include "stream/utils.h"
+#include <string>
 
 namespace undo
 {
 
+template<typename Copyable> class BasicUndoMemento;
+
+/**
+ * Writes and reads the data of a BasicUndoMemento, such that the UndoSystem
+ * can move it out of memory. Copyables without a specialisation of this
+ * template are kept in memory.
+ */
+template<typename Copyable>
+struct UndoDataSerialiser
+{
+	static bool write(std::ostream& stream, const Copyable& data)
+	{
+		return false;
+	}
+
+	static IUndoMementoPtr read(std::istream& stream)
+	{
+		return IUndoMementoPtr();
+	}
+};
+
+// Spawnarg values and other strings
+template<>
+struct UndoDataSerialiser<std::string>
+{
+	static bool write(std::ostream& stream, const std::string& data);
+	static IUndoMementoPtr read(std::istream& stream);
+};
+
 /**
  * An UndoMemento implementation capable of holding a single
  * copyable object, which is stored by value.
@@ -23,6 +54,35 @@ public:
 	{
 		return _data;
 	}
+
+	// The memory allocated by the copied object itself is not known
+	std::size_t getMemoryUsage() const override
+	{
+		return sizeof(*this);
+	}
+
+	bool writeTo(std::ostream& stream) const override
+	{
+		return UndoDataSerialiser<Copyable>::write(stream, _data);
+	}
 };
 
+inline bool UndoDataSerialiser<std::string>::write(std::ostream& stream, const std::string& data)
+{
+	stream::writeNativeString(stream, data);
+	return true;
+}
+
+inline IUndoMementoPtr UndoDataSerialiser<std::string>::read(std::istream& stream)
+{
+	std::string data;
+
+	if (!stream::readNativeString(stream, data))
+	{
+		return IUndoMementoPtr();
+	}
+
+	return IUndoMementoPtr(new BasicUndoMemento<std::string>(data));
+}
+
 } // namespace
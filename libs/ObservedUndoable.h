@@ -64,6 +64,11 @@ public:
 
 		_importCallback(std::static_pointer_cast<BasicUndoMemento<Copyable> >(state)->data());
 	}
+
+	IUndoMementoPtr readState(std::istream& stream) const
+	{
+		return UndoDataSerialiser<Copyable>::read(stream);
+	}
 };
 
 } // namespace
@@ -0,0 +1,501 @@
+#pragma once
+
+#include "DefTokeniser.h"
+
+#include <string>
+#include <string_view>
+#include <cstring>
+
+namespace parser
+{
+
+/**
+ * DefTokeniser working on a contiguous, fully buffered (or memory-mapped)
+ * character range [begin, end). The tokenisation rules are the same as the
+ * ones implemented by DefTokeniserFunc (whitespace splitting, protection of
+ * quoted content, C and C++ style comments, backslash continuation of
+ * quoted strings), but tokens are not assembled character by character.
+ *
+ * Tokens are handed out as std::string_view pointing directly into the
+ * source range. Only quoted tokens containing escape sequences or string
+ * continuations need to be rewritten, these are assembled in an internal
+ * scratch buffer which is re-used across calls.
+ *
+ * The source range must outlive the tokeniser. A view returned by
+ * nextTokenView() or peekView() stays valid until the next call advancing
+ * this tokeniser.
+ */
+class ContiguousDefTokeniser :
+	public DefTokeniser
+{
+private:
+	enum State
+	{
+		SEARCHING,           // haven't found anything yet
+		TOKEN_STARTED,       // found the start of a possible multi-char token
+		QUOTED,              // inside quoted text, no tokenising
+		AFTER_CLOSING_QUOTE, // right after a quoted text, checking for backslash
+		SEARCHING_FOR_QUOTE, // searching for continuation of quoted string (after a backslash was found)
+		FORWARDSLASH,        // forward slash found, possible comment coming
+		COMMENT_EOL,         // double-forwardslash comment
+		COMMENT_DELIM,       // inside delimited comment (/*)
+		STAR                 // asterisk, possibly indicates end of comment (*/)
+	};
+
+	const char* _cur;
+	const char* _end;
+
+	// The position the scan of the upcoming token started at
+	const char* _tokenPosition;
+
+	// Character class lookup tables, built from the delimiter strings
+	bool _isDelim[256];
+	bool _isKeptDelim[256];
+
+	// The token which is returned by the next call to nextToken()
+	std::string_view _token;
+	bool _hasValidToken;
+
+	// Two scratch buffers for tokens which cannot be referenced in the source,
+	// used alternately such that the last returned view is not overwritten
+	// when prefetching the upcoming token
+	std::string _scratch[2];
+	std::size_t _scratchIndex;
+
+	// Token assembly state of the current advance() call
+	const char* _tokStart;
+	std::size_t _tokLength;
+	std::string* _tokBuffer; // non-NULL if the token had to be copied
+
+public:
+	/**
+	 * Construct a tokeniser on top of the given range.
+	 *
+	 * @param begin, end
+	 * The character range to tokenise, which must stay valid during the lifetime
+	 * of this tokeniser.
+	 *
+	 * @param delims
+	 * The list of characters to use as delimiters.
+	 *
+	 * @param keptDelims
+	 * String of characters to treat as delimiters but return as tokens in their
+	 * own right.
+	 */
+	ContiguousDefTokeniser(const char* begin, const char* end,
+						   const char* delims = WHITESPACE,
+						   const char* keptDelims = "{}()") :
+		_cur(begin),
+		_end(end),
+		_tokenPosition(begin),
+		_hasValidToken(false),
+		_scratchIndex(0),
+		_tokStart(nullptr),
+		_tokLength(0),
+		_tokBuffer(nullptr)
+	{
+		std::memset(_isDelim, 0, sizeof(_isDelim));
+		std::memset(_isKeptDelim, 0, sizeof(_isKeptDelim));
+
+		for (const char* c = delims; *c != 0; ++c)
+		{
+			_isDelim[static_cast<unsigned char>(*c)] = true;
+		}
+
+		for (const char* c = keptDelims; *c != 0; ++c)
+		{
+			_isKeptDelim[static_cast<unsigned char>(*c)] = true;
+		}
+
+		advance();
+	}
+
+	// Construct a tokeniser on top of the given string, which must outlive this instance
+	ContiguousDefTokeniser(const std::string& str,
+						   const char* delims = WHITESPACE,
+						   const char* keptDelims = "{}()") :
+		ContiguousDefTokeniser(str.data(), str.data() + str.size(), delims, keptDelims)
+	{}
+
+	// The tokeniser refers to its own scratch buffers, it cannot be copied
+	ContiguousDefTokeniser(const ContiguousDefTokeniser& other) = delete;
+	ContiguousDefTokeniser& operator=(const ContiguousDefTokeniser& other) = delete;
+
+	bool hasMoreTokens() const override
+	{
+		return _hasValidToken;
+	}
+
+	std::string nextToken() override
+	{
+		return std::string(nextTokenView());
+	}
+
+	std::string peek() const override
+	{
+		return std::string(peekView());
+	}
+
+	double nextDouble() override
+	{
+		std::string_view tok = nextTokenView();
+		return string::from_chars<double>(tok.data(), tok.data() + tok.size());
+	}
+
+	float nextFloat() override
+	{
+		std::string_view tok = nextTokenView();
+		return string::from_chars<float>(tok.data(), tok.data() + tok.size());
+	}
+
+	/**
+	 * Returns the next token without copying it. The returned view refers
+	 * either to the source range or to an internal buffer and remains valid
+	 * until the next call advancing this tokeniser.
+	 */
+	std::string_view nextTokenView()
+	{
+		if (!_hasValidToken)
+		{
+			throw ParseException("DefTokeniser: no more tokens");
+		}
+
+		std::string_view token = _token;
+		advance();
+		return token;
+	}
+
+	/**
+	 * Returns a view of the next token without consuming it.
+	 */
+	std::string_view peekView() const
+	{
+		if (!_hasValidToken)
+		{
+			throw ParseException("DefTokeniser: no more tokens");
+		}
+
+		return _token;
+	}
+
+	void assertNextToken(const std::string& val) override
+	{
+		std::string_view tok = nextTokenView();
+
+		if (tok != val)
+		{
+			throw ParseException("DefTokeniser: Assertion failed: Required \""
+				+ val + "\", found \"" + std::string(tok) + "\"");
+		}
+	}
+
+	void skipTokens(unsigned int n) override
+	{
+		for (unsigned int i = 0; i < n; i++)
+		{
+			nextTokenView();
+		}
+	}
+
+	/**
+	 * Returns the position within the source range where the upcoming token
+	 * is located (possibly preceded by whitespace or comments). Everything
+	 * before this position has been consumed.
+	 */
+	const char* getPosition() const
+	{
+		return _tokenPosition;
+	}
+
+	// Returns the end of the source range
+	const char* getEnd() const
+	{
+		return _end;
+	}
+
+	/**
+	 * Continue tokenising at the given position, which must be located within
+	 * the source range. Use this to skip over parts of the source which have been
+	 * processed by other means, or to return to a position which has been
+	 * retrieved through getPosition() earlier.
+	 */
+	void setPosition(const char* position)
+	{
+		_cur = position;
+		advance();
+	}
+
+private:
+	bool isDelim(char c) const
+	{
+		return _isDelim[static_cast<unsigned char>(c)];
+	}
+
+	bool isKeptDelim(char c) const
+	{
+		return _isKeptDelim[static_cast<unsigned char>(c)];
+	}
+
+	bool tokenEmpty() const
+	{
+		return _tokBuffer != nullptr ? _tokBuffer->empty() : _tokLength == 0;
+	}
+
+	// Append the character found at the given source position
+	void appendSource(const char* pos)
+	{
+		if (_tokBuffer != nullptr)
+		{
+			*_tokBuffer += *pos;
+		}
+		else if (_tokLength == 0)
+		{
+			_tokStart = pos;
+			_tokLength = 1;
+		}
+		else if (_tokStart + _tokLength == pos)
+		{
+			++_tokLength;
+		}
+		else
+		{
+			switchToBuffer();
+			*_tokBuffer += *pos;
+		}
+	}
+
+	// Append a character which is not present in the source as it is
+	void appendChar(char c)
+	{
+		if (_tokBuffer == nullptr)
+		{
+			switchToBuffer();
+		}
+
+		*_tokBuffer += c;
+	}
+
+	void switchToBuffer()
+	{
+		_scratchIndex ^= 1;
+		_tokBuffer = &_scratch[_scratchIndex];
+		_tokBuffer->assign(_tokStart != nullptr ? _tokStart : "", _tokLength);
+	}
+
+	void advance()
+	{
+		_tokenPosition = _cur;
+		_tokStart = nullptr;
+		_tokLength = 0;
+		_tokBuffer = nullptr;
+
+		_hasValidToken = scan();
+
+		_token = _tokBuffer != nullptr ? std::string_view(*_tokBuffer) :
+			std::string_view(_tokStart != nullptr ? _tokStart : "", _tokLength);
+	}
+
+	// Mirrors the state machine in DefTokeniserFunc::operator()
+	bool scan()
+	{
+		State state = SEARCHING;
+
+		while (_cur != _end)
+		{
+			switch (state)
+			{
+			case SEARCHING:
+
+				if (isDelim(*_cur))
+				{
+					++_cur;
+					continue;
+				}
+
+				if (isKeptDelim(*_cur))
+				{
+					appendSource(_cur++);
+					return true;
+				}
+
+				state = TOKEN_STARTED;
+				// fall through
+
+			case TOKEN_STARTED:
+
+				if (isDelim(*_cur) || isKeptDelim(*_cur))
+				{
+					return true;
+				}
+
+				switch (*_cur)
+				{
+				case '\"':
+					if (!tokenEmpty())
+					{
+						return true;
+					}
+
+					state = QUOTED;
+					++_cur;
+					continue; // skip the quote
+
+				case '/':
+					state = FORWARDSLASH;
+					++_cur;
+					continue; // skip slash, will be added back if this is not a comment
+
+				default:
+					appendSource(_cur++);
+					continue;
+				}
+
+			case QUOTED:
+
+				if (*_cur == '\"')
+				{
+					++_cur;
+					state = AFTER_CLOSING_QUOTE;
+					continue;
+				}
+				else if (*_cur == '\\')
+				{
+					const char* backslash = _cur++;
+
+					if (_cur != _end)
+					{
+						switch (*_cur)
+						{
+						case 'n': appendChar('\n'); break;
+						case 't': appendChar('\t'); break;
+						case '"': appendChar('"'); break;
+						default:
+							// No special escape sequence, keep the backslash and the character
+							appendSource(backslash);
+							appendSource(_cur);
+						}
+
+						++_cur;
+					}
+
+					continue;
+				}
+
+				appendSource(_cur++);
+				continue;
+
+			case AFTER_CLOSING_QUOTE:
+
+				if (*_cur == '\\')
+				{
+					++_cur;
+					state = SEARCHING_FOR_QUOTE;
+					continue;
+				}
+
+				if (isDelim(*_cur))
+				{
+					++_cur;
+					continue;
+				}
+
+				// The quoted content is not continued, return it (even if it is empty)
+				return true;
+
+			case SEARCHING_FOR_QUOTE:
+
+				if (isDelim(*_cur))
+				{
+					++_cur;
+					continue;
+				}
+
+				if (*_cur == '\"')
+				{
+					++_cur;
+					state = QUOTED;
+					continue;
+				}
+
+				throw ParseException("Could not find opening double quote after backslash.");
+
+			case FORWARDSLASH:
+
+				switch (*_cur)
+				{
+				case '*':
+					state = COMMENT_DELIM;
+					++_cur;
+					continue;
+
+				case '/':
+					state = COMMENT_EOL;
+					++_cur;
+					continue;
+
+				default: // false alarm, add the slash and carry on
+					state = TOKEN_STARTED;
+					appendSource(_cur - 1);
+					continue;
+				}
+
+			case COMMENT_DELIM:
+
+				if (*_cur == '*')
+				{
+					state = STAR;
+				}
+
+				++_cur;
+				continue;
+
+			case COMMENT_EOL:
+
+				if (*_cur == '\r' || *_cur == '\n')
+				{
+					++_cur;
+
+					if (!tokenEmpty())
+					{
+						return true;
+					}
+
+					state = SEARCHING;
+					continue;
+				}
+
+				++_cur;
+				continue;
+
+			case STAR:
+
+				if (*_cur == '/')
+				{
+					++_cur;
+
+					if (!tokenEmpty())
+					{
+						return true;
+					}
+
+					state = SEARCHING;
+					continue;
+				}
+				else if (*_cur == '*')
+				{
+					// Another star, remain in the STAR state in case we have a "**/"
+					++_cur;
+					continue;
+				}
+
+				state = COMMENT_DELIM;
+				++_cur;
+				continue;
+			}
+		}
+
+		return !tokenEmpty();
+	}
+};
+
+} // namespace parser
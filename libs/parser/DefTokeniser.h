@@ -7,6 +7,7 @@
 #include <ios>
 #include <string>
 #include "string/tokeniser.h"
+#include "string/from_chars.h"
 
 namespace parser
 {
@@ -424,6 +425,25 @@ public:
 	 * next without actually changing the tokeniser's state.
 	 */
 	virtual std::string peek() const = 0;
+
+    /**
+     * Consume the next token and return it converted to a floating point
+     * number. The conversion doesn't depend on the current locale. Trailing
+     * non-numeric characters are ignored, a token not starting with a number
+     * yields 0. Subclasses working on contiguous buffers override these to
+     * convert the token in place.
+     */
+    virtual double nextDouble()
+    {
+        const std::string tok = nextToken();
+        return string::from_chars<double>(tok.data(), tok.data() + tok.size());
+    }
+
+    virtual float nextFloat()
+    {
+        const std::string tok = nextToken();
+        return string::from_chars<float>(tok.data(), tok.data() + tok.size());
+    }
 };
 
 /**
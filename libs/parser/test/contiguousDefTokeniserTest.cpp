@@ -0,0 +1,159 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE contiguousDefTokeniserTest
+#include <boost/test/unit_test.hpp>
+
+#include "parser/ContiguousDefTokeniser.h"
+
+#include <string>
+#include <vector>
+
+using parser::BasicDefTokeniser;
+using parser::ContiguousDefTokeniser;
+
+namespace
+{
+    typedef std::vector<std::string> Tokens;
+
+    Tokens getTokens(parser::DefTokeniser& tok)
+    {
+        Tokens tokens;
+
+        while (tok.hasMoreTokens())
+        {
+            tokens.push_back(tok.nextToken());
+        }
+
+        return tokens;
+    }
+
+    // The ContiguousDefTokeniser is meant as a drop-in replacement of the
+    // BasicDefTokeniser, both need to produce the exact same token stream
+    void checkSameAsBasic(const std::string& source,
+                          const char* delims = parser::WHITESPACE,
+                          const char* keptDelims = "{}()")
+    {
+        BOOST_TEST_CONTEXT(source)
+        {
+            BasicDefTokeniser<std::string> basic(source, delims, keptDelims);
+            ContiguousDefTokeniser contiguous(source, delims, keptDelims);
+
+            Tokens expected = getTokens(basic);
+            Tokens tokens = getTokens(contiguous);
+
+            BOOST_CHECK_EQUAL_COLLECTIONS(tokens.begin(), tokens.end(), expected.begin(), expected.end());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(plainTokens)
+{
+    checkSameAsBasic("");
+    checkSameAsBasic("   \t\r\n ");
+    checkSameAsBasic("single");
+    checkSameAsBasic("textures/common/caulk 0 0 0");
+    checkSameAsBasic("  leading and trailing whitespace  \n");
+    checkSameAsBasic("-0.5 1e-3 +128.25 .5");
+}
+
+BOOST_AUTO_TEST_CASE(comments)
+{
+    checkSameAsBasic("before // comment\nafter");
+    checkSameAsBasic("before // comment at the end");
+    checkSameAsBasic("before /* delimited\n comment */ after");
+    checkSameAsBasic("before /** stars **/ after");
+    checkSameAsBasic("before /* unterminated comment");
+    checkSameAsBasic("token// comment\nafter");
+    checkSameAsBasic("token/* comment */after");
+    checkSameAsBasic("a/b textures/path/name /");
+    checkSameAsBasic("// only a comment");
+    checkSameAsBasic("windows // line endings\r\nafter");
+}
+
+BOOST_AUTO_TEST_CASE(quotedStrings)
+{
+    checkSameAsBasic("\"quoted string\" after");
+    checkSameAsBasic("\"\" empty");
+    checkSameAsBasic("\"{ braces ( and // comments }\"");
+    checkSameAsBasic("before\"quoted\"after");
+    checkSameAsBasic("\"first\"\"second\"");
+    checkSameAsBasic("\"continued \" \\ \"over\" \\\n \"lines\"");
+    checkSameAsBasic("\"unterminated quote");
+}
+
+BOOST_AUTO_TEST_CASE(escapedQuotes)
+{
+    checkSameAsBasic("\"say \\\"hello\\\"\" after");
+    checkSameAsBasic("\"tab\\tand\\nnewline\"");
+    checkSameAsBasic("\"unknown \\x escape\"");
+    checkSameAsBasic("\"trailing backslash \\\"");
+    checkSameAsBasic("\"escaped \\\"\" \\ \"continued\"");
+}
+
+BOOST_AUTO_TEST_CASE(delimiters)
+{
+    const char* source = "brushDef3 { ( 0 0 1 -64 ) ( ( 0.03 0 0 ) ( 0 0.03 0 ) ) \"textures/a\" 0 0 0 }";
+
+    // Kept delimiters are returned as tokens of their own
+    checkSameAsBasic(source);
+    checkSameAsBasic("{}(){{)(");
+
+    // Dropped delimiters only separate tokens
+    checkSameAsBasic(source, " \t\n\v\r(){}", "");
+
+    // Custom delimiters
+    checkSameAsBasic("key=value;other=\"quoted;value\"", ";", "=");
+    checkSameAsBasic("a,b,,c", ",", "");
+}
+
+BOOST_AUTO_TEST_CASE(peekAndViews)
+{
+    std::string source = "first \"second \\\"token\\\"\" third";
+    ContiguousDefTokeniser tok(source);
+
+    BOOST_CHECK_EQUAL(tok.peek(), "first");
+    BOOST_CHECK_EQUAL(tok.nextTokenView(), "first");
+
+    // The escaped token is assembled in a scratch buffer, it must survive peeking
+    std::string_view second = tok.nextTokenView();
+    BOOST_CHECK_EQUAL(tok.peekView(), "third");
+    BOOST_CHECK_EQUAL(second, "second \"token\"");
+
+    tok.assertNextToken("third");
+    BOOST_CHECK(!tok.hasMoreTokens());
+    BOOST_CHECK_THROW(tok.nextToken(), parser::ParseException);
+    BOOST_CHECK_THROW(tok.peek(), parser::ParseException);
+}
+
+BOOST_AUTO_TEST_CASE(getAndSetPosition)
+{
+    std::string source = "entity { \"classname\" \"light\" // comment\n brushDef3 { ( 1 2 3 ) } } tail";
+    ContiguousDefTokeniser tok(source);
+
+    BOOST_CHECK(tok.getPosition() == source.data());
+    BOOST_CHECK(tok.getEnd() == source.data() + source.size());
+
+    tok.skipTokens(4);
+
+    // Everything before the position has been consumed: tokenising the
+    // remainder from scratch yields the same tokens
+    const char* position = tok.getPosition();
+    std::string remainder(position, tok.getEnd());
+    BasicDefTokeniser<std::string> basic(remainder);
+
+    Tokens expected = getTokens(basic);
+    Tokens tokens = getTokens(tok);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(tokens.begin(), tokens.end(), expected.begin(), expected.end());
+    BOOST_CHECK(tok.getPosition() == tok.getEnd());
+
+    // Returning to a position continues from there
+    tok.setPosition(position);
+    tokens = getTokens(tok);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(tokens.begin(), tokens.end(), expected.begin(), expected.end());
+
+    // Skip over the brushDef3 block without tokenising it
+    tok.setPosition(source.data() + source.find("} } tail") + 4);
+    BOOST_CHECK_EQUAL(tok.nextToken(), "tail");
+    BOOST_CHECK(!tok.hasMoreTokens());
+}
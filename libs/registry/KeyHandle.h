@@ -0,0 +1,120 @@
+#pragma once
+
+#include "registry.h"
+
+#include <unordered_map>
+
+namespace registry
+{
+
+/**
+ * \brief
+ * Cache of the values of registry keys, converted to the type T.
+ *
+ * Each key is looked up in the registry the first time it's requested, the
+ * converted value is kept and updated through the signal of the key whenever
+ * the registry value changes. A value which is requested again costs a hash
+ * lookup, no XPath query and no conversion.
+ *
+ * Keys which don't exist in the registry are cached as a default-constructed
+ * T, like registry::getValue<T> would return them.
+ */
+template<typename T>
+class TypedKeyCache
+{
+public:
+	class Entry :
+		public sigc::trackable
+	{
+		const std::string _key;
+		T _value;
+
+	public:
+		Entry(const std::string& key) :
+			_key(key)
+		{
+			update();
+
+			GlobalRegistry().signalForKey(key).connect(
+				sigc::mem_fun(this, &Entry::update)
+			);
+		}
+
+		const T& getValue() const
+		{
+			return _value;
+		}
+
+	private:
+		void update()
+		{
+			_value = registry::getValue<T>(_key);
+		}
+	};
+
+private:
+	// The entries never move in memory, handles keep pointers to them
+	std::unordered_map<std::string, Entry> _entries;
+
+public:
+	// Returns the entry of the given key, creating it if necessary
+	const Entry& getEntry(const std::string& key)
+	{
+		typename std::unordered_map<std::string, Entry>::const_iterator found = _entries.find(key);
+
+		if (found != _entries.end())
+		{
+			return found->second;
+		}
+
+		return _entries.emplace(std::piecewise_construct,
+			std::forward_as_tuple(key), std::forward_as_tuple(key)).first->second;
+	}
+
+	// The cache of this module, shared by all keys of type T
+	static TypedKeyCache& Instance()
+	{
+		static TypedKeyCache _instance;
+		return _instance;
+	}
+};
+
+/**
+ * \brief
+ * Get the value of the given registry key converted to type T, through the
+ * TypedKeyCache. Returns the same as registry::getValue<T>(key) without a
+ * default value, but only the first read of a key queries the registry.
+ */
+template<typename T> const T& getCachedValue(const std::string& key)
+{
+	return TypedKeyCache<T>::Instance().getEntry(key).getValue();
+}
+
+/**
+ * \brief
+ * Handle to the cached value of a registry key, to be held by callers reading
+ * a key frequently. The handle points to the entry of the key in the
+ * TypedKeyCache, a read costs a pointer dereference and always returns the
+ * current value of the key.
+ *
+ * Handles can be copied freely, but must not be created before the registry
+ * module has been initialised.
+ */
+template<typename T>
+class KeyHandle
+{
+	const typename TypedKeyCache<T>::Entry* _entry;
+
+public:
+	KeyHandle(const std::string& key) :
+		_entry(&TypedKeyCache<T>::Instance().getEntry(key))
+	{}
+
+	/// Return the current value
+	const T& get() const
+	{
+		return _entry->getValue();
+	}
+};
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "NopVolumeTest.h"
+#include "math/Ray.h"
+
+namespace render
+{
+
+/**
+ * A VolumeTest representing the space covered by a Ray, allowing to query
+ * the scene graph's space partition for nodes possibly hit by the ray.
+ * Only the bounding box tests are implemented, the remaining tests of the
+ * NopVolumeTest always pass.
+ */
+class RayVolumeTest :
+	public NopVolumeTest
+{
+private:
+	Ray _ray;
+
+public:
+	RayVolumeTest(const Ray& ray) :
+		_ray(ray)
+	{}
+
+	VolumeIntersectionValue TestAABB(const AABB& aabb) const override
+	{
+		Vector3 intersection;
+		return _ray.intersectAABB(aabb, intersection) ? VOLUME_PARTIAL : VOLUME_OUTSIDE;
+	}
+
+	VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const override
+	{
+		return TestAABB(AABB::createFromOrientedAABBSafe(aabb, localToWorld));
+	}
+};
+
+}
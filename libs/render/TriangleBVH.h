@@ -0,0 +1,309 @@
+#pragma once
+
+#include "ivolumetest.h"
+#include "math/AABB.h"
+#include "math/Ray.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace render
+{
+
+/**
+ * Bounding volume hierarchy over the triangles of an indexed mesh, used to find
+ * the nearest intersection of a Ray with the mesh without testing every triangle,
+ * and to find the triangles possibly touching a volume (like the one of a
+ * selection test).
+ *
+ * The hierarchy only stores triangle numbers, the vertex and index arrays are
+ * passed to the constructor and to intersect() by the owning surface. The owner
+ * has to discard the hierarchy whenever its geometry changes. Rays are traced in
+ * the mesh's local space, so transforming the mesh doesn't invalidate it.
+ *
+ * Vertices need to provide a "vertex" member convertible to Vector3 (like the
+ * ArbitraryMeshVertex), indices are three per triangle.
+ */
+class TriangleBVH
+{
+private:
+	// Nodes are stored depth-first: the left child follows its parent directly
+	struct Node
+	{
+		Vector3 min;
+		Vector3 max;
+		std::uint32_t start; // leaf: first triangle in _triangles, inner node: index of the right child
+		std::uint32_t count; // number of triangles, 0 for inner nodes
+	};
+
+	std::vector<Node> _nodes;
+	std::vector<std::uint32_t> _triangles;
+
+	static const std::uint32_t MAX_LEAF_SIZE = 4;
+
+public:
+	template<typename Vertices, typename Indices>
+	TriangleBVH(const Vertices& vertices, const Indices& indices)
+	{
+		std::size_t numTriangles = indices.size() / 3;
+
+		if (numTriangles == 0) return;
+
+		// Triangle bounds and centroids, only needed during construction
+		std::vector<BuildTriangle> buildTriangles(numTriangles);
+
+		for (std::size_t i = 0; i < numTriangles; ++i)
+		{
+			BuildTriangle& triangle = buildTriangles[i];
+			const Vector3& p1 = vertices[indices[i*3]].vertex;
+			const Vector3& p2 = vertices[indices[i*3 + 1]].vertex;
+			const Vector3& p3 = vertices[indices[i*3 + 2]].vertex;
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				triangle.min[axis] = std::min({ p1[axis], p2[axis], p3[axis] });
+				triangle.max[axis] = std::max({ p1[axis], p2[axis], p3[axis] });
+			}
+
+			triangle.centroid = (triangle.min + triangle.max) * 0.5;
+			triangle.index = static_cast<std::uint32_t>(i);
+		}
+
+		_nodes.reserve(2 * numTriangles / MAX_LEAF_SIZE + 1);
+		buildNode(buildTriangles, 0, numTriangles);
+
+		_triangles.reserve(numTriangles);
+
+		for (const BuildTriangle& triangle : buildTriangles)
+		{
+			_triangles.push_back(triangle.index);
+		}
+	}
+
+	/**
+	 * Finds the nearest intersection of the given Ray with the mesh, ignoring
+	 * intersections located at the ray origin. Returns false if the ray doesn't
+	 * hit any triangle.
+	 */
+	template<typename Vertices, typename Indices>
+	bool intersect(const Ray& ray, const Vertices& vertices, const Indices& indices, Vector3& intersection) const
+	{
+		if (_nodes.empty()) return false;
+
+		double directionLengthSquared = ray.direction.dot(ray.direction);
+
+		if (directionLengthSquared == 0) return false;
+
+		Vector3 inverseDirection;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			inverseDirection[axis] = ray.direction[axis] != 0 ? 1.0 / ray.direction[axis] :
+				std::numeric_limits<double>::infinity();
+		}
+
+		double best = std::numeric_limits<double>::max();
+		bool found = false;
+
+		std::uint32_t stack[64];
+		std::size_t stackSize = 0;
+
+		if (getEntryDistance(_nodes[0], ray, inverseDirection, best) >= 0)
+		{
+			stack[stackSize++] = 0;
+		}
+
+		while (stackSize > 0)
+		{
+			const Node& node = _nodes[stack[--stackSize]];
+
+			if (node.count > 0)
+			{
+				for (std::uint32_t i = node.start; i < node.start + node.count; ++i)
+				{
+					std::size_t first = _triangles[i] * 3;
+					Vector3 candidate;
+
+					if (ray.intersectTriangle(vertices[indices[first]].vertex, vertices[indices[first + 1]].vertex,
+						vertices[indices[first + 2]].vertex, candidate) != Ray::POINT)
+					{
+						continue;
+					}
+
+					// The ray parameter of the hit, it orders the hits like their distance
+					double distance = (candidate - ray.origin).dot(ray.direction) / directionLengthSquared;
+
+					if (distance > 0 && distance < best)
+					{
+						best = distance;
+						intersection = candidate;
+						found = true;
+					}
+				}
+
+				continue;
+			}
+
+			std::uint32_t left = static_cast<std::uint32_t>(&node - _nodes.data()) + 1;
+			std::uint32_t right = node.start;
+
+			double leftDistance = getEntryDistance(_nodes[left], ray, inverseDirection, best);
+			double rightDistance = getEntryDistance(_nodes[right], ray, inverseDirection, best);
+
+			// Push the farther child first, such that the nearer one is visited first
+			if (leftDistance > rightDistance)
+			{
+				std::swap(left, right);
+				std::swap(leftDistance, rightDistance);
+			}
+
+			if (rightDistance >= 0) stack[stackSize++] = right;
+			if (leftDistance >= 0) stack[stackSize++] = left;
+		}
+
+		return found;
+	}
+
+	/**
+	 * Invokes the given functor for every triangle in the hierarchy nodes which
+	 * are not outside the given volume, the mesh is transformed by localToWorld.
+	 * The functor receives the position of the triangle's first index in the
+	 * index array: void(std::size_t firstIndex). The node bounds are tested
+	 * only, triangles outside the volume may still be passed to the functor.
+	 */
+	template<typename Functor>
+	void foreachTriangleInVolume(const VolumeTest& volume, const Matrix4& localToWorld, const Functor& functor) const
+	{
+		if (_nodes.empty()) return;
+
+		std::uint32_t stack[64];
+		std::size_t stackSize = 0;
+
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = _nodes[stack[--stackSize]];
+
+			if (volume.TestAABB(AABB::createFromMinMax(node.min, node.max), localToWorld) == VOLUME_OUTSIDE)
+			{
+				continue;
+			}
+
+			if (node.count > 0)
+			{
+				for (std::uint32_t i = node.start; i < node.start + node.count; ++i)
+				{
+					functor(static_cast<std::size_t>(_triangles[i]) * 3);
+				}
+
+				continue;
+			}
+
+			stack[stackSize++] = node.start;
+			stack[stackSize++] = static_cast<std::uint32_t>(&node - _nodes.data()) + 1;
+		}
+	}
+
+private:
+	struct BuildTriangle
+	{
+		Vector3 min;
+		Vector3 max;
+		Vector3 centroid;
+		std::uint32_t index;
+	};
+
+	// Builds the node covering the given range of triangles, returns its index
+	std::uint32_t buildNode(std::vector<BuildTriangle>& triangles, std::size_t begin, std::size_t end)
+	{
+		std::uint32_t nodeIndex = static_cast<std::uint32_t>(_nodes.size());
+		_nodes.emplace_back();
+
+		Vector3 min = triangles[begin].min;
+		Vector3 max = triangles[begin].max;
+		Vector3 centroidMin = triangles[begin].centroid;
+		Vector3 centroidMax = triangles[begin].centroid;
+
+		for (std::size_t i = begin + 1; i < end; ++i)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				min[axis] = std::min(min[axis], triangles[i].min[axis]);
+				max[axis] = std::max(max[axis], triangles[i].max[axis]);
+				centroidMin[axis] = std::min(centroidMin[axis], triangles[i].centroid[axis]);
+				centroidMax[axis] = std::max(centroidMax[axis], triangles[i].centroid[axis]);
+			}
+		}
+
+		_nodes[nodeIndex].min = min;
+		_nodes[nodeIndex].max = max;
+
+		Vector3 centroidExtents = centroidMax - centroidMin;
+		int axis = centroidExtents.x() > centroidExtents.y() ?
+			(centroidExtents.x() > centroidExtents.z() ? 0 : 2) :
+			(centroidExtents.y() > centroidExtents.z() ? 1 : 2);
+
+		// Stop at small ranges, or if all centroids are at the same position
+		if (end - begin <= MAX_LEAF_SIZE || centroidExtents[axis] == 0)
+		{
+			_nodes[nodeIndex].start = static_cast<std::uint32_t>(begin);
+			_nodes[nodeIndex].count = static_cast<std::uint32_t>(end - begin);
+			return nodeIndex;
+		}
+
+		// Split at the median centroid along the largest axis
+		std::size_t middle = begin + (end - begin) / 2;
+
+		std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end,
+			[&](const BuildTriangle& a, const BuildTriangle& b) { return a.centroid[axis] < b.centroid[axis]; });
+
+		buildNode(triangles, begin, middle);
+		std::uint32_t right = buildNode(triangles, middle, end);
+
+		_nodes[nodeIndex].start = right;
+		_nodes[nodeIndex].count = 0;
+
+		return nodeIndex;
+	}
+
+	// Returns the ray parameter at which the ray enters the node's bounds,
+	// or -1 if it misses them or only enters beyond the given maximum
+	static double getEntryDistance(const Node& node, const Ray& ray, const Vector3& inverseDirection, double maxDistance)
+	{
+		double entry = 0;
+		double exit = maxDistance;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (ray.direction[axis] == 0)
+			{
+				// Parallel to the slab, the origin has to be in between
+				if (ray.origin[axis] < node.min[axis] || ray.origin[axis] > node.max[axis])
+				{
+					return -1;
+				}
+
+				continue;
+			}
+
+			double t1 = (node.min[axis] - ray.origin[axis]) * inverseDirection[axis];
+			double t2 = (node.max[axis] - ray.origin[axis]) * inverseDirection[axis];
+
+			if (t1 > t2) std::swap(t1, t2);
+
+			entry = std::max(entry, t1);
+			exit = std::min(exit, t2);
+
+			if (entry > exit)
+			{
+				return -1;
+			}
+		}
+
+		return entry;
+	}
+};
+
+}
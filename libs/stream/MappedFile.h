@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#ifdef WIN32
+#include <windows.h>
+
+#undef min
+#undef max
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace stream
+{
+
+/**
+ * A read-only view of a whole file mapped into the address space of the process.
+ * The mapped contents can be accessed from any number of threads without
+ * synchronisation, as long as this instance is alive.
+ *
+ * Mapping can fail (e.g. if the file doesn't exist or the address space is
+ * exhausted), client code should check failed() and fall back to regular file
+ * streams in this case. Empty files are never mapped.
+ */
+class MappedFile
+{
+private:
+	const unsigned char* _data;
+	std::size_t _size;
+
+#ifdef WIN32
+	HANDLE _file;
+	HANDLE _mapping;
+#endif
+
+public:
+	typedef unsigned char byte_type;
+
+	MappedFile(const std::string& path) :
+		_data(nullptr),
+		_size(0)
+#ifdef WIN32
+		, _file(INVALID_HANDLE_VALUE),
+		_mapping(nullptr)
+#endif
+	{
+#ifdef WIN32
+		_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (_file == INVALID_HANDLE_VALUE) return;
+
+		LARGE_INTEGER size;
+
+		if (!GetFileSizeEx(_file, &size) || size.QuadPart <= 0 ||
+			static_cast<unsigned long long>(size.QuadPart) > static_cast<std::size_t>(-1))
+		{
+			return;
+		}
+
+		_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (_mapping == nullptr) return;
+
+		_data = static_cast<const byte_type*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+
+		if (_data != nullptr)
+		{
+			_size = static_cast<std::size_t>(size.QuadPart);
+		}
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+
+		if (fd == -1) return;
+
+		struct stat st;
+
+		if (fstat(fd, &st) == 0 && st.st_size > 0 &&
+			static_cast<unsigned long long>(st.st_size) <= static_cast<std::size_t>(-1))
+		{
+			void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (data != MAP_FAILED)
+			{
+				_data = static_cast<const byte_type*>(data);
+				_size = static_cast<std::size_t>(st.st_size);
+			}
+		}
+
+		// The mapping stays valid after the descriptor has been closed
+		close(fd);
+#endif
+	}
+
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator=(const MappedFile& other) = delete;
+
+	~MappedFile()
+	{
+#ifdef WIN32
+		if (_data != nullptr) UnmapViewOfFile(_data);
+		if (_mapping != nullptr) CloseHandle(_mapping);
+		if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+#else
+		if (_data != nullptr) munmap(const_cast<byte_type*>(_data), _size);
+#endif
+	}
+
+	bool failed() const
+	{
+		return _data == nullptr;
+	}
+
+	// The start of the mapped contents, NULL if the mapping failed
+	const byte_type* data() const
+	{
+		return _data;
+	}
+
+	std::size_t size() const
+	{
+		return _size;
+	}
+};
+
+}
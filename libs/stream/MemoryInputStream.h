@@ -0,0 +1,39 @@
+#pragma once
+
+#include "idatastream.h"
+#include <algorithm>
+#include <cstring>
+
+namespace stream
+{
+
+/**
+ * InputStream reading from a fixed memory range, which must stay valid
+ * during the lifetime of this stream. In contrast to PointerInputStream
+ * reads are bounded by the end of the range.
+ */
+class MemoryInputStream :
+	public InputStream
+{
+private:
+	const byte_type* _cur;
+	const byte_type* _end;
+
+public:
+	MemoryInputStream(const byte_type* data, size_type size) :
+		_cur(data),
+		_end(data + size)
+	{}
+
+	size_type read(byte_type* buffer, size_type length) override
+	{
+		size_type count = std::min(static_cast<size_type>(_end - _cur), length);
+
+		std::memcpy(buffer, _cur, count);
+		_cur += count;
+
+		return count;
+	}
+};
+
+}
@@ -4,8 +4,11 @@
 #include <cstdint>
 
 #include "idatastream.h"
+#include <istream>
 #include <ostream>
+#include <string>
 #include <algorithm>
+#include <type_traits>
 
 namespace stream
 {
@@ -42,6 +45,47 @@ void writeLittleEndian(std::ostream& stream, ValueType value)
 	stream.write(reinterpret_cast<const char*>(&output), sizeof(ValueType));
 }
 
+/**
+ * Writes the bytes of the given trivially copyable value in the byte order of the
+ * calling platform. Only meant for data read back by the same process.
+ */
+template<typename ValueType>
+void writeNative(std::ostream& stream, const ValueType& value)
+{
+	static_assert(std::is_trivially_copyable<ValueType>::value, "Value must be trivially copyable");
+
+	stream.write(reinterpret_cast<const char*>(&value), sizeof(ValueType));
+}
+
+/**
+ * Reads a value written by writeNative(), returns false if the stream ran out of data.
+ */
+template<typename ValueType>
+bool readNative(std::istream& stream, ValueType& value)
+{
+	static_assert(std::is_trivially_copyable<ValueType>::value, "Value must be trivially copyable");
+
+	return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(ValueType)));
+}
+
+// Writes the length of the string followed by its characters, see readNative()
+inline void writeNativeString(std::ostream& stream, const std::string& value)
+{
+	writeNative<std::uint64_t>(stream, value.size());
+	stream.write(value.data(), value.size());
+}
+
+inline bool readNativeString(std::istream& stream, std::string& value)
+{
+	std::uint64_t size;
+
+	if (!readNative(stream, size)) return false;
+
+	value.resize(static_cast<std::size_t>(size));
+
+	return static_cast<bool>(stream.read(&value[0], value.size()));
+}
+
 /**
  * greebo: Read an integer type stored in little endian format 
  * from the given stream and returns its value.
@@ -72,4 +116,21 @@ inline InputStream::byte_type readByte(InputStream& stream)
 	return value;
 }
 
+/**
+ * Reads the remaining contents of the given stream into a single string,
+ * such that it can be processed as one contiguous character range.
+ */
+inline std::string readToString(std::istream& stream)
+{
+	std::string contents;
+	char chunk[65536];
+
+	while (stream.read(chunk, sizeof(chunk)) || stream.gcount() > 0)
+	{
+		contents.append(chunk, static_cast<std::size_t>(stream.gcount()));
+	}
+
+	return contents;
+}
+
 }
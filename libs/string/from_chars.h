@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <sstream>
+#include <locale>
+#include <type_traits>
+
+namespace string
+{
+
+/**
+ * Locale-independent conversion of the number found at the beginning of the
+ * character range [begin, end), in the style of std::from_chars. Like atof(),
+ * leading whitespace is skipped and any trailing non-numeric characters are
+ * ignored. Floating point input may be hexadecimal ("0x1.8p3"), values too
+ * large for T yield +/-HUGE_VAL, values too small yield zero. Returns the
+ * given default value if the range doesn't start with a valid number.
+ *
+ * No temporary string is involved, which makes this suitable for converting
+ * tokens directly in the parse buffer.
+ */
+template<typename T>
+inline T from_chars(const char* begin, const char* end, T defaultVal = T())
+{
+	while (begin != end && std::isspace(static_cast<unsigned char>(*begin)))
+	{
+		++begin;
+	}
+
+	// std::from_chars doesn't accept a leading plus sign
+	if (end - begin > 1 && *begin == '+' && begin[1] != '-')
+	{
+		++begin;
+	}
+
+	T value;
+
+#ifdef __cpp_lib_to_chars
+	if constexpr (std::is_floating_point<T>::value)
+	{
+		bool negative = begin != end && *begin == '-';
+		const char* digits = negative ? begin + 1 : begin;
+
+		if (digits != end && (*digits == '-' || *digits == '+'))
+		{
+			return defaultVal;
+		}
+
+		std::chars_format format = std::chars_format::general;
+
+		// The hexadecimal format of std::from_chars expects no 0x prefix
+		if (end - digits > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'))
+		{
+			digits += 2;
+			format = std::chars_format::hex;
+		}
+
+		std::from_chars_result result = std::from_chars(digits, end, value, format);
+
+		if (result.ec == std::errc::result_out_of_range)
+		{
+			// A negative exponent means the value is too small to be represented
+			const char* exponent = std::find_if(digits, result.ptr, [&](char c)
+			{
+				return format == std::chars_format::hex ? (c == 'p' || c == 'P') : (c == 'e' || c == 'E');
+			});
+
+			bool underflow = exponent + 1 < result.ptr && exponent[1] == '-';
+			value = underflow ? T(0) : static_cast<T>(HUGE_VAL);
+		}
+		else if (result.ec != std::errc())
+		{
+			return defaultVal;
+		}
+
+		return negative ? -value : value;
+	}
+#else
+	if constexpr (std::is_floating_point<T>::value)
+	{
+		// No floating point support in <charconv>, use a stream with the classic locale
+		std::istringstream stream(std::string(begin, end));
+		stream.imbue(std::locale::classic());
+
+		return stream >> value ? value : defaultVal;
+	}
+#endif
+	else
+	{
+		std::from_chars_result result = std::from_chars(begin, end, value);
+
+		return result.ec == std::errc() ? value : defaultVal;
+	}
+}
+
+}
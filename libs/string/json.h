@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <cstdio>
+
+namespace string
+{
+
+/**
+ * Returns a copy of the given string which can be placed between the quotes
+ * of a JSON string value. Quotes, backslashes and all control characters
+ * are escaped, everything else (including UTF-8 sequences) is copied as is.
+ */
+inline std::string escape_json(const std::string& input)
+{
+	std::string output;
+	output.reserve(input.size());
+
+	for (char c : input)
+	{
+		switch (c)
+		{
+		case '"': output += "\\\""; break;
+		case '\\': output += "\\\\"; break;
+		case '\b': output += "\\b"; break;
+		case '\f': output += "\\f"; break;
+		case '\n': output += "\\n"; break;
+		case '\r': output += "\\r"; break;
+		case '\t': output += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				// The remaining control characters have no short form
+				char escaped[7];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+				output += escaped;
+			}
+			else
+			{
+				output += c;
+			}
+		}
+	}
+
+	return output;
+}
+
+}
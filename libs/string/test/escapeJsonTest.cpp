@@ -0,0 +1,31 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE escapeJsonTest
+#include <boost/test/unit_test.hpp>
+
+#include "string/json.h"
+
+BOOST_AUTO_TEST_CASE(plainStringsAreCopied)
+{
+    BOOST_CHECK_EQUAL(string::escape_json(""), "");
+    BOOST_CHECK_EQUAL(string::escape_json("maps/test.map"), "maps/test.map");
+
+    // UTF-8 sequences are valid in JSON strings
+    BOOST_CHECK_EQUAL(string::escape_json("caf\xc3\xa9"), "caf\xc3\xa9");
+}
+
+BOOST_AUTO_TEST_CASE(quotesAndBackslashes)
+{
+    BOOST_CHECK_EQUAL(string::escape_json("say \"hi\""), "say \\\"hi\\\"");
+    BOOST_CHECK_EQUAL(string::escape_json("C:\\maps\\test.map"), "C:\\\\maps\\\\test.map");
+}
+
+BOOST_AUTO_TEST_CASE(controlCharacters)
+{
+    BOOST_CHECK_EQUAL(string::escape_json("a\tb\nc\rd"), "a\\tb\\nc\\rd");
+    BOOST_CHECK_EQUAL(string::escape_json("\b\f"), "\\b\\f");
+    BOOST_CHECK_EQUAL(string::escape_json(std::string("\x01\x1f", 2)), "\\u0001\\u001f");
+    BOOST_CHECK_EQUAL(string::escape_json(std::string("a\0b", 3)), "a\\u0000b");
+
+    // DEL is no control character in JSON
+    BOOST_CHECK_EQUAL(string::escape_json("\x7f"), "\x7f");
+}
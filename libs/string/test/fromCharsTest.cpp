@@ -0,0 +1,89 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE fromCharsTest
+#include <boost/test/unit_test.hpp>
+
+#include "string/from_chars.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    double parseDouble(const char* str)
+    {
+        return string::from_chars<double>(str, str + std::strlen(str));
+    }
+
+    float parseFloat(const char* str)
+    {
+        return string::from_chars<float>(str, str + std::strlen(str));
+    }
+
+    // from_chars is meant as a drop-in replacement of atof for map tokens
+    void checkMatchesAtof(const char* str)
+    {
+        BOOST_TEST_CONTEXT(str)
+        {
+            BOOST_CHECK_EQUAL(parseDouble(str), std::atof(str));
+            BOOST_CHECK_EQUAL(parseFloat(str), static_cast<float>(std::atof(str)));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parseNumbers)
+{
+    checkMatchesAtof("0");
+    checkMatchesAtof("15");
+    checkMatchesAtof("-0.5");
+    checkMatchesAtof("+128.25");
+    checkMatchesAtof("1e-3");
+    checkMatchesAtof("-3.0517578125e-05");
+    checkMatchesAtof(".75");
+}
+
+BOOST_AUTO_TEST_CASE(skipLeadingWhitespace)
+{
+    checkMatchesAtof(" 1.5");
+    checkMatchesAtof("\t-2");
+    checkMatchesAtof("\n \r+3.25");
+}
+
+BOOST_AUTO_TEST_CASE(ignoreTrailingCharacters)
+{
+    checkMatchesAtof("1.5)");
+    checkMatchesAtof("-7abc");
+    checkMatchesAtof("2e");
+}
+
+BOOST_AUTO_TEST_CASE(outOfRange)
+{
+    checkMatchesAtof("1e400");
+    checkMatchesAtof("-1e400");
+    checkMatchesAtof("1e-400");
+    checkMatchesAtof("-1e-400");
+
+    BOOST_CHECK_EQUAL(parseDouble("1e400"), HUGE_VAL);
+    BOOST_CHECK_EQUAL(parseDouble("-1e400"), -HUGE_VAL);
+    BOOST_CHECK_EQUAL(parseFloat("1e40"), HUGE_VALF);
+    BOOST_CHECK_EQUAL(parseFloat("1e-50"), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(hexadecimal)
+{
+    checkMatchesAtof("0x10");
+    checkMatchesAtof("-0X1.8p3");
+    checkMatchesAtof("0x1p-2");
+    checkMatchesAtof("0x");
+}
+
+BOOST_AUTO_TEST_CASE(invalidInput)
+{
+    checkMatchesAtof("");
+    checkMatchesAtof("abc");
+    checkMatchesAtof("--1");
+    checkMatchesAtof("+-1");
+    checkMatchesAtof("-");
+
+    const char* str = "abc";
+    BOOST_CHECK_EQUAL(string::from_chars<double>(str, str + 3, 4.5), 4.5);
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "iworkerpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace util
+{
+
+/**
+ * Returns the number of worker threads to use for data-parallel algorithms,
+ * which is the number of hardware threads (including the calling thread).
+ */
+inline std::size_t getNumWorkerThreads()
+{
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+namespace detail
+{
+
+/**
+ * The chunks of a single parallelFor call. Helpers posted to the pool only
+ * take part while the call is still processing: once the calling thread has
+ * run out of chunks, the job is closed and late helpers return right away.
+ * The caller only waits for the helpers that joined, never for tasks queued
+ * behind other work, so nested calls can't deadlock.
+ */
+struct ParallelJob
+{
+	std::function<void(std::size_t)> processChunk;
+	std::size_t numChunks;
+	std::atomic<std::size_t> nextChunk;
+	std::atomic<bool> failed;
+
+	std::mutex lock;
+	std::condition_variable helpersDone;
+	std::size_t activeHelpers;
+	bool closed;
+	std::exception_ptr error;
+
+	ParallelJob(std::size_t numChunks_) :
+		numChunks(numChunks_),
+		nextChunk(0),
+		failed(false),
+		activeHelpers(0),
+		closed(false)
+	{}
+
+	// Processes chunks until there are none left
+	void work()
+	{
+		while (!failed)
+		{
+			std::size_t chunk = nextChunk++;
+
+			if (chunk >= numChunks) break;
+
+			try
+			{
+				processChunk(chunk);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> guard(lock);
+
+				if (!error)
+				{
+					error = std::current_exception();
+				}
+
+				failed = true;
+			}
+		}
+	}
+
+	void help()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (closed) return;
+
+			++activeHelpers;
+		}
+
+		work();
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			--activeHelpers;
+		}
+
+		helpersDone.notify_one();
+	}
+
+	// Called by the owning thread after its own work() returned
+	void close()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+
+		closed = true;
+		helpersDone.wait(guard, [this]() { return activeHelpers == 0; });
+	}
+};
+
+} // namespace detail
+
+/**
+ * Invokes the given functor for every index in the range [0, count), distributing
+ * the work across the available hardware threads. The range is split into chunks
+ * of the given size, which are picked up by the workers in ascending order. The
+ * functor signature is void(std::size_t index).
+ *
+ * The calling thread takes part in the work, this function returns after all
+ * indices have been processed. There is no ordering guarantee between chunks,
+ * the functor must be safe to call concurrently for different indices. The
+ * other workers are threads of the application's worker pool, modules calling
+ * this need to list MODULE_WORKERPOOL in their dependencies. Once the pool is
+ * shut down, all indices are processed by the calling thread.
+ *
+ * If the functor throws, the remaining chunks are skipped and the first exception
+ * is re-thrown in the calling thread.
+ */
+template<typename Functor>
+void parallelFor(std::size_t count, const Functor& functor, std::size_t chunkSize = 64)
+{
+	if (count == 0) return;
+
+	chunkSize = std::max<std::size_t>(chunkSize, 1);
+
+	std::size_t numChunks = (count + chunkSize - 1) / chunkSize;
+
+	if (numChunks == 1)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			functor(i);
+		}
+
+		return;
+	}
+
+	util::IWorkerPool& pool = GlobalWorkerPool();
+
+	// Queued helpers may outlive this call, they share the ownership of the job
+	std::shared_ptr<detail::ParallelJob> job = std::make_shared<detail::ParallelJob>(numChunks);
+
+	job->processChunk = [&](std::size_t chunk)
+	{
+		std::size_t end = std::min(count, (chunk + 1) * chunkSize);
+
+		for (std::size_t i = chunk * chunkSize; i < end; ++i)
+		{
+			functor(i);
+		}
+	};
+
+	std::size_t numHelpers = std::min(pool.getNumThreads(), numChunks - 1);
+
+	for (std::size_t i = 0; i < numHelpers; ++i)
+	{
+		pool.post([job]() { job->help(); });
+	}
+
+	job->work();
+	job->close();
+
+	if (job->error)
+	{
+		std::rethrow_exception(job->error);
+	}
+}
+
+} // namespace util
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+
+namespace util
+{
+
+/// Measures the wall clock time since its construction or the last restart(),
+/// used by the Benchmark* console commands to time their stages
+class Stopwatch
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point _start;
+
+public:
+
+    /// Construct and start measuring
+    Stopwatch() :
+        _start(Clock::now())
+    {}
+
+    /// Start measuring again from now on
+    void restart()
+    {
+        _start = Clock::now();
+    }
+
+    /// The time passed since the start in milliseconds
+    double getMilliseconds() const
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - _start).count();
+    }
+};
+
+}
@@ -14,21 +14,28 @@ namespace archive
 ///
 /// - Uses z_stream to decompress the data stream on the fly.
 /// - Uses a buffer to reduce the number of times the wrapped stream must be read.
+/// - Alternatively inflates a memory range directly, without any intermediate buffer.
 class DeflatedInputStream :
 	public InputStream
 {
 private:
-	InputStream& _istream;
+	InputStream* _istream; // NULL if inflating a memory range
 	std::unique_ptr<z_stream> _zipStream;
 	unsigned char _buffer[1024];
 
 public:
 	DeflatedInputStream(InputStream& istream);
 
+	// Inflates the given compressed data, which must stay valid during the lifetime of this stream
+	DeflatedInputStream(const byte_type* data, size_type size);
+
 	virtual ~DeflatedInputStream();
 
 	// InputStream implementation
 	size_type read(byte_type* buffer, size_type length) override;
+
+private:
+	void initialise();
 };
 
 }
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "iarchive.h"
+#include "stream/MappedFile.h"
+#include "stream/MemoryInputStream.h"
+#include "stream/BinaryToTextInputStream.h"
+#include "DeflatedInputStream.h"
+#include <memory>
+
+namespace archive
+{
+
+/**
+ * ArchiveFile reading its data from the memory-mapped ZIP file. Stored data is
+ * copied out of the mapping directly, deflated data is inflated from the mapping
+ * without going through an intermediate file stream. Each instance carries its
+ * own stream state, so any number of them can be read in parallel.
+ */
+class MappedArchiveFile :
+	public ArchiveFile
+{
+private:
+	std::string _name;
+	std::shared_ptr<stream::MappedFile> _mapping; // keeps the mapping alive
+	std::unique_ptr<InputStream> _stream;
+	std::size_t _size;
+
+public:
+	MappedArchiveFile(const std::string& name,
+					  const std::shared_ptr<stream::MappedFile>& mapping,
+					  std::size_t position,
+					  std::size_t stream_size,
+					  std::size_t file_size,
+					  bool deflated) :
+		_name(name),
+		_mapping(mapping),
+		_size(file_size)
+	{
+		const InputStream::byte_type* data = _mapping->data() + position;
+
+		if (deflated)
+		{
+			_stream.reset(new DeflatedInputStream(data, stream_size));
+		}
+		else
+		{
+			_stream.reset(new stream::MemoryInputStream(data, stream_size));
+		}
+	}
+
+	std::size_t size() const override
+	{
+		return _size;
+	}
+
+	const std::string& getName() const override
+	{
+		return _name;
+	}
+
+	InputStream& getInputStream() override
+	{
+		return *_stream;
+	}
+};
+
+/**
+ * ArchiveTextFile counterpart of the MappedArchiveFile.
+ */
+class MappedArchiveTextFile :
+	public ArchiveTextFile
+{
+private:
+	MappedArchiveFile _file;
+	stream::BinaryToTextInputStream<InputStream> _textStream; // converts data from _file
+
+	// Mod directory containing this file
+	const std::string _modName;
+
+public:
+	MappedArchiveTextFile(const std::string& name,
+						  const std::shared_ptr<stream::MappedFile>& mapping,
+						  const std::string& modName,
+						  std::size_t position,
+						  std::size_t stream_size,
+						  bool deflated) :
+		_file(name, mapping, position, stream_size, 0, deflated),
+		_textStream(_file.getInputStream()),
+		_modName(modName)
+	{}
+
+	TextInputStream& getInputStream() override
+	{
+		return _textStream;
+	}
+
+	const std::string& getName() const override
+	{
+		return _file.getName();
+	}
+
+	std::string getModName() const override
+	{
+		return _modName;
+	}
+};
+
+}
@@ -1,6 +1,7 @@
 #include "ZipArchive.h"
 
 #include <stdexcept>
+#include <cstring>
 #include "itextstream.h"
 #include "iarchive.h"
 #include "gamelib.h"
@@ -8,12 +9,14 @@
 
 #include "os/fs.h"
 #include "os/path.h"
+#include "stream/MemoryInputStream.h"
 
 #include "ZipStreamUtils.h"
 #include "DeflatedArchiveFile.h"
 #include "DeflatedArchiveTextFile.h"
 #include "StoredArchiveFile.h"
 #include "StoredArchiveTextFile.h"
+#include "MappedArchiveFile.h"
 
 namespace archive
 {
@@ -28,14 +31,99 @@ public:
 	{}
 };
 
+namespace
+{
+	const uint32_t ZIP_INDEX_VERSION = 1;
+
+	// Type tags of the index entries
+	const uint8_t INDEX_ENTRY_STORED = 0;
+	const uint8_t INDEX_ENTRY_DEFLATED = 1;
+	const uint8_t INDEX_ENTRY_DIRECTORY = 2;
+
+	template<typename T>
+	void writeIndexValue(std::string& index, T value)
+	{
+		index.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	// Reads values from an index string, throws ZipFailureException if it is truncated
+	class IndexReader
+	{
+	private:
+		const char* _cur;
+		const char* _end;
+
+	public:
+		IndexReader(const std::string& index) :
+			_cur(index.data()),
+			_end(index.data() + index.size())
+		{}
+
+		template<typename T>
+		T read()
+		{
+			T value;
+			std::memcpy(&value, advance(sizeof(T)), sizeof(T));
+			return value;
+		}
 
-ZipArchive::ZipArchive(const std::string& fullPath) :
+		std::string readString(std::size_t length)
+		{
+			return std::string(advance(length), length);
+		}
+
+		bool atEnd() const
+		{
+			return _cur == _end;
+		}
+
+	private:
+		const char* advance(std::size_t length)
+		{
+			if (static_cast<std::size_t>(_end - _cur) < length)
+			{
+				throw ZipFailureException("Index is truncated");
+			}
+
+			const char* position = _cur;
+			_cur += length;
+
+			return position;
+		}
+	};
+}
+
+
+ZipArchive::ZipArchive(const std::string& fullPath, const std::string& index) :
 	_fullPath(fullPath),
 	_containingFolder(os::standardPathWithSlash(fs::path(_fullPath).remove_filename())),
 	_modName(game::current::getModPath(_containingFolder)),
-	_istream(_fullPath)
+	_mapping(std::make_shared<stream::MappedFile>(_fullPath))
 {
-	if (_istream.failed())
+	if (_mapping->failed())
+	{
+		rWarning() << "Cannot map Zip file " << _fullPath << ", falling back to file streams" << std::endl;
+		_mapping.reset();
+	}
+
+	if (!index.empty())
+	{
+		try
+		{
+			loadIndex(index);
+			return;
+		}
+		catch (ZipFailureException& ex)
+		{
+			rWarning() << "Cannot use the index of Zip file " << _fullPath << ": " << ex.what() << std::endl;
+			_filesystem.clear();
+		}
+	}
+
+	// The stream is only needed while reading the central directory
+	stream::FileInputStream istream(_fullPath);
+
+	if (istream.failed())
 	{
 		rError() << "Cannot open Zip file stream: " << _fullPath << std::endl;
 		return;
@@ -44,7 +132,7 @@ ZipArchive::ZipArchive(const std::string& fullPath) :
 	try
 	{
 		// Try loading the zip file, this will throw exceptoions on any problem
-		loadZipFile();
+		loadZipFile(istream);
 	}
 	catch (ZipFailureException& ex)
 	{
@@ -65,32 +153,18 @@ ArchiveFilePtr ZipArchive::openFile(const std::string& name)
 	{
 		const std::shared_ptr<ZipRecord>& file = i->second.getRecord();
 
-		stream::FileInputStream::size_type position = 0;
-
+		if (_mapping)
 		{
-			// Guard against concurrent access
-			std::lock_guard<std::mutex> lock(_streamLock);
-
-			_istream.seek(file->position);
-
-			ZipFileHeader header;
-			stream::readZipFileHeader(_istream, header);
-
-			position = _istream.tell();
-
-			if (header.magic != ZIP_MAGIC_FILE_HEADER)
-			{
-				rError() << "Error reading zip file " << _fullPath << std::endl;
-				return ArchiveFilePtr();
-			}
+			return std::make_shared<MappedArchiveFile>(name, _mapping, file->position,
+				file->stream_size, file->file_size, file->mode == ZipRecord::eDeflated);
 		}
 
 		switch (file->mode)
 		{
 		case ZipRecord::eStored:
-			return std::make_shared<StoredArchiveFile>(name, _fullPath, position, file->stream_size, file->file_size);
+			return std::make_shared<StoredArchiveFile>(name, _fullPath, file->position, file->stream_size, file->file_size);
 		case ZipRecord::eDeflated:
-			return std::make_shared<DeflatedArchiveFile>(name, _fullPath, position, file->stream_size, file->file_size);
+			return std::make_shared<DeflatedArchiveFile>(name, _fullPath, file->position, file->stream_size, file->file_size);
 		}
 	}
 
@@ -105,27 +179,19 @@ ArchiveTextFilePtr ZipArchive::openTextFile(const std::string& name)
 	{
 		const std::shared_ptr<ZipRecord>& file = i->second.getRecord();
 
-		// Guard against concurrent access
-		std::lock_guard<std::mutex> lock(_streamLock);
-
-		_istream.seek(file->position);
-
-		ZipFileHeader header;
-		stream::readZipFileHeader(_istream, header);
-
-		if (header.magic != ZIP_MAGIC_FILE_HEADER)
+		if (_mapping)
 		{
-			rError() << "Error reading zip file " << _fullPath << std::endl;
-			return ArchiveTextFilePtr();
+			return std::make_shared<MappedArchiveTextFile>(name, _mapping, _modName, file->position,
+				file->stream_size, file->mode == ZipRecord::eDeflated);
 		}
 
 		switch (file->mode)
 		{
 		case ZipRecord::eStored:
-			return std::make_shared<StoredArchiveTextFile>(name, _fullPath, _modName, _istream.tell(), file->stream_size);
+			return std::make_shared<StoredArchiveTextFile>(name, _fullPath, _modName, file->position, file->stream_size);
 
 		case ZipRecord::eDeflated:
-			return std::make_shared<DeflatedArchiveTextFile>(name, _fullPath, _modName, _istream.tell(), file->stream_size);
+			return std::make_shared<DeflatedArchiveTextFile>(name, _fullPath, _modName, file->position, file->stream_size);
 		}
 	}
 
@@ -143,10 +209,10 @@ void ZipArchive::traverse(Visitor& visitor, const std::string& root)
 	_filesystem.traverse(visitor, root);
 }
 
-void ZipArchive::readZipRecord()
+void ZipArchive::readZipRecord(stream::FileInputStream& istream)
 {
 	ZipMagic magic;
-	stream::readZipMagic(_istream, magic);
+	stream::readZipMagic(istream, magic);
 
 	if (magic != ZIP_MAGIC_ROOT_DIR_ENTRY)
 	{
@@ -154,14 +220,14 @@ void ZipArchive::readZipRecord()
 	}
 
 	ZipVersion version_encoder;
-	stream::readZipVersion(_istream, version_encoder);
+	stream::readZipVersion(istream, version_encoder);
 	ZipVersion version_extract;
-	stream::readZipVersion(_istream, version_extract);
+	stream::readZipVersion(istream, version_extract);
 
 	//unsigned short flags =
-	stream::readLittleEndian<int16_t>(_istream);
+	stream::readLittleEndian<int16_t>(istream);
 	
-	uint16_t compression_mode = stream::readLittleEndian<uint16_t>(_istream);
+	uint16_t compression_mode = stream::readLittleEndian<uint16_t>(istream);
 
 	if (compression_mode != Z_DEFLATED && compression_mode != 0)
 	{
@@ -169,25 +235,25 @@ void ZipArchive::readZipRecord()
 	}
 
 	ZipDosTime dostime;
-	stream::readZipDosTime(_istream, dostime);
+	stream::readZipDosTime(istream, dostime);
 
 	//unsigned int crc32 =
-	stream::readLittleEndian<uint32_t>(_istream);
+	stream::readLittleEndian<uint32_t>(istream);
 	
-	uint32_t compressed_size = stream::readLittleEndian<uint32_t>(_istream);
-	uint32_t uncompressed_size = stream::readLittleEndian<uint32_t>(_istream);
-	uint16_t namelength = stream::readLittleEndian<uint16_t>(_istream);
-	uint16_t extras = stream::readLittleEndian<uint16_t>(_istream);
-	uint16_t comment = stream::readLittleEndian<uint16_t>(_istream);
+	uint32_t compressed_size = stream::readLittleEndian<uint32_t>(istream);
+	uint32_t uncompressed_size = stream::readLittleEndian<uint32_t>(istream);
+	uint16_t namelength = stream::readLittleEndian<uint16_t>(istream);
+	uint16_t extras = stream::readLittleEndian<uint16_t>(istream);
+	uint16_t comment = stream::readLittleEndian<uint16_t>(istream);
 
 	//unsigned short diskstart =
-	stream::readLittleEndian<uint16_t>(_istream);
+	stream::readLittleEndian<uint16_t>(istream);
 	//unsigned short filetype =
-	stream::readLittleEndian<uint16_t>(_istream);
+	stream::readLittleEndian<uint16_t>(istream);
 	//unsigned int filemode =
-	stream::readLittleEndian<uint32_t>(_istream);
+	stream::readLittleEndian<uint32_t>(istream);
 
-	uint32_t position = stream::readLittleEndian<uint32_t>(_istream);
+	uint32_t position = stream::readLittleEndian<uint32_t>(istream);
 
 	// greebo: Read the filename directly into a newly constructed std::string.
 
@@ -198,11 +264,11 @@ void ZipArchive::readZipRecord()
 
 	std::string path(namelength, '\0');
 
-	_istream.read(
+	istream.read(
 		reinterpret_cast<stream::FileInputStream::byte_type*>(const_cast<char*>(path.data())),
 		namelength);
 
-	_istream.seek(extras + comment, stream::FileInputStream::cur);
+	istream.seek(extras + comment, stream::FileInputStream::cur);
 
 	if (os::isDirectory(path))
 	{
@@ -218,7 +284,19 @@ void ZipArchive::readZipRecord()
 		}
 		else
 		{
-			entry.getRecord().reset(new ZipRecord(position,
+			uint32_t dataPosition = 0;
+
+			try
+			{
+				dataPosition = getDataPosition(istream, position, compressed_size);
+			}
+			catch (ZipFailureException& ex)
+			{
+				rError() << "Zip archive " << _fullPath << ": cannot read " << path << ": " << ex.what() << std::endl;
+				return;
+			}
+
+			entry.getRecord().reset(new ZipRecord(dataPosition,
 				compressed_size,
 				uncompressed_size,
 				(compression_mode == Z_DEFLATED) ? ZipRecord::eDeflated : ZipRecord::eStored));
@@ -226,30 +304,144 @@ void ZipArchive::readZipRecord()
 	}
 }
 
-void ZipArchive::loadZipFile()
+void ZipArchive::loadZipFile(stream::FileInputStream& istream)
 {
-	SeekableStream::position_type pos = findZipDiskTrailerPosition(_istream);
+	SeekableStream::position_type pos = findZipDiskTrailerPosition(istream);
 
 	if (pos == 0)
 	{
 		throw ZipFailureException("Unable to locate Zip disk trailer");
 	}
 
-	_istream.seek(pos);
+	istream.seek(pos);
 
 	ZipDiskTrailer trailer;
-	stream::readZipDiskTrailer(_istream, trailer);
+	stream::readZipDiskTrailer(istream, trailer);
 
 	if (trailer.magic != ZIP_MAGIC_DISK_TRAILER)
 	{
 		throw ZipFailureException("Invalid Zip Magic, maybe this is not a zip file?");
 	}
 
-	_istream.seek(trailer.rootseek);
+	istream.seek(trailer.rootseek);
 
 	for (unsigned short i = 0; i < trailer.entries; ++i)
 	{
-		readZipRecord();
+		readZipRecord(istream);
+	}
+}
+
+uint32_t ZipArchive::getDataPosition(stream::FileInputStream& istream, uint32_t headerPosition,
+	uint32_t streamSize)
+{
+	ZipFileHeader header;
+
+	if (_mapping)
+	{
+		if (static_cast<uint64_t>(headerPosition) + ZIP_FILE_HEADER_LENGTH > _mapping->size())
+		{
+			throw ZipFailureException("Local file header out of bounds");
+		}
+
+		stream::MemoryInputStream headerStream(_mapping->data() + headerPosition, ZIP_FILE_HEADER_LENGTH);
+		stream::readZipFileHeaderFields(headerStream, header);
+	}
+	else
+	{
+		// Come back to the central directory afterwards
+		stream::FileInputStream::position_type recordEnd = istream.tell();
+
+		istream.seek(headerPosition);
+		stream::readZipFileHeaderFields(istream, header);
+		istream.seek(recordEnd);
+	}
+
+	if (header.magic != ZIP_MAGIC_FILE_HEADER)
+	{
+		throw ZipFailureException("Invalid local file header magic");
+	}
+
+	uint64_t dataPosition = static_cast<uint64_t>(headerPosition) + ZIP_FILE_HEADER_LENGTH +
+		header.nameLength + header.extras;
+
+	if (_mapping && dataPosition + streamSize > _mapping->size())
+	{
+		throw ZipFailureException("File data out of bounds");
+	}
+
+	return static_cast<uint32_t>(dataPosition);
+}
+
+std::string ZipArchive::getIndex()
+{
+	std::string index;
+
+	writeIndexValue<uint32_t>(index, ZIP_INDEX_VERSION);
+	writeIndexValue<uint32_t>(index, static_cast<uint32_t>(std::distance(_filesystem.begin(), _filesystem.end())));
+
+	// The file system is sorted by path, so is the index
+	for (ZipFileSystem::value_type& pair : _filesystem)
+	{
+		const std::string& path = pair.first.string();
+
+		writeIndexValue<uint16_t>(index, static_cast<uint16_t>(path.size()));
+		index.append(path);
+
+		if (pair.second.isDirectory())
+		{
+			writeIndexValue<uint8_t>(index, INDEX_ENTRY_DIRECTORY);
+			continue;
+		}
+
+		const ZipRecord& record = *pair.second.getRecord();
+
+		writeIndexValue<uint8_t>(index, record.mode == ZipRecord::eDeflated ? INDEX_ENTRY_DEFLATED : INDEX_ENTRY_STORED);
+		writeIndexValue<uint32_t>(index, record.position);
+		writeIndexValue<uint32_t>(index, record.stream_size);
+		writeIndexValue<uint32_t>(index, record.file_size);
+	}
+
+	return index;
+}
+
+void ZipArchive::loadIndex(const std::string& index)
+{
+	IndexReader reader(index);
+
+	if (reader.read<uint32_t>() != ZIP_INDEX_VERSION)
+	{
+		throw ZipFailureException("Index version mismatch");
+	}
+
+	uint32_t numEntries = reader.read<uint32_t>();
+
+	for (uint32_t i = 0; i < numEntries; ++i)
+	{
+		std::string path = reader.readString(reader.read<uint16_t>());
+		uint8_t type = reader.read<uint8_t>();
+
+		if (type == INDEX_ENTRY_DIRECTORY)
+		{
+			_filesystem[path].getRecord().reset();
+			continue;
+		}
+
+		uint32_t position = reader.read<uint32_t>();
+		uint32_t streamSize = reader.read<uint32_t>();
+		uint32_t fileSize = reader.read<uint32_t>();
+
+		if (_mapping && static_cast<uint64_t>(position) + streamSize > _mapping->size())
+		{
+			throw ZipFailureException("File data out of bounds");
+		}
+
+		_filesystem[path].getRecord().reset(new ZipRecord(position, streamSize, fileSize,
+			type == INDEX_ENTRY_DEFLATED ? ZipRecord::eDeflated : ZipRecord::eStored));
+	}
+
+	if (!reader.atEnd())
+	{
+		throw ZipFailureException("Index has trailing data");
 	}
 }
 
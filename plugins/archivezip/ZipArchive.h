@@ -3,7 +3,8 @@
 #include "iarchive.h"
 #include "GenericFileSystem.h"
 #include "stream/FileInputStream.h"
-#include <mutex>
+#include "stream/MappedFile.h"
+#include <memory>
 
 namespace archive
 {
@@ -16,6 +17,14 @@ namespace archive
  * physical directories.
  *
  * Archives are owned and instantiated by the GlobalFileSystem instance.
+ *
+ * The local file headers are resolved when the archive is loaded, and the
+ * archive file is memory-mapped, such that files can be opened and read from
+ * multiple threads without any locking. If the archive cannot be mapped, the
+ * opened files fall back to using their own file streams.
+ *
+ * Instead of the central directory, the file table can be taken from an index
+ * created by a previous session, see getIndex().
  */
 class ZipArchive :
 	public Archive
@@ -40,7 +49,7 @@ private:
 			mode(mode_)
 		{}
 
-		uint32_t position;
+		uint32_t position; // start of the file data, after the local file header
 		uint32_t stream_size;
 		uint32_t file_size;
 		CompressionMode mode;
@@ -51,13 +60,20 @@ private:
 	std::string _fullPath;			// the full path to the Zip file
 	std::string _containingFolder;  // the folder this Zip is located in
 	std::string _modName;			// mod name, calculated based on the containing folder
-	stream::FileInputStream _istream;
-    std::mutex _streamLock;
+	std::shared_ptr<stream::MappedFile> _mapping; // NULL if the file couldn't be mapped
 
 public:
-	ZipArchive(const std::string& fullPath);
+	/**
+	 * Opens the Zip file at the given path. If a non-empty index (as returned by
+	 * getIndex()) is passed, the file table is taken from it instead of reading
+	 * the Zip file's central directory.
+	 */
+	ZipArchive(const std::string& fullPath, const std::string& index = std::string());
 	virtual ~ZipArchive();
 
+	// Returns the file table of this archive in a flat binary form, sorted by path
+	std::string getIndex();
+
 	// Archive implementation
 	virtual ArchiveFilePtr openFile(const std::string& name) override;
 	virtual ArchiveTextFilePtr openTextFile(const std::string& name) override;
@@ -65,8 +81,14 @@ public:
 	void traverse(Visitor& visitor, const std::string& root) override;
 
 private:
-	void readZipRecord();
-	void loadZipFile();
+	void readZipRecord(stream::FileInputStream& istream);
+	void loadZipFile(stream::FileInputStream& istream);
+	void loadIndex(const std::string& index);
+
+	// Returns the position of the data following the local file header at the given position,
+	// throws ZipFailureException if the header is invalid
+	uint32_t getDataPosition(stream::FileInputStream& istream, uint32_t headerPosition,
+		uint32_t streamSize);
 };
 
 }
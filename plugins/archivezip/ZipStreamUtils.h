@@ -72,6 +72,9 @@ struct ZipFileHeader
 								/* followed by extra field (of variable size) */
 };
 
+// Size of the fixed part of the local file header
+const std::size_t ZIP_FILE_HEADER_LENGTH = 30;
+
 /* B. data descriptor
 * the data descriptor exists only if bit 3 of z_flags is set. It is byte aligned
 * and immediately follows the last byte of compressed data. It is only used if
@@ -161,7 +164,8 @@ inline void readZipDosTime(InputStream& stream, archive::ZipDosTime& dostime)
 	dostime.date = stream::readLittleEndian<uint16_t>(stream);
 }
 
-inline void readZipFileHeader(SeekableInputStream& stream, archive::ZipFileHeader& header)
+// Reads the fixed part of the local file header, leaving the stream before the filename
+inline void readZipFileHeaderFields(InputStream& stream, archive::ZipFileHeader& header)
 {
 	stream::readZipMagic(stream, header.magic);
 	stream::readZipVersion(stream, header.extract);
@@ -173,6 +177,11 @@ inline void readZipFileHeader(SeekableInputStream& stream, archive::ZipFileHeade
 	header.uncompressedSize = stream::readLittleEndian<uint32_t>(stream);
 	header.nameLength = stream::readLittleEndian<uint16_t>(stream);
 	header.extras = stream::readLittleEndian<uint16_t>(stream);
+}
+
+inline void readZipFileHeader(SeekableInputStream& stream, archive::ZipFileHeader& header)
+{
+	readZipFileHeaderFields(stream, header);
 
 	stream.seek(header.nameLength + header.extras, SeekableInputStream::cur);
 };
@@ -16,6 +16,18 @@ public:
 		return std::make_shared<ZipArchive>(name);
 	}
 
+	ArchivePtr openArchive(const std::string& name, const std::string& index) override
+	{
+		return std::make_shared<ZipArchive>(name, index);
+	}
+
+	std::string getArchiveIndex(const ArchivePtr& archive) override
+	{
+		std::shared_ptr<ZipArchive> zipArchive = std::dynamic_pointer_cast<ZipArchive>(archive);
+
+		return zipArchive ? zipArchive->getIndex() : std::string();
+	}
+
 	virtual const std::string& getExtension() override
 	{
 		static std::string _ext("pk4");
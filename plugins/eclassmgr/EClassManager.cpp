@@ -10,12 +10,14 @@
 #include "iradiant.h"
 #include "iuimanager.h"
 #include "ifilesystem.h"
-#include "parser/DefTokeniser.h"
+#include "iprofiler.h"
+#include "parser/ContiguousDefTokeniser.h"
 
 #include "Doom3EntityClass.h"
 #include "Doom3ModelDef.h"
 
 #include "string/case_conv.h"
+#include "stream/utils.h"
 #include <functional>
 
 #include "debugging/ScopedDebugTimer.h"
@@ -123,6 +125,8 @@ void EClassManager::resolveModelInheritance(const std::string& name, const Doom3
 
 void EClassManager::parseDefFiles()
 {
+	PROFILE_ZONE("EClassManager::parseDefFiles");
+
 	rMessage() << "searching vfs directory 'def' for *.def\n";
 
 	// Increase the parse stamp for this run
@@ -296,6 +300,7 @@ const StringSet& EClassManager::getDependencies() const {
 		_dependencies.insert(MODULE_UIMANAGER);
 		_dependencies.insert(MODULE_EVENTMANAGER);
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_PROFILER);
 	}
 
 	return _dependencies;
@@ -354,9 +359,10 @@ void EClassManager::onFileSystemShutdown()
 // Extract all entitydefs and create objects accordingly.
 void EClassManager::parse(TextInputStream& inStr, const std::string& modDir)
 {
-	// Construct a tokeniser for the stream
+	// Buffer the whole file and construct a tokeniser on top of it
 	std::istream is(&inStr);
-    parser::BasicDefTokeniser<std::istream> tokeniser(is);
+	std::string contents = stream::readToString(is);
+    parser::ContiguousDefTokeniser tokeniser(contents);
 
     while (tokeniser.hasMoreTokens())
 	{
@@ -31,18 +31,17 @@ namespace {
 
 void BasicFilterSystem::setAllFilterStates(bool state)
 {
+	_activeFilters.clear();
+
 	if (state)
 	{
-		_activeFilters = _availableFilters;
-	}
-	else
-	{
-		_activeFilters.clear();
+		for (const FilterTable::value_type& pair : _availableFilters)
+		{
+			_activeFilters.insert(pair.first);
+		}
 	}
 
-	// Invalidate the visibility cache to force new values to be
-	// loaded from the filters themselves
-	_visibilityCache.clear();
+	updateActiveMask();
 
 	// Update the scenegraph instances
 	update();
@@ -165,11 +164,11 @@ void BasicFilterSystem::addFiltersFromXML(const xml::NodeList& nodes, bool readO
 		// If this filter is in our active set, enable it
 		if (activeFilterNames.find(filterName) != activeFilterNames.end()) {
 			fEvent->setToggled(true);
-			_activeFilters.insert(
-				FilterTable::value_type(filterName, inserted)
-			);
+			_activeFilters.insert(filterName);
 		}
 	}
+
+	updateFilterSlots();
 }
 
 // Shut down the Filters module, saving active filters to registry
@@ -179,12 +178,10 @@ void BasicFilterSystem::shutdownModule() {
 	GlobalRegistry().deleteXPath(RKEY_USER_ACTIVE_FILTERS);
 
 	// Add a node for each active filter
-	for (FilterTable::const_iterator i = _activeFilters.begin();
-		 i != _activeFilters.end();
-		 ++i)
+	for (const std::string& filterName : _activeFilters)
 	{
 		GlobalRegistry().createKeyWithName(
-			RKEY_USER_FILTER_BASE, "activeFilter", i->first
+			RKEY_USER_FILTER_BASE, "activeFilter", filterName
 		);
 	}
 
@@ -275,10 +272,8 @@ void BasicFilterSystem::setFilterState(const std::string& filter, bool state) {
 
 	assert(!_availableFilters.empty());
 	if (state) {
-		// Copy the filter to the active filters list
-		_activeFilters.insert(
-			FilterTable::value_type(
-				filter, _availableFilters.find(filter)->second));
+		// Add the filter to the active filters list
+		_activeFilters.insert(filter);
 	}
 	else {
 		assert(!_activeFilters.empty());
@@ -286,12 +281,19 @@ void BasicFilterSystem::setFilterState(const std::string& filter, bool state) {
 		_activeFilters.erase(filter);
 	}
 
-	// Invalidate the visibility cache to force new values to be
-	// loaded from the filters themselves
-	_visibilityCache.clear();
+	// The cached rule evaluations stay valid, only the set of active filters changed
+	updateActiveMask();
+
+	// Material visibility only depends on texture rules
+	FilterTable::const_iterator found = _availableFilters.find(filter);
+
+	if (found == _availableFilters.end() || found->second.hasRules(FilterRule::TYPE_TEXTURE))
+	{
+		updateShaders();
+	}
 
 	// Update the scenegraph instances
-	update();
+	updateScene();
 
 	_filtersChangedSignal.emit();
 
@@ -344,8 +346,8 @@ bool BasicFilterSystem::addFilter(const std::string& filterName, const FilterRul
 		std::bind(&XMLFilter::toggle, &result.first->second, std::placeholders::_1)
 	);
 
-	// Clear the cache, the rules have changed
-	_visibilityCache.clear();
+	// Re-evaluate the rules, they have changed
+	updateFilterSlots();
 
 	_filtersChangedSignal.emit();
 
@@ -367,17 +369,13 @@ bool BasicFilterSystem::removeFilter(const std::string& filter) {
 		GlobalEventManager().disableEvent(f->second.getEventName());
 
 		// Check if the filter was active
-		FilterTable::iterator found = _activeFilters.find(f->first);
-
-		if (found != _activeFilters.end()) {
-			_activeFilters.erase(found);
-		}
+		_activeFilters.erase(f->first);
 
 		// Now remove the object from the available filters too
 		_availableFilters.erase(f);
 
-		// Clear the cache, the rules have changed
-		_visibilityCache.clear();
+		// Re-evaluate the rules, they have changed
+		updateFilterSlots();
 
 		_filtersChangedSignal.emit();
 
@@ -407,13 +405,7 @@ bool BasicFilterSystem::renameFilter(const std::string& oldFilterName, const std
 		}
 
 		// Check if the filter was active
-		FilterTable::iterator found = _activeFilters.find(f->first);
-
-		bool wasActive = (found != _activeFilters.end());
-
-		if (wasActive) {
-			_activeFilters.erase(found);
-		}
+		bool wasActive = _activeFilters.erase(f->first) > 0;
 
 		std::string oldEventName = f->second.getEventName();
 
@@ -449,9 +441,7 @@ bool BasicFilterSystem::renameFilter(const std::string& oldFilterName, const std
 		if (wasActive) {
 			fEvent->setToggled(true);
 
-			_activeFilters.insert(
-				FilterTable::value_type(newFilterName, f->second)
-			);
+			_activeFilters.insert(newFilterName);
 		}
 		else {
 			fEvent->setToggled(false);
@@ -463,6 +453,9 @@ bool BasicFilterSystem::renameFilter(const std::string& oldFilterName, const std
 		// Remove the old event from the EventManager
 		GlobalEventManager().removeEvent(oldEventName);
 
+		// The old table entry is gone, re-assign the filter indices
+		updateFilterSlots();
+
 		return true;
 	}
 	else {
@@ -474,57 +467,132 @@ bool BasicFilterSystem::renameFilter(const std::string& oldFilterName, const std
 // Query whether an item is visible or filtered out
 bool BasicFilterSystem::isVisible(const FilterRule::Type type, const std::string& name)
 {
-	// Check if this item is in the visibility cache, returning
-	// its cached value if found
-	StringFlagCache::iterator cacheIter = _visibilityCache.find(name);
-	if (cacheIter != _visibilityCache.end())
-		return cacheIter->second;
-
-	// Otherwise, walk the list of active filters to find a value for
-	// this item.
-	bool visFlag = true; // default if no filters modify it
-
-	for (FilterTable::iterator activeIter = _activeFilters.begin();
-		 activeIter != _activeFilters.end();
-		 ++activeIter)
+	if (_activeFilters.empty())
+	{
+		return true; // default if no filters modify it
+	}
+
+	// The item is filtered if any of the active filters is hiding it
+	return !getHiddenMask(type, name).intersects(_activeMask);
+}
+
+bool BasicFilterSystem::isEntityVisible(const FilterRule::Type type, const Entity& entity)
+{
+	if (_activeFilters.empty())
+	{
+		return true; // default if no filters modify it
+	}
+
+	switch (type)
+	{
+	case FilterRule::TYPE_ENTITYCLASS:
+		return !getHiddenMask(type, entity.getEntityClass()->getName()).intersects(_activeMask);
+	case FilterRule::TYPE_ENTITYKEYVALUE:
+		return !getHiddenKeyValueMask(entity).intersects(_activeMask);
+	default:
+		return true; // no entity rules for the other types
+	}
+}
+
+const FilterMask& BasicFilterSystem::getHiddenMask(const FilterRule::Type type, const std::string& name)
+{
+	HiddenMaskCache& cache = _hiddenMaskCaches[type];
+	HiddenMaskCache::const_iterator found = cache.find(name);
+
+	if (found != cache.end())
 	{
-		// Delegate the check to the filter object. If a filter returns
-		// false for the visibility check, then the item is filtered
-		// and we don't need any more checks.
-		if (!activeIter->second.isVisible(type, name))
+		return found->second;
+	}
+
+	// Evaluate the rules of all filters, active or not
+	FilterMask mask;
+
+	for (std::size_t i = 0; i < _filterSlots.size(); ++i)
+	{
+		if (!_filterSlots[i]->isVisible(type, name))
 		{
-			visFlag = false;
-			break;
+			mask.set(i);
 		}
 	}
 
-	// Cache the result and return to caller
-	_visibilityCache.insert(StringFlagCache::value_type(name, visFlag));
+	return cache.emplace(name, std::move(mask)).first->second;
+}
+
+const FilterMask& BasicFilterSystem::getHiddenKeyValueMask(const Entity& entity)
+{
+	// Entities are matched by the values of the keys used in the rules only
+	std::vector<std::string> values;
+	values.reserve(_ruleEntityKeys.size());
+
+	for (const std::string& key : _ruleEntityKeys)
+	{
+		values.push_back(entity.getKeyValue(key));
+	}
+
+	KeyValueMaskCache::const_iterator found = _keyValueMaskCache.find(values);
+
+	if (found != _keyValueMaskCache.end())
+	{
+		return found->second;
+	}
+
+	FilterMask mask;
+
+	for (std::size_t i = 0; i < _filterSlots.size(); ++i)
+	{
+		if (!_filterSlots[i]->isEntityVisible(FilterRule::TYPE_ENTITYKEYVALUE, entity))
+		{
+			mask.set(i);
+		}
+	}
 
-	return visFlag;
+	return _keyValueMaskCache.emplace(std::move(values), std::move(mask)).first->second;
 }
 
-bool BasicFilterSystem::isEntityVisible(const FilterRule::Type type, const Entity& entity)
+void BasicFilterSystem::updateFilterSlots()
 {
-	// Otherwise, walk the list of active filters to find a value for
-	// this item.
-	bool visFlag = true; // default if no filters modify it
+	_filterSlots.clear();
+	_ruleEntityKeys.clear();
+
+	std::set<std::string> entityKeys;
 
-	for (FilterTable::iterator activeIter = _activeFilters.begin();
-		 activeIter != _activeFilters.end();
-		 ++activeIter)
+	for (const FilterTable::value_type& pair : _availableFilters)
 	{
-		// Delegate the check to the filter object. If a filter returns
-		// false for the visibility check, then the item is filtered
-		// and we don't need any more checks.
-		if (!activeIter->second.isEntityVisible(type, entity))
+		_filterSlots.push_back(&pair.second);
+
+		for (const FilterRule& rule : pair.second.getRuleSet())
 		{
-			visFlag = false;
-			break;
+			if (rule.type == FilterRule::TYPE_ENTITYKEYVALUE)
+			{
+				entityKeys.insert(rule.entityKey);
+			}
 		}
 	}
 
-	return visFlag;
+	_ruleEntityKeys.assign(entityKeys.begin(), entityKeys.end());
+
+	_hiddenMaskCaches.clear();
+	_keyValueMaskCache.clear();
+
+	updateActiveMask();
+}
+
+void BasicFilterSystem::updateActiveMask()
+{
+	_activeMask.clear();
+
+	// The slots are assigned in table order
+	std::size_t index = 0;
+
+	for (const FilterTable::value_type& pair : _availableFilters)
+	{
+		if (_activeFilters.find(pair.first) != _activeFilters.end())
+		{
+			_activeMask.set(index);
+		}
+
+		++index;
+	}
 }
 
 FilterRules BasicFilterSystem::getRuleSet(const std::string& filter) {
@@ -546,8 +614,8 @@ bool BasicFilterSystem::setFilterRules(const std::string& filter,
 		// Apply the ruleset
 		f->second.setRules(ruleSet);
 
-		// Clear the cache, the ruleset has changed
-		_visibilityCache.clear();
+		// Re-evaluate the rules, the ruleset has changed
+		updateFilterSlots();
 
 		_filtersChangedSignal.emit();
 
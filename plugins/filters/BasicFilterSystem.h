@@ -1,12 +1,15 @@
 #pragma once
 
 #include "XMLFilter.h"
+#include "FilterMask.h"
 #include "imodule.h"
 #include "ifilter.h"
 #include "icommandsystem.h"
 #include "xmlutil/Node.h"
 
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -24,13 +27,30 @@ class BasicFilterSystem
 	typedef std::map<std::string, XMLFilter> FilterTable;
 	FilterTable _availableFilters;
 
-	// Second table containing just the active filters
-	FilterTable _activeFilters;
+	// Names of the active filters
+	typedef std::set<std::string> FilterNameSet;
+	FilterNameSet _activeFilters;
 
-	// Cache of visibility flags for item names, to avoid having to
-	// traverse the active filter list for each lookup
-	typedef std::map<std::string, bool> StringFlagCache;
-	StringFlagCache _visibilityCache;
+	// The available filters in table order, the position of a filter
+	// is its index in the FilterMasks
+	std::vector<const XMLFilter*> _filterSlots;
+
+	// The set of active filters
+	FilterMask _activeMask;
+
+	// The keys used by any of the entitykeyvalue rules
+	std::vector<std::string> _ruleEntityKeys;
+
+	// The filters hiding a given item name, one cache per rule type. Since the
+	// rules don't depend on the filter states, these are kept when toggling
+	// filters and only discarded if the rules themselves change.
+	typedef std::unordered_map<std::string, FilterMask> HiddenMaskCache;
+	typedef std::map<FilterRule::Type, HiddenMaskCache> HiddenMaskCaches;
+	HiddenMaskCaches _hiddenMaskCaches;
+
+	// The filters hiding entities with the given values of the _ruleEntityKeys
+	typedef std::map<std::vector<std::string>, FilterMask> KeyValueMaskCache;
+	KeyValueMaskCache _keyValueMaskCache;
 
     sigc::signal<void> _filtersChangedSignal;
 
@@ -46,6 +66,16 @@ private:
 
 	void addFiltersFromXML(const xml::NodeList& nodes, bool readOnly);
 
+	// Re-assigns the filter indices after filters or rules have been changed,
+	// discarding the cached rule evaluations
+	void updateFilterSlots();
+
+	void updateActiveMask();
+
+	// Returns the set of filters hiding the named item, regardless of their state
+	const FilterMask& getHiddenMask(const FilterRule::Type type, const std::string& name);
+	const FilterMask& getHiddenKeyValueMask(const Entity& entity);
+
 public:
     virtual ~BasicFilterSystem() {}
 
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace filters
+{
+
+/**
+ * A set of filters, each filter being represented by its index in the
+ * filter system's table. The filter system uses these to store which filters
+ * are hiding a given item, and which of the filters are active.
+ */
+class FilterMask
+{
+private:
+	std::vector<std::uint64_t> _words;
+
+public:
+	void set(std::size_t index)
+	{
+		std::size_t word = index / 64;
+
+		if (word >= _words.size())
+		{
+			_words.resize(word + 1, 0);
+		}
+
+		_words[word] |= std::uint64_t(1) << (index % 64);
+	}
+
+	void clear()
+	{
+		_words.clear();
+	}
+
+	// Returns true if both sets have at least one filter in common
+	bool intersects(const FilterMask& other) const
+	{
+		std::size_t numWords = _words.size() < other._words.size() ? _words.size() : other._words.size();
+
+		for (std::size_t i = 0; i < numWords; ++i)
+		{
+			if ((_words[i] & other._words[i]) != 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+}
@@ -3,7 +3,7 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "ifilter.h"
-#include <regex>
+#include "itextstream.h"
 #include <algorithm>
 
 namespace filters
@@ -25,24 +25,20 @@ bool XMLFilter::isVisible(const FilterRule::Type type, const std::string& name)
 
 	bool visible = true; // default if unmodified by rules
 
-	for (FilterRules::const_iterator ruleIter = _rules.begin();
-		 ruleIter != _rules.end();
-		 ++ruleIter)
+	for (std::size_t i = 0; i < _rules.size(); ++i)
 	{
 		// Check the item type.
-		if (ruleIter->type != type)
+		if (_rules[i].type != type)
 		{
 			continue;
 		}
 
-		// If we have a rule for this item, use a regex to match the query name
+		// If we have a rule for this item, use its regex to match the query name
 		// against the "match" parameter
-		std::regex ex(ruleIter->match);
-
-		if (std::regex_match(name, ex))
+		if (matches(i, name))
 		{
 			// Overwrite the visible flag with the value from the rule.
-			visible = ruleIter->show;
+			visible = _rules[i].show;
 		}
 	}
 
@@ -56,31 +52,25 @@ bool XMLFilter::isEntityVisible(const FilterRule::Type type, const Entity& entit
 
 	IEntityClassConstPtr eclass = entity.getEntityClass();
 	
-	for (FilterRules::const_iterator ruleIter = _rules.begin();
-		 ruleIter != _rules.end();
-		 ++ruleIter)
+	for (std::size_t i = 0; i < _rules.size(); ++i)
 	{
-		if (ruleIter->type != type)
+		if (_rules[i].type != type)
 		{
 			continue;
 		}
 
 		if (type == FilterRule::TYPE_ENTITYCLASS)
 		{
-			std::regex ex(ruleIter->match);
-
-			if (std::regex_match(eclass->getName(), ex))
+			if (matches(i, eclass->getName()))
 			{
-				visible = ruleIter->show;
+				visible = _rules[i].show;
 			}
 		}
 		else if (type == FilterRule::TYPE_ENTITYKEYVALUE)
 		{
-			std::regex ex(ruleIter->match);
-
-			if (std::regex_match(entity.getKeyValue(ruleIter->entityKey), ex))
+			if (matches(i, entity.getKeyValue(_rules[i].entityKey)))
 			{
-				visible = ruleIter->show;
+				visible = _rules[i].show;
 			}
 		}
 	}
@@ -110,12 +100,56 @@ bool XMLFilter::isReadOnly() const {
 	return _readonly;
 }
 
-FilterRules XMLFilter::getRuleSet() {
+FilterRules XMLFilter::getRuleSet() const {
 	return _rules;
 }
 
 void XMLFilter::setRules(const FilterRules& rules) {
 	_rules = rules;
+
+	_expressions.clear();
+	_expressions.reserve(_rules.size());
+
+	for (const FilterRule& rule : _rules)
+	{
+		compileExpression(rule);
+	}
+}
+
+bool XMLFilter::hasRules(const FilterRule::Type type) const
+{
+	for (const FilterRule& rule : _rules)
+	{
+		if (rule.type == type) return true;
+	}
+
+	return false;
+}
+
+void XMLFilter::compileExpression(const FilterRule& rule)
+{
+	CompiledExpression compiled;
+	compiled.valid = true;
+
+	try
+	{
+		compiled.expression = std::regex(rule.match);
+	}
+	catch (std::regex_error& ex)
+	{
+		rWarning() << "[filters] Filter " << _name << ": invalid match expression "
+			<< rule.match << " (" << ex.what() << ")" << std::endl;
+		compiled.valid = false;
+	}
+
+	_expressions.push_back(compiled);
+}
+
+bool XMLFilter::matches(std::size_t ruleIndex, const std::string& str) const
+{
+	const CompiledExpression& compiled = _expressions[ruleIndex];
+
+	return compiled.valid && std::regex_match(str, compiled.expression);
 }
 
 void XMLFilter::updateEventName() {
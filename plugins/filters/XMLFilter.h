@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <regex>
 #include "ifilter.h"
 
 namespace filters
@@ -25,6 +26,14 @@ private:
 	// Ordered list of rule objects
 	FilterRules _rules;
 
+	// The match expressions of the rules, compiled once when the rule is added
+	struct CompiledExpression
+	{
+		std::regex expression;
+		bool valid;
+	};
+	std::vector<CompiledExpression> _expressions;
+
 	// True if this filter can't be changed
 	bool _readonly;
 
@@ -51,6 +60,7 @@ public:
 	void addRule(const FilterRule::Type type, const std::string& match, bool show)
 	{
 		_rules.push_back(FilterRule::Create(type, match, show));
+		compileExpression(_rules.back());
 	}
 
 	/** Add an entitykeyvalue rule to this filter.
@@ -68,6 +78,7 @@ public:
 	void addEntityKeyValueRule(const std::string& key, const std::string& match, bool show)
 	{
 		_rules.push_back(FilterRule::CreateEntityKeyValueRule(key, match, show));
+		compileExpression(_rules.back());
 	}
 
 	/** Test a given item for visibility against all of the rules
@@ -109,13 +120,21 @@ public:
 	bool isReadOnly() const;
 
 	// Returns the ruleset
-	FilterRules getRuleSet();
+	FilterRules getRuleSet() const;
 
 	// Applies the given ruleset, replacing the existing one.
 	void setRules(const FilterRules& rules);
 
+	// Returns true if this filter has at least one rule of the given type
+	bool hasRules(const FilterRule::Type type) const;
+
 private:
 	void updateEventName();
+
+	void compileExpression(const FilterRule& rule);
+
+	// Matches the given string against the expression of the rule with the given index
+	bool matches(std::size_t ruleIndex, const std::string& str) const;
 };
 
 
@@ -8,6 +8,8 @@
 #include "igame.h"
 #include "iregistry.h"
 #include "igroupnode.h"
+#include "icommandsystem.h"
+#include "iworkerpool.h"
 
 #include "parser/DefTokeniser.h"
 
@@ -16,6 +18,7 @@
 
 #include "Doom3MapReader.h"
 #include "Doom3MapWriter.h"
+#include "ParserBenchmark.h"
 
 namespace map
 {
@@ -40,6 +43,8 @@ const StringSet& Doom3MapFormat::getDependencies() const
 		_dependencies.insert(MODULE_PATCHDEF3);
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_MAPFORMATMANAGER);
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_WORKERPOOL);
 	}
 
 	return _dependencies;
@@ -52,6 +57,9 @@ void Doom3MapFormat::initialiseModule(const ApplicationContext& ctx)
 	// Register ourselves as map format for maps and regions
 	GlobalMapFormatManager().registerMapFormat("map", shared_from_this());
 	GlobalMapFormatManager().registerMapFormat("reg", shared_from_this());
+
+	GlobalCommandSystem().addCommand("BenchmarkBrushDef3Parsing",
+		benchmarkBrushDef3Parsing, cmd::ARGTYPE_STRING);
 }
 
 void Doom3MapFormat::shutdownModule()
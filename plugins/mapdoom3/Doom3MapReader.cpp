@@ -5,6 +5,9 @@
 #include "igame.h"
 #include "ientity.h"
 #include "string/string.h"
+#include "stream/utils.h"
+#include "registry/registry.h"
+#include "util/ParallelFor.h"
 
 #include "Doom3MapFormat.h"
 
@@ -18,6 +21,91 @@
 
 namespace map {
 
+namespace
+{
+	const char* const RKEY_MAP_PARALLEL_LOADING = "user/ui/map/parallelLoading";
+
+	// Number of primitives to scan before the batch is parsed and added to the scene
+	const std::size_t PARALLEL_BATCH_SIZE = 8192;
+
+	// Skips whitespace and comments, returns the position of the next relevant character
+	const char* skipWhitespace(const char* pos, const char* end)
+	{
+		while (pos != end)
+		{
+			if (*pos == '/' && pos + 1 != end && pos[1] == '/')
+			{
+				while (pos != end && *pos != '\r' && *pos != '\n') ++pos;
+			}
+			else if (*pos == '/' && pos + 1 != end && pos[1] == '*')
+			{
+				for (pos += 2; pos != end && !(*pos == '*' && pos + 1 != end && pos[1] == '/'); ++pos) {}
+
+				if (pos == end) break;
+
+				pos += 2;
+			}
+			else if (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\v' || *pos == '\r')
+			{
+				++pos;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		return pos;
+	}
+
+	// Locates the end of the primitive whose body starts at the given position (right
+	// after the primitive keyword). The primitive body is a braced block followed by
+	// the closing brace of the primitive. Quotes and comments are treated the same
+	// way as the DefTokeniser does. Returns the position after the closing brace,
+	// or nullptr if the structure doesn't match.
+	const char* findPrimitiveEnd(const char* pos, const char* end)
+	{
+		pos = skipWhitespace(pos, end);
+
+		if (pos == end || *pos != '{') return nullptr;
+
+		std::size_t depth = 0;
+
+		while (pos != end)
+		{
+			pos = skipWhitespace(pos, end);
+
+			if (pos == end) break;
+
+			if (*pos == '"')
+			{
+				// Skip over the quoted content, backslashes escape the next character
+				for (++pos; pos != end && *pos != '"'; ++pos)
+				{
+					if (*pos == '\\' && ++pos == end) return nullptr;
+				}
+
+				if (pos == end) return nullptr;
+			}
+			else if (*pos == '{')
+			{
+				++depth;
+			}
+			else if (*pos == '}' && --depth == 0)
+			{
+				// End of the primitive body, the primitive's closing brace must follow
+				pos = skipWhitespace(pos + 1, end);
+
+				return pos != end && *pos == '}' ? pos + 1 : nullptr;
+			}
+
+			++pos;
+		}
+
+		return nullptr;
+	}
+}
+
 Doom3MapReader::Doom3MapReader(IMapImportFilter& importFilter) : 
 	_importFilter(importFilter),
 	_entityCount(0),
@@ -29,12 +117,67 @@ void Doom3MapReader::readFromStream(std::istream& stream)
 	// Call the virtual method to initialise the primitve parser map (if not done yet)
 	initPrimitiveParsers();
 
-	// The tokeniser used to split the stream into pieces
-	parser::BasicDefTokeniser<std::istream> tok(stream);
+	// Read the whole map into memory, the tokeniser is then able to hand out
+	// its tokens without assembling them character by character
+	std::streamoff startPos = stream.tellg();
+	std::string buffer = stream::readToString(stream);
+
+	// The tokeniser used to split the buffer into pieces
+	parser::ContiguousDefTokeniser tok(buffer.data(), buffer.data() + buffer.size());
 
 	// Try to parse the map version (throws on failure)
 	parseMapVersion(tok);
 
+	// Keep the stream position in sync with the parsed data, the
+	// import filter is using it to report the loading progress
+	auto syncStreamPosition = [&](const char* position)
+	{
+		if (startPos >= 0)
+		{
+			stream.clear();
+			stream.seekg(startPos + (position - buffer.data()));
+		}
+	};
+
+	if (registry::getValue<bool>(RKEY_MAP_PARALLEL_LOADING))
+	{
+		// Two-phase loading: the entity and primitive blocks of a batch are located
+		// first, then the primitives are parsed in worker threads, and the resulting
+		// nodes are added to the scene in file order.
+		while (tok.hasMoreTokens())
+		{
+			std::vector<EntityBlock> entities;
+			bool scanSucceeded = scanEntityBlocks(tok, entities);
+
+			parsePrimitiveBlocks(entities);
+
+			for (EntityBlock& entity : entities)
+			{
+				try
+				{
+					addEntityBlock(entity);
+				}
+				catch (FailureException& e)
+				{
+					std::string text = fmt::format(_("Failed parsing entity {0:d}:\n{1}"), _entityCount, e.what());
+
+					// Re-throw with more text
+					throw FailureException(text);
+				}
+
+				_entityCount++;
+
+				syncStreamPosition(entity.end);
+			}
+
+			if (!scanSucceeded)
+			{
+				// Continue with the regular parser, it will take care of reporting any errors
+				break;
+			}
+		}
+	}
+
 	// Read each entity in the map, until EOF is reached
 	while (tok.hasMoreTokens())
 	{
@@ -53,6 +196,8 @@ void Doom3MapReader::readFromStream(std::istream& stream)
 		}
 
 		_entityCount++;
+
+		syncStreamPosition(tok.getPosition());
 	}
 
 	// EOF reached, success
@@ -257,4 +402,214 @@ void Doom3MapReader::parseEntity(parser::DefTokeniser& tok)
 	_importFilter.addEntity(entity);
 }
 
+bool Doom3MapReader::scanEntityBlocks(parser::ContiguousDefTokeniser& tok, std::vector<EntityBlock>& entities)
+{
+	std::size_t numPrimitives = 0;
+
+	while (tok.hasMoreTokens() && numPrimitives < PARALLEL_BATCH_SIZE)
+	{
+		const char* entityStart = tok.getPosition();
+
+		entities.emplace_back();
+
+		bool success = false;
+
+		try
+		{
+			success = scanEntityBlock(tok, entities.back());
+		}
+		catch (parser::ParseException&)
+		{}
+
+		if (!success)
+		{
+			// Rewind to the beginning of this entity
+			entities.pop_back();
+			tok.setPosition(entityStart);
+			return false;
+		}
+
+		numPrimitives += entities.back().primitives.size();
+	}
+
+	return true;
+}
+
+bool Doom3MapReader::scanEntityBlock(parser::ContiguousDefTokeniser& tok, EntityBlock& entity)
+{
+	tok.assertNextToken("{");
+
+	std::string_view token = tok.nextTokenView();
+
+	while (true)
+	{
+		if (token == "{") // PRIMITIVE
+		{
+			PrimitiveParsers::const_iterator p = _primitiveParsers.find(std::string(tok.nextTokenView()));
+
+			if (p == _primitiveParsers.end())
+			{
+				return false;
+			}
+
+			PrimitiveBlock block;
+
+			block.parser = p->second.get();
+			block.begin = tok.getPosition();
+			block.end = findPrimitiveEnd(block.begin, tok.getEnd());
+
+			if (block.end == nullptr)
+			{
+				return false;
+			}
+
+			entity.primitives.emplace_back(std::move(block));
+
+			// Continue after the primitive
+			tok.setPosition(entity.primitives.back().end);
+		}
+		else if (token == "}") // END OF ENTITY
+		{
+			break;
+		}
+		else // KEY
+		{
+			std::string key(token);
+			std::string_view value = tok.nextTokenView();
+
+			// Sanity check (invalid number of tokens will get us out of sync)
+			if (value == "{" || value == "}")
+			{
+				return false;
+			}
+
+			// Keyvalues following the first primitive are ignored by the regular parser too
+			if (entity.primitives.empty())
+			{
+				entity.keyValues.insert(EntityKeyValues::value_type(key, std::string(value)));
+			}
+		}
+
+		token = tok.nextTokenView();
+	}
+
+	entity.end = tok.getPosition();
+
+	return true;
+}
+
+void Doom3MapReader::parsePrimitiveBlocks(std::vector<EntityBlock>& entities)
+{
+	// Collect the blocks which can be parsed without touching the scene
+	std::vector<PrimitiveBlock*> blocks;
+
+	for (EntityBlock& entity : entities)
+	{
+		for (PrimitiveBlock& block : entity.primitives)
+		{
+			if (dynamic_cast<const DetachedPrimitiveParser*>(block.parser) != nullptr)
+			{
+				blocks.push_back(&block);
+			}
+		}
+	}
+
+	util::parallelFor(blocks.size(), [&](std::size_t index)
+	{
+		PrimitiveBlock& block = *blocks[index];
+
+		try
+		{
+			parser::ContiguousDefTokeniser tok(block.begin, block.end);
+
+			block.parsed = static_cast<const DetachedPrimitiveParser*>(block.parser)->parseDetached(tok);
+
+			if (tok.hasMoreTokens())
+			{
+				throw parser::ParseException("Unexpected token after primitive: " + tok.nextToken());
+			}
+		}
+		catch (...)
+		{
+			// Store the exception, it is reported when the primitive is added to the scene
+			block.error = std::current_exception();
+		}
+	});
+}
+
+scene::INodePtr Doom3MapReader::createPrimitive(PrimitiveBlock& block)
+{
+	if (block.error)
+	{
+		std::rethrow_exception(block.error);
+	}
+
+	if (block.parsed)
+	{
+		return block.parsed->createNode();
+	}
+
+	// No detached parse possible, this primitive is processed in the main thread
+	parser::ContiguousDefTokeniser tok(block.begin, block.end);
+
+	scene::INodePtr primitive = block.parser->parse(tok);
+
+	if (tok.hasMoreTokens())
+	{
+		throw parser::ParseException("Unexpected token after primitive: " + tok.nextToken());
+	}
+
+	return primitive;
+}
+
+void Doom3MapReader::addEntityBlock(EntityBlock& block)
+{
+	scene::INodePtr entity;
+
+	// Reset the primitive counter, we're starting a new entity
+	_primitiveCount = 0;
+
+	for (PrimitiveBlock& primitiveBlock : block.primitives)
+	{
+		// Create the entity right now, if not yet done
+		if (entity == NULL)
+		{
+			entity = createEntity(block.keyValues);
+		}
+
+		_primitiveCount++;
+
+		try
+		{
+			scene::INodePtr primitive = createPrimitive(primitiveBlock);
+
+			if (!primitive)
+			{
+				std::string text = fmt::format(_("Primitive #{0:d}: parse error"), _primitiveCount);
+				throw FailureException(text);
+			}
+
+			// Now add the primitive as a child of the entity
+			_importFilter.addPrimitiveToEntity(primitive, entity);
+		}
+		catch (parser::ParseException& e)
+		{
+			// Translate ParseExceptions to FailureExceptions
+			std::string text = fmt::format(_("Primitive #{0:d}: parse exception {1}"), _primitiveCount, e.what());
+			throw FailureException(text);
+		}
+
+		// Release the parsed data as early as possible
+		primitiveBlock.parsed.reset();
+	}
+
+	if (entity == NULL)
+	{
+		entity = createEntity(block.keyValues);
+	}
+
+	// Insert the entity
+	_importFilter.addEntity(entity);
+}
+
 } // namespace map
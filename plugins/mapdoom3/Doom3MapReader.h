@@ -2,9 +2,12 @@
 #define NODE_IMPORTER_H_
 
 #include <map>
+#include <vector>
+#include <exception>
 #include "inode.h"
 #include "imapformat.h"
-#include "parser/DefTokeniser.h"
+#include "parser/ContiguousDefTokeniser.h"
+#include "primitiveparsers/DetachedPrimitiveParser.h"
 
 namespace map {
 
@@ -51,6 +54,48 @@ protected:
 
 	// Create an entity with the given properties and layers
 	scene::INodePtr createEntity(const EntityKeyValues& keyValues);
+
+private:
+	// A primitive block located in the map buffer during the scan phase
+	struct PrimitiveBlock
+	{
+		const PrimitiveParser* parser;
+
+		// The block range, starting after the primitive keyword, including the closing brace
+		const char* begin;
+		const char* end;
+
+		// Result of the detached parse (or the exception thrown during it)
+		ParsedPrimitivePtr parsed;
+		std::exception_ptr error;
+	};
+
+	// An entity block located in the map buffer during the scan phase
+	struct EntityBlock
+	{
+		// The spawnargs up to the first primitive
+		EntityKeyValues keyValues;
+
+		std::vector<PrimitiveBlock> primitives;
+
+		// Position right after the closing brace
+		const char* end;
+	};
+
+	// Phase 1: scans a batch of entities, locating their primitive blocks without parsing them.
+	// Returns false if the scan failed at some entity, in which case the tokeniser is
+	// positioned at the beginning of that entity, to be parsed the regular way.
+	bool scanEntityBlocks(parser::ContiguousDefTokeniser& tok, std::vector<EntityBlock>& entities);
+
+	// Locates the keyvalues and primitive blocks of a single entity, returns false on failure
+	bool scanEntityBlock(parser::ContiguousDefTokeniser& tok, EntityBlock& entity);
+
+	// Phase 2: runs the detached parse of all suitable primitive blocks in worker threads
+	void parsePrimitiveBlocks(std::vector<EntityBlock>& entities);
+
+	// Phase 3: creates the entity and its primitive nodes and sends them to the import filter
+	void addEntityBlock(EntityBlock& entity);
+	scene::INodePtr createPrimitive(PrimitiveBlock& block);
 };
 
 } // namespace map
@@ -59,11 +59,7 @@ void Doom3MapWriter::endWriteEntity(const Entity& entity, std::ostream& stream)
 
 void Doom3MapWriter::beginWriteBrush(const IBrush& brush, std::ostream& stream)
 {
-	// Primitive count comment
-	stream << "// primitive " << _primitiveCount++ << std::endl;
-
-	// Export brushDef3 definition to stream
-	BrushDef3Exporter::exportBrush(stream, brush);
+	writeBrush(_primitiveCount++, brush, stream);
 }
 
 void Doom3MapWriter::endWriteBrush(const IBrush& brush, std::ostream& stream)
@@ -73,11 +69,7 @@ void Doom3MapWriter::endWriteBrush(const IBrush& brush, std::ostream& stream)
 
 void Doom3MapWriter::beginWritePatch(const IPatch& patch, std::ostream& stream)
 {
-	// Primitive count comment
-	stream << "// primitive " << _primitiveCount++ << std::endl;
-
-	// Export patch here _mapStream
-	PatchDefExporter::exportPatch(stream, patch);
+	writePatch(_primitiveCount++, patch, stream);
 }
 
 void Doom3MapWriter::endWritePatch(const IPatch& patch, std::ostream& stream)
@@ -85,4 +77,22 @@ void Doom3MapWriter::endWritePatch(const IPatch& patch, std::ostream& stream)
 	// nothing
 }
 
+void Doom3MapWriter::writeBrush(std::size_t primitiveNum, const IBrush& brush, std::ostream& stream) const
+{
+	// Primitive count comment
+	stream << "// primitive " << primitiveNum << std::endl;
+
+	// Export brushDef3 definition to stream
+	BrushDef3Exporter::exportBrush(stream, brush);
+}
+
+void Doom3MapWriter::writePatch(std::size_t primitiveNum, const IPatch& patch, std::ostream& stream) const
+{
+	// Primitive count comment
+	stream << "// primitive " << primitiveNum << std::endl;
+
+	// Export patch here _mapStream
+	PatchDefExporter::exportPatch(stream, patch);
+}
+
 } // namespace
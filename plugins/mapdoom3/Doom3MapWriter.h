@@ -11,7 +11,8 @@ namespace map
  * Creates a plaintext file with brushDef3/patchDef2/patchDef3 primitives.
  */
 class Doom3MapWriter :
-	public IMapWriter
+	public IMapWriter,
+	public IConcurrentPrimitiveWriter
 {
 protected:
 	// The counters for numbering the comments
@@ -36,6 +37,10 @@ public:
 	virtual void beginWritePatch(const IPatch& patch, std::ostream& stream);
 	virtual void endWritePatch(const IPatch& patch, std::ostream& stream);
 
+	// IConcurrentPrimitiveWriter, the primitive writing is implemented here
+	virtual void writeBrush(std::size_t primitiveNum, const IBrush& brush, std::ostream& stream) const;
+	virtual void writePatch(std::size_t primitiveNum, const IPatch& patch, std::ostream& stream) const;
+
 protected:
 	void writeEntityKeyValues(const Entity& entity, std::ostream& stream);
 };
@@ -0,0 +1,220 @@
+#include "ParserBenchmark.h"
+
+#include "itextstream.h"
+#include "parser/ContiguousDefTokeniser.h"
+#include "stream/utils.h"
+#include "string/from_chars.h"
+#include "string/convert.h"
+#include "math/Matrix4.h"
+#include "math/Plane3.h"
+#include "util/Stopwatch.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+#include "primitiveparsers/BrushDef3.h"
+
+namespace map
+{
+
+namespace
+{
+	const std::size_t NUM_ITERATIONS = 10;
+
+	bool isNumericToken(const std::string_view& tok)
+	{
+		return !tok.empty() && (std::isdigit(static_cast<unsigned char>(tok[0])) ||
+			tok[0] == '-' || tok[0] == '+' || tok[0] == '.');
+	}
+
+	struct LegacyFaceData
+	{
+		Plane3 plane;
+		Matrix4 texdef;
+		std::string shader;
+		std::size_t detailFlag;
+	};
+
+	// The brushDef3 parsing as done before the in-place number conversion:
+	// every number is copied into a string token and converted by string::to_float
+	std::size_t parseWithStringTokens(parser::DefTokeniser& tok, std::vector<LegacyFaceData>& faces)
+	{
+		faces.clear();
+
+		tok.assertNextToken("{");
+
+		while (tok.nextToken() == "(")
+		{
+			faces.emplace_back();
+			LegacyFaceData& face = faces.back();
+
+			face.plane.normal().x() = string::to_float(tok.nextToken());
+			face.plane.normal().y() = string::to_float(tok.nextToken());
+			face.plane.normal().z() = string::to_float(tok.nextToken());
+			face.plane.dist() = -string::to_float(tok.nextToken());
+
+			tok.assertNextToken(")");
+			tok.assertNextToken("(");
+
+			tok.assertNextToken("(");
+			face.texdef.xx() = string::to_float(tok.nextToken());
+			face.texdef.yx() = string::to_float(tok.nextToken());
+			face.texdef.tx() = string::to_float(tok.nextToken());
+			tok.assertNextToken(")");
+
+			tok.assertNextToken("(");
+			face.texdef.xy() = string::to_float(tok.nextToken());
+			face.texdef.yy() = string::to_float(tok.nextToken());
+			face.texdef.ty() = string::to_float(tok.nextToken());
+			tok.assertNextToken(")");
+
+			tok.assertNextToken(")");
+
+			face.shader = tok.nextToken();
+			face.detailFlag = string::convert<std::size_t>(tok.nextToken());
+
+			tok.skipTokens(2);
+		}
+
+		tok.assertNextToken("}");
+
+		return faces.size();
+	}
+}
+
+void benchmarkBrushDef3Parsing(const cmd::ArgumentList& args)
+{
+	if (args.size() != 1)
+	{
+		rError() << "Usage: BenchmarkBrushDef3Parsing <mapfile>" << std::endl;
+		return;
+	}
+
+	std::ifstream stream(args[0].getString());
+
+	if (!stream)
+	{
+		rError() << "Cannot open file " << args[0].getString() << std::endl;
+		return;
+	}
+
+	std::string buffer = stream::readToString(stream);
+
+	// Locate the brushDef3 blocks (the part following the keyword),
+	// running them through the parser once to validate them
+	typedef std::pair<const char*, const char*> Block;
+	std::vector<Block> blocks;
+
+	BrushDef3Parser brushParser;
+
+	try
+	{
+		parser::ContiguousDefTokeniser tok(buffer);
+
+		while (tok.hasMoreTokens())
+		{
+			if (tok.nextTokenView() != brushParser.getKeyword()) continue;
+
+			const char* begin = tok.getPosition();
+			brushParser.parseDetached(tok);
+			blocks.emplace_back(begin, tok.getPosition());
+		}
+	}
+	catch (parser::ParseException& ex)
+	{
+		rError() << "Failed to parse brushDef3 block: " << ex.what() << std::endl;
+		return;
+	}
+
+	// Collect the numeric tokens, both as strings and as views into the buffer
+	std::vector<std::string> numberStrings;
+	std::vector<std::string_view> numberViews;
+
+	for (const Block& block : blocks)
+	{
+		parser::ContiguousDefTokeniser tok(block.first, block.second);
+
+		while (tok.hasMoreTokens())
+		{
+			std::string_view view = tok.nextTokenView();
+
+			if (isNumericToken(view))
+			{
+				numberStrings.emplace_back(view);
+				numberViews.push_back(view);
+			}
+		}
+	}
+
+	rMessage() << "Benchmarking " << blocks.size() << " brushDef3 blocks containing "
+		<< numberViews.size() << " numbers, " << NUM_ITERATIONS << " iterations" << std::endl;
+
+	// Number conversion only
+	double checksumLegacy = 0;
+	util::Stopwatch timer;
+
+	for (std::size_t i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		for (const std::string& str : numberStrings)
+		{
+			checksumLegacy += atof(str.c_str());
+		}
+	}
+
+	double atofTime = timer.getMilliseconds();
+
+	double checksumFast = 0;
+	timer.restart();
+
+	for (std::size_t i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		for (const std::string_view& view : numberViews)
+		{
+			checksumFast += string::from_chars<double>(view.data(), view.data() + view.size());
+		}
+	}
+
+	double fromCharsTime = timer.getMilliseconds();
+
+	rMessage() << fmt::format("Number conversion: atof {0:.2f} ms, from_chars {1:.2f} ms (checksums {2} / {3})",
+		atofTime, fromCharsTime, checksumLegacy, checksumFast) << std::endl;
+
+	// Full brushDef3 parse, string tokens vs. in-place tokens
+	std::vector<LegacyFaceData> legacyFaces;
+	std::size_t numLegacyFaces = 0;
+	timer.restart();
+
+	for (std::size_t i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		for (const Block& block : blocks)
+		{
+			std::string blockString(block.first, block.second);
+			parser::BasicDefTokeniser<std::string> tok(blockString);
+			numLegacyFaces += parseWithStringTokens(tok, legacyFaces);
+		}
+	}
+
+	double stringParseTime = timer.getMilliseconds();
+
+	timer.restart();
+
+	for (std::size_t i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		for (const Block& block : blocks)
+		{
+			parser::ContiguousDefTokeniser tok(block.first, block.second);
+			brushParser.parseDetached(tok);
+		}
+	}
+
+	double inPlaceParseTime = timer.getMilliseconds();
+
+	rMessage() << fmt::format("brushDef3 parsing: string tokens {0:.2f} ms, in-place tokens {1:.2f} ms ({2} faces)",
+		stringParseTime, inPlaceParseTime, numLegacyFaces / NUM_ITERATIONS) << std::endl;
+}
+
+}
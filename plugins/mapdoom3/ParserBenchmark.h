@@ -0,0 +1,19 @@
+#pragma once
+
+#include "icommandsystem.h"
+
+namespace map
+{
+
+/**
+ * Console command measuring the time spent in parsing the brushDef3
+ * primitives of the map file passed as argument. The timings of the
+ * legacy string-based path (std::string tokens converted through
+ * string::to_float) are compared against the in-place path (string_view
+ * tokens converted through string::from_chars) and written to the console.
+ *
+ * Usage: BenchmarkBrushDef3Parsing <absolute path to .map file>
+ */
+void benchmarkBrushDef3Parsing(const cmd::ArgumentList& args);
+
+}
@@ -21,19 +21,19 @@ public:
 		stream << std::endl;
 	}
 
-	virtual void beginWriteBrush(const IBrush& brush, std::ostream& stream)
+	virtual void writeBrush(std::size_t primitiveNum, const IBrush& brush, std::ostream& stream) const
 	{
 		// Primitive count comment
-		stream << "// brush " << _primitiveCount++ << std::endl;
+		stream << "// brush " << primitiveNum << std::endl;
 
 		// Export brushDef definition to stream
 		BrushDefExporter::exportBrush(stream, brush);
 	}
 
-	virtual void beginWritePatch(const IPatch& patch, std::ostream& stream)
+	virtual void writePatch(std::size_t primitiveNum, const IPatch& patch, std::ostream& stream) const
 	{
 		// Primitive count comment, not a typo, patches also seem to have "brush" in their comments
-		stream << "// brush " << _primitiveCount++ << std::endl;
+		stream << "// brush " << primitiveNum << std::endl;
 
 		// Export patchDef2 to stream (patchDef3 is not supported)
 		PatchDefExporter::exportQ3PatchDef2(stream, patch);
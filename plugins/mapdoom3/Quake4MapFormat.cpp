@@ -8,6 +8,7 @@
 #include "igame.h"
 #include "iregistry.h"
 #include "igroupnode.h"
+#include "iworkerpool.h"
 
 #include "parser/DefTokeniser.h"
 
@@ -44,6 +45,7 @@ const StringSet& Quake4MapFormat::getDependencies() const
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_GAMEMANAGER);
 		_dependencies.insert(MODULE_MAPFORMATMANAGER);
+		_dependencies.insert(MODULE_WORKERPOOL);
 	}
 
 	return _dependencies;
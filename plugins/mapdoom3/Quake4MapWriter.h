@@ -20,10 +20,10 @@ public:
 		stream << "Version " << MAP_VERSION_Q4 << std::endl;
 	}
 
-	virtual void beginWriteBrush(const IBrush& brush, std::ostream& stream)
+	virtual void writeBrush(std::size_t primitiveNum, const IBrush& brush, std::ostream& stream) const
 	{
 		// Primitive count comment
-		stream << "// primitive " << _primitiveCount++ << std::endl;
+		stream << "// primitive " << primitiveNum << std::endl;
 
 		// Export brushDef3 definition to stream, but without contents flags
 		BrushDef3Exporter::exportBrush(stream, brush, false);
@@ -1,6 +1,3 @@
-// greebo: Specialise the float casting function
-#define SPECIALISE_STR_TO_FLOAT
-
 #include "BrushDef.h"
 
 #include "string/convert.h"
@@ -62,25 +59,25 @@ scene::INodePtr BrushDefParser::parse(parser::DefTokeniser& tok) const
 		else if (token == "(") // FACE
 		{
 			// Parse three 3D points to construct a plane
-			double x = string::to_float(tok.nextToken());
-			double y = string::to_float(tok.nextToken());
-			double z = string::to_float(tok.nextToken());
+			double x = tok.nextDouble();
+			double y = tok.nextDouble();
+			double z = tok.nextDouble();
 			Vector3 p1(x, y, z);
 
 			tok.assertNextToken(")");
 			tok.assertNextToken("(");
 
-			x = string::to_float(tok.nextToken());
-			y = string::to_float(tok.nextToken());
-			z = string::to_float(tok.nextToken());
+			x = tok.nextDouble();
+			y = tok.nextDouble();
+			z = tok.nextDouble();
 			Vector3 p2(x, y, z);
 
 			tok.assertNextToken(")");
 			tok.assertNextToken("(");
 
-			x = string::to_float(tok.nextToken());
-			y = string::to_float(tok.nextToken());
-			z = string::to_float(tok.nextToken());
+			x = tok.nextDouble();
+			y = tok.nextDouble();
+			z = tok.nextDouble();
 			Vector3 p3(x, y, z);
 
 			tok.assertNextToken(")");
@@ -93,15 +90,15 @@ scene::INodePtr BrushDefParser::parse(parser::DefTokeniser& tok) const
 			tok.assertNextToken("(");
 
 			tok.assertNextToken("(");
-			texdef.xx() = string::to_float(tok.nextToken());
-			texdef.yx() = string::to_float(tok.nextToken());
-			texdef.tx() = string::to_float(tok.nextToken());
+			texdef.xx() = tok.nextDouble();
+			texdef.yx() = tok.nextDouble();
+			texdef.tx() = tok.nextDouble();
 			tok.assertNextToken(")");
 
 			tok.assertNextToken("(");
-			texdef.xy() = string::to_float(tok.nextToken());
-			texdef.yy() = string::to_float(tok.nextToken());
-			texdef.ty() = string::to_float(tok.nextToken());
+			texdef.xy() = tok.nextDouble();
+			texdef.yy() = tok.nextDouble();
+			texdef.ty() = tok.nextDouble();
 			tok.assertNextToken(")");
 
 			tok.assertNextToken(")");
@@ -178,25 +175,25 @@ scene::INodePtr LegacyBrushDefParser::parse(parser::DefTokeniser& tok) const
 		else if (token == "(") // FACE
 		{
 			// Parse three 3D points to construct a plane
-			double x = string::to_float(tok.nextToken());
-			double y = string::to_float(tok.nextToken());
-			double z = string::to_float(tok.nextToken());
+			double x = tok.nextDouble();
+			double y = tok.nextDouble();
+			double z = tok.nextDouble();
 			Vector3 p1(x, y, z);
 
 			tok.assertNextToken(")");
 			tok.assertNextToken("(");
 
-			x = string::to_float(tok.nextToken());
-			y = string::to_float(tok.nextToken());
-			z = string::to_float(tok.nextToken());
+			x = tok.nextDouble();
+			y = tok.nextDouble();
+			z = tok.nextDouble();
 			Vector3 p2(x, y, z);
 
 			tok.assertNextToken(")");
 			tok.assertNextToken("(");
 
-			x = string::to_float(tok.nextToken());
-			y = string::to_float(tok.nextToken());
-			z = string::to_float(tok.nextToken());
+			x = tok.nextDouble();
+			y = tok.nextDouble();
+			z = tok.nextDouble();
 			Vector3 p3(x, y, z);
 
 			tok.assertNextToken(")");
@@ -208,13 +205,13 @@ scene::INodePtr LegacyBrushDefParser::parse(parser::DefTokeniser& tok) const
 			std::string shader = GlobalTexturePrefix_get() + tok.nextToken();
 
 			// Parse texture (shift rotation scale)
-            float shiftS = string::to_float(tok.nextToken());
-            float shiftT = string::to_float(tok.nextToken());
+            float shiftS = tok.nextDouble();
+            float shiftT = tok.nextDouble();
 
-            float rotation = string::to_float(tok.nextToken());
+            float rotation = tok.nextDouble();
 
-            float scaleS = string::to_float(tok.nextToken());
-            float scaleT = string::to_float(tok.nextToken());
+            float scaleS = tok.nextDouble();
+            float scaleT = tok.nextDouble();
 
             Matrix4 texdef = getTexDef(shiftS, shiftT, rotation, scaleS, scaleT);
 
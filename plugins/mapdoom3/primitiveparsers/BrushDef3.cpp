@@ -1,6 +1,3 @@
-// greebo: Specialise the float casting function
-#define SPECIALISE_STR_TO_FLOAT
-
 #include "BrushDef3.h"
 #include "string/convert.h"
 #include "imap.h"
@@ -8,6 +5,7 @@
 #include "parser/DefTokeniser.h"
 #include "math/Matrix4.h"
 #include "math/Plane3.h"
+#include <vector>
 #include "shaderlib.h"
 #include "i18n.h"
 #include <fmt/format.h>
@@ -36,6 +34,36 @@ brushDef3
 }
 */
 
+namespace
+{
+
+// The faces of a brushDef3 primitive, to be applied to a brush node
+class ParsedBrushDef3 :
+	public ParsedPrimitive
+{
+public:
+	struct FaceData
+	{
+		Plane3 plane;
+		Matrix4 texdef;
+		std::string shader;
+		IBrush::DetailFlag detailFlag;
+	};
+
+	std::vector<FaceData> faces;
+
+	// Quake 4 brushes don't carry any detail flags
+	bool hasDetailFlags;
+
+	ParsedBrushDef3(bool hasDetailFlags_) :
+		hasDetailFlags(hasDetailFlags_)
+	{}
+
+	scene::INodePtr createNode() const override;
+};
+
+}
+
 // greebo: switch off optimisations for this section - the symptom is that brushes don't get a 
 // valid d value assigned after the first call to addFace() - the callback triggers a series
 // of calls in the DarkRadiant main module (up to the Texture Tool), and after return the plane
@@ -44,7 +72,7 @@ brushDef3
 #pragma optimize( "", off )
 #endif
 
-scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
+scene::INodePtr ParsedBrushDef3::createNode() const
 {
 	// Create a new brush
 	scene::INodePtr node = GlobalBrushCreator().createBrush();
@@ -55,6 +83,24 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 
 	IBrush& brush = brushNode->getIBrush();
 
+	for (const FaceData& face : faces)
+	{
+		if (hasDetailFlags)
+		{
+			brush.setDetailFlag(face.detailFlag);
+		}
+
+		// Add the new face to the brush
+		/*IFace& face = */brush.addFace(face.plane, face.texdef, face.shader);
+	}
+
+	return node;
+}
+
+ParsedPrimitivePtr BrushDef3Parser::parseDetached(parser::DefTokeniser& tok) const
+{
+	std::unique_ptr<ParsedBrushDef3> brush(new ParsedBrushDef3(true));
+
 	tok.assertNextToken("{");
 
 	// Parse face tokens until a closing brace is encountered
@@ -69,47 +115,46 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 		}
 		else if (token == "(") // FACE
 		{
+			brush->faces.emplace_back();
+			ParsedBrushDef3::FaceData& face = brush->faces.back();
+
 			// Construct a plane and parse its values
-			Plane3 plane;
+			Plane3& plane = face.plane;
 
-			plane.normal().x() = string::to_float(tok.nextToken());
-			plane.normal().y() = string::to_float(tok.nextToken());
-			plane.normal().z() = string::to_float(tok.nextToken());
-			plane.dist() = -string::to_float(tok.nextToken()); // negate d
+			plane.normal().x() = tok.nextDouble();
+			plane.normal().y() = tok.nextDouble();
+			plane.normal().z() = tok.nextDouble();
+			plane.dist() = -tok.nextDouble(); // negate d
 
 			tok.assertNextToken(")");
 
 			// Parse TexDef
-			Matrix4 texdef;
+			Matrix4& texdef = face.texdef;
 			tok.assertNextToken("(");
 
 			tok.assertNextToken("(");
-			texdef.xx() = string::to_float(tok.nextToken());
-			texdef.yx() = string::to_float(tok.nextToken());
-			texdef.tx() = string::to_float(tok.nextToken());
+			texdef.xx() = tok.nextDouble();
+			texdef.yx() = tok.nextDouble();
+			texdef.tx() = tok.nextDouble();
 			tok.assertNextToken(")");
 
 			tok.assertNextToken("(");
-			texdef.xy() = string::to_float(tok.nextToken());
-			texdef.yy() = string::to_float(tok.nextToken());
-			texdef.ty() = string::to_float(tok.nextToken());
+			texdef.xy() = tok.nextDouble();
+			texdef.yy() = tok.nextDouble();
+			texdef.ty() = tok.nextDouble();
 			tok.assertNextToken(")");
 
 			tok.assertNextToken(")");
 
 			// Parse Shader
-			std::string shader = tok.nextToken();
+			face.shader = tok.nextToken();
 
 			// Parse Flags (usually each brush has all faces detail or all faces structural)
-			IBrush::DetailFlag flag = static_cast<IBrush::DetailFlag>(
+			face.detailFlag = static_cast<IBrush::DetailFlag>(
 				string::convert<std::size_t>(tok.nextToken(), IBrush::Structural));
-			brush.setDetailFlag(flag);
 
 			// Ignore the other two flags
 			tok.skipTokens(2);
-
-			// Finally, add the new face to the brush
-			/*IFace& face = */brush.addFace(plane, texdef, shader);
 		}
 		else {
 			std::string text = fmt::format(_("BrushDef3Parser: invalid token '{0}'"), token);
@@ -120,19 +165,12 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 	// Final outer "}"
 	tok.assertNextToken("}");
 
-	return node;
+	return brush;
 }
 
-scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
+ParsedPrimitivePtr BrushDef3ParserQuake4::parseDetached(parser::DefTokeniser& tok) const
 {
-	// Create a new brush
-	scene::INodePtr node = GlobalBrushCreator().createBrush();
-
-	// Cast the node, this must succeed
-	IBrushNodePtr brushNode = std::dynamic_pointer_cast<IBrushNode>(node);
-	assert(brushNode != NULL);
-
-	IBrush& brush = brushNode->getIBrush();
+	std::unique_ptr<ParsedBrushDef3> brush(new ParsedBrushDef3(false));
 
 	tok.assertNextToken("{");
 
@@ -148,39 +186,39 @@ scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
 		}
 		else if (token == "(") // FACE
 		{
+			brush->faces.emplace_back();
+			ParsedBrushDef3::FaceData& face = brush->faces.back();
+
 			// Construct a plane and parse its values
-			Plane3 plane;
+			Plane3& plane = face.plane;
 
-			plane.normal().x() = string::to_float(tok.nextToken());
-			plane.normal().y() = string::to_float(tok.nextToken());
-			plane.normal().z() = string::to_float(tok.nextToken());
-			plane.dist() = -string::to_float(tok.nextToken()); // negate d
+			plane.normal().x() = tok.nextDouble();
+			plane.normal().y() = tok.nextDouble();
+			plane.normal().z() = tok.nextDouble();
+			plane.dist() = -tok.nextDouble(); // negate d
 
 			tok.assertNextToken(")");
 
 			// Parse TexDef
-			Matrix4 texdef;
+			Matrix4& texdef = face.texdef;
 			tok.assertNextToken("(");
 
 			tok.assertNextToken("(");
-			texdef.xx() = string::to_float(tok.nextToken());
-			texdef.yx() = string::to_float(tok.nextToken());
-			texdef.tx() = string::to_float(tok.nextToken());
+			texdef.xx() = tok.nextDouble();
+			texdef.yx() = tok.nextDouble();
+			texdef.tx() = tok.nextDouble();
 			tok.assertNextToken(")");
 
 			tok.assertNextToken("(");
-			texdef.xy() = string::to_float(tok.nextToken());
-			texdef.yy() = string::to_float(tok.nextToken());
-			texdef.ty() = string::to_float(tok.nextToken());
+			texdef.xy() = tok.nextDouble();
+			texdef.yy() = tok.nextDouble();
+			texdef.ty() = tok.nextDouble();
 			tok.assertNextToken(")");
 
 			tok.assertNextToken(")");
 
 			// Parse Shader
-			std::string shader = tok.nextToken();
-
-			// Finally, add the new face to the brush
-			/*IFace& face = */brush.addFace(plane, texdef, shader);
+			face.shader = tok.nextToken();
 		}
 		else {
 			std::string text = fmt::format(_("BrushDef3ParserQuake4: invalid token '{0}'"), token);
@@ -191,7 +229,7 @@ scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
 	// Final outer "}"
 	tok.assertNextToken("}");
 
-	return node;
+	return brush;
 }
 
 #if _MSC_VER >= 1600
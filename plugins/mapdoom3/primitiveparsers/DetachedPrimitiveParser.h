@@ -0,0 +1,53 @@
+#pragma once
+
+#include "imapformat.h"
+#include <memory>
+
+namespace map
+{
+
+/**
+ * The result of a primitive parse which is not bound to a scene node yet.
+ * Creating the actual node involves the brush/patch modules, the render
+ * system and the layer system, which must only happen in the main thread.
+ */
+class ParsedPrimitive
+{
+public:
+	virtual ~ParsedPrimitive() {}
+
+	/**
+	 * Creates the scene node from the parsed data. Must be called from the
+	 * main thread. Throws parser::ParseException if the parsed data cannot
+	 * be applied to the node.
+	 */
+	virtual scene::INodePtr createNode() const = 0;
+};
+typedef std::unique_ptr<ParsedPrimitive> ParsedPrimitivePtr;
+
+/**
+ * A PrimitiveParser which is able to split the parse into a detached phase
+ * (reading the tokens into a ParsedPrimitive) and the node creation.
+ *
+ * The detached phase must not access any global module, such that the map reader
+ * is able to run it in worker threads. Since the regular parse() method is
+ * implemented on top of the detached phase, a map loaded in parallel ends up
+ * with exactly the same nodes as one loaded serially.
+ */
+class DetachedPrimitiveParser :
+	public PrimitiveParser
+{
+public:
+	/**
+	 * Parses the primitive from the given tokeniser without creating a scene node.
+	 * This method is safe to be called from any thread.
+	 */
+	virtual ParsedPrimitivePtr parseDetached(parser::DefTokeniser& tok) const = 0;
+
+	scene::INodePtr parse(parser::DefTokeniser& tok) const override
+	{
+		return parseDetached(tok)->createNode();
+	}
+};
+
+} // namespace map
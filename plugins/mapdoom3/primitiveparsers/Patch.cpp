@@ -1,36 +1,86 @@
-// greebo: Specialise the float casting function
-#define SPECIALISE_STR_TO_FLOAT
-
 #include "Patch.h"
 
-#include "string/convert.h"
 #include "parser/DefTokeniser.h"
 
 namespace map
 {
 
-void PatchParser::parseMatrix(parser::DefTokeniser& tok, IPatch& patch) const
+scene::INodePtr ParsedPatch::createNode() const
+{
+	scene::INodePtr node = parser.createPatchNode();
+
+	IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(node);
+	assert(patchNode != NULL);
+
+	IPatch& patch = patchNode->getPatch();
+
+	parser.setShader(patch, shader);
+
+	patch.setDims(cols, rows);
+
+	if (fixedSubdivisions)
+	{
+		patch.setFixedSubdivisions(true, subdivisions);
+	}
+
+	// The patch might have corrected the dimensions, the parsed matrix must match them
+	if (matrix.size() != patch.getWidth())
+	{
+		throw parser::ParseException("Patch matrix doesn't match the patch width");
+	}
+
+	for (std::size_t c = 0; c < patch.getWidth(); c++)
+	{
+		if (matrix[c].size() != patch.getHeight())
+		{
+			throw parser::ParseException("Patch matrix doesn't match the patch height");
+		}
+
+		for (std::size_t r = 0; r < patch.getHeight(); r++)
+		{
+			patch.ctrlAt(r, c) = matrix[c][r];
+		}
+	}
+
+	patch.controlPointsChanged();
+
+	return node;
+}
+
+void PatchParser::setShader(IPatch& patch, const std::string& shader) const
+{
+	patch.setShader(shader);
+}
+
+void PatchParser::parseMatrix(parser::DefTokeniser& tok, ParsedPatch& patch) const
 {
 	tok.assertNextToken("(");
 
 	// For each row
-	for (std::size_t c = 0; c < patch.getWidth(); c++)
+	while (tok.peek() != ")")
 	{
 		tok.assertNextToken("(");
 
+		patch.matrix.emplace_back();
+		std::vector<PatchControl>& column = patch.matrix.back();
+		column.reserve(patch.rows);
+
 		// For each column
-		for (std::size_t r=0; r < patch.getHeight(); r++)
+		while (tok.peek() != ")")
 		{
 			tok.assertNextToken("(");
 
+			column.emplace_back();
+			PatchControl& ctrl = column.back();
+
 			// Parse vertex coordinates
-			patch.ctrlAt(r, c).vertex[0] = string::to_float(tok.nextToken());
-			patch.ctrlAt(r, c).vertex[1] = string::to_float(tok.nextToken());
-			patch.ctrlAt(r, c).vertex[2] = string::to_float(tok.nextToken());
+			ctrl.vertex[0] = tok.nextDouble();
+			ctrl.vertex[1] = tok.nextDouble();
+			ctrl.vertex[2] = tok.nextDouble();
 
 			// Parse texture coordinates
-			patch.ctrlAt(r, c).texcoord[0] = string::to_float(tok.nextToken());
-			patch.ctrlAt(r, c).texcoord[1] = string::to_float(tok.nextToken());
+			ctrl.texcoord[0] = tok.nextDouble();
+			ctrl.texcoord[1] = tok.nextDouble();
 
 			tok.assertNextToken(")");
 		}
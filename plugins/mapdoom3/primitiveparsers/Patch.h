@@ -1,19 +1,61 @@
 #ifndef Patch_h__
 #define Patch_h__
 
-#include "imapformat.h"
+#include "DetachedPrimitiveParser.h"
 #include "ipatch.h"
+#include <vector>
 
 namespace map
 {
 
+class PatchParser;
+
+// The parsed contents of a patchDef2/patchDef3 primitive
+class ParsedPatch :
+	public ParsedPrimitive
+{
+public:
+	// The parser is used to create the node
+	const PatchParser& parser;
+
+	std::string shader;
+
+	// Matrix dimensions as found in the patch header
+	std::size_t cols;
+	std::size_t rows;
+
+	// Fixed tesselation (patchDef3 only)
+	bool fixedSubdivisions;
+	Subdivisions subdivisions;
+
+	// The control points as found in the file, column by column
+	std::vector< std::vector<PatchControl> > matrix;
+
+	ParsedPatch(const PatchParser& parser_) :
+		parser(parser_),
+		cols(0),
+		rows(0),
+		fixedSubdivisions(false),
+		subdivisions(0, 0)
+	{}
+
+	scene::INodePtr createNode() const override;
+};
+
 // Common base class for PatchDef2Parser and PatchDef3Parser
 class PatchParser :
-	public PrimitiveParser
+	public DetachedPrimitiveParser
 {
+public:
+	// Creates an empty patch node of the type handled by this parser
+	virtual scene::INodePtr createPatchNode() const = 0;
+
+	// Assigns the parsed shader name to the patch
+	virtual void setShader(IPatch& patch, const std::string& shader) const;
+
 protected:
-	// Parses the control point matrix. The given patch must have its dimensions set before this call.
-	void parseMatrix(parser::DefTokeniser& tok, IPatch& patch) const;
+	// Parses the control point matrix into the given patch data
+	void parseMatrix(parser::DefTokeniser& tok, ParsedPatch& patch) const;
 };
 
 } // namespace map
@@ -1,6 +1,3 @@
-// greebo: Specialise the float casting function
-#define SPECIALISE_STR_TO_FLOAT
-
 #include "PatchDef2.h"
 
 #include "imap.h"
@@ -35,28 +32,21 @@ patchDef2
 }
 }
 */
-scene::INodePtr PatchDef2Parser::parse(parser::DefTokeniser& tok) const
+ParsedPrimitivePtr PatchDef2Parser::parseDetached(parser::DefTokeniser& tok) const
 {
-	scene::INodePtr node = GlobalPatchCreator(PatchDefType::Def2).createPatch();
-
-	IPatchNodePtr patchNode = std::dynamic_pointer_cast<IPatchNode>(node);
-	assert(patchNode != NULL);
-
-	IPatch& patch = patchNode->getPatch();
+	std::unique_ptr<ParsedPatch> patch(new ParsedPatch(*this));
 
 	tok.assertNextToken("{");
 
 	// Parse shader
-	setShader(patch, tok.nextToken()); 
+	patch->shader = tok.nextToken();
 
 	// Parse parameters
 	tok.assertNextToken("(");
 
 	// parse matrix dimensions
-	std::size_t cols = string::convert<std::size_t>(tok.nextToken());
-	std::size_t rows = string::convert<std::size_t>(tok.nextToken());
-
-	patch.setDims(cols, rows);
+	patch->cols = string::convert<std::size_t>(tok.nextToken());
+	patch->rows = string::convert<std::size_t>(tok.nextToken());
 
 	// ignore contents/flags values
 	tok.skipTokens(3);
@@ -64,15 +54,18 @@ scene::INodePtr PatchDef2Parser::parse(parser::DefTokeniser& tok) const
 	tok.assertNextToken(")");
 
 	// Parse Patch Matrix
-	parseMatrix(tok, patch);
+	parseMatrix(tok, *patch);
 
 	// Parse Footer
 	tok.assertNextToken("}");
 	tok.assertNextToken("}");
 
-	patch.controlPointsChanged();
+	return patch;
+}
 
-	return node;
+scene::INodePtr PatchDef2Parser::createPatchNode() const
+{
+	return GlobalPatchCreator(PatchDefType::Def2).createPatch();
 }
 
 void PatchDef2Parser::setShader(IPatch& patch, const std::string& shader) const
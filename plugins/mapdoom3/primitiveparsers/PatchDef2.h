@@ -11,10 +11,11 @@ class PatchDef2Parser :
 public:
 	const std::string& getKeyword() const;
 
-    scene::INodePtr parse(parser::DefTokeniser& tok) const;
+    ParsedPrimitivePtr parseDetached(parser::DefTokeniser& tok) const override;
 
-protected:
-	virtual void setShader(IPatch& patch, const std::string& shader) const;
+	scene::INodePtr createPatchNode() const override;
+
+	void setShader(IPatch& patch, const std::string& shader) const override;
 };
 typedef std::shared_ptr<PatchDef2Parser> PatchDef2ParserPtr;
 
@@ -22,8 +23,8 @@ typedef std::shared_ptr<PatchDef2Parser> PatchDef2ParserPtr;
 class PatchDef2ParserQ3 :
 	public PatchDef2Parser
 {
-protected:
-	virtual void setShader(IPatch& patch, const std::string& shader) const;
+public:
+	void setShader(IPatch& patch, const std::string& shader) const override;
 };
 typedef std::shared_ptr<PatchDef2Parser> PatchDef2ParserPtr;
 
@@ -12,7 +12,9 @@ class PatchDef3Parser :
 public:
 	const std::string& getKeyword() const;
 
-    scene::INodePtr parse(parser::DefTokeniser& tok) const;
+    ParsedPrimitivePtr parseDetached(parser::DefTokeniser& tok) const override;
+
+	scene::INodePtr createPatchNode() const override;
 };
 typedef std::shared_ptr<PatchDef3Parser> PatchDef3ParserPtr;
 
@@ -4,34 +4,11 @@
 #include "ibrush.h"
 #include "math/Plane3.h"
 #include "math/Matrix4.h"
+#include "ExportUtil.h"
 
 namespace map
 {
 
-namespace
-{
-	// Writes a double to the given stream and checks for NaN and infinity
-	inline void writeDoubleSafe(const double d, std::ostream& os)
-	{
-		if (isValid(d))
-		{
-			if (d == -0.0)
-			{
-				os << 0; // convert -0 to 0
-			}
-			else
-			{
-				os << d;
-			}
-		}
-		else
-		{
-			// Is infinity or NaN, write 0
-			os << "0";
-		}
-	}
-}
-
 class BrushDef3Exporter
 {
 public:
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <ostream>
+#include <charconv>
+#include "math/FloatTools.h"
+
+namespace map
+{
+
+namespace
+{
+	// Stream flags changing the way operator<< formats a double
+	const std::ios_base::fmtflags FLOAT_FORMAT_FLAGS = std::ios_base::floatfield |
+		std::ios_base::showpoint | std::ios_base::showpos | std::ios_base::uppercase;
+
+	// Writes a double to the given stream and checks for NaN and infinity.
+	// The output is the same as the one of operator<< using the stream's precision,
+	// but the number is formatted by std::to_chars which avoids the stream's
+	// locale facets, making up a big part of the time spent in saving a map.
+	inline void writeDoubleSafe(const double d, std::ostream& os)
+	{
+		// Infinity or NaN are written as 0, convert -0 to 0
+		if (!isValid(d) || d == 0)
+		{
+			os << '0';
+			return;
+		}
+
+#ifdef __cpp_lib_to_chars
+		if ((os.flags() & FLOAT_FORMAT_FLAGS) == 0 && os.width() == 0)
+		{
+			char buffer[64];
+			std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), d,
+				std::chars_format::general, static_cast<int>(os.precision()));
+
+			if (result.ec == std::errc())
+			{
+				os.write(buffer, result.ptr - buffer);
+				return;
+			}
+		}
+#endif
+
+		os << d;
+	}
+}
+
+}
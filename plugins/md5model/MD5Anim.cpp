@@ -2,6 +2,8 @@
 
 #include "itextstream.h"
 #include "string/convert.h"
+#include "stream/utils.h"
+#include "parser/ContiguousDefTokeniser.h"
 
 namespace md5
 {
@@ -54,17 +56,17 @@ void MD5Anim::parseFrameBounds(parser::DefTokeniser& tok)
 	{
 		tok.assertNextToken("(");
 
-		_bounds[i].origin.x() = string::convert<float>(tok.nextToken());
-		_bounds[i].origin.y() = string::convert<float>(tok.nextToken());
-		_bounds[i].origin.z() = string::convert<float>(tok.nextToken());
+		_bounds[i].origin.x() = tok.nextFloat();
+		_bounds[i].origin.y() = tok.nextFloat();
+		_bounds[i].origin.z() = tok.nextFloat();
 
 		tok.assertNextToken(")");
 
 		tok.assertNextToken("(");
 
-		_bounds[i].extents.x() = string::convert<float>(tok.nextToken());
-		_bounds[i].extents.y() = string::convert<float>(tok.nextToken());
-		_bounds[i].extents.z() = string::convert<float>(tok.nextToken());
+		_bounds[i].extents.x() = tok.nextFloat();
+		_bounds[i].extents.y() = tok.nextFloat();
+		_bounds[i].extents.z() = tok.nextFloat();
 
 		tok.assertNextToken(")");
 	}
@@ -81,18 +83,18 @@ void MD5Anim::parseBaseFrame(parser::DefTokeniser& tok)
 	{
 		tok.assertNextToken("(");
 		
-		_baseFrame[i].origin.x() = string::convert<float>(tok.nextToken());
-		_baseFrame[i].origin.y() = string::convert<float>(tok.nextToken());
-		_baseFrame[i].origin.z() = string::convert<float>(tok.nextToken());
+		_baseFrame[i].origin.x() = tok.nextFloat();
+		_baseFrame[i].origin.y() = tok.nextFloat();
+		_baseFrame[i].origin.z() = tok.nextFloat();
 
 		tok.assertNextToken(")");
 
 		tok.assertNextToken("(");
 
 		Vector3 rawRotation;
-		rawRotation.x() = string::convert<float>(tok.nextToken());
-		rawRotation.y() = string::convert<float>(tok.nextToken());
-		rawRotation.z() = string::convert<float>(tok.nextToken());
+		rawRotation.x() = tok.nextFloat();
+		rawRotation.y() = tok.nextFloat();
+		rawRotation.z() = tok.nextFloat();
 
 		// Calculate the fourth component of the quaternion
 		float lSq = rawRotation.getLengthSquared();
@@ -127,7 +129,7 @@ void MD5Anim::parseFrame(std::size_t frame, parser::DefTokeniser& tok)
 	// Each frame block has <numAnimatedComponents> float values
 	for (std::size_t i = 0; i < _numAnimatedComponents; ++i)
 	{
-		_frames[parsedFrameNum][i] = string::convert<float>(tok.nextToken());
+		_frames[parsedFrameNum][i] = tok.nextFloat();
 	}
 
 	tok.assertNextToken("}");
@@ -135,7 +137,10 @@ void MD5Anim::parseFrame(std::size_t frame, parser::DefTokeniser& tok)
 
 void MD5Anim::parseFromStream(std::istream& stream)
 {
-	parser::BasicDefTokeniser<std::istream> tokeniser(stream);
+	// Buffer the file, the frame values are converted in place
+	std::string buffer = stream::readToString(stream);
+
+	parser::ContiguousDefTokeniser tokeniser(buffer);
 	parseFromTokens(tokeniser);
 }
 
@@ -91,6 +91,11 @@ bool MD5ModelNode::intersectsLight(const RendererLight& light) const
 	return light.intersectsAABB(worldAABB());
 }
 
+AABB MD5ModelNode::getLitObjectBounds() const
+{
+	return worldAABB();
+}
+
 void MD5ModelNode::insertLight(const RendererLight& light) {
 	const Matrix4& l2w = localToWorld();
 
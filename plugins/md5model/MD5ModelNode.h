@@ -56,6 +56,7 @@ public:
 
 	// LitObject implementation
 	bool intersectsLight(const RendererLight& light) const override;
+	AABB getLitObjectBounds() const override;
 	void insertLight(const RendererLight& light) override;
 	void clearLights() override;
 
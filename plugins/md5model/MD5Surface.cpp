@@ -40,6 +40,7 @@ MD5Surface::~MD5Surface()
 void MD5Surface::updateGeometry()
 {
 	_aabb_local = AABB();
+	_bvh.reset();
 
 	for (Vertices::const_iterator i = _vertices.begin(); i != _vertices.end(); ++i)
 	{
@@ -162,11 +163,13 @@ void MD5Surface::testSelect(Selector& selector,
 	test.BeginMesh(localToWorld);
 
 	SelectionIntersection best;
-	test.TestTriangles(
-	  vertexpointer_arbitrarymeshvertex(_vertices.data()),
-	  IndexPointer(_indices.data(), IndexPointer::index_type(_indices.size())),
-	  best
-	);
+	VertexPointer vertices = vertexpointer_arbitrarymeshvertex(_vertices.data());
+
+	// Only the triangles in the hierarchy nodes touching the selection volume are tested
+	getTriangleBVH().foreachTriangleInVolume(test.getVolume(), localToWorld, [&](std::size_t firstIndex)
+	{
+		test.TestTriangles(vertices, IndexPointer(_indices.data() + firstIndex, 3), best);
+	});
 
 	if(best.isValid()) {
 		selector.addIntersection(best);
@@ -175,43 +178,29 @@ void MD5Surface::testSelect(Selector& selector,
 
 bool MD5Surface::getIntersection(const Ray& ray, Vector3& intersection, const Matrix4& localToWorld)
 {
-	Vector3 bestIntersection = ray.origin;
-	Vector3 triIntersection;
+	// The ray is traced in local space
+	Ray localRay(ray);
+	localRay.transform(localToWorld.getFullInverse());
 
-	for (Indices::const_iterator i = _indices.begin();
-		 i != _indices.end();
-		 i += 3)
-	{
-		// Get the vertices for this triangle
-		const ArbitraryMeshVertex& p1 = _vertices[*(i)];
-		const ArbitraryMeshVertex& p2 = _vertices[*(i+1)];
-		const ArbitraryMeshVertex& p3 = _vertices[*(i+2)];
-
-		if (ray.intersectTriangle(localToWorld.transformPoint(p1.vertex), 
-			localToWorld.transformPoint(p2.vertex), localToWorld.transformPoint(p3.vertex), triIntersection))
-		{
-			intersection = triIntersection;
-			
-			// Test if this surface intersection is better than what we currently have
-			float oldDistSquared = (bestIntersection - ray.origin).getLengthSquared();
-			float newDistSquared = (triIntersection - ray.origin).getLengthSquared();
-
-			if ((oldDistSquared == 0 && newDistSquared > 0) || newDistSquared < oldDistSquared)
-			{
-				bestIntersection = triIntersection;
-			}
-		}
-	}
+	Vector3 localIntersection;
 
-	if ((bestIntersection - ray.origin).getLengthSquared() > 0)
+	if (!getTriangleBVH().intersect(localRay, _vertices, _indices, localIntersection))
 	{
-		intersection = bestIntersection;
-		return true;
+		return false;
 	}
-	else
+
+	intersection = localToWorld.transformPoint(localIntersection);
+	return true;
+}
+
+const render::TriangleBVH& MD5Surface::getTriangleBVH() const
+{
+	if (!_bvh)
 	{
-		return false;
+		_bvh.reset(new render::TriangleBVH(_vertices, _indices));
 	}
+
+	return *_bvh;
 }
 
 void MD5Surface::setDefaultMaterial(const std::string& name)
@@ -381,6 +370,7 @@ void MD5Surface::buildVertexNormals()
 void MD5Surface::buildIndexArray()
 {
 	_indices.clear();
+	_bvh.reset();
 
 	// Build the indices based on the triangle information
 	for (MD5Tris::const_iterator j = _mesh->triangles.begin(); j != _mesh->triangles.end(); ++j)
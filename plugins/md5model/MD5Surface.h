@@ -5,6 +5,8 @@
 #include "irenderable.h"
 #include "math/AABB.h"
 #include "math/Frustum.h"
+#include "render/TriangleBVH.h"
+#include <memory>
 #include "iselectiontest.h"
 #include "modelskin.h"
 #include "imodelsurface.h"
@@ -44,6 +46,9 @@ private:
 	Vertices _vertices;
 	Indices _indices;
 
+	// Accelerates ray intersections and selection tests, built on demand and discarded when the geometry changes
+	mutable std::unique_ptr<render::TriangleBVH> _bvh;
+
 	// The GL display lists for this surface's geometry
 	GLuint _normalList;
 	GLuint _lightingList;
@@ -59,6 +64,9 @@ private:
 	// Re-calculate the normal vectors
 	void buildVertexNormals();
 
+	// Returns the triangle hierarchy, building it if necessary
+	const render::TriangleBVH& getTriangleBVH() const;
+
 public:
 
 	/**
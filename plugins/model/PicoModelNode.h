@@ -79,6 +79,7 @@ public:
 
 	// LitObject test function
 	bool intersectsLight(const RendererLight& light) const override;
+	AABB getLitObjectBounds() const override;
 	// Add a light to this model instance
 	void insertLight(const RendererLight& light) override;
 	// Clear all lights from this model instance
@@ -296,12 +296,13 @@ void RenderablePicoSurface::testSelect(Selector& selector,
 		test.BeginMesh(localToWorld);
 		SelectionIntersection result;
 
-		test.TestTriangles(
-			VertexPointer(&_vertices[0].vertex, sizeof(ArbitraryMeshVertex)),
-      		IndexPointer(&_indices[0],
-      					 IndexPointer::index_type(_indices.size())),
-			result
-		);
+		VertexPointer vertices(&_vertices[0].vertex, sizeof(ArbitraryMeshVertex));
+
+		// Only the triangles in the hierarchy nodes touching the selection volume are tested
+		getTriangleBVH().foreachTriangleInVolume(test.getVolume(), localToWorld, [&](std::size_t firstIndex)
+		{
+			test.TestTriangles(vertices, IndexPointer(&_indices[firstIndex], 3), result);
+		});
 
 		// Add the intersection to the selector if it is valid
 		if(result.isValid()) {
@@ -375,43 +376,29 @@ void RenderablePicoSurface::setActiveMaterial(const std::string& activeMaterial)
 
 bool RenderablePicoSurface::getIntersection(const Ray& ray, Vector3& intersection, const Matrix4& localToWorld)
 {
-	Vector3 bestIntersection = ray.origin;
-	Vector3 triIntersection;
-
-	for (Indices::const_iterator i = _indices.begin();
-		 i != _indices.end();
-		 i += 3)
-	{
-		// Get the vertices for this triangle
-		const ArbitraryMeshVertex& p1 = _vertices[*(i)];
-		const ArbitraryMeshVertex& p2 = _vertices[*(i+1)];
-		const ArbitraryMeshVertex& p3 = _vertices[*(i+2)];
+	// The ray is traced in local space
+	Ray localRay(ray);
+	localRay.transform(localToWorld.getFullInverse());
 
-		if (ray.intersectTriangle(localToWorld.transformPoint(p1.vertex), 
-			localToWorld.transformPoint(p2.vertex), localToWorld.transformPoint(p3.vertex), triIntersection))
-		{
-			intersection = triIntersection;
-			
-			// Test if this surface intersection is better than what we currently have
-			float oldDistSquared = (bestIntersection - ray.origin).getLengthSquared();
-			float newDistSquared = (triIntersection - ray.origin).getLengthSquared();
-
-			if ((oldDistSquared == 0 && newDistSquared > 0) || newDistSquared < oldDistSquared)
-			{
-				bestIntersection = triIntersection;
-			}
-		}
-	}
+	Vector3 localIntersection;
 
-	if ((bestIntersection - ray.origin).getLengthSquared() > 0)
+	if (!getTriangleBVH().intersect(localRay, _vertices, _indices, localIntersection))
 	{
-		intersection = bestIntersection;
-		return true;
+		return false;
 	}
-	else
+
+	intersection = localToWorld.transformPoint(localIntersection);
+	return true;
+}
+
+const render::TriangleBVH& RenderablePicoSurface::getTriangleBVH() const
+{
+	if (!_bvh)
 	{
-		return false;
+		_bvh.reset(new render::TriangleBVH(_vertices, _indices));
 	}
+
+	return *_bvh;
 }
 
 void RenderablePicoSurface::applyScale(const Vector3& scale, const RenderablePicoSurface& originalSurface)
@@ -438,6 +425,8 @@ void RenderablePicoSurface::applyScale(const Vector3& scale, const RenderablePic
 		_localAABB.includePoint(_vertices[i].vertex);
 	}
 
+	_bvh.reset();
+
 	calculateTangents();
 
 	glDeleteLists(_dlRegular, 1);
@@ -4,6 +4,8 @@
 #include "picomodel.h"
 #include "render.h"
 #include "math/AABB.h"
+#include "render/TriangleBVH.h"
+#include <memory>
 
 #include "ishaders.h"
 #include "imodelsurface.h"
@@ -51,6 +53,9 @@ class RenderablePicoSurface :
 	// The AABB containing this surface, in local object space.
 	AABB _localAABB;
 
+	// Accelerates ray intersections and selection tests, built on demand and discarded when the vertices change
+	mutable std::unique_ptr<render::TriangleBVH> _bvh;
+
 	// The GL display lists for this surface's geometry
 	GLuint _dlRegular;
 	GLuint _dlProgramVcol;
@@ -70,6 +75,9 @@ private:
 
 	std::string cleanupShaderName(const std::string& mapName);
 
+	// Returns the triangle hierarchy, building it if necessary
+	const render::TriangleBVH& getTriangleBVH() const;
+
 public:
 	/**
 	 * Constructor. Accepts a picoSurface_t struct and the file extension to determine
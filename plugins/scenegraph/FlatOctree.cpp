@@ -0,0 +1,394 @@
+#include "FlatOctree.h"
+
+#include "inode.h"
+
+namespace scene
+{
+
+namespace
+{
+	// Same limits as the ones used by the regular Octree
+	const std::size_t SUBDIVISION_THRESHOLD = 32;
+	const std::size_t MIN_CELL_EXTENTS = 128;
+
+	const float START_SIZE = 512.0f;
+	const float MAX_WORLD_COORD = 65536;
+
+	const AABB START_AABB(Vector3(0,0,0), Vector3(START_SIZE, START_SIZE, START_SIZE));
+}
+
+FlatOctree::Cell::Cell() :
+	parent(nullptr),
+	generation(0)
+{}
+
+FlatOctree::Cell& FlatOctree::Cell::getChild(std::size_t index) const
+{
+	return *static_cast<CellHandle&>(*children[index])._cell;
+}
+
+FlatOctree::CellHandle::CellHandle(const CellPoolPtr& pool, Cell& cell) :
+	_pool(pool),
+	_cell(&cell),
+	_generation(cell.generation)
+{}
+
+ISPNodePtr FlatOctree::CellHandle::getParent() const
+{
+	const Cell* cell = getCell();
+
+	return cell != nullptr && cell->parent != nullptr ? cell->parent->handle : ISPNodePtr();
+}
+
+const AABB& FlatOctree::CellHandle::getBounds() const
+{
+	static const AABB _emptyBounds;
+
+	const Cell* cell = getCell();
+	return cell != nullptr ? cell->bounds : _emptyBounds;
+}
+
+const ISPNode::NodeList& FlatOctree::CellHandle::getChildNodes() const
+{
+	static const NodeList _emptyChildren;
+
+	const Cell* cell = getCell();
+	return cell != nullptr ? cell->children : _emptyChildren;
+}
+
+bool FlatOctree::CellHandle::isLeaf() const
+{
+	const Cell* cell = getCell();
+	return cell == nullptr || cell->isLeaf();
+}
+
+const ISPNode::MemberList& FlatOctree::CellHandle::getMembers() const
+{
+	static const MemberList _emptyMembers;
+
+	const Cell* cell = getCell();
+	return cell != nullptr ? cell->members : _emptyMembers;
+}
+
+FlatOctree::FlatOctree() :
+	_cells(std::make_shared<CellPool>()),
+	_root(allocateCell(START_AABB, nullptr))
+{}
+
+FlatOctree::~FlatOctree()
+{
+	// The handles refer to the pool, drop the cells' references to them and
+	// turn the handles still held by others into empty leaves
+	for (Cell& cell : *_cells)
+	{
+		++cell.generation;
+		cell.children.clear();
+		cell.members.clear();
+		cell.handle.reset();
+	}
+}
+
+void FlatOctree::link(const scene::INodePtr& sceneNode)
+{
+	// Make sure we don't do double-links
+	assert(_nodeIndex.find(sceneNode.get()) == _nodeIndex.end());
+
+	ensureRootSize(sceneNode->worldAABB());
+
+	// The list element created here is spliced into the target cell
+	ISPNode::MemberList temp(1, sceneNode);
+	insertMember(*_root, temp, temp.begin());
+}
+
+bool FlatOctree::unlink(const scene::INodePtr& sceneNode)
+{
+	NodeIndex::iterator found = _nodeIndex.find(sceneNode.get());
+
+	if (found == _nodeIndex.end())
+	{
+		return false;
+	}
+
+	found->second.cell->members.erase(found->second.member);
+	_nodeIndex.erase(found);
+
+	return true;
+}
+
+bool FlatOctree::relink(const scene::INodePtr& sceneNode)
+{
+	// Evaluate the bounds before looking up the node, in case this triggers a re-link
+	const AABB& bounds = sceneNode->worldAABB();
+
+	NodeIndex::iterator found = _nodeIndex.find(sceneNode.get());
+
+	if (found == _nodeIndex.end())
+	{
+		return false;
+	}
+
+	Cell& cell = *found->second.cell;
+
+	if (!bounds.isValid())
+	{
+		// Nodes without valid bounds are kept in the root cell
+		if (&cell != _root)
+		{
+			_root->members.splice(_root->members.end(), cell.members, found->second.member);
+			found->second.cell = _root;
+		}
+
+		return true;
+	}
+
+	if (cell.bounds.contains(bounds))
+	{
+		// The node still fits into its cell, but it might fit into a child now
+		if (!cell.isLeaf())
+		{
+			insertMember(cell, cell.members, found->second.member);
+		}
+
+		return true;
+	}
+
+	ensureRootSize(bounds);
+
+	// Growing the root might have moved the node to a different cell
+	const Location& location = _nodeIndex[sceneNode.get()];
+	insertMember(*_root, location.cell->members, location.member);
+
+	return true;
+}
+
+ISPNodePtr FlatOctree::getRoot() const
+{
+	return _root->handle;
+}
+
+FlatOctree::Cell* FlatOctree::allocateCell(const AABB& bounds, Cell* parent)
+{
+	if (!_unusedCells.empty())
+	{
+		Cell* cell = _unusedCells.back();
+		_unusedCells.pop_back();
+
+		cell->bounds = bounds;
+		cell->parent = parent;
+
+		// Handles held by others keep referring to the previous generation
+		if (cell->handle.use_count() == 1)
+		{
+			cell->handle->_generation = cell->generation;
+		}
+		else
+		{
+			cell->handle = std::make_shared<CellHandle>(_cells, *cell);
+		}
+
+		return cell;
+	}
+
+	_cells->emplace_back();
+
+	Cell* cell = &_cells->back();
+
+	cell->bounds = bounds;
+	cell->parent = parent;
+	cell->handle = std::make_shared<CellHandle>(_cells, *cell);
+
+	return cell;
+}
+
+void FlatOctree::releaseCell(Cell& cell)
+{
+	assert(cell.members.empty());
+
+	cell.children.clear();
+	cell.parent = nullptr;
+	++cell.generation;
+
+	_unusedCells.push_back(&cell);
+}
+
+void FlatOctree::insertMember(Cell& start, ISPNode::MemberList& source, ISPNode::MemberList::iterator member)
+{
+	// The list element is spliced, so this reference stays valid
+	const INodePtr& sceneNode = *member;
+	const AABB& bounds = sceneNode->worldAABB();
+
+	Cell* cell = &start;
+
+	// Descend into the smallest cell containing the bounds, invalid bounds stay at the start
+	for (bool descended = bounds.isValid(); descended && !cell->isLeaf(); )
+	{
+		descended = false;
+
+		for (std::size_t i = 0; i < 8; ++i)
+		{
+			Cell& child = cell->getChild(i);
+
+			if (child.bounds.contains(bounds))
+			{
+				cell = &child;
+				descended = true;
+				break;
+			}
+		}
+	}
+
+	cell->members.splice(cell->members.end(), source, member);
+
+	Location& location = _nodeIndex[sceneNode.get()];
+	location.cell = cell;
+	location.member = member;
+
+	// If this is a leaf, check if we exceeded the subdivision threshold and are large enough
+	if (cell->isLeaf() &&
+		cell->members.size() >= SUBDIVISION_THRESHOLD &&
+		cell->bounds.extents.x() > MIN_CELL_EXTENTS)
+	{
+		subdivide(*cell);
+	}
+}
+
+void FlatOctree::subdivide(Cell& cell)
+{
+	// Evaluate all member bounds before redistributing them, such that no
+	// nodeBoundsChanged() calls are happening in the middle of the operation
+	// (see OctreeNode::linkRecursively). Members might re-link themselves here.
+	{
+		std::vector<INodePtr> temp(cell.members.begin(), cell.members.end());
+
+		for (const INodePtr& member : temp)
+		{
+			member->worldAABB();
+		}
+	}
+
+	createChildren(cell);
+
+	// Redistribute the members over the new children
+	ISPNode::MemberList oldMembers;
+	oldMembers.swap(cell.members);
+
+	while (!oldMembers.empty())
+	{
+		insertMember(cell, oldMembers, oldMembers.begin());
+	}
+}
+
+void FlatOctree::createChildren(Cell& cell)
+{
+	assert(cell.isLeaf());
+
+	// Each child cell has half the extents of this cell
+	Vector3 childExtents = cell.bounds.extents * 0.5;
+
+	// Construct delta-vectors, pointing in each room direction
+	Vector3 x(childExtents.x(), 0, 0);
+	Vector3 y(0, childExtents.y(), 0);
+	Vector3 z(0, 0, childExtents.z());
+
+	Vector3 baseUpper = cell.bounds.origin + z;
+	Vector3 baseLower = cell.bounds.origin - z;
+
+	// Same order as in OctreeNode::subdivide: upper half first, then the lower half
+	const Vector3 origins[8] =
+	{
+		baseUpper + x + y, baseUpper + x - y, baseUpper - x - y, baseUpper - x + y,
+		baseLower + x + y, baseLower + x - y, baseLower - x - y, baseLower - x + y,
+	};
+
+	cell.children.reserve(8);
+
+	for (const Vector3& origin : origins)
+	{
+		cell.children.push_back(allocateCell(AABB(origin, childExtents), &cell)->handle);
+	}
+}
+
+void FlatOctree::moveMembers(Cell& from, Cell& to)
+{
+	for (ISPNode::MemberList::iterator i = from.members.begin(); i != from.members.end(); ++i)
+	{
+		_nodeIndex[i->get()].cell = &to;
+	}
+
+	to.members.splice(to.members.end(), from.members);
+}
+
+void FlatOctree::moveChildren(Cell& from, Cell& to)
+{
+	assert(to.isLeaf());
+
+	to.children.swap(from.children);
+	from.children.clear();
+
+	for (std::size_t i = 0; i < to.children.size(); ++i)
+	{
+		to.getChild(i).parent = &to;
+	}
+}
+
+void FlatOctree::ensureRootSize(const AABB& bounds)
+{
+	if (!bounds.isValid()) return; // skip this for invalid bounds
+
+	while (!_root->bounds.contains(bounds))
+	{
+		AABB newBounds = _root->bounds;
+		newBounds.extents *= 2;
+
+		// Don't go beyond the map limits
+		if (newBounds.extents.x() > MAX_WORLD_COORD)
+		{
+			break;
+		}
+
+		Cell& oldRoot = *_root;
+		Cell& newRoot = *allocateCell(newBounds, nullptr);
+
+		// Like the regular Octree, the members of the old root stay in the root
+		// instead of being re-linked, to avoid re-entering the bounds evaluation
+		moveMembers(oldRoot, newRoot);
+		createChildren(newRoot);
+
+		if (!oldRoot.isLeaf())
+		{
+			// Each child of the old root matches one grandchild of the new root
+			for (std::size_t i = 0; i < 8; ++i)
+			{
+				Cell& newChild = newRoot.getChild(i);
+				createChildren(newChild);
+
+				for (std::size_t j = 0; j < 8; ++j)
+				{
+					Cell& newCell = newChild.getChild(j);
+
+					for (std::size_t old = 0; old < 8; ++old)
+					{
+						Cell& oldCell = oldRoot.getChild(old);
+
+						if (newCell.bounds == oldCell.bounds)
+						{
+							moveMembers(oldCell, newCell);
+							moveChildren(oldCell, newCell);
+							break;
+						}
+					}
+				}
+			}
+
+			for (std::size_t old = 0; old < 8; ++old)
+			{
+				releaseCell(oldRoot.getChild(old));
+			}
+		}
+
+		releaseCell(oldRoot);
+		_root = &newRoot;
+	}
+}
+
+} // namespace scene
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "ispacepartition.h"
+#include "math/AABB.h"
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace scene
+{
+
+/**
+ * An Octree variant storing its cells in a pooled container owned by the tree,
+ * instead of allocating each of them separately. The cell layout and the
+ * subdivision rules are the same as the ones of the regular Octree.
+ *
+ * The scene::INodes are mapped to their cell and their position in the cell's
+ * member list through a hash table, so unlinking a node doesn't need to search
+ * the member list. Members are moved between cells by splicing the list
+ * elements, without allocating anything.
+ *
+ * When a node's bounds change, relink() leaves the node in its cell if the new
+ * bounds still fit, otherwise it is moved down into a child cell or
+ * re-inserted from the root.
+ *
+ * The ISPNodePtrs handed out by this tree are small handles referring to a
+ * cell and its generation, which is incremented whenever the cell is dropped
+ * from the tree. A handle to a dropped or re-used cell acts like an empty leaf
+ * without parent. The handles share the ownership of the pool, so they can
+ * safely outlive the tree.
+ */
+class FlatOctree :
+	public ISpacePartitionSystem
+{
+private:
+	class Cell;
+	class CellHandle;
+	typedef std::shared_ptr<CellHandle> CellHandlePtr;
+
+	// Stable storage for all cells, a deque doesn't move its elements when growing
+	typedef std::deque<Cell> CellPool;
+	typedef std::shared_ptr<CellPool> CellPoolPtr;
+
+	class Cell
+	{
+	public:
+		AABB bounds;
+		Cell* parent; // NULL for the root cell
+		ISPNode::NodeList children; // handles of the 8 or 0 child cells
+		ISPNode::MemberList members;
+
+		// Incremented each time this cell is dropped from the tree
+		std::size_t generation;
+
+		// The handle of this cell in its current generation
+		CellHandlePtr handle;
+
+		Cell();
+
+		bool isLeaf() const
+		{
+			return children.empty();
+		}
+
+		Cell& getChild(std::size_t index) const;
+	};
+
+	class CellHandle :
+		public ISPNode
+	{
+	private:
+		friend class FlatOctree;
+
+		CellPoolPtr _pool;
+		Cell* _cell;
+		std::size_t _generation;
+
+	public:
+		CellHandle(const CellPoolPtr& pool, Cell& cell);
+
+		ISPNodePtr getParent() const override;
+		const AABB& getBounds() const override;
+		const NodeList& getChildNodes() const override;
+		bool isLeaf() const override;
+		const MemberList& getMembers() const override;
+
+	private:
+		// Returns NULL if the cell has been dropped since this handle was created
+		const Cell* getCell() const
+		{
+			return _cell->generation == _generation ? _cell : nullptr;
+		}
+	};
+
+	CellPoolPtr _cells;
+
+	// Cells which have been dropped from the tree, ready for re-use
+	std::vector<Cell*> _unusedCells;
+
+	Cell* _root;
+
+	// Locates a scene node's entry in a cell's member list
+	struct Location
+	{
+		Cell* cell;
+		ISPNode::MemberList::iterator member;
+	};
+
+	typedef std::unordered_map<INode*, Location> NodeIndex;
+	NodeIndex _nodeIndex;
+
+public:
+	FlatOctree();
+	~FlatOctree();
+
+	void link(const scene::INodePtr& sceneNode) override;
+	bool unlink(const scene::INodePtr& sceneNode) override;
+	bool relink(const scene::INodePtr& sceneNode) override;
+	ISPNodePtr getRoot() const override;
+
+private:
+	Cell* allocateCell(const AABB& bounds, Cell* parent);
+	void releaseCell(Cell& cell);
+
+	// Moves the given member from the source list into the smallest cell
+	// below (or equal to) the start cell which is able to contain it
+	void insertMember(Cell& start, ISPNode::MemberList& source, ISPNode::MemberList::iterator member);
+
+	// Adds 8 child cells and redistributes the members of the given cell
+	void subdivide(Cell& cell);
+	void createChildren(Cell& cell);
+
+	void moveMembers(Cell& from, Cell& to);
+	void moveChildren(Cell& from, Cell& to);
+
+	// Grows the root cell until it contains the given bounds
+	void ensureRootSize(const AABB& bounds);
+};
+
+} // namespace scene
@@ -120,6 +120,17 @@ bool Octree::unlink(const scene::INodePtr& sceneNode)
 	return false;
 }
 
+bool Octree::relink(const scene::INodePtr& sceneNode)
+{
+	if (!unlink(sceneNode))
+	{
+		return false;
+	}
+
+	link(sceneNode);
+	return true;
+}
+
 // Returns the root node of this SP tree
 ISPNodePtr Octree::getRoot() const
 {
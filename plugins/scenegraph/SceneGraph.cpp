@@ -2,22 +2,120 @@
 
 #include "ivolumetest.h"
 #include "itextstream.h"
+#include "iregistry.h"
+#include "icommandsystem.h"
+#include "iprofiler.h"
+#include "iworkerpool.h"
 
 #include "scene/InstanceWalkers.h"
 #include "debugging/debugging.h"
 
 #include "math/AABB.h"
 #include "Octree.h"
+#include "FlatOctree.h"
 #include "SceneGraphFactory.h"
+#include "SpacePartitionBenchmark.h"
 #include "util/ScopedBoolLock.h"
+#include "registry/registry.h"
+#include "util/ParallelFor.h"
+#include <algorithm>
 
 namespace scene
 {
 
+namespace
+{
+	const char* const RKEY_SPACE_PARTITION = "user/ui/sceneGraph/spacePartition";
+	const char* const RKEY_PARALLEL_TRAVERSAL = "user/ui/sceneGraph/parallelTraversal";
+
+	// The depth of the space partition nodes whose subtrees are culled by the workers
+	const std::size_t PARALLEL_TRAVERSAL_DEPTH = 2;
+
+	// A part of the space partition, in traversal order
+	struct TraversalSegment
+	{
+		const ISPNode* node;
+		bool includeChildren; // false: the node's members only
+
+		// The results of the culling
+		std::vector<const INodePtr*> visibleNodes;
+		std::size_t visitedSPNodes;
+		std::size_t skippedSPNodes;
+	};
+
+	// Creates the space partition implementation selected in the registry
+	ISpacePartitionSystemPtr createSpacePartition()
+	{
+		if (registry::getValue<std::string>(RKEY_SPACE_PARTITION) == "octree")
+		{
+			return std::make_shared<Octree>();
+		}
+
+		return std::make_shared<FlatOctree>();
+	}
+
+	// Splits the tree into segments down to the given depth, culling the nodes on the way
+	void collectTraversalSegments(const ISPNode& node, const VolumeTest& volume, std::size_t depth,
+								  std::vector<TraversalSegment>& segments, std::size_t& skippedSPNodes)
+	{
+		segments.push_back(TraversalSegment{ &node, false, {}, 0, 0 });
+
+		for (const ISPNodePtr& child : node.getChildNodes())
+		{
+			if (volume.TestAABB(child->getBounds()) == VOLUME_OUTSIDE)
+			{
+				skippedSPNodes++;
+				continue;
+			}
+
+			if (depth + 1 == PARALLEL_TRAVERSAL_DEPTH)
+			{
+				segments.push_back(TraversalSegment{ child.get(), true, {}, 0, 0 });
+			}
+			else
+			{
+				collectTraversalSegments(*child, volume, depth + 1, segments, skippedSPNodes);
+			}
+		}
+	}
+
+	// Collects the visible members of the given node (and its children) in traversal order.
+	// The tree is not modified during traversal, so the member pointers stay valid.
+	void cullSegment(const ISPNode& node, const VolumeTest& volume, bool visitHidden,
+					 bool includeChildren, TraversalSegment& segment)
+	{
+		segment.visitedSPNodes++;
+
+		for (const INodePtr& member : node.getMembers())
+		{
+			if (visitHidden || member->visible())
+			{
+				segment.visibleNodes.push_back(&member);
+			}
+		}
+
+		if (!includeChildren) return;
+
+		for (const ISPNodePtr& child : node.getChildNodes())
+		{
+			if (volume.TestAABB(child->getBounds()) == VOLUME_OUTSIDE)
+			{
+				segment.skippedSPNodes++;
+				continue;
+			}
+
+			cullSegment(*child, volume, visitHidden, true, segment);
+		}
+	}
+}
+
 SceneGraph::SceneGraph() :
-	_spacePartition(new Octree),
+	// The registry is not available at construction time, the
+	// implementation is selected when the root node is set
+	_spacePartition(new FlatOctree),
 	_visitedSPNodes(0),
 	_skippedSPNodes(0),
+	_parallelTraversal(false),
     _traversalOngoing(false)
 {}
 
@@ -85,7 +183,8 @@ void SceneGraph::setRoot(const IMapRootNodePtr& newRoot)
 	_root = newRoot;
 
 	// Refresh the space partition class
-	_spacePartition = ISpacePartitionSystemPtr(new Octree);
+	_spacePartition = createSpacePartition();
+	_parallelTraversal = registry::getValue<bool>(RKEY_PARALLEL_TRAVERSAL);
 
 	if (_root)
 	{
@@ -161,11 +260,8 @@ void SceneGraph::nodeBoundsChanged(const INodePtr& node)
         return;
     }
 
-	if (_spacePartition->unlink(node))
-	{
-		// unlink returned true, so the given node was linked before => re-link it
-		_spacePartition->link(node);
-	}
+	// Updates the node's location if it has been linked before
+	_spacePartition->relink(node);
 }
 
 void SceneGraph::foreachNode(const INode::VisitorFunc& functor)
@@ -209,6 +305,8 @@ void SceneGraph::foreachVisibleNodeInVolume(const VolumeTest& volume, const INod
 
 void SceneGraph::foreachNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor, bool visitHidden)
 {
+    PROFILE_ZONE("SceneGraph::foreachNodeInVolume");
+
     // Acquire the worldAABB() of the scenegraph root - if any node got changed in the graph
     // the scenegraph's root bounds are marked as "dirty" and the bounds will be re-calculated
     // which in turn might trigger a re-link in the Octree. We want to avoid that the Octree
@@ -224,7 +322,14 @@ void SceneGraph::foreachNodeInVolume(const VolumeTest& volume, const INode::Visi
 
         _visitedSPNodes = _skippedSPNodes = 0;
 
-        foreachNodeInVolume_r(*root, volume, functor, visitHidden);
+        if (_parallelTraversal)
+        {
+            foreachNodeInVolumeParallel(*root, volume, functor, visitHidden);
+        }
+        else
+        {
+            foreachNodeInVolume_r(*root, volume, functor, visitHidden);
+        }
 
         _visitedSPNodes = _skippedSPNodes = 0;
     }
@@ -297,6 +402,51 @@ bool SceneGraph::foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& vo
 	return true; // continue traversal
 }
 
+void SceneGraph::foreachNodeInVolumeParallel(const ISPNode& root, const VolumeTest& volume,
+											 const INode::VisitorFunc& functor, bool visitHidden)
+{
+	std::vector<TraversalSegment> segments;
+	collectTraversalSegments(root, volume, 0, segments, _skippedSPNodes);
+
+	std::size_t numSubtrees = std::count_if(segments.begin(), segments.end(),
+		[](const TraversalSegment& segment) { return segment.includeChildren; });
+
+	if (numSubtrees < 2)
+	{
+		// Not worth distributing, traverse the tree in this thread
+		foreachNodeInVolume_r(root, volume, functor, visitHidden);
+		return;
+	}
+
+	// The workers only read the tree, the functor is not invoked before all of them are done
+	util::parallelFor(segments.size(), [&](std::size_t index)
+	{
+		PROFILE_ZONE("SceneGraph::cullSegment");
+
+		TraversalSegment& segment = segments[index];
+		cullSegment(*segment.node, volume, visitHidden, segment.includeChildren, segment);
+	}, 1);
+
+	for (const TraversalSegment& segment : segments)
+	{
+		_visitedSPNodes += segment.visitedSPNodes;
+		_skippedSPNodes += segment.skippedSPNodes;
+	}
+
+	// Visit the nodes in the order of the recursive traversal
+	for (const TraversalSegment& segment : segments)
+	{
+		for (const INodePtr* node : segment.visibleNodes)
+		{
+			// We're done, as soon as the walker returns FALSE
+			if (!functor(*node))
+			{
+				return;
+			}
+		}
+	}
+}
+
 ISpacePartitionSystemPtr SceneGraph::getSpacePartition()
 {
 	return _spacePartition;
@@ -333,13 +483,25 @@ const std::string& SceneGraphModule::getName() const
 
 const StringSet& SceneGraphModule::getDependencies() const
 {
-	static StringSet _dependencies; // no deps
+	static StringSet _dependencies;
+
+	if (_dependencies.empty())
+	{
+		_dependencies.insert(MODULE_XMLREGISTRY);
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_PROFILER);
+		_dependencies.insert(MODULE_WORKERPOOL);
+	}
+
 	return _dependencies;
 }
 
 void SceneGraphModule::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << getName() << "::initialiseModule called" << std::endl;
+
+	GlobalCommandSystem().addCommand("BenchmarkSpacePartition", benchmarkSpacePartition,
+		cmd::ARGTYPE_INT|cmd::ARGTYPE_OPTIONAL);
 }
 
 } // namespace scene
@@ -37,6 +37,9 @@ private:
 	std::size_t _visitedSPNodes;
 	std::size_t _skippedSPNodes;
 
+	// Whether the space partition is culled by multiple threads during traversal
+	bool _parallelTraversal;
+
     // During partition traversal all link/unlink calls are buffered and
     // performed later on.
     enum ActionType
@@ -99,6 +102,11 @@ private:
 	bool foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& volume, 
 							   const INode::VisitorFunc& functor, bool visitHidden);
 
+	// Culls the SpacePartition subtrees in worker threads, then passes the
+	// collected nodes to the functor in the same order as the recursive traversal
+	void foreachNodeInVolumeParallel(const ISPNode& root, const VolumeTest& volume,
+									 const INode::VisitorFunc& functor, bool visitHidden);
+
     void flushActionBuffer();
 };
 typedef std::shared_ptr<SceneGraph> SceneGraphPtr;
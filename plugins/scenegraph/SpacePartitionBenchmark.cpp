@@ -0,0 +1,211 @@
+#include "SpacePartitionBenchmark.h"
+
+#include "itextstream.h"
+#include "irenderable.h"
+#include "scene/Node.h"
+#include "util/Stopwatch.h"
+
+#include <random>
+#include <vector>
+#include <fmt/format.h>
+
+#include "Octree.h"
+#include "FlatOctree.h"
+
+namespace scene
+{
+
+namespace
+{
+	const std::size_t DEFAULT_NUM_NODES = 100000;
+	const std::size_t NUM_QUERIES = 200;
+
+	// Nodes are distributed within this range on each axis
+	const double WORLD_EXTENTS = 30000;
+	const double QUERY_EXTENTS = 2048;
+
+	// Minimal scene node with fixed bounds, not being part of any scene graph
+	class BenchmarkNode :
+		public Node
+	{
+	private:
+		AABB _localAABB;
+
+	public:
+		BenchmarkNode(const AABB& bounds) :
+			_localAABB(bounds)
+		{}
+
+		void setBounds(const AABB& bounds)
+		{
+			_localAABB = bounds;
+			boundsChanged();
+		}
+
+		std::string name() const override
+		{
+			return "BenchmarkNode";
+		}
+
+		Type getNodeType() const override
+		{
+			return Type::Unknown;
+		}
+
+		const AABB& localAABB() const override
+		{
+			return _localAABB;
+		}
+
+		void renderSolid(RenderableCollector& collector, const VolumeTest& volume) const override
+		{}
+
+		void renderWireframe(RenderableCollector& collector, const VolumeTest& volume) const override
+		{}
+
+		std::size_t getHighlightFlags() override
+		{
+			return Highlight::NoHighlight;
+		}
+	};
+
+	// Mirrors SceneGraph::foreachNodeInVolume_r, testing each member against the query box
+	std::size_t countNodesInVolume(const ISPNode& node, const AABB& volume)
+	{
+		std::size_t count = 0;
+
+		for (const INodePtr& member : node.getMembers())
+		{
+			if (member->worldAABB().intersects(volume))
+			{
+				++count;
+			}
+		}
+
+		for (const ISPNodePtr& child : node.getChildNodes())
+		{
+			if (child->getBounds().intersects(volume))
+			{
+				count += countNodesInVolume(*child, volume);
+			}
+		}
+
+		return count;
+	}
+
+	void runBenchmark(const std::string& name, ISpacePartitionSystem& spacePartition,
+		const std::vector<std::shared_ptr<BenchmarkNode>>& nodes,
+		const std::vector<AABB>& movedBounds, const std::vector<AABB>& queries)
+	{
+		util::Stopwatch timer;
+
+		for (const std::shared_ptr<BenchmarkNode>& node : nodes)
+		{
+			spacePartition.link(node);
+		}
+
+		double linkTime = timer.getMilliseconds();
+
+		std::size_t numFound = 0;
+		timer.restart();
+
+		for (const AABB& query : queries)
+		{
+			numFound += countNodesInVolume(*spacePartition.getRoot(), query);
+		}
+
+		double traversalTime = timer.getMilliseconds();
+
+		// Move every node and let the tree update its location
+		timer.restart();
+
+		for (std::size_t i = 0; i < nodes.size(); ++i)
+		{
+			nodes[i]->setBounds(movedBounds[i]);
+			spacePartition.relink(nodes[i]);
+		}
+
+		double relinkTime = timer.getMilliseconds();
+
+		timer.restart();
+
+		for (const std::shared_ptr<BenchmarkNode>& node : nodes)
+		{
+			spacePartition.unlink(node);
+		}
+
+		double unlinkTime = timer.getMilliseconds();
+
+		rMessage() << fmt::format("{0}: link {1:.2f} ms, traversal {2:.2f} ms ({3} hits), "
+			"relink {4:.2f} ms, unlink {5:.2f} ms",
+			name, linkTime, traversalTime, numFound, relinkTime, unlinkTime) << std::endl;
+	}
+}
+
+void benchmarkSpacePartition(const cmd::ArgumentList& args)
+{
+	std::size_t numNodes = DEFAULT_NUM_NODES;
+
+	if (!args.empty() && args[0].getInt() > 0)
+	{
+		numNodes = static_cast<std::size_t>(args[0].getInt());
+	}
+
+	// Fixed seed, both trees see the same input
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<double> position(-WORLD_EXTENTS, WORLD_EXTENTS);
+	std::uniform_real_distribution<double> size(4, 256);
+	std::uniform_real_distribution<double> offset(-64, 64);
+
+	std::vector<AABB> initialBounds;
+	std::vector<AABB> movedBounds;
+
+	for (std::size_t i = 0; i < numNodes; ++i)
+	{
+		AABB bounds(Vector3(position(random), position(random), position(random)),
+			Vector3(size(random), size(random), size(random)));
+
+		initialBounds.push_back(bounds);
+
+		// Most nodes are moved a small distance, as happening when dragging a selection
+		bounds.origin += Vector3(offset(random), offset(random), offset(random));
+		movedBounds.push_back(bounds);
+	}
+
+	std::vector<AABB> queries;
+
+	for (std::size_t i = 0; i < NUM_QUERIES; ++i)
+	{
+		queries.emplace_back(Vector3(position(random), position(random), position(random)),
+			Vector3(QUERY_EXTENTS, QUERY_EXTENTS, QUERY_EXTENTS));
+	}
+
+	rMessage() << "Benchmarking space partitions with " << numNodes << " nodes, "
+		<< NUM_QUERIES << " volume queries" << std::endl;
+
+	auto createNodes = [&]()
+	{
+		std::vector<std::shared_ptr<BenchmarkNode>> nodes;
+		nodes.reserve(numNodes);
+
+		for (const AABB& bounds : initialBounds)
+		{
+			nodes.push_back(std::make_shared<BenchmarkNode>(bounds));
+			nodes.back()->worldAABB(); // evaluate the bounds outside the measurement
+		}
+
+		return nodes;
+	};
+
+	{
+		Octree octree;
+		runBenchmark("Octree", octree, createNodes(), movedBounds, queries);
+	}
+
+	{
+		FlatOctree flatOctree;
+		runBenchmark("FlatOctree", flatOctree, createNodes(), movedBounds, queries);
+	}
+}
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "icommandsystem.h"
+
+namespace scene
+{
+
+/**
+ * BenchmarkSpacePartition [numNodes]: compares the regular Octree against
+ * the FlatOctree. A set of synthetic scene nodes is linked into each tree,
+ * moved around (relinking each node after its bounds changed), queried
+ * through a number of volume traversals and finally unlinked.
+ */
+void benchmarkSpacePartition(const cmd::ArgumentList& args);
+
+}
@@ -11,6 +11,7 @@
 
 #include <iostream>
 #include "string/replace.h"
+#include "stream/utils.h"
 
 /* FORWARD DECLS */
 
@@ -24,8 +25,10 @@ void ShaderFileLoader::parseShaderFile(std::istream& inStr,
 									   const std::string& filename)
 {
 	// Parse the file with a blocktokeniser, the actual block contents
-	// will be parsed separately.
-	parser::BasicDefBlockTokeniser<std::istream> tokeniser(inStr);
+	// will be parsed separately. Buffer the whole file first, iterating
+	// over a string is much cheaper than going through istream_iterators.
+	std::string contents = stream::readToString(inStr);
+	parser::BasicDefBlockTokeniser<std::string> tokeniser(contents);
 
 	while (tokeniser.hasMoreBlocks())
 	{
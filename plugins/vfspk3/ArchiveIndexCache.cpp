@@ -0,0 +1,239 @@
+#include "ArchiveIndexCache.h"
+
+#include "itextstream.h"
+#include "os/fs.h"
+#include "stream/utils.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace vfs
+{
+
+namespace
+{
+	const std::uint32_t CACHE_MAGIC = 0x49565244; // "DRVI"
+	const std::uint32_t CACHE_VERSION = 1;
+
+	template<typename T>
+	void writeValue(std::string& buffer, T value)
+	{
+		buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void writeString(std::string& buffer, const std::string& str)
+	{
+		writeValue<std::uint32_t>(buffer, static_cast<std::uint32_t>(str.size()));
+		buffer.append(str);
+	}
+
+	// Reads the values written above, returns false once the buffer is exhausted
+	class CacheReader
+	{
+	private:
+		const char* _cur;
+		const char* _end;
+
+	public:
+		CacheReader(const std::string& buffer) :
+			_cur(buffer.data()),
+			_end(buffer.data() + buffer.size())
+		{}
+
+		template<typename T>
+		bool read(T& value)
+		{
+			if (static_cast<std::size_t>(_end - _cur) < sizeof(T)) return false;
+
+			std::memcpy(&value, _cur, sizeof(T));
+			_cur += sizeof(T);
+
+			return true;
+		}
+
+		bool readString(std::string& str)
+		{
+			std::uint32_t length = 0;
+
+			if (!read(length) || static_cast<std::size_t>(_end - _cur) < length) return false;
+
+			str.assign(_cur, length);
+			_cur += length;
+
+			return true;
+		}
+	};
+}
+
+ArchiveIndexCache::ArchiveIndexCache() :
+	_changed(false)
+{}
+
+void ArchiveIndexCache::load(const std::string& cacheFilename)
+{
+	clear();
+
+	_cacheFilename = cacheFilename;
+
+	if (_cacheFilename.empty())
+	{
+		return;
+	}
+
+	std::ifstream file(_cacheFilename, std::ios::binary);
+
+	if (!file)
+	{
+		_changed = true; // no cache yet
+		return;
+	}
+
+	std::string buffer = stream::readToString(file);
+	CacheReader reader(buffer);
+
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+	std::uint32_t numArchives = 0;
+
+	if (!reader.read(magic) || magic != CACHE_MAGIC ||
+		!reader.read(version) || version != CACHE_VERSION ||
+		!reader.read(numArchives))
+	{
+		rWarning() << "[vfs] Ignoring incompatible archive index cache " << _cacheFilename << std::endl;
+		_changed = true;
+		return;
+	}
+
+	for (std::uint32_t i = 0; i < numArchives; ++i)
+	{
+		std::string filename;
+		CachedIndex cached;
+
+		if (!reader.readString(filename) ||
+			!reader.read(cached.key.size) ||
+			!reader.read(cached.key.modificationTime) ||
+			!reader.readString(cached.index))
+		{
+			rWarning() << "[vfs] Archive index cache " << _cacheFilename << " is truncated" << std::endl;
+			_loadedIndices.clear();
+			_changed = true;
+			return;
+		}
+
+		_loadedIndices.emplace(filename, std::move(cached));
+	}
+}
+
+void ArchiveIndexCache::save()
+{
+	// Archives which have disappeared are dropped from the cache
+	if (_cacheFilename.empty() || (!_changed && _usedIndices.size() == _loadedIndices.size()))
+	{
+		return;
+	}
+
+	std::string buffer;
+	writeValue<std::uint32_t>(buffer, CACHE_MAGIC);
+	writeValue<std::uint32_t>(buffer, CACHE_VERSION);
+	writeValue<std::uint32_t>(buffer, static_cast<std::uint32_t>(_usedIndices.size()));
+
+	for (const IndexMap::value_type& pair : _usedIndices)
+	{
+		writeString(buffer, pair.first);
+		writeValue<std::uint64_t>(buffer, pair.second.key.size);
+		writeValue<std::int64_t>(buffer, pair.second.key.modificationTime);
+		writeString(buffer, pair.second.index);
+	}
+
+	// Write to a temporary file first, the cache is either complete or absent
+	std::string tempFilename = _cacheFilename + ".tmp";
+
+	{
+		std::ofstream file(tempFilename, std::ios::binary);
+		file.write(buffer.data(), buffer.size());
+
+		if (!file)
+		{
+			rWarning() << "[vfs] Failed to write " << tempFilename << std::endl;
+			return;
+		}
+	}
+
+	try
+	{
+		fs::rename(tempFilename, _cacheFilename);
+	}
+	catch (fs::filesystem_error& ex)
+	{
+		rWarning() << "[vfs] Failed to write the archive index cache: " << ex.what() << std::endl;
+		return;
+	}
+
+	rMessage() << "[vfs] Stored the file tables of " << _usedIndices.size() << " archives in "
+		<< _cacheFilename << std::endl;
+
+	// The file now matches the used tables
+	_loadedIndices = _usedIndices;
+	_changed = false;
+}
+
+void ArchiveIndexCache::clear()
+{
+	_loadedIndices.clear();
+	_usedIndices.clear();
+	_changed = false;
+}
+
+ArchivePtr ArchiveIndexCache::openArchive(ArchiveLoader& loader, const std::string& filename)
+{
+	ArchiveKey key;
+
+	if (_cacheFilename.empty() || !getArchiveKey(filename, key))
+	{
+		return loader.openArchive(filename);
+	}
+
+	IndexMap::const_iterator found = _loadedIndices.find(filename);
+
+	if (found != _loadedIndices.end() && found->second.key == key)
+	{
+		_usedIndices[filename] = found->second;
+		return loader.openArchive(filename, found->second.index);
+	}
+
+	// New or modified archive, read its directory and remember the table
+	ArchivePtr archive = loader.openArchive(filename);
+
+	if (archive)
+	{
+		CachedIndex& cached = _usedIndices[filename];
+		cached.key = key;
+		cached.index = loader.getArchiveIndex(archive);
+
+		_changed = true;
+	}
+
+	return archive;
+}
+
+bool ArchiveIndexCache::getArchiveKey(const std::string& filename, ArchiveKey& key)
+{
+	try
+	{
+		fs::path path(filename);
+
+		key.size = static_cast<std::uint64_t>(fs::file_size(path));
+#ifdef DR_USE_STD_FILESYSTEM
+		key.modificationTime = static_cast<std::int64_t>(fs::last_write_time(path).time_since_epoch().count());
+#else
+		key.modificationTime = static_cast<std::int64_t>(fs::last_write_time(path));
+#endif
+		return true;
+	}
+	catch (fs::filesystem_error&)
+	{
+		return false;
+	}
+}
+
+}
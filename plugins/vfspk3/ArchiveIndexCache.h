@@ -0,0 +1,77 @@
+#pragma once
+
+#include "iarchive.h"
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace vfs
+{
+
+/**
+ * Persistent store of the archive file tables, such that archives which haven't
+ * changed since the previous session can be opened without reading their
+ * directory again.
+ *
+ * Each archive is identified by its full path, the cached table is only used
+ * if the archive's size and modification time still match. The cache file
+ * holds the tables of all archives opened in the last session, archives which
+ * are no longer present are dropped when the cache is saved.
+ */
+class ArchiveIndexCache
+{
+private:
+	struct ArchiveKey
+	{
+		std::uint64_t size;
+		std::int64_t modificationTime;
+
+		bool operator==(const ArchiveKey& other) const
+		{
+			return size == other.size && modificationTime == other.modificationTime;
+		}
+	};
+
+	struct CachedIndex
+	{
+		ArchiveKey key;
+		std::string index;
+	};
+
+	typedef std::map<std::string, CachedIndex> IndexMap;
+
+	std::string _cacheFilename;
+
+	// The tables read from the cache file
+	IndexMap _loadedIndices;
+
+	// The tables of the archives opened in this session
+	IndexMap _usedIndices;
+
+	// True if the cache file needs to be written
+	bool _changed;
+
+public:
+	ArchiveIndexCache();
+
+	// Reads the cache from the given file, an empty filename disables the cache
+	void load(const std::string& cacheFilename);
+
+	// Writes the tables of the archives opened since the last load() call,
+	// if they differ from the ones in the cache file
+	void save();
+
+	void clear();
+
+	/**
+	 * Opens the given archive through the loader, using the cached table if the
+	 * archive is unchanged. The table of the opened archive is remembered to be
+	 * written by the next save() call.
+	 */
+	ArchivePtr openArchive(ArchiveLoader& loader, const std::string& filename);
+
+private:
+	static bool getArchiveKey(const std::string& filename, ArchiveKey& key);
+};
+
+}
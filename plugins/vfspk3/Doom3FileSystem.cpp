@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits>
 
 #include "iradiant.h"
 #include "idatastream.h"
@@ -25,6 +26,7 @@
 #include "itextstream.h"
 
 #include "string/string.h"
+#include "string/case_conv.h"
 #include "string/join.h"
 #include "os/path.h"
 #include "os/dir.h"
@@ -41,6 +43,11 @@
 namespace vfs
 {
 
+Doom3FileSystem::Doom3FileSystem() :
+	_indexHits(0),
+	_indexMisses(0)
+{}
+
 void Doom3FileSystem::initDirectory(const std::string& inputPath)
 {
 	// greebo: Normalise path: Replace backslashes and ensure trailing slash
@@ -49,14 +56,7 @@ void Doom3FileSystem::initDirectory(const std::string& inputPath)
 	// Shortcut
 	const std::string& path = _directories.back();
 
-	{
-		ArchiveDescriptor entry;
-		entry.name = path;
-		entry.archive = std::make_shared<DirectoryArchive>(path);
-		entry.is_pakfile = false;
-
-		_archives.push_back(entry);
-	}
+	addArchive(path, std::make_shared<DirectoryArchive>(path), false);
 
 	// Instantiate a new sorting container for the filenames
 	SortedFilenames filenameList;
@@ -122,12 +122,17 @@ void Doom3FileSystem::initialise(const SearchPaths& vfsSearchPaths, const Extens
 		_allowedExtensionsDir.insert(allowedExtension + "dir");
 	}
 
+	// Unchanged archives are opened using the file tables of the previous session
+	_archiveIndex.load(_archiveIndexFilename);
+
 	// Initialise the paths, in the given order
 	for (const std::string& path : _vfsSearchPaths)
 	{
 		initDirectory(path);
 	}
 
+	_archiveIndex.save();
+
 	for (Observer* observer : _observers)
 	{
 		observer->onFileSystemInitialise();
@@ -141,6 +146,14 @@ void Doom3FileSystem::shutdown()
 		observer->onFileSystemShutdown();
 	}
 
+	rMessage() << "[vfs] File lookups: " << _indexHits << " opened from the indexed archive, "
+		<< _indexMisses << " missed" << std::endl;
+
+	_pakFileIndex.clear();
+	_directoryArchives.clear();
+	_indexHits = 0;
+	_indexMisses = 0;
+
 	_archives.clear();
 	_directories.clear();
 	_vfsSearchPaths.clear();
@@ -165,28 +178,49 @@ int Doom3FileSystem::getFileCount(const std::string& filename)
 	int count = 0;
 	std::string fixedFilename(os::standardPathWithSlash(filename));
 
-	for (const ArchiveDescriptor& descriptor : _archives)
+	for (const ArchiveDescriptor* descriptor : _directoryArchives)
 	{
-		if (descriptor.archive->containsFile(fixedFilename))
+		if (descriptor->archive->containsFile(fixedFilename))
 		{
 			++count;
 		}
 	}
 
-	return count;
+	PakFileIndex::const_iterator found = _pakFileIndex.find(string::to_lower_copy(fixedFilename));
+
+	return found != _pakFileIndex.end() ? count + found->second.count : count;
 }
 
-ArchiveFilePtr Doom3FileSystem::openFile(const std::string& filename)
+template<typename FilePtr, typename OpenFunc>
+FilePtr Doom3FileSystem::openFromArchives(const std::string& filename, OpenFunc open)
 {
-	if (filename.find("\\") != std::string::npos)
+	const ArchiveDescriptor* descriptor = findArchiveContainingFile(filename);
+
+	if (descriptor == nullptr)
 	{
-		rError() << "Filename contains backslash: " << filename << std::endl;
-		return ArchiveFilePtr();
+		++_indexMisses;
+		return FilePtr();
 	}
 
-	for (const ArchiveDescriptor& descriptor : _archives)
+	FilePtr file = open(*descriptor->archive);
+
+	if (file)
+	{
+		++_indexHits;
+		return file;
+	}
+
+	++_indexMisses;
+
+	// The archive failed to open its file, try the ones with lower precedence
+	for (const ArchiveDescriptor& candidate : _archives)
 	{
-		ArchiveFilePtr file = descriptor.archive->openFile(filename);
+		if (candidate.priority <= descriptor->priority)
+		{
+			continue;
+		}
+
+		file = open(*candidate.archive);
 
 		if (file)
 		{
@@ -194,8 +228,21 @@ ArchiveFilePtr Doom3FileSystem::openFile(const std::string& filename)
 		}
 	}
 
-	// not found
-	return ArchiveFilePtr();
+	return FilePtr();
+}
+
+ArchiveFilePtr Doom3FileSystem::openFile(const std::string& filename)
+{
+	if (filename.find("\\") != std::string::npos)
+	{
+		rError() << "Filename contains backslash: " << filename << std::endl;
+		return ArchiveFilePtr();
+	}
+
+	return openFromArchives<ArchiveFilePtr>(filename, [&](Archive& archive)
+	{
+		return archive.openFile(filename);
+	});
 }
 
 ArchiveFilePtr Doom3FileSystem::openFileInAbsolutePath(const std::string& filename)
@@ -213,17 +260,10 @@ ArchiveFilePtr Doom3FileSystem::openFileInAbsolutePath(const std::string& filena
 
 ArchiveTextFilePtr Doom3FileSystem::openTextFile(const std::string& filename)
 {
-	for (const ArchiveDescriptor& descriptor : _archives)
+	return openFromArchives<ArchiveTextFilePtr>(filename, [&](Archive& archive)
 	{
-		ArchiveTextFilePtr file = descriptor.archive->openTextFile(filename);
-
-		if (file)
-		{
-			return file;
-		}
-	}
-
-	return ArchiveTextFilePtr();
+		return archive.openTextFile(filename);
+	});
 }
 
 ArchiveTextFilePtr Doom3FileSystem::openTextFileInAbsolutePath(const std::string& filename)
@@ -277,11 +317,12 @@ void Doom3FileSystem::forEachFileInAbsolutePath(const std::string& path,
 
 std::string Doom3FileSystem::findFile(const std::string& name)
 {
-	for (const ArchiveDescriptor& descriptor : _archives)
+	// Only the physical directories are considered
+	for (const ArchiveDescriptor* descriptor : _directoryArchives)
 	{
-		if (!descriptor.is_pakfile && descriptor.archive->containsFile(name))
+		if (descriptor->archive->containsFile(name))
 		{
-			return descriptor.name;
+			return descriptor->name;
 		}
 	}
 
@@ -309,30 +350,71 @@ void Doom3FileSystem::initPakFile(ArchiveLoader& archiveModule, const std::strin
 	if (_allowedExtensions.find(fileExt) != _allowedExtensions.end())
 	{
 		// Matched extension for archive (e.g. "pk3", "pk4")
-		ArchiveDescriptor entry;
-
-		entry.name = filename;
-		entry.archive = archiveModule.openArchive(filename);
-		entry.is_pakfile = true;
-		_archives.push_back(entry);
+		addArchive(filename, _archiveIndex.openArchive(archiveModule, filename), true);
 
 		rMessage() << "[vfs] pak file: " << filename << std::endl;
 	}
 	else if (_allowedExtensionsDir.find(fileExt) != _allowedExtensionsDir.end())
 	{
 		// Matched extension for archive dir (e.g. "pk3dir", "pk4dir")
-		ArchiveDescriptor entry;
-
 		std::string path = os::standardPathWithSlash(filename);
-		entry.name = path;
-		entry.archive = std::make_shared<DirectoryArchive>(path);
-		entry.is_pakfile = false;
-		_archives.push_back(entry);
+		addArchive(path, std::make_shared<DirectoryArchive>(path), false);
 
 		rMessage() << "[vfs] pak dir:  " << path << std::endl;
 	}
 }
 
+void Doom3FileSystem::addArchive(const std::string& name, const ArchivePtr& archive, bool isPakFile)
+{
+	ArchiveDescriptor entry;
+	entry.name = name;
+	entry.archive = archive;
+	entry.is_pakfile = isPakFile;
+	entry.priority = _archives.size();
+
+	_archives.push_back(entry);
+
+	const ArchiveDescriptor& descriptor = _archives.back();
+
+	if (!isPakFile)
+	{
+		_directoryArchives.push_back(&descriptor);
+		return;
+	}
+
+	// Archives are added in the order of precedence, files already present
+	// in the index are shadowing the ones in this pak file
+	ArchiveVisitor visitor([&](const std::string& filename)
+	{
+		IndexedFile& file = _pakFileIndex.emplace(string::to_lower_copy(filename), IndexedFile{ &descriptor, 0 }).first->second;
+		file.count++;
+	}, Archive::eFiles, std::numeric_limits<std::size_t>::max());
+
+	archive->traverse(visitor, "");
+}
+
+const Doom3FileSystem::ArchiveDescriptor* Doom3FileSystem::findArchiveContainingFile(const std::string& filename)
+{
+	PakFileIndex::const_iterator found = _pakFileIndex.find(string::to_lower_copy(filename));
+	const ArchiveDescriptor* pakFile = found != _pakFileIndex.end() ? found->second.archive : nullptr;
+
+	// Directories preceding the pak file take precedence
+	for (const ArchiveDescriptor* descriptor : _directoryArchives)
+	{
+		if (pakFile != nullptr && descriptor->priority > pakFile->priority)
+		{
+			break;
+		}
+
+		if (descriptor->archive->containsFile(filename))
+		{
+			return descriptor;
+		}
+	}
+
+	return pakFile;
+}
+
 const SearchPaths& Doom3FileSystem::getVfsSearchPaths()
 {
 	// Should not be called before the list is initialised
@@ -366,6 +448,8 @@ const StringSet& Doom3FileSystem::getDependencies() const
 void Doom3FileSystem::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << getName() << "::initialiseModule called" << std::endl;
+
+	_archiveIndexFilename = ctx.getSettingsPath() + "vfsindex.cache";
 }
 
 void Doom3FileSystem::shutdownModule()
@@ -2,6 +2,10 @@
 
 #include "iarchive.h"
 #include "ifilesystem.h"
+#include "ArchiveIndexCache.h"
+#include <atomic>
+#include <unordered_map>
+#include <vector>
 
 namespace vfs
 {
@@ -22,15 +26,40 @@ private:
 		std::string name;
 		ArchivePtr archive;
 		bool is_pakfile;
+		std::size_t priority; // position in the archive list, lower values take precedence
 	};
 
 	typedef std::list<ArchiveDescriptor> ArchiveList;
 	ArchiveList _archives;
 
+	// The directory archives in the order of the archive list, these are queried
+	// directly since their contents can change on disk at any time
+	std::vector<const ArchiveDescriptor*> _directoryArchives;
+
+	struct IndexedFile
+	{
+		const ArchiveDescriptor* archive; // the pak file with the highest precedence
+		int count;                        // number of pak files containing this file
+	};
+
+	// Merged index of the files in all pak files, keyed by the lowercase VFS path
+	typedef std::unordered_map<std::string, IndexedFile> PakFileIndex;
+	PakFileIndex _pakFileIndex;
+
+	// Lookup statistics, a hit is a file opened from the archive found through the index
+	std::atomic<std::size_t> _indexHits;
+	std::atomic<std::size_t> _indexMisses;
+
 	typedef std::set<Observer*> ObserverList;
 	ObserverList _observers;
 
+	// File tables of the archives, persisted across sessions
+	ArchiveIndexCache _archiveIndex;
+	std::string _archiveIndexFilename;
+
 public:
+	Doom3FileSystem();
+
 	void initDirectory(const std::string& path) override;
 	void initialise(const SearchPaths& vfsSearchPaths, const ExtensionSet& allowedExtensions) override;
 	void shutdown() override;
@@ -68,6 +97,17 @@ public:
 
 private:
 	void initPakFile(ArchiveLoader& archiveModule, const std::string& filename);
+
+	// Appends the archive to the list, adding its files to the lookup index
+	void addArchive(const std::string& name, const ArchivePtr& archive, bool isPakFile);
+
+	// Returns the archive with the highest precedence containing the given file, or NULL
+	const ArchiveDescriptor* findArchiveContainingFile(const std::string& filename);
+
+	// Opens the file through open(Archive&) from the archive found through the index.
+	// If that fails the archives with lower precedence are tried in order.
+	template<typename FilePtr, typename OpenFunc>
+	FilePtr openFromArchives(const std::string& filename, OpenFunc open);
 };
 
 }
@@ -0,0 +1,142 @@
+#include "RegistryBenchmark.h"
+
+#include "iregistry.h"
+#include "itextstream.h"
+#include "util/Stopwatch.h"
+
+#include <random>
+#include <vector>
+#include <fmt/format.h>
+
+#include "registry/registry.h"
+#include "registry/KeyHandle.h"
+#include "wxutil/IConv.h"
+
+namespace registry
+{
+
+namespace
+{
+	const std::size_t DEFAULT_NUM_READS = 1000000;
+
+	const std::size_t NUM_KEYS = 16;
+
+	// Direct children of user marked as transient are not saved to disk
+	const std::string RKEY_BENCHMARK_ROOT = "user/registryBenchmark";
+
+	// A read as it was done before the value cache, querying both trees
+	float readThroughXPath(const std::string& key)
+	{
+		xml::NodeList nodeList = GlobalRegistry().findXPath(key);
+
+		if (nodeList.empty())
+		{
+			return 0;
+		}
+
+		return string::convert<float>(wxutil::IConv::localeFromUTF8(nodeList[0].getAttributeValue("value")));
+	}
+
+	void printResult(const std::string& name, double milliseconds, std::size_t numReads, double sum)
+	{
+		rMessage() << fmt::format("{0}: {1:.2f} ms ({2:.1f} ns per read, sum {3:.1f})",
+			name, milliseconds, milliseconds * 1e6 / numReads, sum) << std::endl;
+	}
+}
+
+const std::string& RegistryBenchmark::getName() const
+{
+	static std::string _name("RegistryBenchmark");
+	return _name;
+}
+
+const StringSet& RegistryBenchmark::getDependencies() const
+{
+	static StringSet _dependencies;
+
+	if (_dependencies.empty())
+	{
+		_dependencies.insert(MODULE_XMLREGISTRY);
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
+	}
+
+	return _dependencies;
+}
+
+void RegistryBenchmark::initialiseModule(const ApplicationContext& ctx)
+{
+	GlobalCommandSystem().addCommand("BenchmarkRegistryReads", benchmarkRegistryReads,
+		cmd::ARGTYPE_INT|cmd::ARGTYPE_OPTIONAL);
+}
+
+void RegistryBenchmark::benchmarkRegistryReads(const cmd::ArgumentList& args)
+{
+	std::size_t numReads = DEFAULT_NUM_READS;
+
+	if (!args.empty() && args[0].getInt() > 0)
+	{
+		numReads = static_cast<std::size_t>(args[0].getInt());
+	}
+
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<int> value(0, 1000);
+
+	GlobalRegistry().createKey(RKEY_BENCHMARK_ROOT);
+	GlobalRegistry().setAttribute(RKEY_BENCHMARK_ROOT, "transient", "1");
+
+	std::vector<std::string> keys;
+
+	for (std::size_t i = 0; i < NUM_KEYS; ++i)
+	{
+		keys.push_back(fmt::format("{0}/key{1}", RKEY_BENCHMARK_ROOT, i));
+		setValue(keys.back(), value(random) / 8.0f);
+	}
+
+	std::vector<KeyHandle<float>> handles(keys.begin(), keys.end());
+
+	rMessage() << "Benchmarking " << numReads << " registry reads of " << NUM_KEYS << " keys" << std::endl;
+
+	double sum = 0;
+	util::Stopwatch timer;
+
+	for (std::size_t i = 0; i < numReads; ++i)
+	{
+		sum += readThroughXPath(keys[i % NUM_KEYS]);
+	}
+
+	printResult("XPath query", timer.getMilliseconds(), numReads, sum);
+
+	sum = 0;
+	timer.restart();
+
+	for (std::size_t i = 0; i < numReads; ++i)
+	{
+		sum += getValue<float>(keys[i % NUM_KEYS]);
+	}
+
+	printResult("registry::getValue", timer.getMilliseconds(), numReads, sum);
+
+	sum = 0;
+	timer.restart();
+
+	for (std::size_t i = 0; i < numReads; ++i)
+	{
+		sum += getCachedValue<float>(keys[i % NUM_KEYS]);
+	}
+
+	printResult("registry::getCachedValue", timer.getMilliseconds(), numReads, sum);
+
+	sum = 0;
+	timer.restart();
+
+	for (std::size_t i = 0; i < numReads; ++i)
+	{
+		sum += handles[i % NUM_KEYS].get();
+	}
+
+	printResult("registry::KeyHandle", timer.getMilliseconds(), numReads, sum);
+
+	GlobalRegistry().deleteXPath(RKEY_BENCHMARK_ROOT);
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "imodule.h"
+#include "icommandsystem.h"
+
+namespace registry
+{
+
+/**
+ * Module providing the BenchmarkRegistryReads console command, which
+ * measures repeated reads of registry keys. It is kept separate from the
+ * XMLRegistry, as the command system depends on the registry itself.
+ *
+ * A few float keys are written to a transient branch of the user tree and
+ * read in turns through:
+ *
+ * - the XPath query on both registry trees, as done by every read before
+ *   the registry kept its value cache,
+ * - registry::getValue<float>, served by the value cache of the registry,
+ * - registry::getCachedValue<float>, served by the TypedKeyCache,
+ * - registry::KeyHandle<float>, which just dereferences its cache entry.
+ *
+ * The benchmark keys are removed from the registry afterwards. The number
+ * of reads can be passed as argument to the command.
+ */
+class RegistryBenchmark :
+	public RegisterableModule
+{
+public:
+	// RegisterableModule implementation
+	const std::string& getName() const override;
+	const StringSet& getDependencies() const override;
+	void initialiseModule(const ApplicationContext& ctx) override;
+
+private:
+	static void benchmarkRegistryReads(const cmd::ArgumentList& args);
+};
+
+}
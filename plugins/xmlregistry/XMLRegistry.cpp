@@ -1,7 +1,9 @@
 #include "XMLRegistry.h"
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 #include "itextstream.h"
 
 #include "os/file.h"
@@ -14,6 +16,55 @@
 namespace registry
 {
 
+namespace
+{
+	/**
+	 * Returns the absolute path below which all the nodes matched by the given
+	 * registry key or path are located. This is the key itself for plain paths,
+	 * or the part in front of any wildcard, predicate or "//". An empty string
+	 * is returned for keys which can match anywhere in the tree.
+	 */
+	std::string getRootPath(const std::string& key)
+	{
+		if (key.find_first_of("|(") != std::string::npos)
+		{
+			return std::string(); // unions and functions, no fixed root
+		}
+
+		// Relative paths are located below the toplevel node, like in the RegistryTree
+		std::string path = !key.empty() && key[0] == '/' ? key :
+			std::string("/") + TOPLEVEL_NODE_NAME + "/" + key;
+
+		std::size_t end = std::min(path.find_first_of("*[@."), path.find("//"));
+
+		if (end != std::string::npos && path[end] == '[')
+		{
+			// The node name in front of the predicate is complete
+			path.resize(end);
+		}
+		else if (end != std::string::npos)
+		{
+			// Cut back to the last complete node name
+			std::size_t lastSlash = path.rfind('/', end);
+			path.resize(lastSlash == std::string::npos ? 0 : lastSlash);
+		}
+
+		while (!path.empty() && path.back() == '/')
+		{
+			path.pop_back();
+		}
+
+		return path;
+	}
+
+	// True if the given path equals the root path or is located below it
+	bool isAtOrBelow(const std::string& path, const std::string& root)
+	{
+		return path.compare(0, root.size(), root) == 0 &&
+			(path.size() == root.size() || path[root.size()] == '/');
+	}
+}
+
 XMLRegistry::XMLRegistry() :
 	_queryCounter(0),
 	_changesSinceLastSave(0),
@@ -116,9 +167,7 @@ sigc::signal<void> XMLRegistry::signalForKey(const std::string& key) const
 
 bool XMLRegistry::keyExists(const std::string& key)
 {
-	// Pass the query on to findXPath which queries the subtrees
-	xml::NodeList result = findXPath(key);
-	return !result.empty();
+	return lookupValue(key).exists;
 }
 
 void XMLRegistry::deleteXPath(const std::string& path) 
@@ -128,16 +177,20 @@ void XMLRegistry::deleteXPath(const std::string& path)
 	// Add the toplevel node to the path if required
 	xml::NodeList nodeList = findXPath(path);
 
-	if (!nodeList.empty())
+	if (nodeList.empty())
 	{
-		_changesSinceLastSave++;
+		return;
 	}
 
+	_changesSinceLastSave++;
+
 	for (xml::Node& node : nodeList)
     {
 		// unlink and delete the node
 		node.erase();
 	}
+
+	invalidateValueCache(path);
 }
 
 xml::Node XMLRegistry::createKeyWithName(const std::string& path,
@@ -149,7 +202,11 @@ xml::Node XMLRegistry::createKeyWithName(const std::string& path,
 	_changesSinceLastSave++;
 
 	// The key will be created in the user tree (the default tree is read-only)
-	return _userTree.createKeyWithName(path, key, name);
+	xml::Node node = _userTree.createKeyWithName(path, key, name);
+
+	invalidateValueCache(path);
+
+	return node;
 }
 
 xml::Node XMLRegistry::createKey(const std::string& key)
@@ -158,7 +215,11 @@ xml::Node XMLRegistry::createKey(const std::string& key)
 
 	_changesSinceLastSave++;
 
-	return _userTree.createKey(key);
+	xml::Node node = _userTree.createKey(key);
+
+	invalidateValueCache(key);
+
+	return node;
 }
 
 void XMLRegistry::setAttribute(const std::string& path,
@@ -169,6 +230,8 @@ void XMLRegistry::setAttribute(const std::string& path,
 	_changesSinceLastSave++;
 
 	_userTree.setAttribute(path, attrName, attrValue);
+
+	invalidateValueCache(path);
 }
 
 std::string XMLRegistry::getAttribute(const std::string& path,
@@ -187,19 +250,73 @@ std::string XMLRegistry::getAttribute(const std::string& path,
 
 std::string XMLRegistry::get(const std::string& key)
 {
+	return lookupValue(key).value;
+}
+
+const XMLRegistry::CachedValue& XMLRegistry::lookupValue(const std::string& key)
+{
+	ValueCache::const_iterator cached = _valueCache.find(key);
+
+	if (cached != _valueCache.end())
+	{
+		return cached->second;
+	}
+
 	// Pass the query to the findXPath method, which queries the user tree first
 	xml::NodeList nodeList = findXPath(key);
 
+	CachedValue& value = _valueCache[key];
+	value.exists = !nodeList.empty();
+	value.root = getRootPath(key);
+
 	// Does it even exist?
 	// It may well be the case that this returns two or more nodes that match the key criteria
 	// This function always uses the first one, as the user tree should override the default tree
-	if (!nodeList.empty())
+	if (value.exists)
 	{
-		// Convert the UTF-8 string back to locale and return
-		return wxutil::IConv::localeFromUTF8(nodeList[0].getAttributeValue("value"));
+		// Convert the UTF-8 string back to locale
+		value.value = wxutil::IConv::localeFromUTF8(nodeList[0].getAttributeValue("value"));
+	}
+
+	return value;
+}
+
+void XMLRegistry::invalidateValueCache(const std::string& changedPath, const std::string& keyToSkip)
+{
+	std::string changedRoot = getRootPath(changedPath);
+
+	// Keys below the changed path can have a different value now, keys above
+	// it can have been created or deleted along with it
+	std::vector<ValueCache::value_type> affected;
+
+	for (ValueCache::iterator i = _valueCache.begin(); i != _valueCache.end();)
+	{
+		if (isAtOrBelow(i->second.root, changedRoot) || isAtOrBelow(changedRoot, i->second.root))
+		{
+			if (i->first != keyToSkip && _keySignals.find(i->first) != _keySignals.end())
+			{
+				affected.push_back(*i);
+			}
+
+			i = _valueCache.erase(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	// Compare the values of the affected observed keys to the ones read
+	// before, such that their observers can update
+	for (const ValueCache::value_type& pair : affected)
+	{
+		const CachedValue& current = lookupValue(pair.first);
+
+		if (current.exists != pair.second.exists || current.value != pair.second.value)
+		{
+			emitSignalForKey(pair.first);
+		}
 	}
-	
-	return std::string();
 }
 
 void XMLRegistry::set(const std::string& key, const std::string& value) 
@@ -212,6 +329,8 @@ void XMLRegistry::set(const std::string& key, const std::string& value)
 
 	_changesSinceLastSave++;
 
+	invalidateValueCache(key, key);
+
 	// Notify the observers
 	emitSignalForKey(key);
 }
@@ -231,6 +350,8 @@ void XMLRegistry::import(const std::string& importFilePath, const std::string& p
 	}
 
 	_changesSinceLastSave++;
+
+	invalidateValueCache(parentKey);
 }
 
 void XMLRegistry::emitSignalForKey(const std::string& changedKey)
@@ -23,6 +23,7 @@
 
 #include "iregistry.h"
 #include <map>
+#include <unordered_map>
 
 #include "imodule.h"
 #include "RegistryTree.h"
@@ -40,6 +41,24 @@ private:
 	typedef std::map<const std::string, sigc::signal<void> > KeySignals;
 	mutable KeySignals _keySignals;
 
+	// The result of a key lookup, as returned by get() and keyExists()
+	struct CachedValue
+	{
+		bool exists;
+		std::string value;
+
+		// Absolute path below which all nodes matched by the key are located
+		std::string root;
+	};
+
+	// Values of the keys queried so far, such that repeated reads of a key
+	// don't need to run the XPath query on both trees. A write to the registry
+	// drops the keys located at, above or below the written path. Note that
+	// values changed through the xml::Nodes handed out by findXPath() or
+	// createKey() are not noticed.
+	typedef std::unordered_map<std::string, CachedValue> ValueCache;
+	ValueCache _valueCache;
+
 	// The "install" tree, is basically treated as read-only
 	RegistryTree _standardTree;
 
@@ -130,6 +149,14 @@ private:
 
 	void emitSignalForKey(const std::string& changedKey);
 
+	// Returns the cached lookup result of the given key, querying the trees if necessary
+	const CachedValue& lookupValue(const std::string& key);
+
+	// Drops the cached values affected by a write to the given path. Observed
+	// keys among them whose value has changed are notified, except for the
+	// given key, which the caller takes care of.
+	void invalidateValueCache(const std::string& changedPath, const std::string& keyToSkip = std::string());
+
 	// Invoked after all modules have been uninitialised
 	void shutdown();
 };
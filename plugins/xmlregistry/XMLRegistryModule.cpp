@@ -1,4 +1,5 @@
 #include "XMLRegistry.h"
+#include "RegistryBenchmark.h"
 #include "imodule.h"
 
 /**
@@ -10,4 +11,5 @@ extern "C" void DARKRADIANT_DLLEXPORT RegisterModule(IModuleRegistry& registry)
 	module::performDefaultInitialisation(registry);
 
 	registry.registerModule(std::make_shared<registry::XMLRegistry>());
+	registry.registerModule(std::make_shared<registry::RegistryBenchmark>());
 }
@@ -0,0 +1,105 @@
+#include "WorkerPool.h"
+
+#include "itextstream.h"
+#include "modulesystem/StaticModule.h"
+#include "util/ParallelFor.h"
+
+namespace radiant
+{
+
+WorkerPool::WorkerPool() :
+	_stopping(false)
+{}
+
+std::size_t WorkerPool::getNumThreads() const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _stopping ? 0 : _threads.size();
+}
+
+void WorkerPool::post(const std::function<void()>& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+
+		// Nobody is going to run the task after shutdown
+		if (_stopping || _threads.empty()) return;
+
+		_tasks.push_back(task);
+	}
+
+	_taskAvailable.notify_one();
+}
+
+void WorkerPool::run()
+{
+	while (true)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			_taskAvailable.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+
+			if (_stopping) return;
+
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+
+		task();
+	}
+}
+
+const std::string& WorkerPool::getName() const
+{
+	static std::string _name(MODULE_WORKERPOOL);
+	return _name;
+}
+
+const StringSet& WorkerPool::getDependencies() const
+{
+	static StringSet _dependencies; // no dependencies
+	return _dependencies;
+}
+
+void WorkerPool::initialiseModule(const ApplicationContext& ctx)
+{
+	rMessage() << getName() << "::initialiseModule called." << std::endl;
+
+	std::lock_guard<std::mutex> lock(_lock);
+
+	// The thread calling parallelFor is one of the workers
+	for (std::size_t i = 1; i < util::getNumWorkerThreads(); ++i)
+	{
+		_threads.emplace_back([this]() { run(); });
+	}
+}
+
+void WorkerPool::shutdownModule()
+{
+	rMessage() << getName() << "::shutdownModule called." << std::endl;
+
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_stopping = true;
+	}
+
+	_taskAvailable.notify_all();
+
+	for (std::thread& thread : _threads)
+	{
+		thread.join();
+	}
+
+	// Queued helpers of finished parallelFor calls would return right away
+	std::lock_guard<std::mutex> lock(_lock);
+
+	_threads.clear();
+	_tasks.clear();
+}
+
+// Static module instance
+module::StaticModule<WorkerPool> workerPoolModule;
+
+} // namespace radiant
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "iworkerpool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace radiant
+{
+
+/**
+ * IWorkerPool implementation, the pool runs one task per thread at a time.
+ * The threads are only alive between initialiseModule() and shutdownModule(),
+ * they are never joined during static destruction.
+ */
+class WorkerPool :
+	public util::IWorkerPool
+{
+private:
+	mutable std::mutex _lock;
+	std::condition_variable _taskAvailable;
+	std::deque<std::function<void()>> _tasks;
+	std::vector<std::thread> _threads;
+	bool _stopping;
+
+public:
+	WorkerPool();
+
+	// IWorkerPool implementation
+	std::size_t getNumThreads() const override;
+	void post(const std::function<void()>& task) override;
+
+	// RegisterableModule implementation
+	const std::string& getName() const override;
+	const StringSet& getDependencies() const override;
+	void initialiseModule(const ApplicationContext& ctx) override;
+	void shutdownModule() override;
+
+private:
+	void run();
+};
+
+} // namespace radiant
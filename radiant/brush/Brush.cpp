@@ -4,6 +4,7 @@
 #include "irenderable.h"
 #include "itextstream.h"
 #include "iuimanager.h"
+#include "iprofiler.h"
 #include "shaderlib.h"
 
 #include "BrushModule.h"
@@ -11,6 +12,8 @@
 #include "Face.h"
 #include "FixedWinding.h"
 #include "math/Ray.h"
+#include "render/frontend/GeometryUpdateScheduler.h"
+#include "util/ParallelFor.h"
 
 #include <functional>
 
@@ -76,6 +79,8 @@ Brush::Brush(BrushNode& owner, const Brush& other) :
 Brush::~Brush()
 {
     ASSERT_MESSAGE(m_observers.empty(), "Brush::~Brush: observers still attached");
+
+    render::GeometryUpdateScheduler::Instance().unqueueBrush(*this);
 }
 
 BrushNode& Brush::getBrushNode()
@@ -217,12 +222,44 @@ void Brush::setDetailFlag(DetailFlag newValue)
 }
 
 void Brush::evaluateBRep() const {
+    if (m_planeChanged) {
+        // Rebuild all changed brushes in one batch, during a drag the bounds
+        // of the selected brushes are queried one after the other
+        render::GeometryUpdateScheduler::Instance().flushBrushes();
+    }
+
+    // Still set if this brush hasn't been queued or is part of a running flush
     if(m_planeChanged) {
         m_planeChanged = false;
         const_cast<Brush*>(this)->buildBRep();
     }
 }
 
+void Brush::evaluateBReps(const std::vector<Brush*>& brushes) {
+    PROFILE_ZONE("Brush::evaluateBReps");
+
+    std::vector<Brush*> changed;
+    changed.reserve(brushes.size());
+
+    for (Brush* brush : brushes) {
+        if (brush->m_planeChanged) {
+            // The transform might call back into the owning node, evaluate it up front
+            brush->evaluateTransform();
+            changed.push_back(brush);
+        }
+    }
+
+    util::parallelFor(changed.size(), [&](std::size_t i) {
+        PROFILE_ZONE("Brush::constructWindings");
+        changed[i]->constructWindings();
+    }, 16);
+
+    for (Brush* brush : changed) {
+        brush->m_planeChanged = false;
+        brush->buildBRepFromWindings();
+    }
+}
+
 void Brush::transformChanged() {
     m_transformChanged = true;
     onFacePlaneChanged();
@@ -326,7 +363,17 @@ void Brush::undoSave()
 
 IUndoMementoPtr Brush::exportState() const
 {
-    return IUndoMementoPtr(new BrushUndoMemento(m_faces, _detailFlag));
+    std::shared_ptr<const Faces> faces = _lastSavedFaces.lock();
+
+    if (faces && *faces == m_faces)
+    {
+        return IUndoMementoPtr(new BrushUndoMemento(faces, _detailFlag));
+    }
+
+    faces = std::make_shared<const Faces>(m_faces);
+    _lastSavedFaces = faces;
+
+    return IUndoMementoPtr(new BrushUndoMemento(faces, _detailFlag));
 }
 
 void Brush::importState(const IUndoMementoPtr& state)
@@ -336,7 +383,7 @@ void Brush::importState(const IUndoMementoPtr& state)
 	BrushUndoMemento& memento = *std::static_pointer_cast<BrushUndoMemento>(state);
 
 	_detailFlag = memento._detailFlag;
-    appendFaces(memento._faces);
+    appendFaces(*memento._faces);
 
     onFacePlaneChanged();
 
@@ -454,6 +501,8 @@ void Brush::erase(std::size_t index)
 void Brush::onFacePlaneChanged()
 {
     m_planeChanged = true;
+    render::GeometryUpdateScheduler::Instance().queueBrush(*this);
+
     aabbChanged();
     _owner.lightsChanged();
 }
@@ -533,7 +582,21 @@ void Brush::removeEmptyFaces() {
 
 /// \brief Constructs \p winding from the intersection of \p plane with the other planes of the brush.
 void Brush::windingForClipPlane(Winding& winding, const Plane3& plane) const {
-    FixedWinding buffer[2];
+    // Use the allocation-free buffers unless there are obviously too many faces
+    // for them. Each clip should add at most one vertex, but rounding errors
+    // can add more, so redo the face with a growing winding on overflow.
+    if (m_faces.size() + 4 <= MAX_POINTS_ON_WINDING &&
+        clipWindingByFaces<FixedWindingBuffer>(winding, plane))
+    {
+        return;
+    }
+
+    clipWindingByFaces<FixedWinding>(winding, plane);
+}
+
+template<typename WindingBuffer>
+bool Brush::clipWindingByFaces(Winding& winding, const Plane3& plane) const {
+    WindingBuffer buffer[2];
     bool swap = false;
 
     // get a poly that covers an effectively infinite area
@@ -556,7 +619,10 @@ void Brush::windingForClipPlane(Winding& winding, const Plane3& plane) const {
             {
                 // flip the plane, because we want to keep the back side
                 Plane3 clipPlane(-clip.plane3().normal(), -clip.plane3().dist());
-                buffer[swap].clip(plane, clipPlane, i, buffer[!swap]);
+
+                if (!buffer[swap].clip(plane, clipPlane, i, buffer[!swap])) {
+                    return false;
+                }
             }
 
             swap = !swap;
@@ -564,6 +630,7 @@ void Brush::windingForClipPlane(Winding& winding, const Plane3& plane) const {
     }
 
     buffer[swap].writeToWinding(winding);
+    return true;
 }
 
 void Brush::update_wireframe(RenderableWireframe& wire, const bool* faces_visible) const
@@ -1090,7 +1157,7 @@ bool Brush::isBounded() {
 }
 
 /// \brief Constructs the polygon windings for each face of the brush. Also updates the brush bounding-box and face texture-coordinates.
-bool Brush::buildWindings() {
+void Brush::constructWindings() {
     {
         m_aabb_local = AABB();
 
@@ -1119,7 +1186,9 @@ bool Brush::buildWindings() {
             f.updateWinding();
         }
     }
+}
 
+bool Brush::cleanupWindings() {
     bool degenerate = !isBounded();
 
     if (!degenerate) {
@@ -1179,7 +1248,14 @@ std::size_t ProximalVertexArray_index(const ProximalVertexArray& array, const Pr
 
 /// \brief Constructs the face windings and updates anything that depends on them.
 void Brush::buildBRep() {
-  bool degenerate = buildWindings();
+  PROFILE_ZONE("Brush::buildBRep");
+
+  constructWindings();
+  buildBRepFromWindings();
+}
+
+void Brush::buildBRepFromWindings() {
+  bool degenerate = cleanupWindings();
 
   static Vector3 colourVertexVec = ColourSchemes().getColour("brush_vertices");
   static const Colour4b colour_vertex(int(colourVertexVec[0]*255), int(colourVertexVec[1]*255),
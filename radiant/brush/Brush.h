@@ -127,6 +127,9 @@ private:
 	// ----
 
 	DetailFlag _detailFlag;
+
+	// The face list of the most recently exported memento
+	mutable std::weak_ptr<const Faces> _lastSavedFaces;
 	
 public:
 	// Public constants
@@ -140,18 +143,27 @@ public:
 	static const std::size_t SPHERE_MAX_SIDES;
 
 	/// \brief The undo memento for a brush stores only the list of face references - the faces are not copied.
+	/// The list is shared between consecutive mementos as long as the brush keeps the same faces.
 	class BrushUndoMemento : 
 		public IUndoMemento
 	{
 	public:
-		BrushUndoMemento(const Faces& faces, DetailFlag detailFlag) : 
+		BrushUndoMemento(const std::shared_ptr<const Faces>& faces, DetailFlag detailFlag) :
 			_faces(faces), 
 			_detailFlag(detailFlag)
 		{}
 
-		virtual ~BrushUndoMemento() {}
+		std::size_t getMemoryUsage() const override
+		{
+			return sizeof(*this);
+		}
+
+		void foreachSharedData(const std::function<void(const void*, std::size_t)>& functor) const override
+		{
+			functor(_faces.get(), sizeof(Faces) + _faces->capacity() * sizeof(FacePtr));
+		}
 
-		Faces _faces;
+		std::shared_ptr<const Faces> _faces;
 		DetailFlag _detailFlag;
 	};
 
@@ -211,6 +223,14 @@ public:
 
 	void evaluateBRep() const;
 
+	/**
+	 * Evaluates the BRep of all given brushes, with the same result as calling
+	 * evaluateBRep() on each of them. The face windings are constructed by
+	 * worker threads, everything notifying observers or touching renderables
+	 * is done in the calling thread afterwards.
+	 */
+	static void evaluateBReps(const std::vector<Brush*>& brushes);
+
     void transformChanged();
     void evaluateTransform();
 
@@ -331,11 +351,23 @@ private:
 	/// \brief Returns true if the brush is a finite volume. A brush without a finite volume extends past the maximum world bounds and is not valid.
 	bool isBounded();
 
+	// Clips an infinite winding on the given plane by all other face planes, using the given buffer type.
+	// Returns false if the buffer ran out of space, the winding is left untouched in that case.
+	template<typename WindingBuffer>
+	bool clipWindingByFaces(Winding& winding, const Plane3& plane) const;
+
 	/// \brief Constructs the polygon windings for each face of the brush. Also updates the brush bounding-box and face texture-coordinates.
-	bool buildWindings();
+	/// Only this brush is modified, so this can be called for different brushes concurrently, once their transform has been evaluated.
+	void constructWindings();
+
+	/// \brief Cleans up the connectivity of the constructed windings, returns true if the brush is degenerate.
+	bool cleanupWindings();
 
 	/// \brief Constructs the face windings and updates anything that depends on them.
 	void buildBRep();
+
+	/// \brief Updates anything depending on the face windings, which have been constructed by constructWindings() before.
+	void buildBRepFromWindings();
 }; // class Brush
 
 typedef std::vector<Brush*> BrushVector;
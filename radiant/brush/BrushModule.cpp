@@ -8,9 +8,12 @@
 #include "igame.h"
 #include "ilayer.h"
 #include "ieventmanager.h"
+#include "iprofiler.h"
+#include "iworkerpool.h"
 #include "brush/BrushNode.h"
 #include "brush/BrushClipPlane.h"
 #include "brush/BrushVisit.h"
+#include "brush/BrushWindingBenchmark.h"
 #include "gamelib.h"
 
 #include "registry/registry.h"
@@ -91,6 +94,8 @@ const StringSet& BrushModuleImpl::getDependencies() const {
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
 		_dependencies.insert(MODULE_UNDOSYSTEM);
+		_dependencies.insert(MODULE_PROFILER);
+		_dependencies.insert(MODULE_WORKERPOOL);
 	}
 
 	return _dependencies;
@@ -128,6 +133,7 @@ void BrushModuleImpl::registerBrushCommands()
 	GlobalEventManager().addCommand("BrushSphere", "BrushSphere");
 
 	GlobalCommandSystem().addCommand("BrushMakeSided", selection::algorithm::brushMakeSided, cmd::ARGTYPE_INT);
+	GlobalCommandSystem().addCommand("BenchmarkBrushWindings", brush::benchmarkBrushWindings, cmd::ARGTYPE_INT|cmd::ARGTYPE_OPTIONAL);
 
 	// Link the Events to the corresponding statements
 	GlobalEventManager().addCommand("Brush3Sided", "Brush3Sided");
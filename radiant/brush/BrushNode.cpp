@@ -309,6 +309,10 @@ bool BrushNode::intersectsLight(const RendererLight& light) const {
 	return light.intersectsAABB(worldAABB());
 }
 
+AABB BrushNode::getLitObjectBounds() const {
+	return worldAABB();
+}
+
 void BrushNode::insertLight(const RendererLight& light) {
 	const Matrix4& l2w = localToWorld();
 	for (FaceInstances::iterator i = m_faceInstances.begin(); i != m_faceInstances.end(); ++i) {
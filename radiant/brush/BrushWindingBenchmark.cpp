@@ -0,0 +1,154 @@
+#include "BrushWindingBenchmark.h"
+
+#include "ibrush.h"
+#include "itextstream.h"
+#include "util/Stopwatch.h"
+
+#include <random>
+#include <vector>
+#include <fmt/format.h>
+
+#include "Brush.h"
+#include "FixedWinding.h"
+#include "Winding.h"
+
+namespace brush
+{
+
+namespace
+{
+	const std::size_t DEFAULT_NUM_BRUSHES = 100000;
+
+	// Same clipping loop as Brush::clipWindingByFaces, for brushes with unique planes
+	template<typename WindingBuffer>
+	bool clipWinding(const std::vector<Plane3>& planes, std::size_t index, Winding& winding)
+	{
+		WindingBuffer buffer[2];
+		bool swap = false;
+
+		buffer[swap].createInfinite(planes[index], Brush::m_maxWorldCoord + 1);
+
+		for (std::size_t i = 0; i < planes.size(); ++i)
+		{
+			if (i == index) continue;
+
+			buffer[!swap].clear();
+
+			if (!buffer[swap].clip(planes[index], Plane3(-planes[i].normal(), -planes[i].dist()), i, buffer[!swap]))
+			{
+				return false;
+			}
+
+			swap = !swap;
+		}
+
+		buffer[swap].writeToWinding(winding);
+		return true;
+	}
+
+	// Clips all faces of all brushes, returns the total number of vertices
+	template<typename WindingBuffer>
+	std::size_t clipWindings(const std::vector<std::vector<Plane3>>& brushPlanes)
+	{
+		std::size_t numVertices = 0;
+		Winding winding;
+
+		for (const std::vector<Plane3>& planes : brushPlanes)
+		{
+			for (std::size_t i = 0; i < planes.size(); ++i)
+			{
+				// Same fallback as Brush::windingForClipPlane
+				if (!clipWinding<WindingBuffer>(planes, i, winding))
+				{
+					clipWinding<FixedWinding>(planes, i, winding);
+				}
+
+				numVertices += winding.size();
+			}
+		}
+
+		return numVertices;
+	}
+
+	void invalidateBReps(const std::vector<Brush*>& brushes)
+	{
+		for (Brush* brush : brushes)
+		{
+			brush->onFacePlaneChanged();
+		}
+	}
+}
+
+void benchmarkBrushWindings(const cmd::ArgumentList& args)
+{
+	std::size_t numBrushes = DEFAULT_NUM_BRUSHES;
+
+	if (!args.empty() && args[0].getInt() > 0)
+	{
+		numBrushes = static_cast<std::size_t>(args[0].getInt());
+	}
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<double> position(-8192, 8192);
+	std::uniform_real_distribution<double> size(8, 512);
+	std::uniform_int_distribution<std::size_t> sides(4, 12);
+
+	std::vector<scene::INodePtr> nodes;
+	std::vector<Brush*> brushes;
+	std::vector<std::vector<Plane3>> brushPlanes;
+
+	nodes.reserve(numBrushes);
+	brushes.reserve(numBrushes);
+	brushPlanes.reserve(numBrushes);
+
+	for (std::size_t i = 0; i < numBrushes; ++i)
+	{
+		nodes.push_back(GlobalBrushCreator().createBrush());
+
+		Brush* brush = Node_getBrush(nodes.back());
+		brush->constructPrism(AABB(Vector3(position(random), position(random), position(random)),
+			Vector3(size(random), size(random), size(random))), sides(random), 2, "_default");
+
+		brushes.push_back(brush);
+		brushPlanes.emplace_back();
+
+		for (std::size_t f = 0; f < brush->getNumFaces(); ++f)
+		{
+			brushPlanes.back().push_back(brush->getFace(f).getPlane3());
+		}
+	}
+
+	rMessage() << fmt::format("Brush winding benchmark: {0} prism brushes", numBrushes) << std::endl;
+
+	util::Stopwatch timer;
+	std::size_t vectorVertices = clipWindings<FixedWinding>(brushPlanes);
+	double vectorTime = timer.getMilliseconds();
+
+	timer.restart();
+	std::size_t bufferVertices = clipWindings<FixedWindingBuffer>(brushPlanes);
+	double bufferTime = timer.getMilliseconds();
+
+	rMessage() << fmt::format("  Clipping (FixedWinding):       {0:.1f} ms, {1} vertices", vectorTime, vectorVertices) << std::endl;
+	rMessage() << fmt::format("  Clipping (FixedWindingBuffer): {0:.1f} ms, {1} vertices", bufferTime, bufferVertices) << std::endl;
+
+	invalidateBReps(brushes);
+
+	timer.restart();
+
+	// evaluateBRep() would flush all queued brushes, rebuild them in batches of one
+	for (Brush* brush : brushes)
+	{
+		Brush::evaluateBReps(std::vector<Brush*>(1, brush));
+	}
+
+	rMessage() << fmt::format("  BRep rebuild (one by one):     {0:.1f} ms", timer.getMilliseconds()) << std::endl;
+
+	invalidateBReps(brushes);
+
+	timer.restart();
+	Brush::evaluateBReps(brushes);
+
+	rMessage() << fmt::format("  BRep rebuild (batch):          {0:.1f} ms", timer.getMilliseconds()) << std::endl;
+}
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "icommandsystem.h"
+
+namespace brush
+{
+
+/**
+ * BenchmarkBrushWindings [numBrushes]: measures the construction of brush
+ * windings, using a set of prism brushes with random bounds and side counts
+ * which are not part of the scene.
+ *
+ * The clipping of the face windings is timed on its own, using the vector
+ * based FixedWinding and the FixedWindingBuffer. After that, the BReps of all
+ * brushes are rebuilt one after the other (like evaluateBRep() does) and in
+ * one batch through Brush::evaluateBReps (like the map export does).
+ */
+void benchmarkBrushWindings(const cmd::ArgumentList& args);
+
+}
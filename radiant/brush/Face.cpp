@@ -6,6 +6,7 @@
 #include "irenderable.h"
 
 #include "shaderlib.h"
+#include "stream/utils.h"
 #include "Winding.h"
 
 #include "Brush.h"
@@ -19,22 +20,56 @@ class Face::SavedState :
 public:
     FacePlane::SavedState _planeState;
     TextureProjection _texdefState;
-    std::string _materialName;
 
-    SavedState(const Face& face) :
+    // The material name is shared with the previous state if it didn't change
+    std::shared_ptr<const std::string> _materialName;
+
+    SavedState(const Face& face, const std::shared_ptr<SavedState>& previous) :
         _planeState(face.getPlane()),
-        _texdefState(face.getProjection()),
-        _materialName(face.getShader())
-    {}
+        _texdefState(face.getProjection())
+    {
+        if (previous && *previous->_materialName == face.getShader())
+        {
+            _materialName = previous->_materialName;
+        }
+        else
+        {
+            _materialName = std::make_shared<std::string>(face.getShader());
+        }
+    }
 
-    virtual ~SavedState() {}
+    // Constructs a state read back by Face::readState()
+    SavedState(const Plane3& plane, const TextureMatrix& texdef, const std::string& materialName) :
+        _planeState(plane),
+        _texdefState(texdef),
+        _materialName(std::make_shared<std::string>(materialName))
+    {}
 
     void exportState(Face& face) const
     {
         _planeState.exportState(face.getPlane());
-        face.setShader(_materialName);
+        face.setShader(*_materialName);
         face.getProjection().assign(_texdefState);
     }
+
+    std::size_t getMemoryUsage() const override
+    {
+        return sizeof(SavedState);
+    }
+
+    void foreachSharedData(const std::function<void(const void*, std::size_t)>& functor) const override
+    {
+        functor(_materialName.get(), sizeof(std::string) + _materialName->capacity());
+    }
+
+    bool writeTo(std::ostream& stream) const override
+    {
+        stream::writeNative(stream, _planeState.m_plane);
+        stream::writeNative(stream, _texdefState.matrix);
+        stream::writeNativeString(stream, *_materialName);
+
+        return true;
+    }
 };
 
 Face::Face(Brush& owner) :
@@ -177,7 +212,10 @@ void Face::undoSave()
 // undoable
 IUndoMementoPtr Face::exportState() const
 {
-    return IUndoMementoPtr(new SavedState(*this));
+    std::shared_ptr<SavedState> state = std::make_shared<SavedState>(*this, _lastSavedState.lock());
+    _lastSavedState = state;
+
+    return state;
 }
 
 void Face::importState(const IUndoMementoPtr& data)
@@ -192,6 +230,22 @@ void Face::importState(const IUndoMementoPtr& data)
     _owner.onFaceShaderChanged();
 }
 
+IUndoMementoPtr Face::readState(std::istream& stream) const
+{
+    Plane3 plane;
+    TextureMatrix texdef;
+    std::string materialName;
+
+    if (!stream::readNative(stream, plane) ||
+        !stream::readNative(stream, texdef) ||
+        !stream::readNativeString(stream, materialName))
+    {
+        return IUndoMementoPtr();
+    }
+
+    return std::make_shared<SavedState>(plane, texdef, materialName);
+}
+
 void Face::flipWinding() {
     m_plane.reverse();
     planeChanged();
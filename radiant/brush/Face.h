@@ -58,6 +58,9 @@ private:
 
 	IUndoStateSaver* _undoStateSaver;
 
+	// The most recently exported state, unchanged data is shared with it
+	mutable std::weak_ptr<SavedState> _lastSavedState;
+
 	// Cached visibility flag, queried during front end rendering
 	bool _faceIsVisible;
 
@@ -94,6 +97,7 @@ public:
 	// undoable
 	IUndoMementoPtr exportState() const;
 	void importState(const IUndoMementoPtr& data);
+	IUndoMementoPtr readState(std::istream& stream) const;
 
     /// Translate the face by the given vector
     void translate(const Vector3& translation);
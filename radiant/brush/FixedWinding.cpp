@@ -47,6 +47,61 @@ namespace {
 
 		return line;
 	}
+
+	/// \brief Projects a really big axis aligned box onto \p plane, returns its edges.
+	/// Returns false if the plane is invalid.
+	inline bool getInfiniteEdges(const Plane3& plane, double infinity, DoubleLine (&edges)[4]) {
+		double max = -infinity;
+		int x = -1;
+
+		for (int i = 0; i < 3; i++) {
+			double d = fabs(plane.normal()[i]);
+			if (d > max) {
+				x = i;
+				max = d;
+			}
+		}
+
+		if (x == -1) {
+			rError() << "invalid plane\n";
+			return false;
+		}
+
+		Vector3 vup = g_vector3_identity;
+		switch (x) {
+			case 0:
+			case 1:
+				vup[2] = 1;
+				break;
+			case 2:
+				vup[0] = 1;
+				break;
+		}
+
+		vup += plane.normal() * (-vup.dot(plane.normal()));
+		vup.normalise();
+
+		Vector3 org = plane.normal() * plane.dist();
+
+		Vector3 vright = vup.crossProduct(plane.normal());
+
+		vup *= infinity;
+		vright *= infinity;
+
+		edges[0].origin = (org - vright) + vup;
+		edges[0].direction = vright.getNormalised();
+
+		edges[1].origin = org + vright + vup;
+		edges[1].direction = (-vup).getNormalised();
+
+		edges[2].origin = (org + vright) - vup;
+		edges[2].direction = (-vright).getNormalised();
+
+		edges[3].origin = (org - vright) - vup;
+		edges[3].direction = vup.getNormalised();
+
+		return true;
+	}
 }
 
 void FixedWinding::writeToWinding(Winding& winding)
@@ -65,71 +120,25 @@ void FixedWinding::writeToWinding(Winding& winding)
 }
 
 void FixedWinding::createInfinite(const Plane3& plane, double infinity) {
-	double max = -infinity;
-	int x = -1;
-
-	for (int i = 0; i < 3; i++) {
-		double d = fabs(plane.normal()[i]);
-		if (d > max) {
-			x = i;
-			max = d;
-		}
-	}
+	DoubleLine edges[4];
 
-	if (x == -1) {
-		rError() << "invalid plane\n";
+	if (!getInfiniteEdges(plane, infinity, edges)) {
 		return;
 	}
 
-	Vector3 vup = g_vector3_identity;
-	switch (x) {
-		case 0:
-		case 1:
-			vup[2] = 1;
-			break;
-		case 2:
-			vup[0] = 1;
-			break;
+	for (const DoubleLine& edge : edges) {
+		push_back(FixedWindingVertex(edge.origin, edge, c_brush_maxFaces));
 	}
-
-	vup += plane.normal() * (-vup.dot(plane.normal()));
-	vup.normalise();
-
-	Vector3 org = plane.normal() * plane.dist();
-
-	Vector3 vright = vup.crossProduct(plane.normal());
-
-	vup *= infinity;
-	vright *= infinity;
-
-	// project a really big  axis aligned box onto the plane
-
-	DoubleLine r1, r2, r3, r4;
-	r1.origin = (org - vright) + vup;
-	r1.direction = vright.getNormalised();
-	push_back(FixedWindingVertex(r1.origin, r1, c_brush_maxFaces));
-
-	r2.origin = org + vright + vup;
-	r2.direction = (-vup).getNormalised();
-	push_back(FixedWindingVertex(r2.origin, r2, c_brush_maxFaces));
-
-	r3.origin = (org + vright) - vup;
-	r3.direction = (-vright).getNormalised();
-	push_back(FixedWindingVertex(r3.origin, r3, c_brush_maxFaces));
-
-	r4.origin = (org - vright) - vup;
-	r4.direction = vup.getNormalised();
-	push_back(FixedWindingVertex(r4.origin, r4, c_brush_maxFaces));
 }
 
 /// \brief Clip \p winding which lies on \p plane by \p clipPlane, resulting in \p clipped.
 /// If \p winding is completely in front of the plane, \p clipped will be identical to \p winding.
 /// If \p winding is completely in back of the plane, \p clipped will be empty.
 /// If \p winding intersects the plane, the edge of \p clipped which lies on \p clipPlane will store the value of \p adjacent.
-void FixedWinding::clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, FixedWinding& clipped)
+bool FixedWinding::clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, FixedWinding& clipped)
 {
 	if (size() == 0) {
-		return; // Degenerate winding, exit
+		return true; // Degenerate winding, exit
 	}
 
 	PlaneClassification classification = Winding::classifyDistance(clipPlane.distanceToPoint(back().vertex), ON_EPSILON);
@@ -191,4 +200,173 @@ void FixedWinding::clip(const Plane3& plane, const Plane3& clipPlane, std::size_
 			}
 		}
 	}
+
+	return true;
+}
+
+void FixedWindingBuffer::writeToWinding(Winding& winding) const
+{
+	winding.resize(_size);
+
+	for (std::size_t i = 0; i < _size; ++i)
+	{
+		winding[i].vertex[0] = _x[i];
+		winding[i].vertex[1] = _y[i];
+		winding[i].vertex[2] = _z[i];
+		winding[i].adjacent = _edges[i].adjacent;
+	}
+}
+
+void FixedWindingBuffer::createInfinite(const Plane3& plane, double infinity)
+{
+	DoubleLine edges[4];
+
+	if (!getInfiniteEdges(plane, infinity, edges))
+	{
+		return;
+	}
+
+	for (const DoubleLine& edge : edges)
+	{
+		push_back(edge.origin, edge, c_brush_maxFaces);
+	}
+}
+
+bool FixedWindingBuffer::clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, FixedWindingBuffer& clipped) const
+{
+	if (_size == 0)
+	{
+		return true; // Degenerate winding, exit
+	}
+
+	const double nx = clipPlane.normal().x();
+	const double ny = clipPlane.normal().y();
+	const double nz = clipPlane.normal().z();
+	const double dist = clipPlane.dist();
+
+	// Distances of all vertices to the clip plane, in the same order of
+	// operations as Plane3::distanceToPoint to get the exact same results
+	double distances[MAX_POINTS_ON_WINDING];
+
+	for (std::size_t i = 0; i < _size; ++i)
+	{
+		distances[i] = _x[i] * nx + _y[i] * ny + _z[i] * nz - dist;
+	}
+
+	// Same as Winding::classifyDistance, which works on floats
+	const float epsilon = static_cast<float>(ON_EPSILON);
+	PlaneClassification classifications[MAX_POINTS_ON_WINDING];
+
+	for (std::size_t i = 0; i < _size; ++i)
+	{
+		float distance = static_cast<float>(distances[i]);
+		classifications[i] = distance > epsilon ? ePlaneFront : distance < -epsilon ? ePlaneBack : ePlaneOn;
+	}
+
+	// Same logic as FixedWinding::clip, for each edge
+	for (std::size_t next = 0, i = _size - 1; next != _size; i = next, ++next)
+	{
+		PlaneClassification classification = classifications[i];
+		PlaneClassification nextClassification = classifications[next];
+
+		// if first vertex of edge is ON
+		if (classification == ePlaneOn)
+		{
+			if (nextClassification == ePlaneBack)
+			{
+				// this edge lies on the clip plane
+				if (!clipped.push_back(Vector3(_x[i], _y[i], _z[i]), plane3_intersect_plane3(plane, clipPlane), adjacent))
+				{
+					return false;
+				}
+			}
+			else if (!clipped.push_back(*this, i))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		// if first vertex of edge is FRONT
+		if (classification == ePlaneFront && !clipped.push_back(*this, i))
+		{
+			return false;
+		}
+
+		// Nothing to cut if the second vertex is ON or on the same side
+		if (nextClassification == ePlaneOn || nextClassification == classification ||
+			(classification == ePlaneFront && _size == 2))
+		{
+			continue;
+		}
+
+		// first vertex is FRONT and second is BACK or vice versa,
+		// append intersection point of line and plane to output winding
+		DoubleLine edge = getEdge(i);
+		Vector3 mid(edge.intersectPlane(clipPlane));
+
+		// the edge lies on the clip plane if the first vertex is FRONT
+		bool added = classification == ePlaneFront ?
+			clipped.push_back(mid, plane3_intersect_plane3(plane, clipPlane), adjacent) :
+			clipped.push_back(mid, edge, _edges[i].adjacent);
+
+		if (!added)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FixedWindingBuffer::push_back(const Vector3& vertex, const DoubleLine& edge, std::size_t adjacent)
+{
+	if (_size == MAX_POINTS_ON_WINDING)
+	{
+		return false;
+	}
+
+	_x[_size] = vertex.x();
+	_y[_size] = vertex.y();
+	_z[_size] = vertex.z();
+
+	Edge& target = _edges[_size];
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		target.origin[axis] = edge.origin[axis];
+		target.direction[axis] = edge.direction[axis];
+	}
+
+	target.adjacent = adjacent;
+
+	++_size;
+	return true;
+}
+
+bool FixedWindingBuffer::push_back(const FixedWindingBuffer& source, std::size_t index)
+{
+	if (_size == MAX_POINTS_ON_WINDING)
+	{
+		return false;
+	}
+
+	_x[_size] = source._x[index];
+	_y[_size] = source._y[index];
+	_z[_size] = source._z[index];
+	_edges[_size] = source._edges[index];
+
+	++_size;
+	return true;
+}
+
+DoubleLine FixedWindingBuffer::getEdge(std::size_t index) const
+{
+	const Edge& edge = _edges[index];
+
+	DoubleLine line;
+	line.origin = Vector3(edge.origin[0], edge.origin[1], edge.origin[2]);
+	line.direction = Vector3(edge.direction[0], edge.direction[1], edge.direction[2]);
+
+	return line;
 }
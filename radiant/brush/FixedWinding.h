@@ -60,5 +60,72 @@ public:
 	/// If \p winding is completely in front of the plane, \p clipped will be identical to \p winding.
 	/// If \p winding is completely in back of the plane, \p clipped will be empty.
 	/// If \p winding intersects the plane, the edge of \p clipped which lies on \p clipPlane will store the value of \p adjacent.
-	void clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, FixedWinding& clipped);
+	/// Always returns true, \p clipped grows as needed.
+	bool clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, FixedWinding& clipped);
+};
+
+/**
+ * A FixedWinding keeping its vertices in fixed-size arrays on the stack, one array
+ * per coordinate, instead of a vector of FixedWindingVertices. Clipping evaluates
+ * the distances of all vertices to the clip plane in one pass over these arrays
+ * (which the compiler is able to vectorise) before the clipped winding is assembled.
+ * No memory is allocated at all.
+ *
+ * The winding can't hold more than MAX_POINTS_ON_WINDING vertices. In exact
+ * arithmetic each clip adds at most one vertex, but rounding errors in the
+ * classification can add more, so clip() reports when the clipped winding
+ * ran out of space. The caller has to fall back to a FixedWinding then.
+ */
+class FixedWindingBuffer
+{
+private:
+	std::size_t _size;
+
+	double _x[MAX_POINTS_ON_WINDING];
+	double _y[MAX_POINTS_ON_WINDING];
+	double _z[MAX_POINTS_ON_WINDING];
+
+	// Edge line and adjacent face of each vertex, only needed when an edge is cut.
+	// Plain doubles instead of a DoubleLine, such that nothing is initialised.
+	struct Edge
+	{
+		double origin[3];
+		double direction[3];
+		std::size_t adjacent;
+	};
+
+	Edge _edges[MAX_POINTS_ON_WINDING];
+
+public:
+	FixedWindingBuffer() :
+		_size(0)
+	{}
+
+	std::size_t size() const
+	{
+		return _size;
+	}
+
+	void clear()
+	{
+		_size = 0;
+	}
+
+	// Writes the vertices into the given Winding
+	void writeToWinding(Winding& winding) const;
+
+	// Same as FixedWinding::createInfinite
+	void createInfinite(const Plane3& plane, double infinity);
+
+	// Same as FixedWinding::clip, the clipped buffer is expected to be empty.
+	// Returns false if the clipped winding exceeded MAX_POINTS_ON_WINDING vertices,
+	// its contents are incomplete in that case.
+	bool clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, FixedWindingBuffer& clipped) const;
+
+private:
+	// These return false and leave the buffer unchanged if it is full
+	bool push_back(const Vector3& vertex, const DoubleLine& edge, std::size_t adjacent);
+	bool push_back(const FixedWindingBuffer& source, std::size_t index);
+
+	DoubleLine getEdge(std::size_t index) const;
 };
@@ -7,6 +7,7 @@
 #include "ieventmanager.h"
 #include "imainframe.h"
 #include "itextstream.h"
+#include "iprofiler.h"
 
 #include <time.h>
 #include <fmt/format.h>
@@ -23,6 +24,7 @@
 #include "render/frontend/RenderableCollectionWalker.h"
 #include "wxutil/MouseButton.h"
 #include "registry/adaptors.h"
+#include "registry/KeyHandle.h"
 #include "selection/OccludeSelector.h"
 #include "selection/Device.h"
 #include "selection/SelectionTest.h"
@@ -334,7 +336,8 @@ CamWnd::~CamWnd()
 
 SelectionTestPtr CamWnd::createSelectionTestForPoint(const Vector2& point)
 {
-    float selectEpsilon = registry::getValue<float>(RKEY_SELECT_EPSILON);
+    static registry::KeyHandle<float> selectEpsilonKey(RKEY_SELECT_EPSILON);
+    float selectEpsilon = selectEpsilonKey.get();
 
     // Get the mouse position
     Vector2 deviceEpsilon(selectEpsilon / getCamera().width, selectEpsilon / getCamera().height);
@@ -791,11 +794,17 @@ void CamWnd::draw()
 
     if (GlobalMainFrame().screenUpdatesEnabled())
 	{
-        GlobalOpenGL().assertNoErrors();
+        {
+            PROFILE_ZONE("CamWnd::draw");
+
+            GlobalOpenGL().assertNoErrors();
 
-        Cam_Draw();
+            Cam_Draw();
+
+            GlobalOpenGL().assertNoErrors();
+        }
 
-        GlobalOpenGL().assertNoErrors();
+        PROFILE_END_FRAME();
     }
 }
 
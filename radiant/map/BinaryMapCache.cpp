@@ -0,0 +1,683 @@
+#include "BinaryMapCache.h"
+
+#include "itextstream.h"
+#include "ientity.h"
+#include "ieclass.h"
+#include "ibrush.h"
+#include "ipatch.h"
+
+#include "os/fs.h"
+#include "os/file.h"
+#include "stream/utils.h"
+#include "math/Plane3.h"
+#include "math/Matrix4.h"
+
+#include <cstring>
+#include <functional>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace map
+{
+
+namespace
+{
+	const std::uint32_t CACHE_MAGIC = 0x4d435244; // "DRCM"
+	const std::uint32_t CACHE_VERSION = 1;
+
+	const std::uint8_t PRIMITIVE_BRUSH = 0;
+	const std::uint8_t PRIMITIVE_PATCH = 1;
+
+	// The primitive number MapImporter is using for entity nodes
+	const std::size_t EMPTY_PRIMITIVE_NUM = std::numeric_limits<std::size_t>::max();
+
+	const std::size_t HASH_CHUNK_SIZE = 1 << 20;
+
+	// 64 bit hash of a byte sequence, consuming eight bytes at a time.
+	// The result doesn't depend on how the sequence is split into update() calls.
+	class ContentHash
+	{
+	private:
+		std::uint64_t _hash;
+		std::uint64_t _pendingWord;
+		std::size_t _numPendingBytes;
+		std::uint64_t _length;
+
+	public:
+		ContentHash() :
+			_hash(0xcbf29ce484222325ull),
+			_pendingWord(0),
+			_numPendingBytes(0),
+			_length(0)
+		{}
+
+		void update(const char* data, std::size_t size)
+		{
+			_length += size;
+
+			// Complete a word left over from the previous call first
+			for (; size > 0 && _numPendingBytes > 0; --size)
+			{
+				addByte(*data++);
+			}
+
+			for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t))
+			{
+				std::uint64_t word;
+				std::memcpy(&word, data, sizeof(word));
+				data += sizeof(word);
+
+				_hash = mix(_hash, word);
+			}
+
+			for (; size > 0; --size)
+			{
+				addByte(*data++);
+			}
+		}
+
+		std::uint64_t get() const
+		{
+			std::uint64_t hash = _numPendingBytes > 0 ? mix(_hash, _pendingWord) : _hash;
+			return mix(hash, _length);
+		}
+
+	private:
+		void addByte(char c)
+		{
+			_pendingWord |= static_cast<std::uint64_t>(static_cast<unsigned char>(c)) << (8 * _numPendingBytes);
+
+			if (++_numPendingBytes == sizeof(std::uint64_t))
+			{
+				_hash = mix(_hash, _pendingWord);
+				_pendingWord = 0;
+				_numPendingBytes = 0;
+			}
+		}
+
+		static std::uint64_t mix(std::uint64_t hash, std::uint64_t word)
+		{
+			hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+			return hash ^ (hash >> 29);
+		}
+	};
+
+	// Appends plain values to a memory buffer
+	class CacheWriter
+	{
+	private:
+		std::string _buffer;
+
+	public:
+		template<typename T>
+		void write(const T& value)
+		{
+			_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		void writeString(const std::string& str)
+		{
+			write<std::uint32_t>(static_cast<std::uint32_t>(str.size()));
+			_buffer.append(str);
+		}
+
+		const std::string& getBuffer() const
+		{
+			return _buffer;
+		}
+	};
+
+	// Reads the values written by the CacheWriter from a memory range
+	class CacheReader
+	{
+	private:
+		const char* _cur;
+		const char* _end;
+
+	public:
+		CacheReader(const char* begin, const char* end) :
+			_cur(begin),
+			_end(end)
+		{}
+
+		template<typename T>
+		T read()
+		{
+			ensureAvailable(sizeof(T));
+
+			T value;
+			std::memcpy(&value, _cur, sizeof(T));
+			_cur += sizeof(T);
+
+			return value;
+		}
+
+		std::string readString()
+		{
+			std::uint32_t length = read<std::uint32_t>();
+			ensureAvailable(length);
+
+			std::string str(_cur, length);
+			_cur += length;
+
+			return str;
+		}
+
+		const char* getPosition() const
+		{
+			return _cur;
+		}
+
+	private:
+		void ensureAvailable(std::size_t size)
+		{
+			if (static_cast<std::size_t>(_end - _cur) < size)
+			{
+				throw IMapReader::FailureException("Binary map cache is truncated");
+			}
+		}
+	};
+
+	typedef std::vector<std::pair<std::string, std::string>> KeyValues;
+
+	// Mirrors the entity creation of the map readers
+	scene::INodePtr createEntity(const KeyValues& keyValues)
+	{
+		const std::string* className = nullptr;
+
+		for (const KeyValues::value_type& pair : keyValues)
+		{
+			if (pair.first == "classname")
+			{
+				className = &pair.second;
+				break;
+			}
+		}
+
+		if (className == nullptr)
+		{
+			throw IMapReader::FailureException("Binary map cache: could not find classname.");
+		}
+
+		IEntityClassPtr classPtr = GlobalEntityClassManager().findClass(*className);
+
+		if (!classPtr)
+		{
+			rError() << "[BinaryMapCache]: Could not find entity class: " << *className << std::endl;
+
+			// EntityClass not found, insert a brush-based one
+			classPtr = GlobalEntityClassManager().findOrInsert(*className, true);
+		}
+
+		IEntityNodePtr node(GlobalEntityCreator().createEntity(classPtr));
+
+		for (const KeyValues::value_type& pair : keyValues)
+		{
+			node->getEntity().setKeyValue(pair.first, pair.second);
+		}
+
+		return node;
+	}
+
+	scene::INodePtr createBrush(CacheReader& reader, const std::vector<std::string>& shaders)
+	{
+		scene::INodePtr node = GlobalBrushCreator().createBrush();
+		IBrush& brush = *Node_getIBrush(node);
+
+		brush.setDetailFlag(static_cast<IBrush::DetailFlag>(reader.read<std::uint32_t>()));
+
+		std::uint32_t numFaces = reader.read<std::uint32_t>();
+
+		for (std::uint32_t i = 0; i < numFaces; ++i)
+		{
+			Plane3 plane;
+			plane.normal().x() = reader.read<double>();
+			plane.normal().y() = reader.read<double>();
+			plane.normal().z() = reader.read<double>();
+			plane.dist() = reader.read<double>();
+
+			Matrix4 texdef = Matrix4::getIdentity();
+			texdef.xx() = reader.read<double>();
+			texdef.yx() = reader.read<double>();
+			texdef.tx() = reader.read<double>();
+			texdef.xy() = reader.read<double>();
+			texdef.yy() = reader.read<double>();
+			texdef.ty() = reader.read<double>();
+
+			brush.addFace(plane, texdef, shaders.at(reader.read<std::uint32_t>()));
+		}
+
+		return node;
+	}
+
+	scene::INodePtr createPatch(CacheReader& reader, const std::vector<std::string>& shaders)
+	{
+		const std::string& shader = shaders.at(reader.read<std::uint32_t>());
+		std::uint32_t width = reader.read<std::uint32_t>();
+		std::uint32_t height = reader.read<std::uint32_t>();
+		bool fixedSubdivisions = reader.read<std::uint8_t>() != 0;
+		Subdivisions subdivisions;
+		subdivisions.x() = reader.read<std::uint32_t>();
+		subdivisions.y() = reader.read<std::uint32_t>();
+
+		scene::INodePtr node = GlobalPatchCreator(
+			fixedSubdivisions ? PatchDefType::Def3 : PatchDefType::Def2).createPatch();
+		IPatch& patch = *Node_getIPatch(node);
+
+		patch.setShader(shader);
+		patch.setDims(width, height);
+
+		if (fixedSubdivisions)
+		{
+			patch.setFixedSubdivisions(true, subdivisions);
+		}
+
+		if (patch.getWidth() != width || patch.getHeight() != height)
+		{
+			throw IMapReader::FailureException("Binary map cache: patch dimensions don't match");
+		}
+
+		for (std::size_t c = 0; c < width; c++)
+		{
+			for (std::size_t r = 0; r < height; r++)
+			{
+				PatchControl& ctrl = patch.ctrlAt(r, c);
+
+				ctrl.vertex.x() = reader.read<double>();
+				ctrl.vertex.y() = reader.read<double>();
+				ctrl.vertex.z() = reader.read<double>();
+				ctrl.texcoord.x() = reader.read<double>();
+				ctrl.texcoord.y() = reader.read<double>();
+			}
+		}
+
+		patch.controlPointsChanged();
+
+		return node;
+	}
+
+	void writeBrush(CacheWriter& writer, const IBrush& brush,
+					const std::function<std::uint32_t(const std::string&)>& getShaderIndex)
+	{
+		writer.write<std::uint8_t>(PRIMITIVE_BRUSH);
+		writer.write<std::uint32_t>(brush.getDetailFlag());
+		writer.write<std::uint32_t>(static_cast<std::uint32_t>(brush.getNumFaces()));
+
+		for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+		{
+			const IFace& face = brush.getFace(i);
+
+			const Plane3& plane = face.getPlane3();
+			writer.write<double>(plane.normal().x());
+			writer.write<double>(plane.normal().y());
+			writer.write<double>(plane.normal().z());
+			writer.write<double>(plane.dist());
+
+			Matrix4 texdef = face.getTexDefMatrix();
+			writer.write<double>(texdef.xx());
+			writer.write<double>(texdef.yx());
+			writer.write<double>(texdef.tx());
+			writer.write<double>(texdef.xy());
+			writer.write<double>(texdef.yy());
+			writer.write<double>(texdef.ty());
+
+			writer.write<std::uint32_t>(getShaderIndex(face.getShader()));
+		}
+	}
+
+	void writePatch(CacheWriter& writer, const IPatch& patch,
+					const std::function<std::uint32_t(const std::string&)>& getShaderIndex)
+	{
+		writer.write<std::uint8_t>(PRIMITIVE_PATCH);
+		writer.write<std::uint32_t>(getShaderIndex(patch.getShader()));
+		writer.write<std::uint32_t>(static_cast<std::uint32_t>(patch.getWidth()));
+		writer.write<std::uint32_t>(static_cast<std::uint32_t>(patch.getHeight()));
+		writer.write<std::uint8_t>(patch.subdivisionsFixed() ? 1 : 0);
+		writer.write<std::uint32_t>(patch.getSubdivisions().x());
+		writer.write<std::uint32_t>(patch.getSubdivisions().y());
+
+		for (std::size_t c = 0; c < patch.getWidth(); c++)
+		{
+			for (std::size_t r = 0; r < patch.getHeight(); r++)
+			{
+				const PatchControl& ctrl = patch.ctrlAt(r, c);
+
+				writer.write<double>(ctrl.vertex.x());
+				writer.write<double>(ctrl.vertex.y());
+				writer.write<double>(ctrl.vertex.z());
+				writer.write<double>(ctrl.texcoord.x());
+				writer.write<double>(ctrl.texcoord.y());
+			}
+		}
+	}
+}
+
+BinaryMapCache::BinaryMapCache(const std::string& mapFilename, const std::string& cacheFilename,
+							   const std::string& formatName) :
+	_mapFilename(mapFilename),
+	_cacheFilename(cacheFilename),
+	_formatName(formatName)
+{
+	_keyValid = calculateKey();
+}
+
+bool BinaryMapCache::calculateKey()
+{
+	try
+	{
+		fs::path path(_mapFilename);
+
+		_key.size = static_cast<std::uint64_t>(fs::file_size(path));
+#ifdef DR_USE_STD_FILESYSTEM
+		_key.modificationTime = static_cast<std::int64_t>(fs::last_write_time(path).time_since_epoch().count());
+#else
+		_key.modificationTime = static_cast<std::int64_t>(fs::last_write_time(path));
+#endif
+	}
+	catch (fs::filesystem_error& ex)
+	{
+		rWarning() << "[BinaryMapCache] Cannot access map file: " << ex.what() << std::endl;
+		return false;
+	}
+
+	std::ifstream file(_mapFilename, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	ContentHash hash;
+	std::vector<char> buffer(HASH_CHUNK_SIZE);
+
+	while (file)
+	{
+		file.read(buffer.data(), buffer.size());
+		hash.update(buffer.data(), static_cast<std::size_t>(file.gcount()));
+	}
+
+	_key.contentHash = hash.get();
+
+	return true;
+}
+
+bool BinaryMapCache::load(IMapImportFilter& importFilter)
+{
+	if (!_keyValid || !os::fileOrDirExists(_cacheFilename))
+	{
+		return false;
+	}
+
+	std::ifstream file(_cacheFilename, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	std::string buffer = stream::readToString(file);
+	const char* bufferEnd = buffer.data() + buffer.size();
+
+	CacheReader header(buffer.data(), bufferEnd);
+	std::uint64_t payloadSize = 0;
+	std::uint64_t payloadHash = 0;
+
+	try
+	{
+		if (header.read<std::uint32_t>() != CACHE_MAGIC ||
+			header.read<std::uint32_t>() != CACHE_VERSION ||
+			header.read<std::uint64_t>() != _key.size ||
+			header.read<std::int64_t>() != _key.modificationTime ||
+			header.read<std::uint64_t>() != _key.contentHash)
+		{
+			rMessage() << "[BinaryMapCache] Cache " << _cacheFilename << " is outdated." << std::endl;
+			return false;
+		}
+
+		payloadSize = header.read<std::uint64_t>();
+		payloadHash = header.read<std::uint64_t>();
+	}
+	catch (IMapReader::FailureException&)
+	{
+		return false;
+	}
+
+	const char* payload = header.getPosition();
+
+	ContentHash hash;
+	hash.update(payload, bufferEnd - payload);
+
+	if (static_cast<std::uint64_t>(bufferEnd - payload) != payloadSize || hash.get() != payloadHash)
+	{
+		rWarning() << "[BinaryMapCache] Cache " << _cacheFilename << " is corrupt." << std::endl;
+		return false;
+	}
+
+	CacheReader reader(payload, bufferEnd);
+	std::vector<std::string> shaders;
+	std::uint32_t numEntities = 0;
+
+	try
+	{
+		if (reader.readString() != _formatName)
+		{
+			return false;
+		}
+
+		shaders.resize(reader.read<std::uint32_t>());
+
+		for (std::string& shader : shaders)
+		{
+			shader = reader.readString();
+		}
+
+		numEntities = reader.read<std::uint32_t>();
+	}
+	catch (IMapReader::FailureException&)
+	{
+		return false;
+	}
+
+	// From here on nodes are inserted, errors can't be recovered from
+	try
+	{
+		for (std::uint32_t e = 0; e < numEntities; ++e)
+		{
+			KeyValues keyValues(reader.read<std::uint32_t>());
+
+			for (KeyValues::value_type& pair : keyValues)
+			{
+				pair.first = reader.readString();
+				pair.second = reader.readString();
+			}
+
+			scene::INodePtr entity = createEntity(keyValues);
+
+			// The primitives are added before the entity, like the map readers do
+			std::uint32_t numPrimitives = reader.read<std::uint32_t>();
+
+			for (std::uint32_t p = 0; p < numPrimitives; ++p)
+			{
+				scene::INodePtr primitive = reader.read<std::uint8_t>() == PRIMITIVE_BRUSH ?
+					createBrush(reader, shaders) : createPatch(reader, shaders);
+
+				importFilter.addPrimitiveToEntity(primitive, entity);
+			}
+
+			importFilter.addEntity(entity);
+		}
+	}
+	catch (std::out_of_range&)
+	{
+		throw IMapReader::FailureException("Binary map cache: invalid shader index");
+	}
+
+	rMessage() << "[BinaryMapCache] Loaded " << numEntities << " entities from " << _cacheFilename << std::endl;
+
+	return true;
+}
+
+void BinaryMapCache::save(const NodeIndexMap& nodes)
+{
+	if (!_keyValid)
+	{
+		return;
+	}
+
+	// Shaders are stored once, faces and patches refer to them by index
+	std::vector<std::string> shaders;
+	std::map<std::string, std::uint32_t> shaderIndices;
+
+	auto getShaderIndex = [&](const std::string& shader)
+	{
+		auto result = shaderIndices.emplace(shader, static_cast<std::uint32_t>(shaders.size()));
+
+		if (result.second)
+		{
+			shaders.push_back(shader);
+		}
+
+		return result.first->second;
+	};
+
+	CacheWriter entityWriter;
+	std::uint32_t numEntities = 0;
+
+	// The node map is sorted by entity number, the primitives of an
+	// entity are preceding the entity node itself
+	std::vector<scene::INodePtr> primitives;
+
+	for (const NodeIndexMap::value_type& pair : nodes)
+	{
+		if (pair.first.second != EMPTY_PRIMITIVE_NUM)
+		{
+			primitives.push_back(pair.second);
+			continue;
+		}
+
+		Entity* entity = Node_getEntity(pair.second);
+
+		if (entity == nullptr)
+		{
+			return;
+		}
+
+		KeyValues keyValues;
+
+		entity->forEachKeyValue([&](const std::string& key, const std::string& value)
+		{
+			keyValues.emplace_back(key, value);
+		});
+
+		entityWriter.write<std::uint32_t>(static_cast<std::uint32_t>(keyValues.size()));
+
+		for (const KeyValues::value_type& keyValue : keyValues)
+		{
+			entityWriter.writeString(keyValue.first);
+			entityWriter.writeString(keyValue.second);
+		}
+
+		entityWriter.write<std::uint32_t>(static_cast<std::uint32_t>(primitives.size()));
+
+		for (const scene::INodePtr& primitive : primitives)
+		{
+			const IBrush* brush = Node_getIBrush(primitive);
+
+			if (brush != nullptr)
+			{
+				writeBrush(entityWriter, *brush, getShaderIndex);
+				continue;
+			}
+
+			const IPatch* patch = Node_getIPatch(primitive);
+
+			if (patch == nullptr)
+			{
+				rWarning() << "[BinaryMapCache] Unsupported primitive type, not writing the cache." << std::endl;
+				return;
+			}
+
+			writePatch(entityWriter, *patch, getShaderIndex);
+		}
+
+		primitives.clear();
+		numEntities++;
+	}
+
+	if (!primitives.empty())
+	{
+		return; // primitives without an entity, this map can't be cached
+	}
+
+	CacheWriter payloadWriter;
+	payloadWriter.writeString(_formatName);
+	payloadWriter.write<std::uint32_t>(static_cast<std::uint32_t>(shaders.size()));
+
+	for (const std::string& shader : shaders)
+	{
+		payloadWriter.writeString(shader);
+	}
+
+	payloadWriter.write<std::uint32_t>(numEntities);
+
+	const std::string& payload = payloadWriter.getBuffer();
+	const std::string& entityData = entityWriter.getBuffer();
+
+	ContentHash payloadHash;
+	payloadHash.update(payload.data(), payload.size());
+	payloadHash.update(entityData.data(), entityData.size());
+
+	CacheWriter headerWriter;
+	headerWriter.write<std::uint32_t>(CACHE_MAGIC);
+	headerWriter.write<std::uint32_t>(CACHE_VERSION);
+	headerWriter.write<std::uint64_t>(_key.size);
+	headerWriter.write<std::int64_t>(_key.modificationTime);
+	headerWriter.write<std::uint64_t>(_key.contentHash);
+	headerWriter.write<std::uint64_t>(payload.size() + entityData.size());
+	headerWriter.write<std::uint64_t>(payloadHash.get());
+
+	// Write to a temporary file first, the cache is either complete or absent
+	std::string tempFilename = _cacheFilename + ".tmp";
+
+	{
+		std::ofstream file(tempFilename, std::ios::binary);
+
+		file.write(headerWriter.getBuffer().data(), headerWriter.getBuffer().size());
+		file.write(payload.data(), payload.size());
+		file.write(entityData.data(), entityData.size());
+
+		if (!file)
+		{
+			rWarning() << "[BinaryMapCache] Failed to write " << tempFilename << std::endl;
+			return;
+		}
+	}
+
+	try
+	{
+		fs::rename(tempFilename, _cacheFilename);
+	}
+	catch (fs::filesystem_error& ex)
+	{
+		rWarning() << "[BinaryMapCache] Failed to write the cache: " << ex.what() << std::endl;
+	}
+}
+
+void BinaryMapCache::remove(const std::string& cacheFilename)
+{
+	try
+	{
+		if (fs::exists(cacheFilename))
+		{
+			fs::remove(cacheFilename);
+		}
+	}
+	catch (fs::filesystem_error& ex)
+	{
+		rWarning() << "[BinaryMapCache] Failed to remove the cache: " << ex.what() << std::endl;
+	}
+}
+
+} // namespace map
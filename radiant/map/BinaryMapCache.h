@@ -0,0 +1,74 @@
+#pragma once
+
+#include "imapformat.h"
+#include "imapinfofile.h"
+#include <cstdint>
+#include <string>
+
+namespace map
+{
+
+/**
+ * Binary sidecar file storing the entities and primitives of a text map file
+ * in a flat layout, such that reopening an unchanged map doesn't need to run
+ * the map parser.
+ *
+ * The cache is keyed by the size, modification time and content hash of the
+ * map file. It stores the spawnargs of each entity, the planes, texture
+ * matrices and shaders of the brush faces and the control grids of the patches,
+ * in the form they have been delivered to the map import filter, so a map
+ * loaded from the cache ends up with the same nodes (and the same node indices
+ * for the info file) as one loaded through the map reader.
+ *
+ * The numbers are taken from the nodes created by the map reader, which is why
+ * the cache can only be created right after the map file has been parsed.
+ */
+class BinaryMapCache
+{
+private:
+	// Identifies the map file contents the cache has been created from
+	struct MapFileKey
+	{
+		std::uint64_t size;
+		std::int64_t modificationTime;
+		std::uint64_t contentHash;
+	};
+
+	std::string _mapFilename;
+	std::string _cacheFilename;
+	std::string _formatName;
+
+	MapFileKey _key;
+	bool _keyValid;
+
+public:
+	/**
+	 * Construct a cache for the given map file, which needs to be located in the
+	 * physical file system. The cache is only valid for the given map format.
+	 * The construction calculates the hash of the map file's contents.
+	 */
+	BinaryMapCache(const std::string& mapFilename, const std::string& cacheFilename,
+				   const std::string& formatName);
+
+	/**
+	 * Inserts the cached nodes through the given import filter. Returns false
+	 * if there is no cache matching the map file, nothing has been imported in
+	 * this case. Throws IMapReader::FailureException if the cache turns out to
+	 * be corrupt after the import has started.
+	 */
+	bool load(IMapImportFilter& importFilter);
+
+	/**
+	 * Writes the nodes of the map, as they have been delivered to the import
+	 * filter by the map reader, to the cache file.
+	 */
+	void save(const NodeIndexMap& nodes);
+
+	// Deletes the cache file belonging to a map file which has been overwritten
+	static void remove(const std::string& cacheFilename);
+
+private:
+	bool calculateKey();
+};
+
+} // namespace map
@@ -11,6 +11,8 @@
 #include "ifilesystem.h"
 #include "ifiletypes.h"
 #include "iselectiongroup.h"
+#include "iprofiler.h"
+#include "iworkerpool.h"
 #include "ifilter.h"
 #include "icounter.h"
 #include "iradiant.h"
@@ -109,6 +111,7 @@ void Map::loadMapResourceFromPath(const std::string& path)
     // This usually takes a while since all editor textures are loaded - display a dialog to inform the user
     {
         ui::ScreenUpdateBlocker blocker(_("Processing..."), _("Loading textures..."), true); // force display
+        PROFILE_ZONE("Map: realise shaders");
 
         GlobalSceneGraph().root()->setRenderSystem(std::dynamic_pointer_cast<RenderSystem>(
             module::GlobalModuleRegistry().getModule(MODULE_RENDERSYSTEM)));
@@ -389,6 +392,8 @@ const scene::INodePtr& Map::findOrInsertWorldspawn()
 }
 
 void Map::load(const std::string& filename) {
+    PROFILE_ZONE("Map::load");
+
     rMessage() << "Loading map from " << filename << "\n";
 
     setMapName(filename);
@@ -971,6 +976,8 @@ const StringSet& Map::getDependencies() const
 		_dependencies.insert(MODULE_GAMEMANAGER);
 		_dependencies.insert(MODULE_SCENEGRAPH);
 		_dependencies.insert(MODULE_FILETYPES);
+		_dependencies.insert(MODULE_PROFILER);
+		_dependencies.insert(MODULE_WORKERPOOL);
     }
 
     return _dependencies;
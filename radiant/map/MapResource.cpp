@@ -11,6 +11,7 @@
 #include "ifilesystem.h"
 #include "imainframe.h"
 #include "iregistry.h"
+#include "iprofiler.h"
 #include "imapinfofile.h"
 
 #include "map/Map.h"
@@ -36,6 +37,8 @@
 #include "algorithm/MapExporter.h"
 #include "infofile/InfoFileExporter.h"
 #include "algorithm/ChildPrimitives.h"
+#include "BinaryMapCache.h"
+#include "registry/registry.h"
 
 namespace map
 {
@@ -43,6 +46,8 @@ namespace map
 namespace
 {
 	const char* const GKEY_INFO_FILE_EXTENSION = "/mapFormat/infoFileExtension";
+	const char* const RKEY_MAP_BINARY_CACHE = "user/ui/map/binaryCache";
+	const char* const BINARY_CACHE_SUFFIX = ".cache";
 
 	// name may be absolute or relative
 	inline std::string rootPath(const std::string& name) {
@@ -322,6 +327,8 @@ MapFormatPtr MapResource::determineMapFormat(std::istream& stream)
 
 RootNodePtr MapResource::loadMapNode()
 {
+	PROFILE_ZONE("MapResource::loadMapNode");
+
 	RootNodePtr rootNode;
 
 	// greebo: Check if we have valid settings
@@ -377,16 +384,36 @@ RootNodePtr MapResource::loadMapNodeFromStream(std::istream& stream, const std::
 
 bool MapResource::loadFile(std::istream& mapStream, const MapFormat& format, const RootNodePtr& root, const std::string& filename)
 {
+	PROFILE_ZONE("MapResource::loadFile");
+
 	// Our importer taking care of scene insertion
 	MapImporter importFilter(root, mapStream);
 
 	// Acquire a map reader/parser
 	IMapReaderPtr reader = format.getMapReader(importFilter);
 
+	// The binary cache is stored next to the info file, only physical files are cached
+	std::unique_ptr<BinaryMapCache> cache;
+
+	if (format.allowInfoFileCreation() && path_is_absolute(filename.c_str()) &&
+		registry::getValue<bool>(RKEY_MAP_BINARY_CACHE))
+	{
+		cache.reset(new BinaryMapCache(filename, getBinaryCacheFilename(filename), format.getMapFormatName()));
+	}
+
 	try
 	{
-		// Start parsing
-		reader->readFromStream(mapStream);
+		if (!cache || !cache->load(importFilter))
+		{
+			// Start parsing
+			reader->readFromStream(mapStream);
+
+			// Store the freshly parsed nodes, before the child primitives are modified
+			if (cache)
+			{
+				cache->save(importFilter.getNodeMap());
+			}
+		}
 
 		// Prepare child primitives
 		addOriginToChildPrimitives(root);
@@ -515,6 +542,11 @@ void MapResource::openFileStream(const std::string& path, const std::function<vo
 	}
 }
 
+std::string MapResource::getBinaryCacheFilename(const std::string& mapFilename)
+{
+	return os::replaceExtension(mapFilename, _infoFileExt) + BINARY_CACHE_SUFFIX;
+}
+
 bool MapResource::checkIsWriteable(const fs::path& path)
 {
 	// Check writeability of the given file
@@ -606,6 +638,9 @@ bool MapResource::saveFile(const MapFormat& format, const scene::INodePtr& root,
 
 		outFileStream->close();
 
+		// The binary cache of the overwritten map file is outdated now
+		BinaryMapCache::remove(getBinaryCacheFilename(filename));
+
 		if (auxFileStream)
 		{
 			auxFileStream->close();
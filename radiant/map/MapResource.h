@@ -73,6 +73,9 @@ private:
 	void openFileStream(const std::string& path, const std::function<void(std::istream&)>& streamProcessor);
 
 	static bool checkIsWriteable(const fs::path& path);
+
+	// Returns the path of the binary cache belonging to the given map file
+	static std::string getBinaryCacheFilename(const std::string& mapFilename);
 };
 // Resource pointer types
 typedef std::shared_ptr<MapResource> MapResourcePtr;
@@ -12,6 +12,9 @@
 
 #include "registry/registry.h"
 #include "string/string.h"
+#include "util/ParallelFor.h"
+
+#include <sstream>
 
 #include "ChildPrimitives.h"
 
@@ -22,6 +25,14 @@ namespace map
 	{
 		const char* const RKEY_FLOAT_PRECISION = "/mapFormat/floatPrecision";
 		const char* const RKEY_MAP_SAVE_STATUS_INTERLEAVE = "user/ui/map/saveStatusInterleave";
+		const char* const RKEY_MAP_PARALLEL_SAVING = "user/ui/map/parallelSaving";
+
+		// Number of queued primitives triggering a write, limiting the memory
+		// held by the buffers and keeping the progress dialog responsive
+		const std::size_t PENDING_PRIMITIVE_BATCH_SIZE = 4096;
+
+		// Number of primitives serialised into the same buffer by a worker
+		const std::size_t PRIMITIVES_PER_CHUNK = 128;
 	}
 
 MapExporter::MapExporter(IMapWriter& writer, const scene::INodePtr& root, std::ostream& mapStream, std::size_t nodeCount) :
@@ -32,7 +43,10 @@ MapExporter::MapExporter(IMapWriter& writer, const scene::INodePtr& root, std::o
 	_totalNodeCount(nodeCount),
 	_curNodeCount(0),
 	_entityNum(0),
-	_primitiveNum(0)
+	_primitiveNum(0),
+	_concurrentWriter(nullptr),
+	_insideEntity(false),
+	_entityPrimitiveCount(0)
 {
 	construct();
 }
@@ -47,7 +61,10 @@ MapExporter::MapExporter(IMapWriter& writer, const scene::INodePtr& root,
 	_totalNodeCount(nodeCount),
 	_curNodeCount(0),
 	_entityNum(0),
-	_primitiveNum(0)
+	_primitiveNum(0),
+	_concurrentWriter(nullptr),
+	_insideEntity(false),
+	_entityPrimitiveCount(0)
 {
 	construct();
 }
@@ -79,6 +96,11 @@ void MapExporter::construct()
 	int precision = string::convert<int>(nodes[0].getAttributeValue("value"));
 	_mapStream.precision(precision);
 
+	if (registry::getValue<bool>(RKEY_MAP_PARALLEL_SAVING))
+	{
+		_concurrentWriter = dynamic_cast<IConcurrentPrimitiveWriter*>(&_writer);
+	}
+
 	// Add origin to func_* children before writing
 	prepareScene();
 }
@@ -132,6 +154,9 @@ bool MapExporter::pre(const scene::INodePtr& node)
 			
 			_writer.beginWriteEntity(*entity, _mapStream);
 
+			_insideEntity = true;
+			_entityPrimitiveCount = 0;
+
 			if (_infoFileExporter) _infoFileExporter->visitEntity(node, _entityNum);
 
 			return true;
@@ -144,7 +169,10 @@ bool MapExporter::pre(const scene::INodePtr& node)
 			// Progress dialog handling
 			onNodeProgress();
 
-			_writer.beginWriteBrush(*brush, _mapStream);
+			if (!queuePrimitive(node, brush, nullptr))
+			{
+				_writer.beginWriteBrush(*brush, _mapStream);
+			}
 
 			if (_infoFileExporter) _infoFileExporter->visitPrimitive(node, _entityNum, _primitiveNum);
 
@@ -158,7 +186,10 @@ bool MapExporter::pre(const scene::INodePtr& node)
 			// Progress dialog handling
 			onNodeProgress();
 
-			_writer.beginWritePatch(*patch, _mapStream);
+			if (!queuePrimitive(node, nullptr, patch))
+			{
+				_writer.beginWritePatch(*patch, _mapStream);
+			}
 
 			if (_infoFileExporter) _infoFileExporter->visitPrimitive(node, _entityNum, _primitiveNum);
 
@@ -181,6 +212,9 @@ void MapExporter::post(const scene::INodePtr& node)
 
 		if (entity != NULL)
 		{
+			writePendingPrimitives();
+			_insideEntity = false;
+
 			_writer.endWriteEntity(*entity, _mapStream);
 
 			_entityNum++;
@@ -191,7 +225,12 @@ void MapExporter::post(const scene::INodePtr& node)
 
 		if (brush != NULL && brush->hasContributingFaces())
 		{
-			_writer.endWriteBrush(*brush, _mapStream);
+			// Queued brushes have been completely written by the concurrent writer
+			if (!(_concurrentWriter && _insideEntity))
+			{
+				_writer.endWriteBrush(*brush, _mapStream);
+			}
+
 			_primitiveNum++;
 			return;
 		}
@@ -200,7 +239,11 @@ void MapExporter::post(const scene::INodePtr& node)
 
 		if (patch != NULL)
 		{
-			_writer.endWritePatch(*patch, _mapStream);
+			if (!(_concurrentWriter && _insideEntity))
+			{
+				_writer.endWritePatch(*patch, _mapStream);
+			}
+
 			_primitiveNum++;
 			return;
 		}
@@ -211,6 +254,83 @@ void MapExporter::post(const scene::INodePtr& node)
 	}
 }
 
+bool MapExporter::queuePrimitive(const scene::INodePtr& node, const IBrush* brush, const IPatch* patch)
+{
+	// Primitives outside an entity are written the regular way
+	if (!_concurrentWriter || !_insideEntity)
+	{
+		return false;
+	}
+
+	_pendingPrimitives.push_back(PendingPrimitive{ node, brush, patch, _entityPrimitiveCount++ });
+
+	if (_pendingPrimitives.size() >= PENDING_PRIMITIVE_BATCH_SIZE)
+	{
+		writePendingPrimitives();
+	}
+
+	return true;
+}
+
+void MapExporter::writePendingPrimitives()
+{
+	if (_pendingPrimitives.empty()) return;
+
+	std::size_t numPrimitives = _pendingPrimitives.size();
+	std::size_t numChunks = (numPrimitives + PRIMITIVES_PER_CHUNK - 1) / PRIMITIVES_PER_CHUNK;
+
+	std::vector<std::string> chunks(numChunks);
+	std::vector<std::string> errors(numPrimitives);
+
+	// Each worker formats a consecutive range of primitives into its own buffer
+	util::parallelFor(numChunks, [&](std::size_t chunk)
+	{
+		std::ostringstream buffer;
+		buffer.copyfmt(_mapStream);
+
+		std::size_t end = std::min(numPrimitives, (chunk + 1) * PRIMITIVES_PER_CHUNK);
+
+		for (std::size_t i = chunk * PRIMITIVES_PER_CHUNK; i < end; ++i)
+		{
+			const PendingPrimitive& primitive = _pendingPrimitives[i];
+
+			try
+			{
+				if (primitive.brush != nullptr)
+				{
+					_concurrentWriter->writeBrush(primitive.primitiveNum, *primitive.brush, buffer);
+				}
+				else
+				{
+					_concurrentWriter->writePatch(primitive.primitiveNum, *primitive.patch, buffer);
+				}
+			}
+			catch (IMapWriter::FailureException& ex)
+			{
+				errors[i] = ex.what();
+			}
+		}
+
+		chunks[chunk] = buffer.str();
+	}, 1);
+
+	// Append the buffers in order, producing the same output as the sequential writer
+	for (const std::string& chunk : chunks)
+	{
+		_mapStream.write(chunk.data(), chunk.size());
+	}
+
+	for (const std::string& error : errors)
+	{
+		if (!error.empty())
+		{
+			rError() << "Failure exporting a node (pre): " << error << std::endl;
+		}
+	}
+
+	_pendingPrimitives.clear();
+}
+
 void MapExporter::onNodeProgress()
 {
 	_curNodeCount++;
@@ -245,17 +365,22 @@ void MapExporter::finishScene()
 
 void MapExporter::recalculateBrushWindings()
 {
-	_root->foreachNode([] (const scene::INodePtr& child)->bool
+	std::vector<Brush*> brushes;
+
+	_root->foreachNode([&] (const scene::INodePtr& child)->bool
 	{
 		Brush* brush = Node_getBrush(child);
 
 		if (brush != NULL)
 		{
-			brush->evaluateBRep();
+			brushes.push_back(brush);
 		}
 
 		return true;
 	});
+
+	// Rebuild all of them in one batch
+	Brush::evaluateBReps(brushes);
 }
 
 } // namespace
@@ -3,6 +3,7 @@
 #include "inode.h"
 #include "imapformat.h"
 #include "igame.h"
+#include <vector>
 
 #include "wxutil/ModalProgressDialog.h"
 #include "../infofile/InfoFileExporter.h"
@@ -52,6 +53,24 @@ private:
 	std::size_t _entityNum;
 	std::size_t _primitiveNum;
 
+	// Non-NULL if the writer supports serialising primitives concurrently
+	IConcurrentPrimitiveWriter* _concurrentWriter;
+
+	// A brush or patch of the current entity, waiting to be written
+	struct PendingPrimitive
+	{
+		scene::INodePtr node;
+		const IBrush* brush;
+		const IPatch* patch;
+		std::size_t primitiveNum; // number within the entity
+	};
+
+	// The primitives are collected while traversing an entity and
+	// written in batches, the entity is not closed until they are flushed
+	std::vector<PendingPrimitive> _pendingPrimitives;
+	bool _insideEntity;
+	std::size_t _entityPrimitiveCount;
+
 public:
 	// The constructor prepares the scene and the output stream
 	MapExporter(IMapWriter& writer, const scene::INodePtr& root, 
@@ -80,6 +99,12 @@ private:
 
 	void onNodeProgress();
 
+	// Returns true if the given primitive has been queued for concurrent writing
+	bool queuePrimitive(const scene::INodePtr& node, const IBrush* brush, const IPatch* patch);
+
+	// Serialises the queued primitives in parallel and writes them to the map stream
+	void writePendingPrimitives();
+
 	// Is called before exporting the scene to prepare func_* groups.
 	void prepareScene();
 
@@ -136,8 +136,7 @@ void ModuleRegistry::initialiseModuleRecursive(const std::string& name)
 	module->initialiseModule(*_context);
 }
 
-// Initialise all registered modules
-void ModuleRegistry::loadAndInitialiseModules()
+void ModuleRegistry::loadModules()
 {
 	if (_modulesInitialised)
     {
@@ -156,6 +155,12 @@ void ModuleRegistry::loadAndInitialiseModules()
 	// Load modules from application-relative path
 	_loader.loadModules(_context->getApplicationPath());
 #endif
+}
+
+// Initialise all registered modules
+void ModuleRegistry::loadAndInitialiseModules()
+{
+	loadModules();
 
 	_progress = 0.1f;
 	_sigModuleInitialisationProgress.emit(_("Initialising Modules"), _progress);
@@ -178,6 +183,18 @@ void ModuleRegistry::loadAndInitialiseModules()
 	_sigAllModulesInitialised.emit();
 }
 
+void ModuleRegistry::loadAndInitialiseModules(const StringSet& moduleNames)
+{
+	loadModules();
+
+	for (const std::string& name : moduleNames)
+	{
+		initialiseModuleRecursive(name);
+	}
+
+	_modulesInitialised = true;
+}
+
 void ModuleRegistry::shutdownModules()
 {
 	if (_modulesShutdown)
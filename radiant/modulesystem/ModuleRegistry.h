@@ -56,6 +56,15 @@ public:
 	// Initialise all registered modules
     void loadAndInitialiseModules() override;
 
+	/**
+	 * Loads the modules like loadAndInitialiseModules(), but initialises only
+	 * the named modules and their dependencies. This is used by tools running
+	 * without the main frame, the allModulesInitialised signal is not fired.
+	 *
+	 * Throws std::logic_error if one of the named modules doesn't exist.
+	 */
+	void loadAndInitialiseModules(const StringSet& moduleNames);
+
 	// Shutdown all modules
     void shutdownModules() override;
 
@@ -94,6 +103,9 @@ private:
 	// is destructed - the shared_ptrs don't work anymore and are causing double-deletes.
 	void unloadModules();
 
+	// Loads the modules from the DLLs in the modules/ and plugins/ folders
+	void loadModules();
+
 	// Initialises the module (including dependencies, recursively).
 	void initialiseModuleRecursive(const std::string& name);
 
@@ -0,0 +1,117 @@
+#include "BezierPatchSampler.h"
+
+BezierPatchSampler::BezierPatchSampler(std::size_t horzSub, std::size_t vertSub) :
+	_numU(horzSub + 1),
+	_numV(vertSub + 1),
+	_u(_numU),
+	_v(_numV),
+	_rows(3 * NUM_CHANNELS * _numU),
+	_qA(NUM_CHANNELS * _numU),
+	_qB(NUM_CHANNELS * _numU),
+	_qC(NUM_CHANNELS * _numU),
+	_samples(NUM_CHANNELS * _numU)
+{
+	for (std::size_t i = 0; i < _numU; ++i)
+	{
+		_u[i] = static_cast<float>(i) / (_numU - 1);
+	}
+
+	for (std::size_t j = 0; j < _numV; ++j)
+	{
+		_v[j] = static_cast<float>(j) / (_numV - 1);
+	}
+}
+
+void BezierPatchSampler::sample(const ArbitraryMeshVertex ctrl[3][3], ArbitraryMeshVertex* out, std::size_t rowStride)
+{
+	const std::size_t numU = _numU;
+	const float* u = _u.data();
+
+	// Evaluate each control row at all u parameters
+	for (std::size_t vPoint = 0; vPoint < 3; ++vPoint)
+	{
+		for (std::size_t channel = 0; channel < NUM_CHANNELS; ++channel)
+		{
+			float a = getChannel(ctrl[0][vPoint], channel);
+			float b = getChannel(ctrl[1][vPoint], channel);
+			float c = getChannel(ctrl[2][vPoint], channel);
+
+			float qA = a - 2.0f * b + c;
+			float qB = 2.0f * b - 2.0f * a;
+			float qC = a;
+
+			float* row = &_rows[(vPoint * NUM_CHANNELS + channel) * numU];
+
+			for (std::size_t i = 0; i < numU; ++i)
+			{
+				row[i] = qA * u[i] * u[i] + qB * u[i] + qC;
+			}
+		}
+	}
+
+	// The coefficients along v are the same for all output rows
+	for (std::size_t channel = 0; channel < NUM_CHANNELS; ++channel)
+	{
+		const float* a = &_rows[channel * numU];
+		const float* b = &_rows[(NUM_CHANNELS + channel) * numU];
+		const float* c = &_rows[(2 * NUM_CHANNELS + channel) * numU];
+
+		float* qA = &_qA[channel * numU];
+		float* qB = &_qB[channel * numU];
+		float* qC = &_qC[channel * numU];
+
+		for (std::size_t i = 0; i < numU; ++i)
+		{
+			qA[i] = a[i] - 2.0f * b[i] + c[i];
+			qB[i] = 2.0f * b[i] - 2.0f * a[i];
+			qC[i] = a[i];
+		}
+	}
+
+	const std::size_t numValues = NUM_CHANNELS * numU;
+	const float* qA = _qA.data();
+	const float* qB = _qB.data();
+	const float* qC = _qC.data();
+	float* samples = _samples.data();
+
+	for (std::size_t j = 0; j < _numV; ++j)
+	{
+		const float v = _v[j];
+
+		// Interpolate all channels of the whole row in one go
+		for (std::size_t k = 0; k < numValues; ++k)
+		{
+			samples[k] = qA[k] * v * v + qB[k] * v + qC[k];
+		}
+
+		ArbitraryMeshVertex* outRow = out + j * rowStride;
+
+		for (std::size_t i = 0; i < numU; ++i)
+		{
+			ArbitraryMeshVertex& vertex = outRow[i];
+
+			vertex.vertex[0] = samples[i];
+			vertex.vertex[1] = samples[numU + i];
+			vertex.vertex[2] = samples[2 * numU + i];
+			vertex.normal[0] = samples[3 * numU + i];
+			vertex.normal[1] = samples[4 * numU + i];
+			vertex.normal[2] = samples[5 * numU + i];
+			vertex.texcoord[0] = samples[6 * numU + i];
+			vertex.texcoord[1] = samples[7 * numU + i];
+		}
+	}
+}
+
+float BezierPatchSampler::getChannel(const ArbitraryMeshVertex& vertex, std::size_t channel)
+{
+	if (channel < 3)
+	{
+		return static_cast<float>(vertex.vertex[channel]);
+	}
+	else if (channel < 6)
+	{
+		return static_cast<float>(vertex.normal[channel - 3]);
+	}
+
+	return static_cast<float>(vertex.texcoord[channel - 6]);
+}
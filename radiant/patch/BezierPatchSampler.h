@@ -0,0 +1,61 @@
+#pragma once
+
+#include "render/ArbitraryMeshVertex.h"
+#include <vector>
+
+/**
+ * Evaluates quadratic 3x3 Bezier patches on a regular grid of parameters, like
+ * used by the fixed patch tesselation. Position, normal and texture coordinates
+ * are processed as separate float channels: the three control rows are first
+ * evaluated at all u parameters, after which every output row is interpolated
+ * along v across all its samples at once. These loops are running over
+ * contiguous float arrays, which allows the compiler to vectorise them.
+ *
+ * The arithmetic is the same as in the per-point evaluation, so the results
+ * don't depend on the evaluation order. The sampler keeps its buffers, it should
+ * be re-used for all 3x3 sub-patches of a patch.
+ */
+class BezierPatchSampler
+{
+private:
+	// Vertex (3), normal (3) and texture coordinates (2)
+	static const std::size_t NUM_CHANNELS = 8;
+
+	std::size_t _numU;
+	std::size_t _numV;
+
+	// The sample parameters in [0..1]
+	std::vector<float> _u;
+	std::vector<float> _v;
+
+	// The control rows evaluated at each u, indexed by [controlRow][channel][u]
+	std::vector<float> _rows;
+
+	// The quadratic coefficients along v, indexed by [channel][u]
+	std::vector<float> _qA;
+	std::vector<float> _qB;
+	std::vector<float> _qC;
+
+	// One interpolated output row, indexed by [channel][u]
+	std::vector<float> _samples;
+
+public:
+	// Prepares the sampling of (horzSub + 1) x (vertSub + 1) points per patch
+	BezierPatchSampler(std::size_t horzSub, std::size_t vertSub);
+
+	/**
+	 * Evaluates the patch defined by the given control points (indexed by
+	 * [column][row]). Sample (i, j) is written to out[j * rowStride + i], only
+	 * its vertex, normal and texcoord members are assigned.
+	 */
+	void sample(const ArbitraryMeshVertex ctrl[3][3], ArbitraryMeshVertex* out, std::size_t rowStride);
+
+	// Returns the number of points written by each sample() call
+	std::size_t getNumSamples() const
+	{
+		return _numU * _numV;
+	}
+
+private:
+	static float getChannel(const ArbitraryMeshVertex& vertex, std::size_t channel);
+};
@@ -11,6 +11,8 @@
 #include "registry/registry.h"
 #include "math/Frustum.h"
 #include "math/Ray.h"
+#include "util/ParallelFor.h"
+#include "render/frontend/GeometryUpdateScheduler.h"
 #include "texturelib.h"
 #include "brush/TextureProjection.h"
 #include "brush/Winding.h"
@@ -19,6 +21,7 @@
 #include "selection/algorithm/Shader.h"
 
 #include "PatchSavedState.h"
+#include "PatchTesselationCache.h"
 #include "PatchNode.h"
 
 // ====== Helper Functions ==================================================================
@@ -52,10 +55,12 @@ inline bool double_valid(double f) {
 Patch::Patch(PatchNode& node) :
 	_node(node),
 	_undoStateSaver(nullptr),
-	_solidRenderable(_mesh),
-	_wireframeRenderable(_mesh),
-	_fixedWireframeRenderable(_mesh),
-	_renderableNTBVectors(_mesh),
+	_mesh(std::make_shared<PatchTesselation>()),
+	_meshOrigin(0, 0, 0),
+	_solidRenderable(_mesh, _meshOrigin),
+	_wireframeRenderable(_mesh, _meshOrigin),
+	_fixedWireframeRenderable(_mesh, _meshOrigin),
+	_renderableNTBVectors(_mesh, _meshOrigin),
 	_renderableCtrlPoints(GL_POINTS, _ctrl_vertices),
 	_renderableLattice(GL_LINES, _latticeIndices, _ctrl_vertices),
 	_transformChanged(false),
@@ -73,10 +78,12 @@ Patch::Patch(const Patch& other, PatchNode& node) :
 	IUndoable(other),
 	_node(node),
 	_undoStateSaver(nullptr),
-	_solidRenderable(_mesh),
-	_wireframeRenderable(_mesh),
-	_fixedWireframeRenderable(_mesh),
-	_renderableNTBVectors(_mesh),
+	_mesh(std::make_shared<PatchTesselation>()),
+	_meshOrigin(0, 0, 0),
+	_solidRenderable(_mesh, _meshOrigin),
+	_wireframeRenderable(_mesh, _meshOrigin),
+	_fixedWireframeRenderable(_mesh, _meshOrigin),
+	_renderableNTBVectors(_mesh, _meshOrigin),
 	_renderableCtrlPoints(GL_POINTS, _ctrl_vertices),
 	_renderableLattice(GL_LINES, _latticeIndices, _ctrl_vertices),
 	_transformChanged(false),
@@ -257,20 +264,22 @@ void Patch::setRenderSystem(const RenderSystemPtr& renderSystem)
 
 // Implementation of the abstract method of SelectionTestable
 // Called to test if the patch can be selected by the mouse pointer
-void Patch::testSelect(Selector& selector, SelectionTest& test)
+void Patch::testSelect(Selector& selector, SelectionTest& test, const Matrix4& localToWorld)
 {
 	// ensure the tesselation is up to date
 	updateTesselation();
 
 	// The updateTesselation routine might have produced a degenerate patch, catch this
-	if (_mesh.vertices.empty()) return;
+	if (_mesh->vertices.empty()) return;
+
+	test.BeginMesh(localToWorld.getMultipliedBy(Matrix4::getTranslation(_meshOrigin)), true);
 
 	SelectionIntersection best;
-	IndexPointer::index_type* pIndex = &_mesh.indices.front();
+	IndexPointer::pointer pIndex = &_mesh->indices.front();
 
-	for (std::size_t s=0; s<_mesh.numStrips; s++) {
-		test.TestQuadStrip(vertexpointer_arbitrarymeshvertex(&_mesh.vertices.front()), IndexPointer(pIndex, _mesh.lenStrips), best);
-		pIndex += _mesh.lenStrips;
+	for (std::size_t s=0; s<_mesh->numStrips; s++) {
+		test.TestQuadStrip(vertexpointer_arbitrarymeshvertex(&_mesh->vertices.front()), IndexPointer(pIndex, _mesh->lenStrips), best);
+		pIndex += _mesh->lenStrips;
 	}
 
 	if (best.isValid()) {
@@ -305,6 +314,8 @@ void Patch::transformChanged()
 	_transformChanged = true;
 	_node.lightsChanged();
 	_tesselationChanged = true;
+
+	render::GeometryUpdateScheduler::Instance().queuePatch(*this);
 }
 
 // Called to evaluate the transform
@@ -438,7 +449,11 @@ void Patch::undoSave()
 // Save the current patch state into a new UndoMemento instance (allocated on heap) and return it to the undo observer
 IUndoMementoPtr Patch::exportState() const
 {
-	return IUndoMementoPtr(new SavedState(_width, _height, _ctrl, _patchDef3, _subDivisions.x(), _subDivisions.y(), _shader.getMaterialName()));
+	std::shared_ptr<SavedState> state = std::make_shared<SavedState>(_width, _height, _ctrl, _patchDef3,
+		_subDivisions.x(), _subDivisions.y(), _shader.getMaterialName(), _lastSavedState.lock());
+	_lastSavedState = state;
+
+	return state;
 }
 
 // Revert the state of this patch to the one that has been saved in the UndoMemento
@@ -454,11 +469,11 @@ void Patch::importState(const IUndoMementoPtr& state)
 	{
 		_width = other.m_width;
 		_height = other.m_height;
-		_ctrl = other.m_ctrl;
+		_ctrl = other.getControls();
 		onAllocate(_ctrl.size());
 		_patchDef3 = other.m_patchDef3;
 		_subDivisions = Subdivisions(other.m_subdivisions_x, other.m_subdivisions_y);
-        _shader.setMaterialName(other._materialName);
+        _shader.setMaterialName(*other._materialName);
 	}
 
 	// end duplicate code
@@ -468,6 +483,11 @@ void Patch::importState(const IUndoMementoPtr& state)
 	controlPointsChanged();
 }
 
+IUndoMementoPtr Patch::readState(std::istream& stream) const
+{
+	return SavedState::ReadFrom(stream);
+}
+
 void Patch::check_shader()
 {
 	if (!shader_valid(getShader().c_str()))
@@ -487,6 +507,8 @@ Patch::~Patch()
 	// Release the shaders
     _pointShader.reset();
     _latticeShader.reset();
+
+	render::GeometryUpdateScheduler::Instance().unqueuePatch(*this);
 }
 
 bool Patch::isValid() const
@@ -544,18 +566,70 @@ void Patch::updateTesselation()
 
 	_tesselationChanged = false;
 
-    _ctrl_vertices.clear();
-    _latticeIndices.clear();
-    
     if (!isValid())
     {
-        _mesh.clear();
-		_localAABB = AABB();
+        clearTesselation();
         return;
     }
 
 	// Run the tesselation code
-	_mesh.generate(_width, _height, _ctrlTransformed, subdivisionsFixed(), getSubdivisions());
+	generateTesselation();
+	onTesselationGenerated();
+}
+
+void Patch::updateTesselations(const std::vector<Patch*>& patches)
+{
+	std::vector<Patch*> changed;
+	changed.reserve(patches.size());
+
+	for (Patch* patch : patches)
+	{
+		if (!patch->_tesselationChanged) continue;
+
+		patch->_tesselationChanged = false;
+
+		// The validity check is reporting errors, keep it out of the worker threads
+		if (!patch->isValid())
+		{
+			patch->clearTesselation();
+			continue;
+		}
+
+		changed.push_back(patch);
+	}
+
+	util::parallelFor(changed.size(), [&](std::size_t i)
+	{
+		changed[i]->generateTesselation();
+	}, 4);
+
+	for (Patch* patch : changed)
+	{
+		patch->onTesselationGenerated();
+	}
+}
+
+void Patch::clearTesselation()
+{
+    _ctrl_vertices.clear();
+    _latticeIndices.clear();
+
+    _mesh = std::make_shared<PatchTesselation>();
+    _meshOrigin = Vector3(0, 0, 0);
+    _localAABB = AABB();
+}
+
+void Patch::generateTesselation()
+{
+	_meshOrigin = _ctrlTransformed.empty() ? Vector3(0, 0, 0) : _ctrlTransformed.front().vertex;
+	_mesh = PatchTesselationCache::Instance().getTesselation(_width, _height, _ctrlTransformed,
+		subdivisionsFixed(), getSubdivisions());
+}
+
+void Patch::onTesselationGenerated()
+{
+    _ctrl_vertices.clear();
+    _latticeIndices.clear();
 
     updateAABB();
 
@@ -1854,12 +1928,12 @@ void Patch::alignTexture(EAlignType align)
 	controlPointsChanged();
 }
 
-PatchTesselation& Patch::getTesselation()
+const PatchTesselation& Patch::getTesselation()
 {
 	// Ensure the tesselation is up to date
 	updateTesselation();
 
-	return _mesh;
+	return *_mesh;
 }
 
 PatchMesh Patch::getTesselatedPatchMesh() const
@@ -1869,15 +1943,15 @@ PatchMesh Patch::getTesselatedPatchMesh() const
 
 	PatchMesh mesh;
 
-	mesh.width = _mesh.width;
-	mesh.height = _mesh.height;
+	mesh.width = _mesh->width;
+	mesh.height = _mesh->height;
 
-	for (std::vector<ArbitraryMeshVertex>::const_iterator i = _mesh.vertices.begin();
-		i != _mesh.vertices.end(); ++i)
+	for (std::vector<ArbitraryMeshVertex>::const_iterator i = _mesh->vertices.begin();
+		i != _mesh->vertices.end(); ++i)
 	{
 		VertexNT v;
 
-		v.vertex = i->vertex;
+		v.vertex = i->vertex + _meshOrigin;
 		v.texcoord = i->texcoord;
 		v.normal = i->normal;
 
@@ -2690,44 +2764,47 @@ bool Patch::subdivisionsFixed() const
 
 bool Patch::getIntersection(const Ray& ray, Vector3& intersection)
 {
-	std::vector<RenderIndex>::const_iterator stripStartIndex = _mesh.indices.begin();
+	// Intersect in the space of the tesselation, relative to its origin
+	Ray meshRay(ray.origin - _meshOrigin, ray.direction);
+
+	std::vector<RenderIndex>::const_iterator stripStartIndex = _mesh->indices.begin();
 
 	// Go over each quad strip and intersect the ray with its triangles
-	for (std::size_t strip = 0; strip < _mesh.numStrips; ++strip)
+	for (std::size_t strip = 0; strip < _mesh->numStrips; ++strip)
 	{
 		// Iterate over the indices. The +2 increment will lead up to the next quad
 		for (std::vector<RenderIndex>::const_iterator indexIter = stripStartIndex;
-			indexIter + 2 < stripStartIndex + _mesh.lenStrips; indexIter += 2)
+			indexIter + 2 < stripStartIndex + _mesh->lenStrips; indexIter += 2)
 		{
 			Vector3 triangleIntersection;
 
 			// Run a selection test against the quad's triangles
 			{
-				const Vector3& p1 = _mesh.vertices[*indexIter].vertex;
-				const Vector3& p2 = _mesh.vertices[*(indexIter + 1)].vertex;
-				const Vector3& p3 = _mesh.vertices[*(indexIter + 2)].vertex;
+				const Vector3& p1 = _mesh->vertices[*indexIter].vertex;
+				const Vector3& p2 = _mesh->vertices[*(indexIter + 1)].vertex;
+				const Vector3& p3 = _mesh->vertices[*(indexIter + 2)].vertex;
 
-				if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
+				if (meshRay.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
 				{
-					intersection = triangleIntersection;
+					intersection = triangleIntersection + _meshOrigin;
 					return true;
 				}
 			}
 
 			{
-				const Vector3& p1 = _mesh.vertices[*(indexIter + 2)].vertex;
-				const Vector3& p2 = _mesh.vertices[*(indexIter + 1)].vertex;
-				const Vector3& p3 = _mesh.vertices[*(indexIter + 3)].vertex;
+				const Vector3& p1 = _mesh->vertices[*(indexIter + 2)].vertex;
+				const Vector3& p2 = _mesh->vertices[*(indexIter + 1)].vertex;
+				const Vector3& p3 = _mesh->vertices[*(indexIter + 3)].vertex;
 
-				if (ray.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
+				if (meshRay.intersectTriangle(p1, p2, p3, triangleIntersection) == Ray::POINT)
 				{
-					intersection = triangleIntersection;
+					intersection = triangleIntersection + _meshOrigin;
 					return true;
 				}
 			}
 		}
 
-		stripStartIndex += _mesh.lenStrips;
+		stripStartIndex += _mesh->lenStrips;
 	}
 
 	return false;
@@ -23,6 +23,7 @@
 
 class PatchNode;
 class Ray;
+class SavedState;
 
 /* greebo: The patch class itself, represented by control vertices. The basic rendering of the patch
  * is handled here (unselected control points, tesselation lines, shader).
@@ -49,13 +50,19 @@ class Patch :
 
 	IUndoStateSaver* _undoStateSaver;
 
+	// The most recently exported undo state, unchanged data is shared with it
+	mutable std::weak_ptr<SavedState> _lastSavedState;
+
 	// dynamically allocated array of control points, size is _width*_height
 	PatchControlArray _ctrl;			// the true control array
 	PatchControlArray _ctrlTransformed;	// a temporary control array used during transformations, so that the
 										// changes can be reverted and overwritten by <_ctrl>
 
-	// The tesselation for this patch
-	PatchTesselation _mesh;
+	// The tesselation for this patch, possibly shared with other patches
+	PatchTesselationPtr _mesh;
+
+	// The tesselation's vertices are relative to this point (the first control point)
+	Vector3 _meshOrigin;
 
 	// The OpenGL renderables for three rendering modes
 	RenderablePatchSolid _solidRenderable;
@@ -135,7 +142,7 @@ public:
 
 	// Implementation of the abstract method of SelectionTestable
 	// Called to test if the patch can be selected by the mouse pointer
-	void testSelect(Selector& selector, SelectionTest& test);
+	void testSelect(Selector& selector, SelectionTest& test, const Matrix4& localToWorld);
 
 	// Transform this patch as defined by the transformation matrix <matrix>
 	void transform(const Matrix4& matrix);
@@ -193,7 +200,8 @@ public:
 		return _ctrl.end();
 	}
 
-	PatchTesselation& getTesselation();
+	// The tesselated mesh, its vertex positions are relative to the first control point
+	const PatchTesselation& getTesselation();
 
 	// Returns a copy of the tesselated geometry
 	PatchMesh getTesselatedPatchMesh() const override;
@@ -333,6 +341,9 @@ public:
 	// Revert the state of this patch to the one that has been saved in the UndoMemento
 	void importState(const IUndoMementoPtr& state) override;
 
+	// Recreates a state moved out of memory by the UndoSystem
+	IUndoMementoPtr readState(std::istream& stream) const override;
+
 	/** greebo: Gets whether this patch is a patchDef3 (fixed tesselation)
 	 */
 	bool subdivisionsFixed() const override;
@@ -355,12 +366,30 @@ public:
 	// Static signal holder, signal is emitted after any patch texture has changed
 	static sigc::signal<void>& signal_patchTextureChanged();
 
+	/**
+	 * Updates the tesselation of all given patches which have been changed,
+	 * with the same result as calling updateTesselation() on each of them.
+	 * The meshes are generated by worker threads, the bounds and renderables
+	 * are updated in the calling thread afterwards.
+	 */
+	static void updateTesselations(const std::vector<Patch*>& patches);
+
 private:
 	// This notifies the surfaceinspector/patchinspector about the texture change
 	void textureChanged();
 
 	void updateTesselation();
 
+	// Resets the tesselation of an invalid patch
+	void clearTesselation();
+
+	// Tesselates the control points into the mesh. This doesn't touch anything
+	// outside this patch, so it can be called for different patches concurrently.
+	void generateTesselation();
+
+	// Updates the bounds, the control point vertices and the renderables after generateTesselation()
+	void onTesselationGenerated();
+
 	// greebo: checks, if the shader name is valid
 	void check_shader();
 
@@ -5,6 +5,7 @@
 #include "ieventmanager.h"
 #include "ipreferencesystem.h"
 #include "itextstream.h"
+#include "iworkerpool.h"
 #include "i18n.h"
 
 #include "PatchNode.h"
@@ -47,6 +48,7 @@ const StringSet& Doom3PatchCreator::getDependencies() const
 	if (_dependencies.empty())
 	{
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_WORKERPOOL);
 	}
 
 	return _dependencies;
@@ -164,6 +166,7 @@ const StringSet& Doom3PatchDef2Creator::getDependencies() const
 	{
 		_dependencies.insert(MODULE_RENDERSYSTEM);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_WORKERPOOL);
 	}
 
 	return _dependencies;
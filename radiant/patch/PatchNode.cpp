@@ -127,9 +127,8 @@ void PatchNode::testSelect(Selector& selector, SelectionTest& test) {
 	if (!isVisible())
 		return;
 
-    test.BeginMesh(localToWorld(), true);
     // Pass the selection test call to the patch
-    m_patch.testSelect(selector, test);
+    m_patch.testSelect(selector, test, localToWorld());
 }
 
 void PatchNode::selectPlanes(Selector& selector, SelectionTest& test, const PlaneCallback& selectedPlaneCallback) {
@@ -277,6 +276,10 @@ bool PatchNode::intersectsLight(const RendererLight& light) const {
 	return light.intersectsAABB(worldAABB());
 }
 
+AABB PatchNode::getLitObjectBounds() const {
+	return worldAABB();
+}
+
 void PatchNode::renderSolid(RenderableCollector& collector, const VolumeTest& volume) const
 {
 	// Don't render invisible shaders
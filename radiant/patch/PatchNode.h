@@ -124,6 +124,7 @@ public:
 
 	// LitObject implementation
 	bool intersectsLight(const RendererLight& light) const override;
+	AABB getLitObjectBounds() const override;
 
 	// Renderable implementation
 
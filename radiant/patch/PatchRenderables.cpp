@@ -1,5 +1,22 @@
 #include "PatchRenderables.h"
 
+namespace
+{
+    // The tesselation is relative to the patch origin, the buffers get the absolute positions
+    template<typename VertexBuffer_T>
+    void addTranslatedVertices(VertexBuffer_T& buffer, const std::vector<ArbitraryMeshVertex>& vertices, const Vector3& origin)
+    {
+        std::vector<ArbitraryMeshVertex> translated(vertices);
+
+        for (ArbitraryMeshVertex& vertex : translated)
+        {
+            vertex.vertex += origin;
+        }
+
+        buffer.addVertices(translated.begin(), translated.end());
+    }
+}
+
 void RenderablePatchWireframe::render(const RenderInfo& info) const
 {
     // No colour changing
@@ -9,7 +26,7 @@ void RenderablePatchWireframe::render(const RenderInfo& info) const
         glColor3f(1, 1, 1);
     }
 
-    if (_tess.vertices.empty()) return;
+    if (_tess->vertices.empty()) return;
 
     if (_needsUpdate)
     {
@@ -17,15 +34,15 @@ void RenderablePatchWireframe::render(const RenderInfo& info) const
 
         // Create a VBO and add the vertex data
         VertexBuffer_T currentVBuf;
-        currentVBuf.addVertices(_tess.vertices.begin(), _tess.vertices.end());
+        addTranslatedVertices(currentVBuf, _tess->vertices, _origin);
 
         // Submit index batches
-        const RenderIndex* strip_indices = &_tess.indices.front();
+        const RenderIndex* strip_indices = &_tess->indices.front();
         for (std::size_t i = 0;
-            i < _tess.numStrips;
-            i++, strip_indices += _tess.lenStrips)
+            i < _tess->numStrips;
+            i++, strip_indices += _tess->lenStrips)
         {
-            currentVBuf.addIndexBatch(strip_indices, _tess.lenStrips);
+            currentVBuf.addIndexBatch(strip_indices, _tess->lenStrips);
         }
 
         // Render all index batches
@@ -40,14 +57,15 @@ void RenderablePatchWireframe::queueUpdate()
     _needsUpdate = true;
 }
 
-RenderablePatchSolid::RenderablePatchSolid(PatchTesselation& tess) :
+RenderablePatchSolid::RenderablePatchSolid(const PatchTesselationPtr& tess, const Vector3& origin) :
     _tess(tess),
+    _origin(origin),
     _needsUpdate(true)
 {}
 
 void RenderablePatchSolid::render(const RenderInfo& info) const
 {
-    if (_tess.vertices.empty() || _tess.indices.empty()) return;
+    if (_tess->vertices.empty() || _tess->indices.empty()) return;
 
     if (!info.checkFlag(RENDER_BUMP))
     {
@@ -68,15 +86,15 @@ void RenderablePatchSolid::render(const RenderInfo& info) const
 
         // Add vertex geometry to vertex buffer
         VertexBuffer_T currentVBuf;
-        currentVBuf.addVertices(_tess.vertices.begin(), _tess.vertices.end());
+        addTranslatedVertices(currentVBuf, _tess->vertices, _origin);
 
         // Submit indices
-        const RenderIndex* strip_indices = &_tess.indices.front();
+        const RenderIndex* strip_indices = &_tess->indices.front();
         for (std::size_t i = 0;
-            i < _tess.numStrips;
-            i++, strip_indices += _tess.lenStrips)
+            i < _tess->numStrips;
+            i++, strip_indices += _tess->lenStrips)
         {
-            currentVBuf.addIndexBatch(strip_indices, _tess.lenStrips);
+            currentVBuf.addIndexBatch(strip_indices, _tess->lenStrips);
         }
 
         // Render all batches
@@ -101,8 +119,9 @@ const ShaderPtr& RenderablePatchVectorsNTB::getShader() const
 	return _shader;
 }
 
-RenderablePatchVectorsNTB::RenderablePatchVectorsNTB(const PatchTesselation& tess) :
-	_tess(tess)
+RenderablePatchVectorsNTB::RenderablePatchVectorsNTB(const PatchTesselationPtr& tess, const Vector3& origin) :
+	_tess(tess),
+	_origin(origin)
 {}
 
 void RenderablePatchVectorsNTB::setRenderSystem(const RenderSystemPtr& renderSystem)
@@ -121,12 +140,15 @@ void RenderablePatchVectorsNTB::setRenderSystem(const RenderSystemPtr& renderSys
 
 void RenderablePatchVectorsNTB::render(const RenderInfo& info) const
 {
-	if (_tess.vertices.empty()) return;
+	if (_tess->vertices.empty()) return;
 
 	glBegin(GL_LINES);
 
-	for (const ArbitraryMeshVertex& v : _tess.vertices)
+	for (const ArbitraryMeshVertex& meshVertex : _tess->vertices)
 	{
+		ArbitraryMeshVertex v(meshVertex);
+		v.vertex += _origin;
+
 		Vector3 end;
 
 		glColor3f(0, 0, 1);
@@ -16,8 +16,9 @@ class RenderablePatchWireframe :
 	public OpenGLRenderable
 {
 protected:
-	// Geometry source
-	const PatchTesselation& _tess;
+	// Geometry source, refers to the owning patch's tesselation and its origin
+	const PatchTesselationPtr& _tess;
+	const Vector3& _origin;
 
 	// VertexBuffer for rendering
 	typedef render::IndexedVertexBuffer<Vertex3f> VertexBuffer_T;
@@ -26,8 +27,9 @@ protected:
 	mutable bool _needsUpdate;
 
 public:
-	RenderablePatchWireframe(const PatchTesselation& tess) :
+	RenderablePatchWireframe(const PatchTesselationPtr& tess, const Vector3& origin) :
 		_tess(tess),
+		_origin(origin),
 		_needsUpdate(true)
 	{ }
 
@@ -43,8 +45,8 @@ class RenderablePatchFixedWireframe :
 	public RenderablePatchWireframe
 {
 public:
-    RenderablePatchFixedWireframe(PatchTesselation& tess) : 
-		RenderablePatchWireframe(tess)
+    RenderablePatchFixedWireframe(const PatchTesselationPtr& tess, const Vector3& origin) : 
+		RenderablePatchWireframe(tess, origin)
     {}
 };
 
@@ -52,8 +54,9 @@ public:
 class RenderablePatchSolid :
 	public OpenGLRenderable
 {
-    // Geometry source
-	PatchTesselation& _tess;
+    // Geometry source, refers to the owning patch's tesselation and its origin
+	const PatchTesselationPtr& _tess;
+	const Vector3& _origin;
 
     // VertexBuffer for rendering
     typedef render::IndexedVertexBuffer<ArbitraryMeshVertex> VertexBuffer_T;
@@ -62,7 +65,7 @@ class RenderablePatchSolid :
     mutable bool _needsUpdate;
 
 public:
-	RenderablePatchSolid(PatchTesselation& tess);
+	RenderablePatchSolid(const PatchTesselationPtr& tess, const Vector3& origin);
 
 	void render(const RenderInfo& info) const;
 
@@ -75,14 +78,15 @@ class RenderablePatchVectorsNTB :
 {
 private:
     std::vector<VertexCb> _vertices;
-	const PatchTesselation& _tess;
+	const PatchTesselationPtr& _tess;
+	const Vector3& _origin;
 
 	ShaderPtr _shader;
 
 public:
 	const ShaderPtr& getShader() const;
 
-	RenderablePatchVectorsNTB(const PatchTesselation& tess);
+	RenderablePatchVectorsNTB(const PatchTesselationPtr& tess, const Vector3& origin);
 
 	void setRenderSystem(const RenderSystemPtr& renderSystem);
 
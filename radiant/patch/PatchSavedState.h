@@ -1,22 +1,36 @@
 #pragma once
 
 #include "PatchControl.h"
+#include "stream/utils.h"
+#include <memory>
+#include <utility>
+#include <vector>
 
 /* greebo: This is a structure that is allocated on the heap and contains all the state
  * information of a patch. This information is used by the UndoSystem to save the current
  * patch state and to revert it on request.
+ *
+ * The control points are not copied for every state: each state refers to a full copy
+ * of the control grid (the keyframe) and stores only the controls differing from it.
+ * The keyframe and the material name are shared with the previous state of the same
+ * patch, a new keyframe is only taken if the changes would get too large.
  */
-class SavedState : 
+class SavedState :
 	public IUndoMemento
 {
 public:
+	typedef std::pair<std::size_t, PatchControl> ChangedControl;
+
 	// The members to store the state information
 	std::size_t m_width, m_height;
-	PatchControlArray m_ctrl;
+	std::shared_ptr<const PatchControlArray> _keyframe;
+	std::vector<ChangedControl> _changedControls;
 	bool m_patchDef3;
 	std::size_t m_subdivisions_x;
 	std::size_t m_subdivisions_y;
-    std::string _materialName;
+	std::shared_ptr<const std::string> _materialName;
+
+	std::size_t _memoryUsage;
 
 	// Constructor
 	SavedState(
@@ -26,14 +40,145 @@ public:
 		bool patchDef3,
 		std::size_t subdivisions_x,
 		std::size_t subdivisions_y,
-        const std::string& materialName
+        const std::string& materialName,
+		const std::shared_ptr<SavedState>& previous
 	) :
 		m_width(width),
 		m_height(height),
-		m_ctrl(ctrl),
 		m_patchDef3(patchDef3),
 		m_subdivisions_x(subdivisions_x),
 		m_subdivisions_y(subdivisions_y),
-        _materialName(materialName)
-    {}
+		_memoryUsage(sizeof(SavedState))
+    {
+		if (previous && previous->_keyframe->size() == ctrl.size())
+		{
+			storeChangedControls(previous->_keyframe, ctrl);
+		}
+
+		if (!_keyframe)
+		{
+			_keyframe = std::make_shared<const PatchControlArray>(ctrl);
+		}
+
+		if (previous && *previous->_materialName == materialName)
+		{
+			_materialName = previous->_materialName;
+		}
+		else
+		{
+			_materialName = std::make_shared<const std::string>(materialName);
+		}
+	}
+
+	// Returns the saved control grid
+	PatchControlArray getControls() const
+	{
+		PatchControlArray ctrl(*_keyframe);
+
+		for (const ChangedControl& changed : _changedControls)
+		{
+			ctrl[changed.first] = changed.second;
+		}
+
+		return ctrl;
+	}
+
+	std::size_t getMemoryUsage() const override
+	{
+		return _memoryUsage;
+	}
+
+	void foreachSharedData(const std::function<void(const void*, std::size_t)>& functor) const override
+	{
+		functor(_keyframe.get(), sizeof(PatchControlArray) + _keyframe->capacity() * sizeof(PatchControl));
+		functor(_materialName.get(), sizeof(std::string) + _materialName->capacity());
+	}
+
+	// Writes the full control grid, the keyframe isn't shared with the state read back
+	bool writeTo(std::ostream& stream) const override
+	{
+		stream::writeNative<std::uint64_t>(stream, m_width);
+		stream::writeNative<std::uint64_t>(stream, m_height);
+
+		PatchControlArray ctrl = getControls();
+		stream::writeNative<std::uint64_t>(stream, ctrl.size());
+
+		for (const PatchControl& control : ctrl)
+		{
+			stream::writeNative(stream, control);
+		}
+
+		stream::writeNative(stream, m_patchDef3);
+		stream::writeNative<std::uint64_t>(stream, m_subdivisions_x);
+		stream::writeNative<std::uint64_t>(stream, m_subdivisions_y);
+		stream::writeNativeString(stream, *_materialName);
+
+		return true;
+	}
+
+	// Reads a state written by writeTo(), returns NULL on failure
+	static std::shared_ptr<SavedState> ReadFrom(std::istream& stream)
+	{
+		std::uint64_t width, height, numControls;
+
+		if (!stream::readNative(stream, width) ||
+			!stream::readNative(stream, height) ||
+			!stream::readNative(stream, numControls))
+		{
+			return std::shared_ptr<SavedState>();
+		}
+
+		PatchControlArray ctrl(static_cast<std::size_t>(numControls));
+
+		for (PatchControl& control : ctrl)
+		{
+			if (!stream::readNative(stream, control)) return std::shared_ptr<SavedState>();
+		}
+
+		bool patchDef3;
+		std::uint64_t subdivisionsX, subdivisionsY;
+		std::string materialName;
+
+		if (!stream::readNative(stream, patchDef3) ||
+			!stream::readNative(stream, subdivisionsX) ||
+			!stream::readNative(stream, subdivisionsY) ||
+			!stream::readNativeString(stream, materialName))
+		{
+			return std::shared_ptr<SavedState>();
+		}
+
+		return std::make_shared<SavedState>(static_cast<std::size_t>(width), static_cast<std::size_t>(height),
+			ctrl, patchDef3, static_cast<std::size_t>(subdivisionsX), static_cast<std::size_t>(subdivisionsY),
+			materialName, std::shared_ptr<SavedState>());
+	}
+
+private:
+	// Refers to the given keyframe, unless more than a quarter of the controls differ from it
+	void storeChangedControls(const std::shared_ptr<const PatchControlArray>& keyframe, const PatchControlArray& ctrl)
+	{
+		std::size_t maxChanges = ctrl.size() / 4;
+
+		for (std::size_t i = 0; i < ctrl.size(); ++i)
+		{
+			const PatchControl& control = (*keyframe)[i];
+
+			if (control.vertex == ctrl[i].vertex && control.texcoord == ctrl[i].texcoord)
+			{
+				continue;
+			}
+
+			if (_changedControls.size() == maxChanges)
+			{
+				_changedControls.clear();
+				return;
+			}
+
+			_changedControls.emplace_back(i, ctrl[i]);
+		}
+
+		_changedControls.shrink_to_fit();
+		_memoryUsage += _changedControls.capacity() * sizeof(ChangedControl);
+
+		_keyframe = keyframe;
+	}
 };
@@ -1,6 +1,7 @@
 #include "PatchTesselation.h"
 
 #include "Patch.h"
+#include "BezierPatchSampler.h"
 
 void PatchTesselation::clear()
 {
@@ -192,89 +193,6 @@ void PatchTesselation::generateNormals()
 	}
 }
 
-void PatchTesselation::sampleSinglePatchPoint(const ArbitraryMeshVertex ctrl[3][3], float u, float v, ArbitraryMeshVertex& out) const
-{
-	float vCtrl[3][8];
-
-	// find the control points for the v coordinate
-	for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
-	{
-		for (std::size_t axis = 0; axis < 8; axis++)
-		{
-			float a, b, c;
-
-			if (axis < 3)
-			{
-				a = ctrl[0][vPoint].vertex[axis];
-				b = ctrl[1][vPoint].vertex[axis];
-				c = ctrl[2][vPoint].vertex[axis];
-			}
-			else if (axis < 6)
-			{
-				a = ctrl[0][vPoint].normal[axis - 3];
-				b = ctrl[1][vPoint].normal[axis - 3];
-				c = ctrl[2][vPoint].normal[axis - 3];
-			}
-			else
-			{
-				a = ctrl[0][vPoint].texcoord[axis - 6];
-				b = ctrl[1][vPoint].texcoord[axis - 6];
-				c = ctrl[2][vPoint].texcoord[axis - 6];
-			}
-
-			float qA = a - 2.0f * b + c;
-			float qB = 2.0f * b - 2.0f * a;
-			float qC = a;
-
-			vCtrl[vPoint][axis] = qA * u * u + qB * u + qC;
-		}
-	}
-
-	// interpolate the v value
-	for (std::size_t axis = 0; axis < 8; axis++)
-	{
-		float a = vCtrl[0][axis];
-		float b = vCtrl[1][axis];
-		float c = vCtrl[2][axis];
-		float qA = a - 2.0f * b + c;
-		float qB = 2.0f * b - 2.0f * a;
-		float qC = a;
-
-		if (axis < 3)
-		{
-			out.vertex[axis] = qA * v * v + qB * v + qC;
-		}
-		else if (axis < 6)
-		{
-			out.normal[axis - 3] = qA * v * v + qB * v + qC;
-		}
-		else
-		{
-			out.texcoord[axis - 6] = qA * v * v + qB * v + qC;
-		}
-	}
-}
-
-void PatchTesselation::sampleSinglePatch(const ArbitraryMeshVertex ctrl[3][3], 
-	std::size_t baseCol, std::size_t baseRow,
-	std::size_t w, std::size_t horzSub, std::size_t vertSub,
-	std::vector<ArbitraryMeshVertex>& outVerts) const
-{
-	horzSub++;
-	vertSub++;
-
-	for (std::size_t i = 0; i < horzSub; i++)
-	{
-		for (std::size_t j = 0; j < vertSub; j++)
-		{
-			float u = static_cast<float>(i) / (horzSub - 1);
-			float v = static_cast<float>(j) / (vertSub - 1);
-
-			sampleSinglePatchPoint(ctrl, u, v, outVerts[((baseRow + j) * w) + i + baseCol]);
-		}
-	}
-}
-
 void PatchTesselation::subdivideMeshFixed(std::size_t subdivX, std::size_t subdivY)
 {
 	std::size_t outWidth = ((width - 1) / 2 * subdivX) + 1;
@@ -285,6 +203,9 @@ void PatchTesselation::subdivideMeshFixed(std::size_t subdivX, std::size_t subdi
 	std::size_t baseCol = 0;
 	ArbitraryMeshVertex sample[3][3];
 
+	// All 3x3 sub-patches are sampled at the same parameters
+	BezierPatchSampler sampler(subdivX, subdivY);
+
 	for (std::size_t i = 0; i + 2 < width; i += 2)
 	{
 		std::size_t baseRow = 0;
@@ -299,7 +220,7 @@ void PatchTesselation::subdivideMeshFixed(std::size_t subdivX, std::size_t subdi
 				}
 			}
 
-			sampleSinglePatch(sample, baseCol, baseRow, outWidth, subdivX, subdivY, dv);
+			sampler.sample(sample, &dv[baseRow * outWidth + baseCol], outWidth);
 
 			baseRow += subdivY;
 		}
@@ -2,6 +2,7 @@
 
 #include "render.h"
 #include "PatchControl.h"
+#include <memory>
 
 struct FaceTangents;
 
@@ -63,10 +64,9 @@ private:
 	static void lerpVert(const ArbitraryMeshVertex& a, const ArbitraryMeshVertex& b, ArbitraryMeshVertex&out);
 	static Vector3 projectPointOntoVector(const Vector3& point, const Vector3& vStart, const Vector3& vEnd);
 
-	void sampleSinglePatch(const ArbitraryMeshVertex ctrl[3][3], std::size_t baseCol, std::size_t baseRow, 
-		std::size_t width, std::size_t horzSub, std::size_t vertSub, 
-		std::vector<ArbitraryMeshVertex>& outVerts) const;
-	void sampleSinglePatchPoint(const ArbitraryMeshVertex ctrl[3][3], float u, float v, ArbitraryMeshVertex& out) const;
 	void deriveTangents();
 	void deriveFaceTangents(std::vector<FaceTangents>& faceTangents);
 };
+
+// Tesselations are immutable once generated, patches with the same geometry share them
+typedef std::shared_ptr<const PatchTesselation> PatchTesselationPtr;
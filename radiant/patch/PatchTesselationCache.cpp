@@ -0,0 +1,147 @@
+#include "PatchTesselationCache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+	// Below this size the expired entries are left alone
+	const std::size_t MIN_PURGE_THRESHOLD = 1024;
+
+	inline void combineHash(std::size_t& seed, double value)
+	{
+		seed ^= std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+}
+
+bool PatchTesselationCache::Key::operator==(const Key& other) const
+{
+	if (hash != other.hash || width != other.width || height != other.height ||
+		subdivisionsFixed != other.subdivisionsFixed || (subdivisionsFixed && subdivisions != other.subdivisions) ||
+		controlPoints.size() != other.controlPoints.size())
+	{
+		return false;
+	}
+
+	for (std::size_t i = 0; i < controlPoints.size(); ++i)
+	{
+		if (controlPoints[i].vertex != other.controlPoints[i].vertex ||
+			controlPoints[i].texcoord != other.controlPoints[i].texcoord)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+PatchTesselationCache::PatchTesselationCache() :
+	_purgeThreshold(MIN_PURGE_THRESHOLD)
+{}
+
+PatchTesselationPtr PatchTesselationCache::getTesselation(std::size_t width, std::size_t height,
+	const PatchControlArray& controlPoints, bool subdivisionsFixed, const Subdivisions& subdivisions)
+{
+	Key key;
+	key.width = width;
+	key.height = height;
+	key.subdivisionsFixed = subdivisionsFixed;
+	key.subdivisions = subdivisions;
+	key.controlPoints = controlPoints;
+
+	// Key the shape of the patch, not its location
+	if (!controlPoints.empty())
+	{
+		Vector3 origin = controlPoints.front().vertex;
+
+		for (PatchControl& control : key.controlPoints)
+		{
+			control.vertex -= origin;
+		}
+	}
+
+	key.hash = 0;
+	combineHash(key.hash, static_cast<double>(width));
+	combineHash(key.hash, static_cast<double>(height));
+
+	// The subdivisions are only considered by fixed tesselations
+	if (subdivisionsFixed)
+	{
+		combineHash(key.hash, subdivisions.x());
+		combineHash(key.hash, subdivisions.y());
+	}
+
+	for (const PatchControl& control : key.controlPoints)
+	{
+		combineHash(key.hash, control.vertex.x());
+		combineHash(key.hash, control.vertex.y());
+		combineHash(key.hash, control.vertex.z());
+		combineHash(key.hash, control.texcoord.x());
+		combineHash(key.hash, control.texcoord.y());
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+
+		Entries::const_iterator found = _entries.find(key);
+
+		if (found != _entries.end())
+		{
+			PatchTesselationPtr existing = found->second.lock();
+
+			if (existing)
+			{
+				return existing;
+			}
+		}
+	}
+
+	// Generate the tesselation without holding the lock
+	std::shared_ptr<PatchTesselation> tesselation = std::make_shared<PatchTesselation>();
+	tesselation->generate(width, height, key.controlPoints, subdivisionsFixed, subdivisions);
+
+	std::lock_guard<std::mutex> lock(_lock);
+
+	std::weak_ptr<const PatchTesselation>& entry = _entries[key];
+
+	// Another thread might have been faster, prefer its tesselation
+	PatchTesselationPtr existing = entry.lock();
+
+	if (existing)
+	{
+		return existing;
+	}
+
+	entry = tesselation;
+
+	if (_entries.size() > _purgeThreshold)
+	{
+		purgeExpiredEntries();
+	}
+
+	return tesselation;
+}
+
+void PatchTesselationCache::purgeExpiredEntries()
+{
+	for (Entries::iterator i = _entries.begin(); i != _entries.end();)
+	{
+		if (i->second.expired())
+		{
+			i = _entries.erase(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	// Don't purge again before the number of entries has doubled
+	_purgeThreshold = std::max(MIN_PURGE_THRESHOLD, _entries.size() * 2);
+}
+
+PatchTesselationCache& PatchTesselationCache::Instance()
+{
+	static PatchTesselationCache _instance;
+	return _instance;
+}
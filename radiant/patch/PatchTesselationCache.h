@@ -0,0 +1,69 @@
+#pragma once
+
+#include "PatchTesselation.h"
+
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * Shares the tesselations of patches having the same shape and subdivision
+ * settings, like the patches of cloned pillars or arches, or a patch switching
+ * back and forth between two states during undo/redo. The tesselations are
+ * looked up by a hash of their input and are immutable, so the vertex and index
+ * buffers are shared between all patches using them.
+ *
+ * The control points are keyed relative to the first one, such that patches
+ * differing only by a translation share their tesselation. The vertices of
+ * the tesselations are relative to the first control point as well, the
+ * patches apply this offset when using them.
+ *
+ * The cache only keeps weak references, a tesselation is released as soon as
+ * no patch refers to it anymore. It can be used by several threads at once.
+ */
+class PatchTesselationCache
+{
+private:
+	struct Key
+	{
+		std::size_t width;
+		std::size_t height;
+		bool subdivisionsFixed;
+		Subdivisions subdivisions;
+		PatchControlArray controlPoints; // relative to the first control point
+
+		// Calculated from the values above
+		std::size_t hash;
+
+		bool operator==(const Key& other) const;
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const
+		{
+			return key.hash;
+		}
+	};
+
+	typedef std::unordered_map<Key, std::weak_ptr<const PatchTesselation>, KeyHash> Entries;
+	Entries _entries;
+
+	// Expired entries are purged once the map grows beyond this size
+	std::size_t _purgeThreshold;
+
+	std::mutex _lock;
+
+public:
+	PatchTesselationCache();
+
+	// Returns the tesselation for the given input, which is only generated if it isn't cached already.
+	// The vertices of the tesselation are relative to the first control point.
+	PatchTesselationPtr getTesselation(std::size_t width, std::size_t height,
+		const PatchControlArray& controlPoints, bool subdivisionsFixed, const Subdivisions& subdivisions);
+
+	// Contains the static instance used by all patches
+	static PatchTesselationCache& Instance();
+
+private:
+	void purgeExpiredEntries();
+};
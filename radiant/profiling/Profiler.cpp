@@ -0,0 +1,245 @@
+#include "Profiler.h"
+
+#include "itextstream.h"
+#include "modulesystem/StaticModule.h"
+#include "string/json.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <fmt/format.h>
+
+namespace profiling
+{
+
+namespace
+{
+	// Zones are kept for this number of frames...
+	const std::size_t MAX_FRAMES = 120;
+
+	// ...as long as they fit into the buffer of their thread
+	const std::size_t MAX_ZONES_PER_THREAD = 1 << 16;
+
+	// Gives up the buffer of the calling thread when the thread finishes
+	struct ThreadRegistration
+	{
+		Profiler::ThreadBufferPtr buffer;
+
+		~ThreadRegistration()
+		{
+			if (buffer)
+			{
+				buffer->active = false;
+			}
+		}
+	};
+
+	thread_local ThreadRegistration _threadRegistration;
+}
+
+Profiler::Profiler() :
+	_startTime(Clock::now()),
+	_frame(0)
+{}
+
+void Profiler::beginZone(const char* name)
+{
+	ThreadBuffer& buffer = getThreadBuffer();
+
+	buffer.openZones.push_back(OpenZone{ name, getTime(), _frame.load(std::memory_order_relaxed) });
+}
+
+void Profiler::endZone()
+{
+	std::int64_t end = getTime();
+	ThreadBuffer& buffer = getThreadBuffer();
+
+	if (buffer.openZones.empty()) return;
+
+	const OpenZone& open = buffer.openZones.back();
+	Zone zone{ open.name, open.start, end - open.start, buffer.openZones.size() - 1, open.frame };
+
+	buffer.openZones.pop_back();
+
+	std::lock_guard<std::mutex> lock(buffer.lock);
+
+	if (buffer.zones.size() < MAX_ZONES_PER_THREAD)
+	{
+		buffer.zones.push_back(zone);
+	}
+	else
+	{
+		buffer.zones[buffer.nextZone] = zone;
+	}
+
+	buffer.nextZone = (buffer.nextZone + 1) % MAX_ZONES_PER_THREAD;
+}
+
+void Profiler::endFrame()
+{
+	std::lock_guard<std::mutex> lock(_frameLock);
+
+	std::size_t frame = _frame.load();
+
+	if (_frameEnds.size() < MAX_FRAMES)
+	{
+		_frameEnds.push_back(getTime());
+	}
+	else
+	{
+		_frameEnds[frame % MAX_FRAMES] = getTime();
+	}
+
+	_frame = frame + 1;
+}
+
+void Profiler::exportChromeTrace(std::ostream& stream)
+{
+	std::size_t currentFrame = _frame.load();
+	std::size_t firstFrame = currentFrame >= MAX_FRAMES ? currentFrame - MAX_FRAMES + 1 : 0;
+
+	std::vector<ThreadBufferPtr> threads;
+	{
+		std::lock_guard<std::mutex> lock(_threadLock);
+		threads = _threads;
+	}
+
+	stream << "{\"traceEvents\":[\n";
+
+	bool first = true;
+
+	auto writeEvent = [&](const std::string& event)
+	{
+		stream << (first ? "" : ",\n") << event;
+		first = false;
+	};
+
+	std::vector<Zone> zones;
+
+	for (const ThreadBufferPtr& buffer : threads)
+	{
+		writeEvent(fmt::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{0},\"args\":{{\"name\":\"{1}\"}}}}",
+			buffer->index, string::escape_json(buffer->name)));
+
+		{
+			std::lock_guard<std::mutex> lock(buffer->lock);
+			zones = buffer->zones;
+		}
+
+		for (const Zone& zone : zones)
+		{
+			if (zone.frame < firstFrame) continue;
+
+			writeEvent(fmt::format("{{\"name\":\"{0}\",\"cat\":\"zone\",\"ph\":\"X\",\"ts\":{1:.3f},\"dur\":{2:.3f},\"pid\":1,\"tid\":{3}}}",
+				string::escape_json(zone.name), zone.start / 1000.0, zone.duration / 1000.0, buffer->index));
+		}
+	}
+
+	// Mark the ends of the recent frames across all threads
+	{
+		std::lock_guard<std::mutex> lock(_frameLock);
+
+		for (std::size_t frame = firstFrame; frame < currentFrame && frame < firstFrame + _frameEnds.size(); ++frame)
+		{
+			writeEvent(fmt::format("{{\"name\":\"Frame {0}\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"ts\":{1:.3f},\"pid\":1,\"tid\":0}}",
+				frame, _frameEnds[frame % MAX_FRAMES] / 1000.0));
+		}
+	}
+
+	stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+Profiler::ThreadBuffer& Profiler::getThreadBuffer()
+{
+	if (!_threadRegistration.buffer)
+	{
+		_threadRegistration.buffer = acquireThreadBuffer();
+	}
+
+	return *_threadRegistration.buffer;
+}
+
+Profiler::ThreadBufferPtr Profiler::acquireThreadBuffer()
+{
+	std::lock_guard<std::mutex> lock(_threadLock);
+
+	bool isMainThread = std::this_thread::get_id() == _mainThread;
+
+	// Take over the buffer of a finished thread, the main thread keeps its own
+	std::vector<ThreadBufferPtr>::iterator finished = std::find_if(_threads.begin(), _threads.end(),
+		[&](const ThreadBufferPtr& buffer) { return !buffer->active && !isMainThread; });
+
+	if (finished != _threads.end())
+	{
+		ThreadBufferPtr buffer = *finished;
+		buffer->openZones.clear();
+		buffer->active = true;
+
+		return buffer;
+	}
+
+	ThreadBufferPtr buffer = std::make_shared<ThreadBuffer>();
+	buffer->index = _threads.size();
+	buffer->name = isMainThread ? "Main thread" : fmt::format("Worker thread {0}", _threads.size());
+	buffer->nextZone = 0;
+	buffer->active = true;
+
+	_threads.push_back(buffer);
+
+	return buffer;
+}
+
+void Profiler::exportTraceCmd(const cmd::ArgumentList& args)
+{
+	if (args.size() != 1)
+	{
+		rWarning() << "Usage: ExportProfilerTrace <filename>" << std::endl;
+		return;
+	}
+
+	std::ofstream stream(args[0].getString());
+
+	if (!stream)
+	{
+		rError() << "Could not open " << args[0].getString() << " for writing" << std::endl;
+		return;
+	}
+
+	exportChromeTrace(stream);
+
+	rMessage() << "Profiler trace written to " << args[0].getString() << std::endl;
+}
+
+const std::string& Profiler::getName() const
+{
+	static std::string _name(MODULE_PROFILER);
+	return _name;
+}
+
+const StringSet& Profiler::getDependencies() const
+{
+	static StringSet _dependencies;
+
+	if (_dependencies.empty())
+	{
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
+	}
+
+	return _dependencies;
+}
+
+void Profiler::initialiseModule(const ApplicationContext& ctx)
+{
+	rMessage() << getName() << "::initialiseModule called." << std::endl;
+
+	// The modules are initialised by the main thread
+	_mainThread = std::this_thread::get_id();
+
+	GlobalCommandSystem().addCommand("ExportProfilerTrace",
+		std::bind(&Profiler::exportTraceCmd, this, std::placeholders::_1), cmd::ARGTYPE_STRING);
+}
+
+// Static module instance
+module::StaticModule<Profiler> profilerModule;
+
+} // namespace profiling
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "iprofiler.h"
+#include "icommandsystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace profiling
+{
+
+/**
+ * IProfiler implementation. Each thread records its closed zones into a ring
+ * buffer of its own, which is only locked against concurrent exports. Zones
+ * belonging to frames older than the last few ones are left out of the
+ * export and eventually overwritten.
+ *
+ * Threads don't keep their buffer when they finish, it's handed to the next
+ * new thread, such that short-lived worker threads don't pile up buffers.
+ */
+class Profiler :
+	public IProfiler
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	// A closed zone, times are nanoseconds since the profiler was started
+	struct Zone
+	{
+		const char* name;
+		std::int64_t start;
+		std::int64_t duration;
+		std::size_t depth;
+		std::size_t frame;
+	};
+
+	struct OpenZone
+	{
+		const char* name;
+		std::int64_t start;
+		std::size_t frame;
+	};
+
+	struct ThreadBuffer
+	{
+		// The number of this buffer, used as thread ID in the exported trace
+		std::size_t index;
+		std::string name;
+
+		// Guards the zones against the export
+		std::mutex lock;
+		std::vector<Zone> zones;
+		std::size_t nextZone;
+
+		// Only accessed by the owning thread
+		std::vector<OpenZone> openZones;
+
+		// False once the owning thread has finished
+		std::atomic<bool> active;
+	};
+	typedef std::shared_ptr<ThreadBuffer> ThreadBufferPtr;
+
+private:
+	Clock::time_point _startTime;
+	std::thread::id _mainThread;
+
+	std::mutex _threadLock;
+	std::vector<ThreadBufferPtr> _threads;
+
+	// The number of the current frame and the end times of the recent ones
+	std::atomic<std::size_t> _frame;
+	std::mutex _frameLock;
+	std::vector<std::int64_t> _frameEnds;
+
+public:
+	Profiler();
+
+	// IProfiler implementation
+	void beginZone(const char* name) override;
+	void endZone() override;
+	void endFrame() override;
+
+	// Writes the zones of the recent frames as Chrome trace events
+	void exportChromeTrace(std::ostream& stream);
+
+	// RegisterableModule implementation
+	const std::string& getName() const override;
+	const StringSet& getDependencies() const override;
+	void initialiseModule(const ApplicationContext& ctx) override;
+
+private:
+	ThreadBuffer& getThreadBuffer();
+	ThreadBufferPtr acquireThreadBuffer();
+
+	std::int64_t getTime() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _startTime).count();
+	}
+
+	void exportTraceCmd(const cmd::ArgumentList& args);
+};
+
+} // namespace profiling
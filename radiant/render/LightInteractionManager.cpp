@@ -0,0 +1,479 @@
+#include "LightInteractionManager.h"
+
+#include "math/AABB.h"
+#include "debugging/debugging.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace render
+{
+
+namespace
+{
+	// Edge length of the grid cells
+	const double CELL_SIZE = 512;
+
+	// Number of cells along each axis, covering the map limits of +/-65536.
+	// This needs to be a power of two, the light volumes are located by halving
+	// the whole grid down to single cells.
+	const int GRID_SIZE = 256;
+
+	// Objects and lights exceeding these are not stored in the grid
+	const std::size_t MAX_OBJECT_CELLS = 64;
+	const std::size_t MAX_LIGHT_CELLS = 4096;
+
+	inline std::int64_t getCellKey(int x, int y, int z)
+	{
+		return (static_cast<std::int64_t>(x + GRID_SIZE / 2) << 32) |
+			(static_cast<std::int64_t>(y + GRID_SIZE / 2) << 16) |
+			static_cast<std::int64_t>(z + GRID_SIZE / 2);
+	}
+
+	inline int getCellIndex(double coord)
+	{
+		return static_cast<int>(std::floor(coord / CELL_SIZE));
+	}
+
+	template<typename T>
+	void removeElement(std::vector<T*>& elements, T* element)
+	{
+		typename std::vector<T*>::iterator found = std::find(elements.begin(), elements.end(), element);
+
+		if (found != elements.end())
+		{
+			*found = elements.back();
+			elements.pop_back();
+		}
+	}
+}
+
+LightInteractionManager::ObjectLightList::ObjectLightList(LightInteractionManager& manager_, LitObject& object_) :
+	manager(manager_),
+	object(object_),
+	unbounded(false),
+	dirty(true),
+	lightsChanged(false),
+	visited(0)
+{}
+
+void LightInteractionManager::ObjectLightList::calculateIntersectingLights() const
+{
+	// The list is only const to its users, the manager updates it on demand
+	manager.updateObject(const_cast<ObjectLightList&>(*this));
+}
+
+void LightInteractionManager::ObjectLightList::setDirty()
+{
+	dirty = true;
+}
+
+void LightInteractionManager::ObjectLightList::insertLight(RendererLight& light)
+{
+	std::vector<RendererLight*>::iterator i = std::lower_bound(lights.begin(), lights.end(), &light);
+
+	if (i == lights.end() || *i != &light)
+	{
+		lights.insert(i, &light);
+	}
+
+	// Also if it's not new, the object might be checking the light volume on its own
+	lightsChanged = true;
+}
+
+void LightInteractionManager::ObjectLightList::removeLight(RendererLight& light)
+{
+	std::vector<RendererLight*>::iterator i = std::lower_bound(lights.begin(), lights.end(), &light);
+
+	if (i != lights.end() && *i == &light)
+	{
+		lights.erase(i);
+		lightsChanged = true;
+	}
+}
+
+void LightInteractionManager::ObjectLightList::forEachLight(const RendererLightCallback& callback) const
+{
+	calculateIntersectingLights();
+
+	for (RendererLight* light : lights)
+	{
+		callback(*light);
+	}
+}
+
+LightInteractionManager::LightInteractionManager() :
+	_visitCount(0)
+{}
+
+LightList& LightInteractionManager::attachLitObject(LitObject& object)
+{
+	return _objects.emplace(std::piecewise_construct,
+		std::forward_as_tuple(&object), std::forward_as_tuple(*this, object)).first->second;
+}
+
+void LightInteractionManager::detachLitObject(LitObject& object)
+{
+	std::unordered_map<LitObject*, ObjectLightList>::iterator found = _objects.find(&object);
+
+	if (found == _objects.end()) return;
+
+	unregisterObject(found->second);
+	_objects.erase(found);
+}
+
+void LightInteractionManager::litObjectChanged(LitObject& object)
+{
+	std::unordered_map<LitObject*, ObjectLightList>::iterator found = _objects.find(&object);
+	assert(found != _objects.end());
+
+	found->second.setDirty();
+}
+
+void LightInteractionManager::attachLight(RendererLight& light)
+{
+	ASSERT_MESSAGE(_lights.find(&light) == _lights.end(), "light could not be attached");
+
+	LightEntry& entry = _lights[&light];
+	entry.light = &light;
+	entry.unbounded = false;
+	entry.changed = false;
+	entry.visited = 0;
+
+	// The cells are located on the next update
+	lightChanged(light);
+}
+
+void LightInteractionManager::detachLight(RendererLight& light)
+{
+	std::unordered_map<RendererLight*, LightEntry>::iterator found = _lights.find(&light);
+	ASSERT_MESSAGE(found != _lights.end(), "light could not be detached");
+
+	LightEntry& entry = found->second;
+
+	if (entry.changed)
+	{
+		removeElement(_changedLights, &entry);
+	}
+
+	// Objects lit by this light are sharing a cell with it
+	++_visitCount;
+
+	forEachObjectNearLight(entry, [&](ObjectLightList& list)
+	{
+		list.removeLight(light);
+	});
+
+	unregisterLight(entry);
+	_lights.erase(found);
+}
+
+void LightInteractionManager::lightChanged(RendererLight& light)
+{
+	std::unordered_map<RendererLight*, LightEntry>::iterator found = _lights.find(&light);
+
+	if (found == _lights.end() || found->second.changed) return;
+
+	found->second.changed = true;
+	_changedLights.push_back(&found->second);
+}
+
+void LightInteractionManager::updateObject(ObjectLightList& list)
+{
+	updateChangedLights();
+
+	if (list.dirty)
+	{
+		list.dirty = false;
+
+		unregisterObject(list);
+		registerObject(list);
+
+		list.lights.clear();
+
+		std::size_t visitCount = ++_visitCount;
+
+		auto testLight = [&](LightEntry* entry)
+		{
+			if (entry->visited == visitCount) return;
+
+			entry->visited = visitCount;
+
+			if (list.object.intersectsLight(*entry->light))
+			{
+				list.lights.push_back(entry->light);
+			}
+		};
+
+		if (list.unbounded)
+		{
+			for (std::pair<RendererLight* const, LightEntry>& pair : _lights)
+			{
+				testLight(&pair.second);
+			}
+		}
+		else
+		{
+			for (CellKey key : list.cells)
+			{
+				std::unordered_map<CellKey, Cell>::iterator cell = _cells.find(key);
+
+				if (cell == _cells.end()) continue;
+
+				for (LightEntry* entry : cell->second.lights)
+				{
+					testLight(entry);
+				}
+			}
+
+			for (LightEntry* entry : _unboundedLights)
+			{
+				testLight(entry);
+			}
+		}
+
+		// Same order as the LinearLightList, which iterates over a set of light pointers
+		std::sort(list.lights.begin(), list.lights.end());
+		list.lightsChanged = true;
+	}
+
+	if (list.lightsChanged)
+	{
+		list.lightsChanged = false;
+
+		list.object.clearLights();
+
+		for (RendererLight* light : list.lights)
+		{
+			list.object.insertLight(*light);
+		}
+	}
+}
+
+void LightInteractionManager::updateChangedLights()
+{
+	if (_changedLights.empty()) return;
+
+	std::vector<LightEntry*> changedLights;
+	changedLights.swap(_changedLights);
+
+	for (LightEntry* entry : changedLights)
+	{
+		entry->changed = false;
+
+		// Drop the light from the objects around its old volume...
+		++_visitCount;
+
+		forEachObjectNearLight(*entry, [&](ObjectLightList& list)
+		{
+			list.removeLight(*entry->light);
+		});
+
+		unregisterLight(*entry);
+		registerLight(*entry);
+
+		// ...and test the ones around the new volume. Objects can only be lit by
+		// lights sharing one of their cells, which keeps the removal above complete.
+		++_visitCount;
+
+		forEachObjectNearLight(*entry, [&](ObjectLightList& list)
+		{
+			// Dirty objects are testing all their lights anyway
+			if (!list.dirty && list.object.intersectsLight(*entry->light))
+			{
+				list.insertLight(*entry->light);
+			}
+		});
+	}
+}
+
+template<typename Func>
+void LightInteractionManager::forEachObjectNearLight(const LightEntry& entry, Func func)
+{
+	std::size_t visitCount = _visitCount;
+
+	auto visit = [&](ObjectLightList* list)
+	{
+		if (list->visited == visitCount) return;
+
+		list->visited = visitCount;
+		func(*list);
+	};
+
+	if (entry.unbounded)
+	{
+		for (std::pair<LitObject* const, ObjectLightList>& pair : _objects)
+		{
+			visit(&pair.second);
+		}
+
+		return;
+	}
+
+	for (CellKey key : entry.cells)
+	{
+		std::unordered_map<CellKey, Cell>::iterator cell = _cells.find(key);
+
+		if (cell == _cells.end()) continue;
+
+		for (ObjectLightList* list : cell->second.objects)
+		{
+			visit(list);
+		}
+	}
+
+	for (ObjectLightList* list : _unboundedObjects)
+	{
+		visit(list);
+	}
+}
+
+void LightInteractionManager::registerObject(ObjectLightList& list)
+{
+	list.cells.clear();
+	list.unbounded = true;
+
+	AABB bounds = list.object.getLitObjectBounds();
+
+	if (bounds.isValid())
+	{
+		Vector3 min = bounds.origin - bounds.extents;
+		Vector3 max = bounds.origin + bounds.extents;
+
+		int minX = getCellIndex(min.x()), minY = getCellIndex(min.y()), minZ = getCellIndex(min.z());
+		int maxX = getCellIndex(max.x()), maxY = getCellIndex(max.y()), maxZ = getCellIndex(max.z());
+
+		bool insideGrid = minX >= -GRID_SIZE / 2 && minY >= -GRID_SIZE / 2 && minZ >= -GRID_SIZE / 2 &&
+			maxX < GRID_SIZE / 2 && maxY < GRID_SIZE / 2 && maxZ < GRID_SIZE / 2;
+
+		if (insideGrid && static_cast<std::size_t>(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1) <= MAX_OBJECT_CELLS)
+		{
+			list.unbounded = false;
+
+			for (int x = minX; x <= maxX; ++x)
+			{
+				for (int y = minY; y <= maxY; ++y)
+				{
+					for (int z = minZ; z <= maxZ; ++z)
+					{
+						list.cells.push_back(getCellKey(x, y, z));
+					}
+				}
+			}
+		}
+	}
+
+	if (list.unbounded)
+	{
+		_unboundedObjects.push_back(&list);
+		return;
+	}
+
+	for (CellKey key : list.cells)
+	{
+		_cells[key].objects.push_back(&list);
+	}
+}
+
+void LightInteractionManager::unregisterObject(ObjectLightList& list)
+{
+	if (list.unbounded)
+	{
+		removeElement(_unboundedObjects, &list);
+	}
+
+	for (CellKey key : list.cells)
+	{
+		std::unordered_map<CellKey, Cell>::iterator cell = _cells.find(key);
+
+		if (cell == _cells.end()) continue;
+
+		removeElement(cell->second.objects, &list);
+
+		if (cell->second.objects.empty() && cell->second.lights.empty())
+		{
+			_cells.erase(cell);
+		}
+	}
+
+	list.cells.clear();
+	list.unbounded = false;
+}
+
+void LightInteractionManager::registerLight(LightEntry& entry)
+{
+	entry.cells.clear();
+	entry.unbounded = !collectLightCells(*entry.light, -GRID_SIZE / 2, -GRID_SIZE / 2, -GRID_SIZE / 2,
+		GRID_SIZE, entry.cells);
+
+	if (entry.unbounded)
+	{
+		entry.cells.clear();
+		_unboundedLights.push_back(&entry);
+		return;
+	}
+
+	for (CellKey key : entry.cells)
+	{
+		_cells[key].lights.push_back(&entry);
+	}
+}
+
+void LightInteractionManager::unregisterLight(LightEntry& entry)
+{
+	if (entry.unbounded)
+	{
+		removeElement(_unboundedLights, &entry);
+	}
+
+	for (CellKey key : entry.cells)
+	{
+		std::unordered_map<CellKey, Cell>::iterator cell = _cells.find(key);
+
+		if (cell == _cells.end()) continue;
+
+		removeElement(cell->second.lights, &entry);
+
+		if (cell->second.objects.empty() && cell->second.lights.empty())
+		{
+			_cells.erase(cell);
+		}
+	}
+
+	entry.cells.clear();
+	entry.unbounded = false;
+}
+
+bool LightInteractionManager::collectLightCells(const RendererLight& light, int x, int y, int z, int size,
+	std::vector<CellKey>& cells) const
+{
+	double halfSize = size * CELL_SIZE * 0.5;
+	AABB block(Vector3(x * CELL_SIZE + halfSize, y * CELL_SIZE + halfSize, z * CELL_SIZE + halfSize),
+		Vector3(halfSize, halfSize, halfSize));
+
+	if (!light.intersectsAABB(block))
+	{
+		return true;
+	}
+
+	if (size == 1)
+	{
+		cells.push_back(getCellKey(x, y, z));
+		return cells.size() <= MAX_LIGHT_CELLS;
+	}
+
+	int half = size / 2;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		if (!collectLightCells(light, x + (i & 1 ? half : 0), y + (i & 2 ? half : 0), z + (i & 4 ? half : 0),
+			half, cells))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+} // namespace render
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "irender.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace render
+{
+
+/**
+ * Keeps track of the lights intersecting each lit object of the render system,
+ * replacing the LinearLightList which tests its object against every light as
+ * soon as any light changes.
+ *
+ * Lights and lit objects are registered in a shared uniform grid. The cells of
+ * an object are derived from its bounds, the ones of a light are found by
+ * testing the light volume against successively smaller blocks of the grid,
+ * using the same RendererLight::intersectsAABB() check the objects are using.
+ * Objects and lights covering too many cells are kept aside and are treated as
+ * overlapping everything.
+ *
+ * When a light changes, only the objects sharing a cell with the light's old or
+ * new volume are tested against this single light. When an object changes, it
+ * is tested against the lights sharing one of its cells. Like before, all this
+ * happens lazily when a light list is asked for its lights.
+ */
+class LightInteractionManager
+{
+private:
+	typedef std::int64_t CellKey;
+
+	struct LightEntry
+	{
+		RendererLight* light;
+
+		// The grid cells intersecting the light volume, unless unbounded is set
+		std::vector<CellKey> cells;
+		bool unbounded;
+
+		// Set while the light is waiting in the _changedLights list
+		bool changed;
+
+		std::size_t visited;
+	};
+
+	// The LightList handed out to each lit object
+	class ObjectLightList :
+		public LightList
+	{
+	public:
+		LightInteractionManager& manager;
+		LitObject& object;
+
+		// The lights intersecting the object, ordered by address
+		std::vector<RendererLight*> lights;
+
+		// The grid cells overlapped by the object, unless unbounded is set
+		std::vector<CellKey> cells;
+		bool unbounded;
+
+		// The object has been changed, its cells and lights need to be determined again
+		bool dirty;
+
+		// The lights need to be passed to the object again
+		bool lightsChanged;
+
+		std::size_t visited;
+
+		ObjectLightList(LightInteractionManager& manager_, LitObject& object_);
+
+		void calculateIntersectingLights() const override;
+		void setDirty() override;
+		void forEachLight(const RendererLightCallback& callback) const override;
+
+		// Adds or removes the given light, keeping the order
+		void insertLight(RendererLight& light);
+		void removeLight(RendererLight& light);
+	};
+
+	struct Cell
+	{
+		std::vector<ObjectLightList*> objects;
+		std::vector<LightEntry*> lights;
+	};
+
+	std::unordered_map<LitObject*, ObjectLightList> _objects;
+	std::unordered_map<RendererLight*, LightEntry> _lights;
+	std::unordered_map<CellKey, Cell> _cells;
+
+	std::vector<ObjectLightList*> _unboundedObjects;
+	std::vector<LightEntry*> _unboundedLights;
+
+	// Lights which have been attached or changed since the last update
+	std::vector<LightEntry*> _changedLights;
+
+	// Incremented for each pass over the grid, to visit each object or light once
+	std::size_t _visitCount;
+
+public:
+	LightInteractionManager();
+
+	LightList& attachLitObject(LitObject& object);
+	void detachLitObject(LitObject& object);
+	void litObjectChanged(LitObject& object);
+
+	void attachLight(RendererLight& light);
+	void detachLight(RendererLight& light);
+	void lightChanged(RendererLight& light);
+
+private:
+	// Brings the lights of the given object up to date
+	void updateObject(ObjectLightList& list);
+
+	// Tests the objects around each changed light against it
+	void updateChangedLights();
+
+	void registerObject(ObjectLightList& list);
+	void unregisterObject(ObjectLightList& list);
+	void registerLight(LightEntry& entry);
+	void unregisterLight(LightEntry& entry);
+
+	// Calls the given function once for each object sharing a cell with the light
+	template<typename Func>
+	void forEachObjectNearLight(const LightEntry& entry, Func func);
+
+	// Adds the cells within the given block which intersect the light volume,
+	// returns false if the light has been found to cover too many cells
+	bool collectLightCells(const RendererLight& light, int x, int y, int z, int size,
+		std::vector<CellKey>& cells) const;
+};
+
+} // namespace render
@@ -3,9 +3,12 @@
 #include "ishaders.h"
 #include "igl.h"
 #include "itextstream.h"
+#include "icommandsystem.h"
+#include "iprofiler.h"
 #include "math/Matrix4.h"
 #include "modulesystem/StaticModule.h"
 #include "backend/GLProgramFactory.h"
+#include "frontend/RenderFrontendBenchmark.h"
 #include "debugging/debugging.h"
 
 #include <functional>
@@ -42,7 +45,6 @@ OpenGLRenderSystem::OpenGLRenderSystem() :
     _glProgramFactory(std::make_shared<GLProgramFactory>()),
 	_currentShaderProgram(SHADER_PROGRAM_NONE),
 	_time(0),
-	m_lightsChanged(true),
 	m_traverseRenderablesMutex(false)
 {
 	// For the static default rendersystem, the MaterialManager is not existent yet,
@@ -120,6 +122,8 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
                                const Matrix4& projection,
                                const Vector3& viewer)
 {
+	PROFILE_ZONE("OpenGLRenderSystem::render");
+
 	glPushAttrib(GL_ALL_ATTRIB_BITS);
 
 	// Set the projection and modelview matrices
@@ -421,65 +425,32 @@ sigc::signal<void> OpenGLRenderSystem::signal_extensionsInitialised()
 
 LightList& OpenGLRenderSystem::attachLitObject(LitObject& object)
 {
-	return m_lightLists.insert(
-		LightLists::value_type(
-			&object,
-			LinearLightList(
-                object,
-                m_lights,
-                std::bind(
-                    &OpenGLRenderSystem::propagateLightChangedFlagToAllLights,
-                    this
-                )
-            )
-        )
-    ).first->second;
+	return _lightInteractions.attachLitObject(object);
 }
 
 void OpenGLRenderSystem::detachLitObject(LitObject& object) 
 {
-	m_lightLists.erase(&object);
+	_lightInteractions.detachLitObject(object);
 }
 
 void OpenGLRenderSystem::litObjectChanged(LitObject& object) 
 {
-	LightLists::iterator i = m_lightLists.find(&object);
-    assert(i != m_lightLists.end());
-
-	i->second.setDirty();
+	_lightInteractions.litObjectChanged(object);
 }
 
 void OpenGLRenderSystem::attachLight(RendererLight& light)
 {
-    ASSERT_MESSAGE(m_lights.find(&light) == m_lights.end(), "light could not be attached");
-    m_lights.insert(&light);
-    lightChanged(light);
+	_lightInteractions.attachLight(light);
 }
 
 void OpenGLRenderSystem::detachLight(RendererLight& light)
 {
-    ASSERT_MESSAGE(m_lights.find(&light) != m_lights.end(), "light could not be detached");
-    m_lights.erase(&light);
-    lightChanged(light);
+	_lightInteractions.detachLight(light);
 }
 
 void OpenGLRenderSystem::lightChanged(RendererLight& light)
 {
-    m_lightsChanged = true;
-}
-
-void OpenGLRenderSystem::propagateLightChangedFlagToAllLights()
-{
-    if (m_lightsChanged)
-    {
-    	m_lightsChanged = false;
-    	for (LightLists::iterator i = m_lightLists.begin();
-             i != m_lightLists.end();
-             ++i) 
-        {
-    		i->second.setDirty();
-    	}
-	}
+	_lightInteractions.lightChanged(light);
 }
 
 void OpenGLRenderSystem::insertSortedState(const OpenGLStates::value_type& val) {
@@ -527,6 +498,8 @@ const StringSet& OpenGLRenderSystem::getDependencies() const
 	{
 		_dependencies.insert(MODULE_SHADERSYSTEM);
 		_dependencies.insert(MODULE_OPENGL);
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_PROFILER);
 	}
 
 	return _dependencies;
@@ -546,6 +519,10 @@ void OpenGLRenderSystem::initialiseModule(const ApplicationContext& ctx)
 		realise();
 	}
 
+	GlobalCommandSystem().addCommand("BenchmarkRenderFrontend", benchmarkRenderFrontend,
+		cmd::Signature(cmd::ARGTYPE_STRING, cmd::ARGTYPE_INT|cmd::ARGTYPE_OPTIONAL,
+			cmd::ARGTYPE_STRING|cmd::ARGTYPE_OPTIONAL));
+
 	// greebo: Don't realise the module yet, this must wait
 	// until the shared GL context has been created (this
 	// happens as soon as the first GL widget has been realised).
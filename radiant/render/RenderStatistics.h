@@ -1,7 +1,7 @@
 #pragma once
 
 #include <wx/stopwatch.h>
-#include "string/string.h"
+#include "string/convert.h"
 
 namespace render
 {
@@ -13,6 +13,7 @@ class RenderStatistics
 	std::size_t _countPrims;
 	std::size_t _countStates;
 	std::size_t _countTransforms;
+	std::size_t _countAllocations;
 
 	wxStopWatch _timer;
 public:
@@ -21,6 +22,7 @@ public:
         _statStr = "prims: " + string::to_string(_countPrims) +
 				  " | states: " + string::to_string(_countStates) +
 				  " | transforms: "	+ string::to_string(_countTransforms) +
+				  " | allocs: " + string::to_string(_countAllocations) +
 				  " | msec: " + string::to_string(_timer.Time());
 
 		return _statStr;
@@ -31,10 +33,17 @@ public:
 		_countPrims = 0;
 		_countStates = 0;
 		_countTransforms = 0;
+		_countAllocations = 0;
 
 		_timer.Start();
 	}
 
+	// Memory allocations of the render buckets while collecting the frame
+	void addAllocations(std::size_t count)
+	{
+		_countAllocations += count;
+	}
+
 	static RenderStatistics& Instance()
     {
 		static RenderStatistics _instance;
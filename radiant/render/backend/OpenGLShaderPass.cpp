@@ -9,6 +9,7 @@
 #include "iglprogram.h"
 
 #include "debugging/render.h"
+#include "../RenderStatistics.h"
 
 namespace render
 {
@@ -571,7 +572,7 @@ void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
                                       const Matrix4& modelview,
                                       const RendererLight* light)
 {
-    _renderablesWithoutEntity.push_back(TransformedRenderable(renderable, modelview, light, NULL));
+    _renderables.add(renderable, modelview, nullptr, light);
 }
 
 void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
@@ -579,14 +580,7 @@ void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
                                       const IRenderEntity& entity,
                                       const RendererLight* light)
 {
-    RenderablesByEntity::iterator i = _renderables.find(&entity);
-
-    if (i == _renderables.end())
-    {
-        i = _renderables.insert(RenderablesByEntity::value_type(&entity, Renderables())).first;
-    }
-
-    i->second.push_back(TransformedRenderable(renderable, modelview, light, &entity));
+    _renderables.add(renderable, modelview, &entity, light);
 }
 
 // Render the bucket contents
@@ -604,27 +598,30 @@ void OpenGLShaderPass::render(OpenGLState& current,
     // Apply our state to the current state object
     applyState(current, flagsMask, viewer, time, NULL);
 
-    if (!_renderablesWithoutEntity.empty())
+    const RenderableBuckets::Renderables& renderablesWithoutEntity = _renderables.getRenderablesWithoutEntity();
+
+    if (!renderablesWithoutEntity.empty())
     {
-        renderAllContained(_renderablesWithoutEntity, current, viewer, time);
+        renderAllContained(renderablesWithoutEntity, current, viewer, time);
     }
 
-    for (RenderablesByEntity::const_iterator i = _renderables.begin();
-         i != _renderables.end();
-         ++i)
+    _renderables.forEachEntityBucket([&](const IRenderEntity& entity,
+                                         const RenderableBuckets::Renderables& renderables)
     {
         // Apply our state to the current state object
-        applyState(current, flagsMask, viewer, time, i->first);
+        applyState(current, flagsMask, viewer, time, &entity);
 
         if (!stateIsActive())
         {
-            continue;
+            return;
         }
 
-        renderAllContained(i->second, current, viewer, time);
-    }
+        renderAllContained(renderables, current, viewer, time);
+    });
+
+    RenderStatistics::Instance().addAllocations(_renderables.getAllocationCount());
 
-    _renderablesWithoutEntity.clear();
+    // Keep the buckets for the next frame
     _renderables.clear();
 }
 
@@ -691,25 +688,27 @@ void OpenGLShaderPass::setUpLightingCalculation(OpenGLState& current,
 }
 
 // Flush renderables
-void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
+void OpenGLShaderPass::renderAllContained(const RenderableBuckets::Renderables& renderables,
                                           OpenGLState& current,
                                           const Vector3& viewer,
                                           std::size_t time)
 {
-    // Keep a pointer to the last transform matrix and render entity used
+    // Keep a pointer to the last transform matrix and its index in the arena
     const Matrix4* transform = 0;
+    std::uint32_t transformIndex = 0;
 
     glPushMatrix();
 
     // Iterate over each transformed renderable in the vector
-    for (const TransformedRenderable& r : renderables)
+    for (const RenderableBuckets::Renderable& r : renderables)
     {
         // If the current iteration's transform matrix was different from the
         // last, apply it and store for the next iteration
         if (transform == NULL ||
-            (transform != r.transform && !transform->isAffineEqual(*r.transform)))
+            (transformIndex != r.transform && !transform->isAffineEqual(_renderables.getTransform(r.transform))))
         {
-            transform = r.transform;
+            transform = &_renderables.getTransform(r.transform);
+            transformIndex = r.transform;
             glPopMatrix();
             glPushMatrix();
             glMultMatrixd(*transform);
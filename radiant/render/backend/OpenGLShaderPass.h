@@ -2,12 +2,9 @@
 
 #include "math/Vector3.h"
 #include "iglrender.h"
-
-#include <vector>
-#include <map>
+#include "RenderableBuckets.h"
 
 /* FORWARD DECLS */
-class Matrix4;
 class OpenGLRenderable;
 class RendererLight;
 
@@ -30,44 +27,8 @@ class OpenGLShaderPass
 	// The state applied to this bucket
 	OpenGLState _glState;
 
-	/*
-	 * Representation of a transformed-and-lit renderable object. Stores a
-	 * single object, with its transform matrix and illuminating light source.
-	 */
-	struct TransformedRenderable
-	{
-    	// The renderable object
-    	const OpenGLRenderable* renderable;
-
-    	// The modelview transform for this renderable
-    	const Matrix4* transform;
-
-		// The light falling on this obejct
-    	const RendererLight* light;
-
-		// The entity attached to this renderable
-		const IRenderEntity* entity;
-
-		// Constructor
-		TransformedRenderable(const OpenGLRenderable& r,
-							  const Matrix4& t,
-							  const RendererLight* l,
-							  const IRenderEntity* e)
-		: renderable(&r),
-		  transform(&t),
-		  light(l),
-		  entity(e)
-		{}
-	};
-
-	// Vector of transformed renderables using this state
-	typedef std::vector<TransformedRenderable> Renderables;
-	Renderables _renderablesWithoutEntity;
-	
-	// Renderables sorted by RenderEntity
-	typedef std::map<const IRenderEntity*, Renderables> RenderablesByEntity;
-
-	RenderablesByEntity _renderables;
+	// The renderables collected for the current frame, grouped by entity
+	RenderableBuckets _renderables;
 
 private:
 
@@ -85,8 +46,8 @@ private:
 
 	void setupTextureMatrix(GLenum textureUnit, const ShaderLayerPtr& stage);
 
-	// Render all of the given TransformedRenderables
-	void renderAllContained(const Renderables& renderables,
+	// Render all of the given renderables
+	void renderAllContained(const RenderableBuckets::Renderables& renderables,
 							OpenGLState& current,
 						    const Vector3& viewer,
 							std::size_t time);
@@ -184,7 +145,7 @@ public:
 	 */
 	bool empty() const
 	{
-		return _renderables.empty() && _renderablesWithoutEntity.empty();
+		return _renderables.empty();
 	}
 
 	friend std::ostream& operator<<(std::ostream& st, const OpenGLShaderPass& self);
@@ -0,0 +1,125 @@
+#include "RenderableBuckets.h"
+
+namespace render
+{
+
+namespace
+{
+	const std::size_t INITIAL_SLOTS = 16;
+
+	inline std::size_t getHash(const IRenderEntity* entity)
+	{
+		// Spread the pointer bits, the lower ones are zero due to alignment
+		std::uint64_t value = reinterpret_cast<std::uintptr_t>(entity);
+		return static_cast<std::size_t>((value * 0x9E3779B97F4A7C15ull) >> 32);
+	}
+}
+
+RenderableBuckets::RenderableBuckets() :
+	_buckets(1),
+	_numBuckets(1),
+	_allocations(0)
+{
+	_buckets.front().entity = nullptr;
+	_buckets.front().slot = 0;
+}
+
+void RenderableBuckets::add(const OpenGLRenderable& renderable, const Matrix4& transform,
+	const IRenderEntity* entity, const RendererLight* light)
+{
+	// Renderables of the same node tend to be added right after each other
+	if (_transforms.empty() || _transforms.back() != transform)
+	{
+		countGrowth(_transforms);
+		_transforms.push_back(transform);
+	}
+
+	Renderables& renderables = getBucket(entity).renderables;
+
+	countGrowth(renderables);
+	renderables.push_back(Renderable{ &renderable, static_cast<std::uint32_t>(_transforms.size() - 1), light });
+}
+
+void RenderableBuckets::clear()
+{
+	_transforms.clear();
+	_buckets.front().renderables.clear();
+
+	for (std::size_t i = 1; i < _numBuckets; ++i)
+	{
+		_slots[_buckets[i].slot].entity = nullptr;
+		_buckets[i].renderables.clear();
+	}
+
+	_numBuckets = 1;
+	_allocations = 0;
+}
+
+RenderableBuckets::Bucket& RenderableBuckets::getBucket(const IRenderEntity* entity)
+{
+	if (entity == nullptr)
+	{
+		return _buckets.front();
+	}
+
+	// Keep the table at most half full
+	if (_numBuckets * 2 > _slots.size())
+	{
+		growSlots();
+	}
+
+	std::size_t mask = _slots.size() - 1;
+	std::size_t slot = getHash(entity) & mask;
+
+	while (_slots[slot].entity != nullptr)
+	{
+		if (_slots[slot].entity == entity)
+		{
+			return _buckets[_slots[slot].bucket];
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	// New entity this frame, re-use a bucket of a previous frame if possible
+	if (_numBuckets == _buckets.size())
+	{
+		countGrowth(_buckets);
+		_buckets.emplace_back();
+	}
+
+	Bucket& bucket = _buckets[_numBuckets];
+	bucket.entity = entity;
+	bucket.slot = slot;
+
+	_slots[slot].entity = entity;
+	_slots[slot].bucket = static_cast<std::uint32_t>(_numBuckets++);
+
+	return bucket;
+}
+
+void RenderableBuckets::growSlots()
+{
+	++_allocations;
+
+	std::vector<Slot> slots(_slots.empty() ? INITIAL_SLOTS : _slots.size() * 2, Slot{ nullptr, 0 });
+	std::size_t mask = slots.size() - 1;
+
+	for (std::size_t i = 1; i < _numBuckets; ++i)
+	{
+		std::size_t slot = getHash(_buckets[i].entity) & mask;
+
+		while (slots[slot].entity != nullptr)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		slots[slot].entity = _buckets[i].entity;
+		slots[slot].bucket = static_cast<std::uint32_t>(i);
+		_buckets[i].slot = slot;
+	}
+
+	_slots.swap(slots);
+}
+
+} // namespace render
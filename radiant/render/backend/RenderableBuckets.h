@@ -0,0 +1,131 @@
+#pragma once
+
+#include "math/Matrix4.h"
+
+#include <cstdint>
+#include <vector>
+
+class OpenGLRenderable;
+class RendererLight;
+class IRenderEntity;
+
+namespace render
+{
+
+/**
+ * The renderables collected by an OpenGLShaderPass during a single frame,
+ * grouped by their render entity.
+ *
+ * All containers are kept across frames: clear() only resets them, such that
+ * a pass collecting a similar set of renderables as in the previous frame
+ * doesn't need to allocate any memory. The transforms are copied into an
+ * arena and referred to by index, consecutive renderables sharing the same
+ * transform share the same arena entry. Entities are mapped to their bucket
+ * through an open-addressing hash table.
+ */
+class RenderableBuckets
+{
+public:
+	struct Renderable
+	{
+		const OpenGLRenderable* renderable;
+
+		// Index into the transform arena
+		std::uint32_t transform;
+
+		// The light falling on this object
+		const RendererLight* light;
+	};
+
+	typedef std::vector<Renderable> Renderables;
+
+private:
+	struct Bucket
+	{
+		const IRenderEntity* entity;
+
+		// The hash table slot referring to this bucket
+		std::size_t slot;
+
+		Renderables renderables;
+	};
+
+	struct Slot
+	{
+		const IRenderEntity* entity;
+		std::uint32_t bucket;
+	};
+
+	std::vector<Matrix4> _transforms;
+
+	// The first bucket holds the renderables without entity, the ones
+	// beyond _numBuckets are left over from previous frames
+	std::vector<Bucket> _buckets;
+	std::size_t _numBuckets;
+
+	// Hash table mapping the entities to buckets, size is a power of two
+	std::vector<Slot> _slots;
+
+	// Number of memory allocations since the last clear()
+	std::size_t _allocations;
+
+public:
+	RenderableBuckets();
+
+	// Adds a renderable, entity and light may be null
+	void add(const OpenGLRenderable& renderable, const Matrix4& transform,
+		const IRenderEntity* entity, const RendererLight* light);
+
+	bool empty() const
+	{
+		// Every renderable refers to a transform
+		return _transforms.empty();
+	}
+
+	const Matrix4& getTransform(std::uint32_t index) const
+	{
+		return _transforms[index];
+	}
+
+	const Renderables& getRenderablesWithoutEntity() const
+	{
+		return _buckets.front().renderables;
+	}
+
+	// Calls func(const IRenderEntity&, const Renderables&) for each entity
+	// which got renderables, in the order of their first renderable
+	template<typename Func>
+	void forEachEntityBucket(Func func) const
+	{
+		for (std::size_t i = 1; i < _numBuckets; ++i)
+		{
+			func(*_buckets[i].entity, _buckets[i].renderables);
+		}
+	}
+
+	// Number of memory allocations since the last clear(), to see whether
+	// the buckets have settled
+	std::size_t getAllocationCount() const
+	{
+		return _allocations;
+	}
+
+	// Removes all renderables, keeping the allocated memory for the next frame
+	void clear();
+
+private:
+	Bucket& getBucket(const IRenderEntity* entity);
+	void growSlots();
+
+	// Records an allocation if the given container is going to grow
+	template<typename Container>
+	void countGrowth(const Container& container)
+	{
+		if (container.size() == container.capacity())
+		{
+			++_allocations;
+		}
+	}
+};
+
+} // namespace render
@@ -0,0 +1,62 @@
+#include "GeometryUpdateScheduler.h"
+
+#include <vector>
+
+#include "brush/Brush.h"
+#include "patch/Patch.h"
+
+namespace render
+{
+
+void GeometryUpdateScheduler::queueBrush(Brush& brush)
+{
+	_brushes.insert(&brush);
+}
+
+void GeometryUpdateScheduler::unqueueBrush(Brush& brush)
+{
+	_brushes.erase(&brush);
+}
+
+void GeometryUpdateScheduler::queuePatch(Patch& patch)
+{
+	_patches.insert(&patch);
+}
+
+void GeometryUpdateScheduler::unqueuePatch(Patch& patch)
+{
+	_patches.erase(&patch);
+}
+
+void GeometryUpdateScheduler::flush()
+{
+	flushBrushes();
+
+	// Take the queued primitives first, the updates might queue new ones
+	if (!_patches.empty())
+	{
+		std::vector<Patch*> patches(_patches.begin(), _patches.end());
+		_patches.clear();
+
+		Patch::updateTesselations(patches);
+	}
+}
+
+void GeometryUpdateScheduler::flushBrushes()
+{
+	if (_brushes.empty()) return;
+
+	// Take the queued brushes first, the updates might queue new ones
+	std::vector<Brush*> brushes(_brushes.begin(), _brushes.end());
+	_brushes.clear();
+
+	Brush::evaluateBReps(brushes);
+}
+
+GeometryUpdateScheduler& GeometryUpdateScheduler::Instance()
+{
+	static GeometryUpdateScheduler _instance;
+	return _instance;
+}
+
+} // namespace
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <unordered_set>
+
+class Brush;
+class Patch;
+
+namespace render
+{
+
+/**
+ * Collects the brushes and patches whose geometry has been invalidated, such
+ * that their windings and tesselations can be rebuilt in one batch instead of
+ * one by one whenever the scene is asking for them. During a manipulator drag
+ * every selected primitive is invalidated in each frame.
+ *
+ * flush() is called before the scene is rendered or tested for selection. A
+ * brush asked for its geometry before that (like in a bounds query) flushes
+ * the queued brushes, such that the first query of a frame rebuilds all of
+ * them in one batch. Patches still evaluate their geometry on demand, in which
+ * case the batch has less to do.
+ *
+ * Brushes and patches remove themselves from the queue when being destroyed.
+ */
+class GeometryUpdateScheduler
+{
+private:
+	std::unordered_set<Brush*> _brushes;
+	std::unordered_set<Patch*> _patches;
+
+public:
+	void queueBrush(Brush& brush);
+	void unqueueBrush(Brush& brush);
+
+	void queuePatch(Patch& patch);
+	void unqueuePatch(Patch& patch);
+
+	// Rebuilds the geometry of all queued primitives and empties the queue
+	void flush();
+
+	// Rebuilds the queued brushes only
+	void flushBrushes();
+
+	// Contains the static instance used by all primitives
+	static GeometryUpdateScheduler& Instance();
+};
+
+} // namespace
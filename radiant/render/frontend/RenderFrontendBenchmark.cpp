@@ -0,0 +1,433 @@
+#include "RenderFrontendBenchmark.h"
+
+#include "imap.h"
+#include "imapresource.h"
+#include "imodule.h"
+#include "irender.h"
+#include "iscenegraph.h"
+#include "iscenegraphfactory.h"
+#include "itextstream.h"
+#include "math/AABB.h"
+#include "math/Matrix4.h"
+#include "math/pi.h"
+#include "registry/registry.h"
+#include "string/json.h"
+#include "util/Stopwatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+#include <fmt/format.h>
+
+#include "RenderableCollectionWalker.h"
+#include "render/View.h"
+#include "render/backend/RenderableBuckets.h"
+#include "selection/SelectionPool.h"
+#include "selection/SelectionTest.h"
+
+namespace render
+{
+
+namespace
+{
+	const std::size_t VIEW_WIDTH = 1280;
+	const std::size_t VIEW_HEIGHT = 720;
+	const float FIELD_OF_VIEW = 90.0f;
+	const float FAR_CLIP = 32768.0f;
+
+	// Same as the camera's conversion between radiant and OpenGL view axes
+	const Matrix4 RADIANT2OPENGL = Matrix4::byColumns(
+		0, -1, 0, 0,
+		0,  0, 1, 0,
+	   -1,  0, 0, 0,
+		0,  0, 0, 1
+	);
+
+	// Timings of a single stage over all frames of a camera path
+	struct Stage
+	{
+		double totalTime = 0;
+		double maxTime = 0;
+		std::size_t count = 0;
+
+		void addFrame(double time, std::size_t frameCount)
+		{
+			totalTime += time;
+			maxTime = std::max(maxTime, time);
+			count += frameCount;
+		}
+
+		std::string toJson(std::size_t numFrames, const std::string& countName) const
+		{
+			return fmt::format("{{ \"totalMs\": {0:.3f}, \"meanMs\": {1:.4f}, \"maxMs\": {2:.4f}, \"{3}\": {4} }}",
+				totalTime, numFrames > 0 ? totalTime / numFrames : 0.0, maxTime, countName, count);
+		}
+	};
+
+	/**
+	 * Collector sorting the submitted renderables into RenderableBuckets per
+	 * shader, like the OpenGLShaderPasses do. The light lists are kept aside to
+	 * be evaluated in a separate stage.
+	 */
+	class RecordingRenderableCollector :
+		public RenderableCollector
+	{
+	private:
+		std::unordered_map<const Shader*, RenderableBuckets> _buckets;
+		std::vector<const LightList*> _lightLists;
+
+		std::size_t _numRenderables;
+
+		// Allocations of the containers above, since the last clear()
+		std::size_t _allocations;
+
+	public:
+		RecordingRenderableCollector() :
+			_numRenderables(0),
+			_allocations(0)
+		{}
+
+		void addRenderable(const ShaderPtr& shader, const OpenGLRenderable& renderable,
+			const Matrix4& world) override
+		{
+			getBuckets(shader).add(renderable, world, nullptr, nullptr);
+			++_numRenderables;
+		}
+
+		void addRenderable(const ShaderPtr& shader, const OpenGLRenderable& renderable,
+			const Matrix4& world, const IRenderEntity& entity) override
+		{
+			getBuckets(shader).add(renderable, world, &entity, nullptr);
+			++_numRenderables;
+		}
+
+		void addRenderable(const ShaderPtr& shader, const OpenGLRenderable& renderable,
+			const Matrix4& world, const IRenderEntity& entity, const LightList& lights) override
+		{
+			getBuckets(shader).add(renderable, world, &entity, nullptr);
+			++_numRenderables;
+
+			if (_lightLists.size() == _lightLists.capacity())
+			{
+				++_allocations;
+			}
+
+			_lightLists.push_back(&lights);
+		}
+
+		bool supportsFullMaterials() const override
+		{
+			return true;
+		}
+
+		void setHighlightFlag(Highlight::Flags flags, bool enabled) override
+		{}
+
+		std::size_t getNumRenderables() const
+		{
+			return _numRenderables;
+		}
+
+		const std::vector<const LightList*>& getLightLists() const
+		{
+			return _lightLists;
+		}
+
+		std::size_t getAllocationCount() const
+		{
+			std::size_t allocations = _allocations;
+
+			for (const std::pair<const Shader* const, RenderableBuckets>& pair : _buckets)
+			{
+				allocations += pair.second.getAllocationCount();
+			}
+
+			return allocations;
+		}
+
+		// Resets the collector for the next frame, keeping the buckets
+		void clear()
+		{
+			for (std::pair<const Shader* const, RenderableBuckets>& pair : _buckets)
+			{
+				pair.second.clear();
+			}
+
+			_lightLists.clear();
+			_numRenderables = 0;
+			_allocations = 0;
+		}
+
+	private:
+		RenderableBuckets& getBuckets(const ShaderPtr& shader)
+		{
+			std::unordered_map<const Shader*, RenderableBuckets>::iterator found = _buckets.find(shader.get());
+
+			if (found == _buckets.end())
+			{
+				++_allocations;
+				found = _buckets.emplace(shader.get(), RenderableBuckets()).first;
+			}
+
+			return found->second;
+		}
+	};
+
+	struct CameraPosition
+	{
+		Vector3 origin;
+		Vector3 target;
+	};
+
+	// Builds the view like the Camera does for the given position
+	void constructView(View& view, const CameraPosition& position)
+	{
+		Vector3 direction = (position.target - position.origin).getNormalised();
+
+		double yaw = radians_to_degrees(atan2(direction.y(), direction.x()));
+		double pitch = radians_to_degrees(asin(std::max(-1.0, std::min(1.0, direction.z()))));
+
+		Matrix4 modelview = Matrix4::getIdentity();
+		modelview.translateBy(position.origin);
+		modelview.rotateByEulerXYZDegrees(Vector3(0, -pitch, yaw));
+		modelview.multiplyBy(RADIANT2OPENGL);
+		modelview.invert();
+
+		float nearClip = FAR_CLIP / 4096.0f;
+		float halfWidth = nearClip * tan(degrees_to_radians(FIELD_OF_VIEW * 0.5f));
+		float halfHeight = halfWidth * static_cast<float>(VIEW_HEIGHT) / static_cast<float>(VIEW_WIDTH);
+
+		Matrix4 projection = Matrix4::getProjectionForFrustum(-halfWidth, halfWidth,
+			-halfHeight, halfHeight, nearClip, FAR_CLIP);
+
+		view.Construct(projection, modelview, VIEW_WIDTH, VIEW_HEIGHT);
+	}
+
+	// Circles around the map, looking down at its centre
+	std::vector<CameraPosition> getOrbitPath(const AABB& bounds, std::size_t numFrames)
+	{
+		std::vector<CameraPosition> path;
+		double radius = std::max(std::max(bounds.extents.x(), bounds.extents.y()), 256.0) * 1.5;
+
+		for (std::size_t i = 0; i < numFrames; ++i)
+		{
+			double angle = 2 * c_pi * i / numFrames;
+
+			CameraPosition position;
+			position.target = bounds.origin;
+			position.origin = bounds.origin + Vector3(cos(angle) * radius, sin(angle) * radius,
+				bounds.extents.z() + radius * 0.25);
+
+			path.push_back(position);
+		}
+
+		return path;
+	}
+
+	// Flies along the longer horizontal axis of the map, looking ahead
+	std::vector<CameraPosition> getFlythroughPath(const AABB& bounds, std::size_t numFrames)
+	{
+		std::vector<CameraPosition> path;
+		Vector3 axis = bounds.extents.x() >= bounds.extents.y() ?
+			Vector3(bounds.extents.x(), 0, 0) : Vector3(0, bounds.extents.y(), 0);
+
+		Vector3 start = bounds.origin - axis;
+		Vector3 direction = axis.getNormalised();
+
+		for (std::size_t i = 0; i < numFrames; ++i)
+		{
+			double fraction = numFrames > 1 ? static_cast<double>(i) / (numFrames - 1) : 0;
+
+			CameraPosition position;
+			position.origin = start + axis * (2 * fraction);
+			position.target = position.origin + direction;
+
+			path.push_back(position);
+		}
+
+		return path;
+	}
+
+	std::string runPath(scene::Graph& graph, const std::string& name, const std::vector<CameraPosition>& path)
+	{
+		RecordingRenderableCollector collector;
+
+		Stage collect;
+		Stage lights;
+		Stage selection;
+		std::size_t allocations = 0;
+		std::size_t firstFrameAllocations = 0;
+
+		for (std::size_t frame = 0; frame < path.size(); ++frame)
+		{
+			View view(true);
+			constructView(view, path[frame]);
+
+			// Collect the renderables of the visible nodes
+			util::Stopwatch timer;
+			RenderableCollectionWalker::CollectRenderablesInGraph(graph, collector, view);
+			collect.addFrame(timer.getMilliseconds(), collector.getNumRenderables());
+
+			// Bring the light lists up to date, like the backend does when adding lit renderables
+			std::size_t numInteractions = 0;
+			timer.restart();
+
+			for (const LightList* lightList : collector.getLightLists())
+			{
+				lightList->forEachLight([&](const RendererLight&) { ++numInteractions; });
+			}
+
+			lights.addFrame(timer.getMilliseconds(), numInteractions);
+
+			// Select the objects at the centre of the view
+			timer.restart();
+
+			View scissored(view);
+			ConstructSelectionTest(scissored, selection::Rectangle::ConstructFromPoint(Vector2(0, 0), Vector2(0.02, 0.02)));
+
+			SelectionVolume test(scissored);
+			SelectionPool entityPool;
+			SelectionPool primitivePool;
+
+			EntityAndPrimitiveSelector tester(entityPool, primitivePool, test);
+			graph.foreachVisibleNodeInVolume(scissored, tester);
+
+			std::size_t numCandidates = std::distance(entityPool.begin(), entityPool.end()) +
+				std::distance(primitivePool.begin(), primitivePool.end());
+
+			selection.addFrame(timer.getMilliseconds(), numCandidates);
+
+			if (frame == 0)
+			{
+				firstFrameAllocations = collector.getAllocationCount();
+			}
+
+			allocations += collector.getAllocationCount();
+			collector.clear();
+		}
+
+		return fmt::format(
+			"    {{\n"
+			"      \"name\": \"{0}\",\n"
+			"      \"frames\": {1},\n"
+			"      \"collect\": {2},\n"
+			"      \"lights\": {3},\n"
+			"      \"selection\": {4},\n"
+			"      \"allocations\": {{ \"firstFrame\": {5}, \"total\": {6} }}\n"
+			"    }}",
+			name, path.size(),
+			collect.toJson(path.size(), "renderables"),
+			lights.toJson(path.size(), "interactions"),
+			selection.toJson(path.size(), "candidates"),
+			firstFrameAllocations, allocations);
+	}
+}
+
+std::string runRenderFrontendBenchmark(const std::string& mapPath, std::size_t numFrames)
+{
+	// Load the map into its own scenegraph
+	util::Stopwatch timer;
+
+	IMapResourcePtr resource = GlobalMapResourceManager().loadFromPath(mapPath);
+
+	// No progress dialog while loading
+	registry::ScopedKeyChanger<bool> changer(RKEY_MAP_SUPPRESS_LOAD_STATUS_DIALOG, true);
+
+	if (!resource || !resource->load())
+	{
+		rWarning() << "RenderFrontendBenchmark: could not load " << mapPath << std::endl;
+		return std::string();
+	}
+
+	scene::IMapRootNodePtr root = resource->getNode();
+
+	scene::GraphPtr graph = GlobalSceneGraphFactory().createSceneGraph();
+	graph->setRoot(root);
+
+	// Capture the shaders and register the lights and lit objects
+	root->setRenderSystem(std::dynamic_pointer_cast<RenderSystem>(
+		module::GlobalModuleRegistry().getModule(MODULE_RENDERSYSTEM)));
+
+	double loadTime = timer.getMilliseconds();
+
+	std::size_t numNodes = 0;
+	AABB bounds;
+
+	root->foreachNode([&](const scene::INodePtr& node)
+	{
+		++numNodes;
+		bounds.includeAABB(node->worldAABB());
+		return true;
+	});
+
+	if (!bounds.isValid())
+	{
+		bounds = AABB(Vector3(0, 0, 0), Vector3(256, 256, 256));
+	}
+
+	std::string json = fmt::format(
+		"{{\n"
+		"  \"map\": \"{0}\",\n"
+		"  \"nodes\": {1},\n"
+		"  \"loadMs\": {2:.3f},\n"
+		"  \"paths\": [\n"
+		"{3},\n"
+		"{4}\n"
+		"  ]\n"
+		"}}\n",
+		string::escape_json(mapPath), numNodes, loadTime,
+		runPath(*graph, "orbit", getOrbitPath(bounds, numFrames)),
+		runPath(*graph, "flythrough", getFlythroughPath(bounds, numFrames)));
+
+	// Release the lights and lit objects before dropping the scene
+	root->setRenderSystem(RenderSystemPtr());
+	graph->setRoot(scene::IMapRootNodePtr());
+
+	return json;
+}
+
+bool writeRenderFrontendBenchmarkResult(const std::string& json, const std::string& outputFile)
+{
+	std::ofstream output(outputFile);
+
+	if (!output)
+	{
+		rWarning() << "RenderFrontendBenchmark: could not write " << outputFile << std::endl;
+		return false;
+	}
+
+	output << json;
+	return true;
+}
+
+void benchmarkRenderFrontend(const cmd::ArgumentList& args)
+{
+	if (args.empty())
+	{
+		rWarning() << "Usage: BenchmarkRenderFrontend <mapPath> [numFrames] [outputFile]" << std::endl;
+		return;
+	}
+
+	std::size_t numFrames = DEFAULT_RENDER_FRONTEND_BENCHMARK_FRAMES;
+
+	if (args.size() > 1 && args[1].getInt() > 0)
+	{
+		numFrames = static_cast<std::size_t>(args[1].getInt());
+	}
+
+	std::string json = runRenderFrontendBenchmark(args[0].getString(), numFrames);
+
+	if (json.empty()) return;
+
+	rMessage() << json;
+
+	if (args.size() > 2 && !args[2].getString().empty())
+	{
+		writeRenderFrontendBenchmarkResult(json, args[2].getString());
+	}
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "icommandsystem.h"
+#include <string>
+
+namespace render
+{
+
+/**
+ * Timing of the render frontend on a given map, without drawing anything.
+ * The map is loaded through a MapResource into a separate scenegraph, the
+ * current map and the views are left alone.
+ *
+ * A camera is moved along two scripted paths, an orbit around the map and a
+ * straight flight through its centre. For each frame the renderables are
+ * collected by the RenderableCollectionWalker into a recording collector,
+ * which sorts them into RenderableBuckets per shader like the backend does.
+ * Then the light lists of the lit renderables are evaluated and a selection
+ * test is run at the centre of the view.
+ *
+ * The benchmark is available as console command and as the standalone
+ * renderfrontendbenchmark tool (see RenderFrontendBenchmarkApp.cpp).
+ */
+
+// Camera positions per path, unless specified otherwise
+const std::size_t DEFAULT_RENDER_FRONTEND_BENCHMARK_FRAMES = 100;
+
+/**
+ * Runs the benchmark on the given map and returns the timings of each stage
+ * and the allocations made by the collector as JSON. Returns an empty string
+ * if the map could not be loaded.
+ */
+std::string runRenderFrontendBenchmark(const std::string& mapPath, std::size_t numFrames);
+
+// Writes the JSON returned by runRenderFrontendBenchmark() to the given file
+bool writeRenderFrontendBenchmarkResult(const std::string& json, const std::string& outputFile);
+
+/**
+ * Console command running the benchmark, the result is written to the
+ * console and optionally to a file.
+ *
+ * Usage: BenchmarkRenderFrontend <mapPath> [numFrames] [outputFile]
+ * (numFrames defaults to 100 per path)
+ */
+void benchmarkRenderFrontend(const cmd::ArgumentList& args);
+
+}
@@ -0,0 +1,153 @@
+/**
+ * Entry point of the renderfrontendbenchmark tool, running the render frontend
+ * benchmark outside of the editor:
+ *
+ * renderfrontendbenchmark <mapPath> [numFrames] [outputFile]
+ *
+ * Only the modules needed to load a map and to collect its renderables are
+ * initialised. No main frame, no window and no GL context are created, the
+ * OpenGLRenderSystem is never realised. The JSON result is written to stdout
+ * (and to the output file, if given), the exit code is non-zero on failure.
+ *
+ * The game setup is read from the user settings like the editor does, so the
+ * settings folder needs a valid game configuration. The UI manager (providing
+ * the colour schemes) still needs the GUI toolkit to be initialised, on Linux
+ * machines without a display the tool can be run through xvfb-run.
+ */
+#include "icounter.h"
+#include "ientity.h"
+#include "imapresource.h"
+#include "imodelcache.h"
+#include "irender.h"
+#include "iscenegraphfactory.h"
+#include "iselection.h"
+#include "itextstream.h"
+
+#include "log/LogFile.h"
+#include "log/LogStream.h"
+#include "modulesystem/ModuleRegistry.h"
+#include "modulesystem/ApplicationContextImpl.h"
+#include "string/convert.h"
+
+#include "RenderFrontendBenchmark.h"
+
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <wx/app.h>
+
+namespace render
+{
+
+class RenderFrontendBenchmarkApp :
+	public wxApp
+{
+private:
+	radiant::ApplicationContextImpl _context;
+
+	std::string _mapPath;
+	std::size_t _numFrames;
+	std::string _outputFile;
+
+public:
+	RenderFrontendBenchmarkApp() :
+		_numFrames(DEFAULT_RENDER_FRONTEND_BENCHMARK_FRAMES)
+	{}
+
+	bool OnInit() override
+	{
+		// The default command line parsing of wxApp::OnInit() is skipped,
+		// the arguments are positional
+		if (argc < 2)
+		{
+			std::fputs("Usage: renderfrontendbenchmark <mapPath> [numFrames] [outputFile]\n", stderr);
+			return false;
+		}
+
+		_mapPath = argv[1].ToStdString();
+
+		if (argc > 2 && string::convert<int>(argv[2].ToStdString()) > 0)
+		{
+			_numFrames = string::convert<std::size_t>(argv[2].ToStdString());
+		}
+
+		if (argc > 3)
+		{
+			_outputFile = argv[3].ToStdString();
+		}
+
+		applog::LogStream::InitialiseStreams();
+
+		wxLog::SetLogLevel(wxLOG_Warning);
+
+		_context.initialise(argc, argv);
+		module::ModuleRegistry::Instance().setContext(_context);
+
+		applog::LogFile::create("renderfrontendbenchmark.log");
+
+		// Parse floats from text files independent of the user's locale
+		setlocale(LC_NUMERIC, "C");
+		setlocale(LC_TIME, "C");
+
+		wxInitAllImageHandlers();
+
+		return true;
+	}
+
+	// Runs the benchmark instead of the main loop
+	int OnRun() override
+	{
+		int result = EXIT_FAILURE;
+
+		try
+		{
+			StringSet modules;
+
+			modules.insert(MODULE_MAPRESOURCEMANAGER);
+			modules.insert(MODULE_SCENEGRAPHFACTORY);
+			modules.insert(MODULE_RENDERSYSTEM);
+			modules.insert(MODULE_ENTITYCREATOR);
+			modules.insert(MODULE_SELECTIONSYSTEM);
+			modules.insert(MODULE_COUNTER);
+			modules.insert(MODULE_MODELCACHE);
+			modules.insert("PicoModelModule");
+			modules.insert("MD5Module");
+
+			module::ModuleRegistry::Instance().loadAndInitialiseModules(modules);
+
+			std::string json = runRenderFrontendBenchmark(_mapPath, _numFrames);
+
+			if (!json.empty())
+			{
+				std::fputs(json.c_str(), stdout);
+
+				if (_outputFile.empty() || writeRenderFrontendBenchmarkResult(json, _outputFile))
+				{
+					result = EXIT_SUCCESS;
+				}
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			rError() << "renderfrontendbenchmark: " << ex.what() << std::endl;
+			std::fprintf(stderr, "renderfrontendbenchmark: %s\n", ex.what());
+		}
+
+		return result;
+	}
+
+	int OnExit() override
+	{
+		module::GlobalModuleRegistry().shutdownModules();
+
+		applog::LogFile::close();
+		applog::LogStream::ShutdownStreams();
+
+		return wxApp::OnExit();
+	}
+};
+
+}
+
+wxIMPLEMENT_APP(render::RenderFrontendBenchmarkApp);
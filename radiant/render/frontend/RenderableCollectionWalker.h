@@ -4,6 +4,8 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "iscenegraph.h"
+#include "iprofiler.h"
+#include "GeometryUpdateScheduler.h"
 #include <functional>
 
 namespace render
@@ -105,11 +107,26 @@ public:
      */
     static void CollectRenderablesInScene(RenderableCollector& collector, const VolumeTest& volume)
     {
+        CollectRenderablesInGraph(GlobalSceneGraph(), collector, volume);
+    }
+
+    /**
+     * \brief
+     * Same as above, for the given scenegraph.
+     */
+    static void CollectRenderablesInGraph(scene::Graph& graph, RenderableCollector& collector,
+                                          const VolumeTest& volume)
+    {
+        PROFILE_ZONE("RenderableCollection");
+
+        // Rebuild the primitives changed since the last frame in one go
+        GeometryUpdateScheduler::Instance().flush();
+
         // Instantiate a new walker class
         RenderableCollectionWalker renderHighlightWalker(collector, volume);
 
         // Submit renderables from scene graph
-        GlobalSceneGraph().foreachVisibleNodeInVolume(volume, renderHighlightWalker);
+        graph.foreachVisibleNodeInVolume(volume, renderHighlightWalker);
 
         // Submit any renderables that have been directly attached to the RenderSystem
 		// without belonging to an actual scene object
@@ -8,6 +8,7 @@
 #include "ieventmanager.h"
 #include "ipreferencesystem.h"
 #include "imousetoolmanager.h"
+#include "iprofiler.h"
 #include "SelectionPool.h"
 #include "SelectionTest.h"
 #include "modulesystem/StaticModule.h"
@@ -16,6 +17,7 @@
 #include "selection/algorithm/General.h"
 #include "selection/algorithm/Primitives.h"
 #include "xyview/GlobalXYWnd.h"
+#include "render/frontend/GeometryUpdateScheduler.h"
 #include "SceneWalkers.h"
 
 #include "manipulators/DragManipulator.h"
@@ -26,6 +28,7 @@
 #include "manipulators/ModelScaleManipulator.h"
 
 #include <functional>
+#include <unordered_set>
 
 namespace selection
 {
@@ -73,6 +76,9 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
                                              const render::View& view, SelectionSystem::EMode mode,
                                              SelectionSystem::EComponentMode componentMode)
 {
+    // Bring the changed primitives up to date before testing them
+    render::GeometryUpdateScheduler::Instance().flush();
+
     // The (temporary) storage pool
     SelectionPool selector;
     SelectionPool sel2;
@@ -103,15 +109,10 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
             }
             else
             {
-                // We have an orthoview, here, select entities first
-
-                // First, obtain all the selectable entities
-                EntitySelector entityTester(selector, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, entityTester);
-
-                // Now retrieve all the selectable primitives
-                PrimitiveSelector primitiveTester(sel2, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, primitiveTester);
+                // We have an orthoview, here, select entities first. The entities
+                // and the primitives are collected in separate pools in one traversal.
+                EntityAndPrimitiveSelector tester(selector, sel2, test);
+                GlobalSceneGraph().foreachVisibleNodeInVolume(view, tester);
             }
 
             // Add the first selection crop to the target vector
@@ -120,15 +121,17 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
             }
 
             // Add the secondary crop to the vector (if it has any entries)
-            for (SelectionPool::const_iterator i = sel2.begin(); i != sel2.end(); ++i) {
-                // Check for duplicates
-                SelectablesList::iterator j;
-                for (j = targetList.begin(); j != targetList.end(); ++j) {
-                    if (*j == i->second) break;
-                }
-                // Insert if not yet in the list
-                if (j == targetList.end()) {
-                    targetList.push_back(i->second);
+            if (!sel2.empty())
+            {
+                std::unordered_set<ISelectable*> added(targetList.begin(), targetList.end());
+
+                for (SelectionPool::const_iterator i = sel2.begin(); i != sel2.end(); ++i)
+                {
+                    // Insert if not yet in the list
+                    if (added.insert(i->second).second)
+                    {
+                        targetList.push_back(i->second);
+                    }
                 }
             }
         }
@@ -550,6 +553,8 @@ void RadiantSelectionSystem::SelectPoint(const render::View& view,
                                          SelectionSystem::EModifier modifier,
                                          bool face)
 {
+    PROFILE_ZONE("SelectionSystem::SelectPoint");
+
     ASSERT_MESSAGE(fabs(device_point[0]) <= 1.0f && fabs(device_point[1]) <= 1.0f, "point-selection error");
     // If the user is holding the replace modifiers (default: Alt-Shift), deselect the current selection
     if (modifier == SelectionSystem::eReplace) {
@@ -692,6 +697,8 @@ void RadiantSelectionSystem::SelectArea(const render::View& view,
                                         const Vector2& device_delta,
                                         SelectionSystem::EModifier modifier, bool face)
 {
+    PROFILE_ZONE("SelectionSystem::SelectArea");
+
     // If we are in replace mode, deselect all the components or previous selections
     if (modifier == SelectionSystem::eReplace) {
         if (face) {
@@ -854,6 +861,7 @@ const StringSet& RadiantSelectionSystem::getDependencies() const
         _dependencies.insert(MODULE_MOUSETOOLMANAGER);
 		_dependencies.insert(MODULE_MAP);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_PROFILER);
     }
 
     return _dependencies;
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <map>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 #include "iselectiontest.h"
 #include "iselectable.h"
 
@@ -16,27 +18,35 @@
  *
  * The addIntersection() method is called by the tested object in between
  * pushSelectable() and popSelectable(), picking the best Intersection out of the crop.
+ *
+ * The candidates are collected in a flat array, duplicates are detected through
+ * a hash map. The array is sorted once when iterating over the pool; selectables
+ * with equal intersections keep the order they have been added in.
  */
 class SelectionPool :
 	public Selector
 {
 public:
-	typedef std::multimap<SelectionIntersection, ISelectable*> SelectableSortedSet;
-	typedef SelectableSortedSet::const_iterator const_iterator;
+	typedef std::pair<SelectionIntersection, ISelectable*> Candidate;
+	typedef std::vector<Candidate> Candidates;
+	typedef Candidates::const_iterator const_iterator;
 
 private:
-	SelectableSortedSet _pool;
+	// Replaced candidates are kept with a NULL selectable until the pool is sorted
+	mutable Candidates _pool;
+	mutable bool _sorted;
+
 	SelectionIntersection _curIntersection;
 	ISelectable* _curSelectable;
 
-	// A set of all current ISelectable* candidates, to prevent double-insertions
-	// The iterator value points to an element in the SelectableSortedSet
-	// to allow for fast lookup and removal.
-	typedef std::map<ISelectable*, SelectableSortedSet::iterator> SelectablesMap;
-	SelectablesMap _currentSelectables;
+	// A map of all current ISelectable* candidates, to prevent double-insertions.
+	// The value is the index of the candidate in the pool.
+	typedef std::unordered_map<ISelectable*, std::size_t> SelectablesMap;
+	mutable SelectablesMap _currentSelectables;
 
 public:
 	SelectionPool() :
+		_sorted(true),
 		_curSelectable(nullptr)
 	{}
 
@@ -75,51 +85,68 @@ public:
 	{
 		if (!intersection.isValid()) return; // skip invalid intersections
 
-		SelectablesMap::iterator existing = _currentSelectables.find(selectable);
+		std::pair<SelectablesMap::iterator, bool> result =
+			_currentSelectables.insert(std::make_pair(selectable, _pool.size()));
 
-		if (existing != _currentSelectables.end())
+		if (!result.second)
 		{
 			// greebo: We had that selectable before, check if the intersection is a better one
 			// and update it if necessary. It's possible that the selectable is the parent of
 			// two different child primitives, but both may want to add themselves to this pool.
 			// To prevent the "worse" primitive from shadowing the "better" one, perform this check.
+			Candidate& existing = _pool[result.first->second];
 
-			// Check if the intersection is better
-			if (intersection < existing->second->first)
-			{
-				// Yes, update the map, remove old stuff first
-				_pool.erase(existing->second);
-				_currentSelectables.erase(existing);
-			}
-			else
+			if (!(intersection < existing.first))
 			{
 				// The existing intersection is better, we're done here
 				return;
 			}
-		}
 
-		// At this point, the selectable is ready for insertion into the pool
-		// Either it's a completely new Selectable, or it is replacing an existing one
-		SelectableSortedSet::iterator result = _pool.insert(
-			std::make_pair(intersection, selectable)
-		);
+			// Drop the existing candidate, the selectable is re-added below
+			existing.second = nullptr;
+			result.first->second = _pool.size();
+		}
 
-		// Memorise the Selectable for fast lookups
-		_currentSelectables.insert(std::make_pair(selectable, result));
+		_pool.emplace_back(intersection, selectable);
+		_sorted = false;
 	}
 
 	const_iterator begin() const
 	{
+		ensureSorted();
 		return _pool.begin();
 	}
 
 	const_iterator end() const 
 	{
+		ensureSorted();
 		return _pool.end();
 	}
 
-	bool empty()
+	bool empty() const
 	{
-		return _pool.empty();
+		return _currentSelectables.empty();
+	}
+
+private:
+	void ensureSorted() const
+	{
+		if (_sorted) return;
+
+		_pool.erase(std::remove_if(_pool.begin(), _pool.end(),
+			[](const Candidate& candidate) { return candidate.second == nullptr; }), _pool.end());
+
+		std::stable_sort(_pool.begin(), _pool.end(), [](const Candidate& a, const Candidate& b)
+		{
+			return a.first < b.first;
+		});
+
+		// The candidates have moved, update their indices
+		for (std::size_t i = 0; i < _pool.size(); ++i)
+		{
+			_currentSelectables[_pool[i].second] = i;
+		}
+
+		_sorted = true;
 	}
 };
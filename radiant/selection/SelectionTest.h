@@ -100,6 +100,30 @@ public:
 	bool visit(const scene::INodePtr& node);
 };
 
+// Runs an EntitySelector and a PrimitiveSelector in a single scene traversal,
+// each of them adding its candidates to its own Selector.
+class EntityAndPrimitiveSelector :
+	public scene::Graph::Walker
+{
+private:
+	EntitySelector _entitySelector;
+	PrimitiveSelector _primitiveSelector;
+
+public:
+	EntityAndPrimitiveSelector(Selector& entitySelector, Selector& primitiveSelector, SelectionTest& test) :
+		_entitySelector(entitySelector, test),
+		_primitiveSelector(primitiveSelector, test)
+	{}
+
+	bool visit(const scene::INodePtr& node)
+	{
+		_entitySelector.visit(node);
+		_primitiveSelector.visit(node);
+
+		return true;
+	}
+};
+
 // A Selector looking for child primitives of group nodes only, non-worldspawn parent
 class GroupChildPrimitiveSelector :
 	public SelectionTestWalker
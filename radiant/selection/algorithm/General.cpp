@@ -11,6 +11,7 @@
 #include "itraceable.h"
 
 #include "math/Ray.h"
+#include "render/RayVolumeTest.h"
 #include "map/Map.h"
 #include "selection/shaderclipboard/ShaderClipboard.h"
 #include "ui/texturebrowser/TextureBrowser.h"
@@ -820,8 +821,10 @@ void snapSelectionToGrid(const cmd::ArgumentList& args)
 	}
 }
 
+// Visits the nodes in the space partition cells hit by the ray, the
+// traced models use their own hierarchy to find the intersected triangles
 class IntersectionFinder : 
-	public scene::NodeVisitor
+	public scene::Graph::Walker
 {
 private:
 	const Ray& _ray;
@@ -842,10 +845,13 @@ public:
 		return _bestPoint;
 	}
 
-	bool pre(const scene::INodePtr& node)
+	bool visit(const scene::INodePtr& node) override
 	{
-		if (node == _self) return false;
-		if (!node->visible()) return true;
+		// Skip the traced node and its children
+		for (scene::INodePtr n = node; n; n = n->getParent())
+		{
+			if (n == _self) return true;
+		}
 
 		const AABB& aabb = node->worldAABB();
 		Vector3 intersection;
@@ -961,7 +967,7 @@ void floorNode(const scene::INodePtr& node)
 	Ray ray(objectOrigin + Vector3(0, 0, 1), Vector3(0, 0, -1));
 
 	IntersectionFinder finder(ray, node);
-	GlobalSceneGraph().root()->traverseChildren(finder);
+	GlobalSceneGraph().foreachVisibleNodeInVolume(render::RayVolumeTest(ray), finder);
 
 	if ((finder.getIntersection() - ray.origin).getLengthSquared() > 0)
 	{
@@ -0,0 +1,193 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE bezierPatchSamplerTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/patch/BezierPatchSampler.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    // The per-point evaluation formerly used by the PatchTesselation
+    void sampleSinglePatchPoint(const ArbitraryMeshVertex ctrl[3][3], float u, float v, ArbitraryMeshVertex& out)
+    {
+        float vCtrl[3][8];
+
+        // find the control points for the v coordinate
+        for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
+        {
+            for (std::size_t axis = 0; axis < 8; axis++)
+            {
+                float a, b, c;
+
+                if (axis < 3)
+                {
+                    a = ctrl[0][vPoint].vertex[axis];
+                    b = ctrl[1][vPoint].vertex[axis];
+                    c = ctrl[2][vPoint].vertex[axis];
+                }
+                else if (axis < 6)
+                {
+                    a = ctrl[0][vPoint].normal[axis - 3];
+                    b = ctrl[1][vPoint].normal[axis - 3];
+                    c = ctrl[2][vPoint].normal[axis - 3];
+                }
+                else
+                {
+                    a = ctrl[0][vPoint].texcoord[axis - 6];
+                    b = ctrl[1][vPoint].texcoord[axis - 6];
+                    c = ctrl[2][vPoint].texcoord[axis - 6];
+                }
+
+                float qA = a - 2.0f * b + c;
+                float qB = 2.0f * b - 2.0f * a;
+                float qC = a;
+
+                vCtrl[vPoint][axis] = qA * u * u + qB * u + qC;
+            }
+        }
+
+        // interpolate the v value
+        for (std::size_t axis = 0; axis < 8; axis++)
+        {
+            float a = vCtrl[0][axis];
+            float b = vCtrl[1][axis];
+            float c = vCtrl[2][axis];
+            float qA = a - 2.0f * b + c;
+            float qB = 2.0f * b - 2.0f * a;
+            float qC = a;
+
+            if (axis < 3)
+            {
+                out.vertex[axis] = qA * v * v + qB * v + qC;
+            }
+            else if (axis < 6)
+            {
+                out.normal[axis - 3] = qA * v * v + qB * v + qC;
+            }
+            else
+            {
+                out.texcoord[axis - 6] = qA * v * v + qB * v + qC;
+            }
+        }
+    }
+
+    void sampleSinglePatch(const ArbitraryMeshVertex ctrl[3][3], std::size_t horzSub, std::size_t vertSub,
+        std::vector<ArbitraryMeshVertex>& outVerts)
+    {
+        horzSub++;
+        vertSub++;
+
+        for (std::size_t i = 0; i < horzSub; i++)
+        {
+            for (std::size_t j = 0; j < vertSub; j++)
+            {
+                float u = static_cast<float>(i) / (horzSub - 1);
+                float v = static_cast<float>(j) / (vertSub - 1);
+
+                sampleSinglePatchPoint(ctrl, u, v, outVerts[j * horzSub + i]);
+            }
+        }
+    }
+
+    // Samples random control grids with both methods, the results must be bit-identical
+    void checkSameAsPerPoint(std::size_t horzSub, std::size_t vertSub)
+    {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<double> coord(-1024, 1024);
+        std::uniform_real_distribution<double> unit(-1, 1);
+
+        BezierPatchSampler sampler(horzSub, vertSub);
+        std::size_t numSamples = (horzSub + 1) * (vertSub + 1);
+
+        BOOST_REQUIRE_EQUAL(sampler.getNumSamples(), numSamples);
+
+        std::vector<ArbitraryMeshVertex> expected(numSamples);
+        std::vector<ArbitraryMeshVertex> sampled(numSamples);
+
+        for (std::size_t patch = 0; patch < 100; ++patch)
+        {
+            ArbitraryMeshVertex ctrl[3][3];
+
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                for (std::size_t l = 0; l < 3; ++l)
+                {
+                    ctrl[k][l].vertex = Vertex3f(coord(random), coord(random), coord(random));
+                    ctrl[k][l].normal = Normal3f(unit(random), unit(random), unit(random));
+                    ctrl[k][l].texcoord = TexCoord2f(unit(random), unit(random));
+                }
+            }
+
+            sampleSinglePatch(ctrl, horzSub, vertSub, expected);
+            sampler.sample(ctrl, sampled.data(), horzSub + 1);
+
+            for (std::size_t i = 0; i < numSamples; ++i)
+            {
+                BOOST_REQUIRE(sampled[i].vertex == expected[i].vertex);
+                BOOST_REQUIRE(sampled[i].normal == expected[i].normal);
+                BOOST_REQUIRE(sampled[i].texcoord == expected[i].texcoord);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sameAsPerPointSampling)
+{
+    checkSameAsPerPoint(16, 16);
+}
+
+BOOST_AUTO_TEST_CASE(sameAsPerPointSamplingUneven)
+{
+    checkSameAsPerPoint(1, 1);
+    checkSameAsPerPoint(3, 7);
+    checkSameAsPerPoint(12, 2);
+}
+
+BOOST_AUTO_TEST_CASE(rowStride)
+{
+    // Samples go to out[j * rowStride + i], the gaps are left alone
+    const std::size_t horzSub = 2;
+    const std::size_t vertSub = 3;
+    const std::size_t rowStride = 5;
+
+    ArbitraryMeshVertex ctrl[3][3];
+
+    for (std::size_t k = 0; k < 3; ++k)
+    {
+        for (std::size_t l = 0; l < 3; ++l)
+        {
+            ctrl[k][l].vertex = Vertex3f(k * 64.0, l * 64.0, (k + l) * 8.0);
+        }
+    }
+
+    std::vector<ArbitraryMeshVertex> expected((horzSub + 1) * (vertSub + 1));
+    sampleSinglePatch(ctrl, horzSub, vertSub, expected);
+
+    std::vector<ArbitraryMeshVertex> sampled(rowStride * (vertSub + 1));
+    const Vertex3f marker(-1, -1, -1);
+
+    for (ArbitraryMeshVertex& vertex : sampled)
+    {
+        vertex.vertex = marker;
+    }
+
+    BezierPatchSampler sampler(horzSub, vertSub);
+    sampler.sample(ctrl, sampled.data(), rowStride);
+
+    for (std::size_t j = 0; j <= vertSub; ++j)
+    {
+        for (std::size_t i = 0; i < rowStride; ++i)
+        {
+            if (i <= horzSub)
+            {
+                BOOST_CHECK(sampled[j * rowStride + i].vertex == expected[j * (horzSub + 1) + i].vertex);
+            }
+            else
+            {
+                BOOST_CHECK(sampled[j * rowStride + i].vertex == marker);
+            }
+        }
+    }
+}
@@ -0,0 +1,379 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE lightInteractionTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/render/LightInteractionManager.h"
+#include "math/Frustum.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+
+using render::LightInteractionManager;
+
+namespace
+{
+    // A point light, its volume is a plain AABB
+    class TestLight :
+        public RendererLight
+    {
+    private:
+        ShaderPtr _shader;
+        Vector3 _direction;
+
+    public:
+        AABB volume;
+
+        float getShaderParm(int parmNum) const override { return 0; }
+        const Vector3& getDirection() const override { return _direction; }
+        const ShaderPtr& getWireShader() const override { return _shader; }
+        const ShaderPtr& getShader() const override { return _shader; }
+        const Vector3& worldOrigin() const override { return volume.origin; }
+        Matrix4 getLightTextureTransformation() const override { return Matrix4::getIdentity(); }
+        bool intersectsAABB(const AABB& aabb) const override { return volume.intersects(aabb); }
+        Vector3 getLightOrigin() const override { return volume.origin; }
+    };
+
+    // A projected light, tested like the frustum of a real projected light,
+    // which reports some boxes outside the frustum as intersecting
+    class TestProjectedLight :
+        public RendererLight
+    {
+    private:
+        ShaderPtr _shader;
+        Vector3 _direction;
+        Vector3 _origin;
+
+    public:
+        Matrix4 viewproj;
+        Frustum frustum;
+
+        void setViewProj(const Vector3& origin, const Matrix4& rotation, double size, double length)
+        {
+            _origin = origin;
+            viewproj = Matrix4::getProjectionForFrustum(-size, size, -size, size, 8, length)
+                .getMultipliedBy(rotation.getTransposed())
+                .getMultipliedBy(Matrix4::getTranslation(-origin));
+            frustum = Frustum::createFromViewproj(viewproj);
+        }
+
+        float getShaderParm(int parmNum) const override { return 0; }
+        const Vector3& getDirection() const override { return _direction; }
+        const ShaderPtr& getWireShader() const override { return _shader; }
+        const ShaderPtr& getShader() const override { return _shader; }
+        const Vector3& worldOrigin() const override { return _origin; }
+        Matrix4 getLightTextureTransformation() const override { return viewproj; }
+        bool intersectsAABB(const AABB& aabb) const override { return frustum.testIntersection(aabb) != VOLUME_OUTSIDE; }
+        Vector3 getLightOrigin() const override { return _origin; }
+    };
+
+    class TestObject :
+        public LitObject
+    {
+    public:
+        AABB bounds;
+
+        bool intersectsLight(const RendererLight& light) const override
+        {
+            return light.intersectsAABB(bounds);
+        }
+
+        AABB getLitObjectBounds() const override
+        {
+            return bounds;
+        }
+    };
+
+    typedef std::vector<const RendererLight*> Lights;
+
+    // The lights of the object as calculated by the LinearLightList the
+    // LightInteractionManager replaced: every light in the order of a set of
+    // light pointers, tested against the object
+    Lights getLinearLights(const TestObject& object, const std::set<RendererLight*>& lights)
+    {
+        Lights result;
+
+        for (RendererLight* light : lights)
+        {
+            if (object.intersectsLight(*light))
+            {
+                result.push_back(light);
+            }
+        }
+
+        return result;
+    }
+
+    Lights getManagedLights(const LightList& list)
+    {
+        Lights result;
+        list.forEachLight([&](const RendererLight& light) { result.push_back(&light); });
+        return result;
+    }
+
+    void checkSameAsLinear(const std::vector<TestObject>& objects, const std::vector<LightList*>& lists,
+        const std::set<RendererLight*>& lights)
+    {
+        std::size_t mismatches = 0;
+
+        for (std::size_t i = 0; i < objects.size(); ++i)
+        {
+            if (getManagedLights(*lists[i]) != getLinearLights(objects[i], lights))
+            {
+                ++mismatches;
+            }
+        }
+
+        BOOST_CHECK_EQUAL(mismatches, 0);
+    }
+
+    void getProjectedExtents(const std::vector<Vector3>& points, const Vector3& axis, double& min, double& max)
+    {
+        min = std::numeric_limits<double>::max();
+        max = -std::numeric_limits<double>::max();
+
+        for (const Vector3& point : points)
+        {
+            double projected = point.dot(axis);
+            min = std::min(min, projected);
+            max = std::max(max, projected);
+        }
+    }
+
+    // Exact test of the box against the frustum volume of the light by the
+    // separating axis theorem, both being convex polyhedra
+    bool isSeparated(const AABB& aabb, const TestProjectedLight& light)
+    {
+        std::vector<Vector3> boxCorners;
+        std::vector<Vector3> frustumCorners;
+
+        Matrix4 inverse = light.viewproj.getFullInverse();
+
+        for (int i = 0; i < 8; ++i)
+        {
+            Vector3 sign(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1);
+
+            boxCorners.push_back(aabb.origin + aabb.extents * sign);
+
+            Vector4 corner = inverse.transform(Vector4(sign, 1));
+            frustumCorners.push_back(Vector3(corner.x(), corner.y(), corner.z()) / corner.w());
+        }
+
+        const Plane3* planes[6] = { &light.frustum.right, &light.frustum.left, &light.frustum.bottom,
+            &light.frustum.top, &light.frustum.back, &light.frustum.front };
+
+        // The corners differing in one bit of their index share an edge
+        std::vector<Vector3> frustumEdges;
+
+        for (int i = 0; i < 8; ++i)
+        {
+            for (int bit = 1; bit < 8; bit <<= 1)
+            {
+                if ((i & bit) == 0)
+                {
+                    frustumEdges.push_back(frustumCorners[i | bit] - frustumCorners[i]);
+                }
+            }
+        }
+
+        std::vector<Vector3> axes = { Vector3(1, 0, 0), Vector3(0, 1, 0), Vector3(0, 0, 1) };
+
+        for (const Plane3* plane : planes)
+        {
+            axes.push_back(plane->normal());
+        }
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            for (const Vector3& edge : frustumEdges)
+            {
+                Vector3 axis = axes[i].crossProduct(edge);
+
+                if (axis.getLengthSquared() > 1e-12)
+                {
+                    axes.push_back(axis.getNormalised());
+                }
+            }
+        }
+
+        for (const Vector3& axis : axes)
+        {
+            double boxMin, boxMax, frustumMin, frustumMax;
+            getProjectedExtents(boxCorners, axis, boxMin, boxMax);
+            getProjectedExtents(frustumCorners, axis, frustumMin, frustumMax);
+
+            if (boxMax < frustumMin || frustumMax < boxMin)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pointLightsSameAsLinear)
+{
+    const std::size_t NUM_LIGHTS = 200;
+    const std::size_t NUM_OBJECTS = 4000;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<double> horizontal(-4096, 4096);
+    std::uniform_real_distribution<double> vertical(-1024, 1024);
+    std::uniform_real_distribution<double> lightRadius(64, 768);
+    std::uniform_real_distribution<double> objectSize(4, 256);
+
+    auto randomPosition = [&]() { return Vector3(horizontal(random), horizontal(random), vertical(random)); };
+
+    std::vector<TestLight> lights(NUM_LIGHTS);
+
+    for (TestLight& light : lights)
+    {
+        light.volume = AABB(randomPosition(), Vector3(lightRadius(random), lightRadius(random), lightRadius(random)));
+    }
+
+    // A few lights and objects too large for the grid
+    lights[0].volume = AABB(Vector3(0, 0, 0), Vector3(6000, 6000, 6000));
+    lights[1].volume = AABB(randomPosition(), Vector3(4000, 4000, 512));
+
+    std::vector<TestObject> objects(NUM_OBJECTS);
+
+    for (TestObject& object : objects)
+    {
+        object.bounds = AABB(randomPosition(), Vector3(objectSize(random), objectSize(random), objectSize(random)));
+    }
+
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        objects[i].bounds = AABB(randomPosition(), Vector3(20000, 20000, 8));
+    }
+
+    LightInteractionManager manager;
+    std::set<RendererLight*> lightSet;
+    std::vector<LightList*> lists;
+
+    for (TestObject& object : objects)
+    {
+        lists.push_back(&manager.attachLitObject(object));
+    }
+
+    for (TestLight& light : lights)
+    {
+        manager.attachLight(light);
+        lightSet.insert(&light);
+    }
+
+    checkSameAsLinear(objects, lists, lightSet);
+
+    // Move single lights, checking all objects after each move
+    std::uniform_int_distribution<std::size_t> lightIndex(0, NUM_LIGHTS - 1);
+
+    for (std::size_t move = 0; move < 10; ++move)
+    {
+        TestLight& light = lights[lightIndex(random)];
+        light.volume.origin = randomPosition();
+        manager.lightChanged(light);
+
+        checkSameAsLinear(objects, lists, lightSet);
+    }
+
+    // Move a bunch of objects at once
+    std::uniform_int_distribution<std::size_t> objectIndex(0, NUM_OBJECTS - 1);
+
+    for (std::size_t move = 0; move < 500; ++move)
+    {
+        std::size_t index = objectIndex(random);
+        objects[index].bounds.origin = randomPosition();
+        lists[index]->setDirty();
+    }
+
+    checkSameAsLinear(objects, lists, lightSet);
+
+    // Remove some lights
+    for (std::size_t i = 0; i < NUM_LIGHTS; i += 3)
+    {
+        manager.detachLight(lights[i]);
+        lightSet.erase(&lights[i]);
+    }
+
+    checkSameAsLinear(objects, lists, lightSet);
+}
+
+BOOST_AUTO_TEST_CASE(projectedLightsDropOnlyFalsePositives)
+{
+    const std::size_t NUM_LIGHTS = 100;
+    const std::size_t NUM_OBJECTS = 4000;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<double> horizontal(-4096, 4096);
+    std::uniform_real_distribution<double> vertical(-1024, 1024);
+    std::uniform_real_distribution<double> angle(-3.14, 3.14);
+    std::uniform_real_distribution<double> frustumSize(4, 16);
+    std::uniform_real_distribution<double> frustumLength(256, 2048);
+    std::uniform_real_distribution<double> objectSize(4, 256);
+
+    auto randomPosition = [&]() { return Vector3(horizontal(random), horizontal(random), vertical(random)); };
+
+    std::vector<TestProjectedLight> lights(NUM_LIGHTS);
+
+    for (TestProjectedLight& light : lights)
+    {
+        Matrix4 rotation = Matrix4::getRotationAboutZ(angle(random)).getMultipliedBy(
+            Matrix4::getRotationAboutX(angle(random)));
+
+        light.setViewProj(randomPosition(), rotation, frustumSize(random), frustumLength(random));
+    }
+
+    std::vector<TestObject> objects(NUM_OBJECTS);
+
+    for (TestObject& object : objects)
+    {
+        object.bounds = AABB(randomPosition(), Vector3(objectSize(random), objectSize(random), objectSize(random)));
+    }
+
+    LightInteractionManager manager;
+    std::set<RendererLight*> lightSet;
+    std::vector<LightList*> lists;
+
+    for (TestObject& object : objects)
+    {
+        lists.push_back(&manager.attachLitObject(object));
+    }
+
+    for (TestProjectedLight& light : lights)
+    {
+        manager.attachLight(light);
+        lightSet.insert(&light);
+    }
+
+    // The grid only tests an object against the lights sharing one of its cells.
+    // Cells rejected by the frustum test may drop objects the frustum test alone
+    // would accept, these must not actually intersect the light volume.
+    std::size_t numInteractions = 0;
+    std::size_t numDropped = 0;
+
+    for (std::size_t i = 0; i < NUM_OBJECTS; ++i)
+    {
+        Lights managed = getManagedLights(*lists[i]);
+        Lights linear = getLinearLights(objects[i], lightSet);
+
+        BOOST_REQUIRE(std::includes(linear.begin(), linear.end(), managed.begin(), managed.end()));
+
+        Lights dropped;
+        std::set_difference(linear.begin(), linear.end(), managed.begin(), managed.end(),
+            std::back_inserter(dropped));
+
+        for (const RendererLight* light : dropped)
+        {
+            BOOST_CHECK(isSeparated(objects[i].bounds, static_cast<const TestProjectedLight&>(*light)));
+        }
+
+        numInteractions += managed.size();
+        numDropped += dropped.size();
+    }
+
+    BOOST_TEST_MESSAGE(numInteractions << " interactions, " << numDropped << " false positives dropped");
+    BOOST_CHECK(numInteractions > 0);
+}
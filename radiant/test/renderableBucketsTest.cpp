@@ -0,0 +1,251 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE renderableBucketsTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/render/backend/RenderableBuckets.h"
+#include "irender.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using render::RenderableBuckets;
+
+namespace
+{
+    const std::size_t NUM_RENDERABLES = 30000;
+    const std::size_t RENDERABLES_PER_ENTITY = 30;
+    const std::size_t NUM_PASSES = 400;
+
+    class TestRenderable :
+        public OpenGLRenderable
+    {
+    public:
+        void render(const RenderInfo& info) const override
+        {}
+    };
+
+    class TestEntity :
+        public IRenderEntity
+    {
+    private:
+        Vector3 _direction;
+        ShaderPtr _shader;
+
+    public:
+        float getShaderParm(int parmNum) const override { return 0; }
+        const Vector3& getDirection() const override { return _direction; }
+        const ShaderPtr& getWireShader() const override { return _shader; }
+    };
+
+    // A node submitting one renderable per frame
+    struct TestNode
+    {
+        TestRenderable renderable;
+        const Matrix4* transform;
+        const IRenderEntity* entity;
+        std::size_t pass;
+    };
+
+    // The collection scheme of the OpenGLShaderPass the RenderableBuckets replaced:
+    // a std::map of entities looked up for every renderable, freed after each frame
+    class MapBucket
+    {
+    public:
+        struct TransformedRenderable
+        {
+            const OpenGLRenderable* renderable;
+            const Matrix4* transform;
+        };
+
+        typedef std::vector<TransformedRenderable> Renderables;
+        Renderables renderablesWithoutEntity;
+
+        typedef std::map<const IRenderEntity*, Renderables> RenderablesByEntity;
+        RenderablesByEntity renderables;
+
+        void addRenderable(const OpenGLRenderable& renderable, const Matrix4& modelview,
+            const IRenderEntity* entity)
+        {
+            TransformedRenderable transformed = { &renderable, &modelview };
+
+            if (entity == nullptr)
+            {
+                renderablesWithoutEntity.push_back(transformed);
+                return;
+            }
+
+            renderables[entity].push_back(transformed);
+        }
+
+        void clear()
+        {
+            renderablesWithoutEntity.clear();
+            renderables.clear();
+        }
+    };
+
+    // The renderables of a pass as (entity, renderable, transform) tuples
+    typedef std::tuple<const IRenderEntity*, const OpenGLRenderable*, Matrix4> Entry;
+
+    bool compareEntries(const Entry& a, const Entry& b)
+    {
+        return std::get<0>(a) < std::get<0>(b) ||
+            (std::get<0>(a) == std::get<0>(b) && std::get<1>(a) < std::get<1>(b));
+    }
+
+    std::vector<Entry> getEntries(const MapBucket& bucket)
+    {
+        std::vector<Entry> entries;
+
+        for (const MapBucket::TransformedRenderable& r : bucket.renderablesWithoutEntity)
+        {
+            entries.emplace_back(nullptr, r.renderable, *r.transform);
+        }
+
+        for (const MapBucket::RenderablesByEntity::value_type& pair : bucket.renderables)
+        {
+            for (const MapBucket::TransformedRenderable& r : pair.second)
+            {
+                entries.emplace_back(pair.first, r.renderable, *r.transform);
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(), compareEntries);
+        return entries;
+    }
+
+    std::vector<Entry> getEntries(const RenderableBuckets& buckets)
+    {
+        std::vector<Entry> entries;
+
+        for (const RenderableBuckets::Renderable& r : buckets.getRenderablesWithoutEntity())
+        {
+            entries.emplace_back(nullptr, r.renderable, buckets.getTransform(r.transform));
+        }
+
+        buckets.forEachEntityBucket([&](const IRenderEntity& entity, const RenderableBuckets::Renderables& renderables)
+        {
+            for (const RenderableBuckets::Renderable& r : renderables)
+            {
+                entries.emplace_back(&entity, r.renderable, buckets.getTransform(r.transform));
+            }
+        });
+
+        std::sort(entries.begin(), entries.end(), compareEntries);
+        return entries;
+    }
+
+    // Renderables distributed randomly over the passes, visited entity by entity
+    // like the scene walker does. A quarter of them (like the worldspawn brushes)
+    // is not rendered with an entity.
+    class TestScene
+    {
+    public:
+        std::vector<TestEntity> entities;
+        std::vector<Matrix4> transforms;
+        std::vector<TestNode> nodes;
+
+        TestScene() :
+            entities(NUM_RENDERABLES / RENDERABLES_PER_ENTITY + 1),
+            transforms(entities.size()),
+            nodes(NUM_RENDERABLES)
+        {
+            std::mt19937 random(1234);
+            std::uniform_int_distribution<std::size_t> passIndex(0, NUM_PASSES - 1);
+            std::uniform_int_distribution<int> quarter(0, 3);
+            std::uniform_real_distribution<double> coordinate(-8192, 8192);
+
+            for (Matrix4& transform : transforms)
+            {
+                transform = Matrix4::getTranslation(Vector3(coordinate(random), coordinate(random), coordinate(random)));
+            }
+
+            for (std::size_t i = 0; i < nodes.size(); ++i)
+            {
+                std::size_t entity = i / RENDERABLES_PER_ENTITY;
+
+                nodes[i].transform = &transforms[entity];
+                nodes[i].entity = quarter(random) == 0 ? nullptr : &entities[entity];
+                nodes[i].pass = passIndex(random);
+            }
+        }
+
+        void collect(std::vector<RenderableBuckets>& passes) const
+        {
+            for (const TestNode& node : nodes)
+            {
+                passes[node.pass].add(node.renderable, *node.transform, node.entity, nullptr);
+            }
+        }
+
+        void collect(std::vector<MapBucket>& passes) const
+        {
+            for (const TestNode& node : nodes)
+            {
+                passes[node.pass].addRenderable(node.renderable, *node.transform, node.entity);
+            }
+        }
+    };
+}
+
+BOOST_AUTO_TEST_CASE(sameRenderablesAsEntityMap)
+{
+    TestScene scene;
+
+    std::vector<MapBucket> mapBuckets(NUM_PASSES);
+    std::vector<RenderableBuckets> renderableBuckets(NUM_PASSES);
+
+    // Check a few frames, the later ones re-use the buckets of the first one
+    for (std::size_t frame = 0; frame < 3; ++frame)
+    {
+        scene.collect(mapBuckets);
+        scene.collect(renderableBuckets);
+
+        std::size_t mismatches = 0;
+
+        for (std::size_t pass = 0; pass < NUM_PASSES; ++pass)
+        {
+            if (getEntries(mapBuckets[pass]) != getEntries(renderableBuckets[pass]))
+            {
+                ++mismatches;
+            }
+
+            mapBuckets[pass].clear();
+            renderableBuckets[pass].clear();
+        }
+
+        BOOST_CHECK_EQUAL(mismatches, 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(noAllocationsAfterFirstFrame)
+{
+    TestScene scene;
+
+    std::vector<RenderableBuckets> renderableBuckets(NUM_PASSES);
+
+    for (std::size_t frame = 0; frame < 10; ++frame)
+    {
+        scene.collect(renderableBuckets);
+
+        std::size_t allocations = 0;
+
+        for (RenderableBuckets& buckets : renderableBuckets)
+        {
+            allocations += buckets.getAllocationCount();
+            buckets.clear();
+        }
+
+        if (frame == 0)
+        {
+            BOOST_CHECK(allocations > 0);
+        }
+        else
+        {
+            BOOST_CHECK_EQUAL(allocations, 0);
+        }
+    }
+}
@@ -0,0 +1,280 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE selectionPoolTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/selection/SelectionPool.h"
+#include "util/Stopwatch.h"
+
+#include <list>
+#include <map>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    class TestSelectable :
+        public ISelectable
+    {
+    private:
+        bool _selected = false;
+
+    public:
+        void setSelected(bool select) override
+        {
+            _selected = select;
+        }
+
+        bool isSelected() const override
+        {
+            return _selected;
+        }
+    };
+
+    // The pool as used before the SelectionPool, a sorted multimap plus a map
+    // for the duplicate check. Used as reference for the candidate order.
+    class MultimapSelectionPool
+    {
+    public:
+        typedef std::multimap<SelectionIntersection, ISelectable*> SelectableSortedSet;
+
+    private:
+        SelectableSortedSet _pool;
+        std::map<ISelectable*, SelectableSortedSet::iterator> _currentSelectables;
+
+    public:
+        void addSelectable(const SelectionIntersection& intersection, ISelectable* selectable)
+        {
+            if (!intersection.isValid()) return;
+
+            auto existing = _currentSelectables.find(selectable);
+
+            if (existing != _currentSelectables.end())
+            {
+                if (!(intersection < existing->second->first)) return;
+
+                _pool.erase(existing->second);
+                _currentSelectables.erase(existing);
+            }
+
+            _currentSelectables.insert(std::make_pair(selectable, _pool.insert(std::make_pair(intersection, selectable))));
+        }
+
+        const SelectableSortedSet& getPool() const
+        {
+            return _pool;
+        }
+    };
+
+    void checkSameOrder(const SelectionPool& pool, const MultimapSelectionPool& reference)
+    {
+        std::vector<ISelectable*> poolOrder;
+        std::vector<ISelectable*> referenceOrder;
+
+        for (const SelectionPool::Candidate& candidate : pool)
+        {
+            poolOrder.push_back(candidate.second);
+        }
+
+        for (const auto& pair : reference.getPool())
+        {
+            referenceOrder.push_back(pair.second);
+        }
+
+        BOOST_CHECK(poolOrder == referenceOrder);
+    }
+
+    typedef std::vector<std::pair<SelectionIntersection, ISelectable*>> CandidateList;
+
+    // The entity and primitive pools of a selection test, merged into one list
+    // the way RadiantSelectionSystem did before the SelectionPool
+    std::size_t collectWithMultimapPools(const CandidateList& entityCandidates, const CandidateList& primitiveCandidates)
+    {
+        MultimapSelectionPool entities;
+        MultimapSelectionPool primitives;
+
+        for (const auto& candidate : entityCandidates)
+        {
+            entities.addSelectable(candidate.first, candidate.second);
+        }
+
+        for (const auto& candidate : primitiveCandidates)
+        {
+            primitives.addSelectable(candidate.first, candidate.second);
+        }
+
+        std::list<ISelectable*> targetList;
+
+        for (const auto& pair : entities.getPool())
+        {
+            targetList.push_back(pair.second);
+        }
+
+        for (const auto& pair : primitives.getPool())
+        {
+            if (std::find(targetList.begin(), targetList.end(), pair.second) == targetList.end())
+            {
+                targetList.push_back(pair.second);
+            }
+        }
+
+        return targetList.size();
+    }
+
+    // Same as above with the SelectionPool and a hash set for the merge
+    std::size_t collectWithSelectionPools(const CandidateList& entityCandidates, const CandidateList& primitiveCandidates)
+    {
+        SelectionPool entities;
+        SelectionPool primitives;
+
+        for (const auto& candidate : entityCandidates)
+        {
+            entities.addSelectable(candidate.first, candidate.second);
+        }
+
+        for (const auto& candidate : primitiveCandidates)
+        {
+            primitives.addSelectable(candidate.first, candidate.second);
+        }
+
+        std::list<ISelectable*> targetList;
+
+        for (const auto& candidate : entities)
+        {
+            targetList.push_back(candidate.second);
+        }
+
+        std::unordered_set<ISelectable*> added(targetList.begin(), targetList.end());
+
+        for (const auto& candidate : primitives)
+        {
+            if (added.insert(candidate.second).second)
+            {
+                targetList.push_back(candidate.second);
+            }
+        }
+
+        return targetList.size();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(emptyPool)
+{
+    SelectionPool pool;
+    TestSelectable selectable;
+
+    BOOST_CHECK(pool.empty());
+
+    // Invalid intersections are not added
+    pool.addSelectable(SelectionIntersection(), &selectable);
+
+    BOOST_CHECK(pool.empty());
+    BOOST_CHECK(pool.begin() == pool.end());
+}
+
+BOOST_AUTO_TEST_CASE(keepBestIntersection)
+{
+    SelectionPool pool;
+    TestSelectable first;
+    TestSelectable second;
+
+    pool.addSelectable(SelectionIntersection(0.5f, 0), &first);
+    pool.addSelectable(SelectionIntersection(0.2f, 0), &second);
+
+    // A worse intersection doesn't replace the existing one
+    pool.addSelectable(SelectionIntersection(0.8f, 0), &second);
+
+    BOOST_REQUIRE_EQUAL(std::distance(pool.begin(), pool.end()), 2);
+    BOOST_CHECK(pool.begin()->second == &second);
+
+    // A better one does
+    pool.addSelectable(SelectionIntersection(0.1f, 0), &first);
+
+    BOOST_REQUIRE_EQUAL(std::distance(pool.begin(), pool.end()), 2);
+    BOOST_CHECK(pool.begin()->second == &first);
+    BOOST_CHECK_EQUAL(pool.begin()->first.depth(), 0.1f);
+}
+
+BOOST_AUTO_TEST_CASE(sameOrderAsMultimap)
+{
+    const std::size_t NUM_SELECTABLES = 2000;
+    const std::size_t NUM_CANDIDATES = 8000;
+
+    std::vector<TestSelectable> selectables(NUM_SELECTABLES);
+
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<std::size_t> index(0, NUM_SELECTABLES - 1);
+
+    // Few distinct depths and distances, such that many intersections are equal
+    std::uniform_int_distribution<int> depth(-4, 4);
+    std::uniform_int_distribution<int> distance(0, 2);
+
+    SelectionPool pool;
+    MultimapSelectionPool reference;
+
+    for (std::size_t i = 0; i < NUM_CANDIDATES; ++i)
+    {
+        SelectionIntersection intersection(depth(random) * 0.25f, static_cast<float>(distance(random)));
+        ISelectable* selectable = &selectables[index(random)];
+
+        pool.addSelectable(intersection, selectable);
+        reference.addSelectable(intersection, selectable);
+
+        // Iterating sorts the pool, further candidates must still be merged correctly
+        if (i == NUM_CANDIDATES / 2)
+        {
+            checkSameOrder(pool, reference);
+        }
+    }
+
+    checkSameOrder(pool, reference);
+}
+
+BOOST_AUTO_TEST_CASE(fasterThanMultimap)
+{
+    const std::size_t NUM_PRIMITIVES = 50000;
+    const std::size_t NUM_ENTITIES = NUM_PRIMITIVES / 10;
+
+    // Each group entity is reported once for each of its child primitives
+    const std::size_t CHILDREN_PER_ENTITY = 4;
+
+    std::vector<TestSelectable> primitives(NUM_PRIMITIVES);
+    std::vector<TestSelectable> entities(NUM_ENTITIES);
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> depth(-1, 1);
+
+    CandidateList entityCandidates;
+    CandidateList primitiveCandidates;
+
+    for (TestSelectable& entity : entities)
+    {
+        for (std::size_t i = 0; i < CHILDREN_PER_ENTITY; ++i)
+        {
+            entityCandidates.emplace_back(SelectionIntersection(depth(random), 0), &entity);
+        }
+    }
+
+    // Box selections report a zero distance for every primitive
+    for (TestSelectable& primitive : primitives)
+    {
+        primitiveCandidates.emplace_back(SelectionIntersection(depth(random), 0), &primitive);
+    }
+
+    std::shuffle(entityCandidates.begin(), entityCandidates.end(), random);
+
+    util::Stopwatch timer;
+    std::size_t numMultimapCandidates = collectWithMultimapPools(entityCandidates, primitiveCandidates);
+    double multimapTime = timer.getMilliseconds();
+
+    timer.restart();
+    std::size_t numPoolCandidates = collectWithSelectionPools(entityCandidates, primitiveCandidates);
+    double poolTime = timer.getMilliseconds();
+
+    BOOST_TEST_MESSAGE(NUM_PRIMITIVES << " primitives, " << NUM_ENTITIES << " entities: multimap pools "
+        << multimapTime << " ms, SelectionPool " << poolTime << " ms");
+
+    BOOST_CHECK_EQUAL(numPoolCandidates, numMultimapCandidates);
+    BOOST_CHECK_EQUAL(numPoolCandidates, NUM_PRIMITIVES + NUM_ENTITIES);
+    BOOST_CHECK(poolTime < multimapTime);
+}
@@ -33,14 +33,59 @@ public:
 		_command = name;
 	}
 
-	void save(IUndoable& undoable)
+	// Returns the memory used by the saved state, excluding the data it shares
+	std::size_t save(IUndoable& undoable, SharedDataTracker& sharedData)
 	{
-		_snapshot.save(undoable);
+		return _snapshot.save(undoable, sharedData);
 	}
 
-	void restoreSnapshot()
+	void releaseSharedData(SharedDataTracker& sharedData) const
 	{
-		_snapshot.restore();
+		_snapshot.releaseSharedData(sharedData);
+	}
+
+	void releaseSpilledStates(SpillFile& spillFile) const
+	{
+		_snapshot.releaseSpilledStates(spillFile);
+	}
+
+	void foreachSharedData(const std::function<void(const void*, std::size_t)>& functor) const
+	{
+		_snapshot.foreachSharedData(functor);
+	}
+
+	// Moves the saved states holding plain data to the given file, returns false if nothing was moved
+	bool spill(SpillFile& spillFile, SharedDataTracker& sharedData)
+	{
+		return _snapshot.spill(spillFile, sharedData);
+	}
+
+	bool isSpilled() const
+	{
+		return _snapshot.isSpilled();
+	}
+
+	std::size_t getSpilledSize() const
+	{
+		return _snapshot.getSpilledSize();
+	}
+
+	// Returns false if the spilled states couldn't be read back, nothing is restored then
+	bool restoreSnapshot(SpillFile& spillFile)
+	{
+		return _snapshot.restore(spillFile);
+	}
+
+	// The number of saved Undoables
+	std::size_t getNumSavedStates() const
+	{
+		return _snapshot.size();
+	}
+
+	// The number of bytes allocated for the saved states, excluding the data they share
+	std::size_t getMemoryUsage() const
+	{
+		return _snapshot.getMemoryUsage();
 	}
 };
 typedef std::shared_ptr<Operation> OperationPtr;
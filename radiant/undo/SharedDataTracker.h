@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace undo
+{
+
+/**
+ * Counts the memory of the data blocks shared between UndoMementos. Each
+ * block is counted once, as long as at least one saved memento refers to it,
+ * no matter which memento allocated it. Removing the oldest operation of a
+ * stack therefore only frees the blocks no newer operation is holding.
+ */
+class SharedDataTracker
+{
+private:
+	struct Block
+	{
+		std::size_t size;
+		std::size_t holders;
+	};
+
+	std::unordered_map<const void*, Block> _blocks;
+	std::size_t _memoryUsage;
+
+public:
+	SharedDataTracker() :
+		_memoryUsage(0)
+	{}
+
+	// Adds a holder of the given block
+	void add(const void* data, std::size_t size)
+	{
+		auto result = _blocks.emplace(data, Block{ size, 0 });
+
+		if (result.second)
+		{
+			_memoryUsage += size;
+		}
+
+		++result.first->second.holders;
+	}
+
+	// Removes a holder of the given block, the block isn't counted after its last holder is gone
+	void remove(const void* data)
+	{
+		auto found = _blocks.find(data);
+
+		if (found == _blocks.end()) return;
+
+		if (--found->second.holders == 0)
+		{
+			_memoryUsage -= found->second.size;
+			_blocks.erase(found);
+		}
+	}
+
+	// The memory used by all blocks with at least one holder
+	std::size_t getMemoryUsage() const
+	{
+		return _memoryUsage;
+	}
+};
+
+} // namespace undo
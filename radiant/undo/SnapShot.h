@@ -1,6 +1,13 @@
 #pragma once
 
 #include "iundo.h"
+#include "itextstream.h"
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "SharedDataTracker.h"
+#include "SpillFile.h"
 
 namespace undo
 {
@@ -16,17 +23,63 @@ public:
 	IUndoable& _undoable;
 private:
 	IUndoMementoPtr _data;
+
+	// Set once the memento has been moved to the spill file
+	bool _spilled;
 public:
 	// Constructor
 	UndoMementoKeeper(IUndoable& undoable) :
 		_undoable(undoable), 
-		_data(_undoable.exportState())
+		_data(_undoable.exportState()),
+		_spilled(false)
 	{}
 
 	void restoreState()
 	{
 		_undoable.importState(_data);
 	}
+
+	// Restores a state read back from the spill file
+	void restoreState(const IUndoMementoPtr& data)
+	{
+		_undoable.importState(data);
+	}
+
+	// True if the memento has been moved to the spill file
+	bool isSpilled() const
+	{
+		return _spilled;
+	}
+
+	bool writeState(std::ostream& stream) const
+	{
+		return _data && _data->writeTo(stream);
+	}
+
+	// Releases the memento after it has been written to the spill file
+	void dropState()
+	{
+		_data.reset();
+		_spilled = true;
+	}
+
+	IUndoMementoPtr readState(std::istream& stream) const
+	{
+		return _undoable.readState(stream);
+	}
+
+	std::size_t getMemoryUsage() const
+	{
+		return sizeof(*this) + (_data ? _data->getMemoryUsage() : 0);
+	}
+
+	void foreachSharedData(const std::function<void(const void*, std::size_t)>& functor) const
+	{
+		if (_data)
+		{
+			_data->foreachSharedData(functor);
+		}
+	}
 };
 
 /** 
@@ -36,27 +89,200 @@ public:
  * What happens on save(): The Undable is queried for its UndoMemento (the actual data)
  * whose pointer is stored along with the Undable* itself into a list.
  *
- * Upon request (restore() or release()) the UndoMementos are restored back to their according
- * Undoables or released from memory, resp.
+ * The keepers are stored in a contiguous array, in order of saving. Upon request (restore())
+ * the UndoMementos are restored back to their according Undoables in reverse order.
+ *
+ * The UndoMementos holding plain data can be moved to a SpillFile by spill(), they
+ * are read back from there by restore(). Mementos referring to other objects
+ * (like the face list of a brush or the children of a node) stay in memory.
  */
-class Snapshot :
-	public std::list<UndoMementoKeeper>
+class Snapshot
 {
+private:
+	std::vector<UndoMementoKeeper> _states;
+
+	// The memory used by the saved UndoMementos alone
+	std::size_t _memoryUsage = 0;
+
+	// The blocks the saved UndoMementos share with other ones
+	std::vector<const void*> _sharedData;
+
+	// Set if some of the UndoMementos have been moved to the spill file
+	bool _spilled = false;
+	SpillFile::Chunk _spilledChunk;
+
 public:
 	// Adds a StateApplicator to the internal list. The Undoable pointer is saved as well as
-	// the pointer to its UndoMemento (queried by exportState().
-	void save(IUndoable& undoable)
+	// the pointer to its UndoMemento (queried by exportState(). The shared data of the state
+	// is added to the given tracker. Returns the memory used by the state alone.
+	std::size_t save(IUndoable& undoable, SharedDataTracker& sharedData)
 	{
-		push_front(UndoMementoKeeper(undoable));
+		_states.emplace_back(undoable);
+
+		_states.back().foreachSharedData([&](const void* data, std::size_t size)
+		{
+			_sharedData.push_back(data);
+			sharedData.add(data, size);
+		});
+
+		std::size_t memoryUsage = _states.back().getMemoryUsage();
+		_memoryUsage += memoryUsage;
+
+		return memoryUsage;
 	}
 
-	// Cycles through all the StateApplicators and tells them to restore the state.
-	void restore()
+	// Removes this snapshot from the holders of its shared data
+	void releaseSharedData(SharedDataTracker& sharedData) const
 	{
-		std::for_each(begin(), end(), [&] (UndoMementoKeeper& state)
+		for (const void* data : _sharedData)
 		{
-			state.restoreState();
-		});
+			sharedData.remove(data);
+		}
+	}
+
+	// Releases the block of this snapshot in the given spill file, if there is one
+	void releaseSpilledStates(SpillFile& spillFile) const
+	{
+		if (_spilled)
+		{
+			spillFile.release(_spilledChunk);
+		}
+	}
+
+	bool isSpilled() const
+	{
+		return _spilled;
+	}
+
+	// The number of bytes the spilled states are taking up in the file
+	std::size_t getSpilledSize() const
+	{
+		return _spilled ? static_cast<std::size_t>(_spilledChunk.compressedSize) : 0;
+	}
+
+	// Writes the UndoMementos holding plain data to the given file and releases them.
+	// The memory usage and the shared data are recounted for the remaining mementos.
+	// Returns false if nothing has been moved, a snapshot is only spilled once.
+	bool spill(SpillFile& spillFile, SharedDataTracker& sharedData)
+	{
+		if (_spilled) return false;
+
+		std::ostringstream stream(std::ios::out | std::ios::binary);
+		std::vector<bool> written(_states.size(), false);
+		bool anyWritten = false;
+
+		for (std::size_t i = 0; i < _states.size(); ++i)
+		{
+			written[i] = _states[i].writeState(stream);
+			anyWritten |= written[i];
+		}
+
+		if (!anyWritten || !spillFile.write(stream.str(), _spilledChunk))
+		{
+			return false;
+		}
+
+		_spilled = true;
+
+		releaseSharedData(sharedData);
+		_sharedData.clear();
+		_memoryUsage = 0;
+
+		for (std::size_t i = 0; i < _states.size(); ++i)
+		{
+			if (written[i])
+			{
+				_states[i].dropState();
+			}
+
+			_states[i].foreachSharedData([&](const void* data, std::size_t size)
+			{
+				_sharedData.push_back(data);
+				sharedData.add(data, size);
+			});
+
+			_memoryUsage += _states[i].getMemoryUsage();
+		}
+
+		return true;
+	}
+
+	void foreachSharedData(const std::function<void(const void*, std::size_t)>& functor) const
+	{
+		for (const UndoMementoKeeper& state : _states)
+		{
+			state.foreachSharedData(functor);
+		}
+	}
+
+	std::size_t size() const
+	{
+		return _states.size();
+	}
+
+	std::size_t getMemoryUsage() const
+	{
+		return _memoryUsage;
+	}
+
+	// Cycles through all the StateApplicators and tells them to restore the state,
+	// the most recently saved one first. Spilled states are read back from the given
+	// file first, nothing is restored if that fails.
+	bool restore(SpillFile& spillFile)
+	{
+		std::vector<IUndoMementoPtr> spilledStates;
+
+		if (_spilled && !readSpilledStates(spillFile, spilledStates))
+		{
+			return false;
+		}
+
+		std::vector<IUndoMementoPtr>::reverse_iterator spilledState = spilledStates.rbegin();
+
+		for (std::vector<UndoMementoKeeper>::reverse_iterator i = _states.rbegin(); i != _states.rend(); ++i)
+		{
+			if (i->isSpilled())
+			{
+				i->restoreState(*spilledState++);
+			}
+			else
+			{
+				i->restoreState();
+			}
+		}
+
+		return true;
+	}
+
+private:
+	// Reads the spilled mementos, in the order they were saved
+	bool readSpilledStates(SpillFile& spillFile, std::vector<IUndoMementoPtr>& spilledStates) const
+	{
+		std::string data;
+
+		if (!spillFile.read(_spilledChunk, data))
+		{
+			return false;
+		}
+
+		std::istringstream stream(data, std::ios::in | std::ios::binary);
+
+		for (const UndoMementoKeeper& state : _states)
+		{
+			if (!state.isSpilled()) continue;
+
+			IUndoMementoPtr memento = state.readState(stream);
+
+			if (!memento)
+			{
+				rError() << "Undo: could not read back a saved state" << std::endl;
+				return false;
+			}
+
+			spilledStates.push_back(memento);
+		}
+
+		return true;
 	}
 };
 
@@ -0,0 +1,154 @@
+#include "SpillFile.h"
+
+#include "itextstream.h"
+#include "os/fs.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <zlib.h>
+#include <fmt/format.h>
+
+namespace undo
+{
+
+SpillFile::SpillFile() :
+	_size(0),
+	_numChunks(0)
+{}
+
+SpillFile::~SpillFile()
+{
+	close();
+}
+
+bool SpillFile::write(const std::string& data, Chunk& chunk)
+{
+	if (!_stream.is_open() && !open())
+	{
+		return false;
+	}
+
+	uLongf compressedSize = compressBound(static_cast<uLong>(data.size()));
+	std::vector<Bytef> compressed(compressedSize);
+
+	if (compress2(compressed.data(), &compressedSize, reinterpret_cast<const Bytef*>(data.data()),
+		static_cast<uLong>(data.size()), Z_BEST_SPEED) != Z_OK)
+	{
+		rError() << "Undo: could not compress the saved states" << std::endl;
+		return false;
+	}
+
+	_stream.seekp(static_cast<std::streamoff>(_size));
+	_stream.write(reinterpret_cast<const char*>(compressed.data()), compressedSize);
+	_stream.flush();
+
+	if (!_stream)
+	{
+		rError() << "Undo: could not write to " << _path << std::endl;
+		_stream.clear();
+		return false;
+	}
+
+	chunk.offset = _size;
+	chunk.compressedSize = compressedSize;
+	chunk.size = data.size();
+
+	_size += compressedSize;
+	++_numChunks;
+
+	return true;
+}
+
+bool SpillFile::read(const Chunk& chunk, std::string& data)
+{
+	std::vector<Bytef> compressed(static_cast<std::size_t>(chunk.compressedSize));
+
+	_stream.seekg(static_cast<std::streamoff>(chunk.offset));
+	_stream.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+
+	if (!_stream)
+	{
+		rError() << "Undo: could not read from " << _path << std::endl;
+		_stream.clear();
+		return false;
+	}
+
+	data.resize(static_cast<std::size_t>(chunk.size));
+	uLongf size = static_cast<uLongf>(chunk.size);
+
+	if (uncompress(reinterpret_cast<Bytef*>(&data[0]), &size, compressed.data(),
+		static_cast<uLong>(compressed.size())) != Z_OK || size != chunk.size)
+	{
+		rError() << "Undo: could not decompress the saved states read from " << _path << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void SpillFile::release(const Chunk& chunk)
+{
+	if (_numChunks == 0) return;
+
+	// Start over with an empty file once nothing refers to its contents anymore
+	if (--_numChunks == 0)
+	{
+		close();
+	}
+}
+
+std::uint64_t SpillFile::getSize() const
+{
+	return _size;
+}
+
+bool SpillFile::open()
+{
+	// The address of this instance tells apart the files of a process
+	auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+
+	try
+	{
+		_path = (fs::temp_directory_path() / fmt::format("darkradiant_undo_{0:x}_{1:x}.tmp",
+			reinterpret_cast<std::uintptr_t>(this), ticks)).string();
+	}
+	catch (fs::filesystem_error& ex)
+	{
+		rError() << "Undo: no temporary directory available: " << ex.what() << std::endl;
+		return false;
+	}
+
+	_stream.open(_path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+
+	if (!_stream)
+	{
+		rError() << "Undo: could not create " << _path << std::endl;
+		_stream.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void SpillFile::close()
+{
+	if (!_stream.is_open()) return;
+
+	_stream.close();
+	_stream.clear();
+
+	try
+	{
+		fs::remove(_path);
+	}
+	catch (fs::filesystem_error& ex)
+	{
+		rWarning() << "Undo: could not remove " << _path << ": " << ex.what() << std::endl;
+	}
+
+	_size = 0;
+	_numChunks = 0;
+}
+
+} // namespace undo
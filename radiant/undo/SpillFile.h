@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace undo
+{
+
+/**
+ * A temporary file receiving the saved states of old undo operations, such that
+ * the undo history can be limited by its memory usage without throwing away the
+ * oldest operations. Each block of states is compressed and appended to the file,
+ * the blocks are read back when their operation is undone or redone.
+ *
+ * The space of released blocks is not re-used, the file is truncated once all
+ * of them are released. The file is created on first use in the system's
+ * temporary directory and removed when this instance is destroyed.
+ */
+class SpillFile
+{
+public:
+	// The location of a written block of data
+	struct Chunk
+	{
+		std::uint64_t offset;
+		std::uint64_t compressedSize;
+		std::uint64_t size;
+	};
+
+private:
+	std::string _path;
+	std::fstream _stream;
+
+	// The end of the data written to the file
+	std::uint64_t _size;
+
+	// The number of written chunks which haven't been released yet
+	std::size_t _numChunks;
+
+public:
+	SpillFile();
+	~SpillFile();
+
+	// Compresses the given data and appends it to the file, returns false on failure
+	bool write(const std::string& data, Chunk& chunk);
+
+	// Reads back the data of the given chunk, returns false on failure
+	bool read(const Chunk& chunk, std::string& data);
+
+	// Marks the chunk as no longer needed
+	void release(const Chunk& chunk);
+
+	// The number of bytes in the file
+	std::uint64_t getSize() const;
+
+private:
+	bool open();
+	void close();
+};
+
+} // namespace undo
@@ -26,7 +26,21 @@ class UndoStack
 	// The pending undo operation (a working variable, so to say)
 	OperationPtr _pending;
 
+	// The memory used by the saved states of all Operations, excluding the data they share
+	std::size_t _memoryUsage;
+
+	// Counts the data shared by the saved states, across the undo and redo stacks
+	SharedDataTracker& _sharedData;
+
+	// Receives the states of old operations, shared with the other stack
+	SpillFile& _spillFile;
+
 public:
+	UndoStack(SharedDataTracker& sharedData, SpillFile& spillFile) :
+		_memoryUsage(0),
+		_sharedData(sharedData),
+		_spillFile(spillFile)
+	{}
 
 	bool empty() const
 	{
@@ -48,19 +62,77 @@ public:
 		return _stack.front();
 	}
 
+	std::size_t getMemoryUsage() const
+	{
+		return _memoryUsage;
+	}
+
 	void pop_front()
 	{
+		release(*_stack.front());
 		_stack.pop_front();
 	}
 
 	void pop_back()
 	{
+		release(*_stack.back());
 		_stack.pop_back();
 	}
 
 	void clear()
 	{
+		for (const OperationPtr& operation : _stack)
+		{
+			release(*operation);
+		}
+
 		_stack.clear();
+		_memoryUsage = 0;
+	}
+
+	// Moves the plain data of the given operation of this stack to the spill file,
+	// returns false if there was nothing to move
+	bool spill(Operation& operation)
+	{
+		std::size_t memoryUsage = operation.getMemoryUsage();
+
+		if (!operation.spill(_spillFile, _sharedData))
+		{
+			return false;
+		}
+
+		_memoryUsage -= memoryUsage - operation.getMemoryUsage();
+		return true;
+	}
+
+	// Restores the states of the given operation, reading back the spilled ones
+	bool restore(Operation& operation)
+	{
+		return operation.restoreSnapshot(_spillFile);
+	}
+
+	typedef Operations::const_iterator const_iterator;
+
+	const_iterator begin() const
+	{
+		return _stack.begin();
+	}
+
+	const_iterator end() const
+	{
+		return _stack.end();
+	}
+
+	typedef Operations::const_reverse_iterator const_reverse_iterator;
+
+	const_reverse_iterator rbegin() const
+	{
+		return _stack.rbegin();
+	}
+
+	const_reverse_iterator rend() const
+	{
+		return _stack.rend();
 	}
 
 	// Allocate a new Operation to work with
@@ -103,7 +175,15 @@ public:
 		}
 
 		// Save the UndoMemento of the most recently added command into the snapshot
-		back()->save(undoable);
+		_memoryUsage += back()->save(undoable, _sharedData);
+	}
+
+private:
+	void release(const Operation& operation)
+	{
+		_memoryUsage -= operation.getMemoryUsage();
+		operation.releaseSharedData(_sharedData);
+		operation.releaseSpilledStates(_spillFile);
 	}
 
 }; // class UndoStack
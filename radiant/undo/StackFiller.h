@@ -7,38 +7,54 @@
 namespace undo 
 {
 
+/**
+ * The undo or redo operation the Undoables are currently saving their state to.
+ * A single instance is owned by the UndoSystem and shared by all UndoStackFillers,
+ * such that starting or finishing an operation doesn't need to visit every filler.
+ */
+struct ActiveOperation
+{
+	// The stack receiving the states, NULL if no operation is active
+	UndoStack* stack;
+
+	// Incremented each time an operation is started
+	std::size_t id;
+
+	ActiveOperation() :
+		stack(nullptr),
+		id(0)
+	{}
+};
+
 /**
  * greebo: This class acts as some sort of "duplication guard".
  * Undoable objects like brushes and patches will save their state
  * by calling the save() method - to ensure Undoables don't submit
- * their state more than once, the associated UndoStack reference 
- * is cleared after submission in the save() routine. Further calls
- * to save() will not have any effect. The stack reference is set
- * by the UndoSystem on start of an undo or redo operation.
+ * their state more than once, the filler remembers the operation
+ * it has been saved to. Further calls to save() during the same
+ * operation will not have any effect. Fillers created during an
+ * operation will only save their Undoable in the next one.
  */
 class UndoStackFiller :
 	public IUndoStateSaver
 {
-	UndoStack* _stack;
+	const ActiveOperation& _operation;
+
+	// The id of the operation this Undoable has been saved to
+	std::size_t _savedOperation;
 
     IMapFileChangeTracker* _tracker;
 
 public:
-
-	// Constructor
-	UndoStackFiller() : 
-		_stack(nullptr),
-        _tracker(nullptr)
-	{}
-
-    UndoStackFiller(IMapFileChangeTracker& tracker) :
-        _stack(nullptr),
+    UndoStackFiller(const ActiveOperation& operation, IMapFileChangeTracker& tracker) :
+        _operation(operation),
+        _savedOperation(operation.id),
         _tracker(&tracker)
     {}
 
-	void save(IUndoable& undoable)
+	void save(IUndoable& undoable) override
 	{
-        if (_stack != nullptr)
+        if (_operation.stack != nullptr && _savedOperation != _operation.id)
 		{
             // Optionally notify the change tracker
             if (_tracker != nullptr)
@@ -47,20 +63,12 @@ public:
             }
 
             // Export the Undoable's memento
-			_stack->save(undoable);
+			_operation.stack->save(undoable);
 
-            // Make sure the stack is dissociated after saving
-            // to make sure further save() calls don't have any effect
-            _stack = nullptr;
+            // Further save() calls during this operation don't have any effect
+            _savedOperation = _operation.id;
 		}
 	}
-
-	// Assign the stack of this class. This usually happens when starting
-	// an undo or redo operation.
-	void setStack(UndoStack* stack)
-	{
-		_stack = stack;
-	}
 };
 
 } // namespace undo
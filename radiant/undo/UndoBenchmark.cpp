@@ -0,0 +1,165 @@
+#include "UndoBenchmark.h"
+
+#include "itextstream.h"
+#include "mapfile.h"
+#include "math/Vector3.h"
+#include "BasicUndoMemento.h"
+#include "util/Stopwatch.h"
+
+#include <memory>
+#include <vector>
+#include <fmt/format.h>
+
+#include "UndoSystem.h"
+
+namespace undo
+{
+
+namespace
+{
+	const std::size_t DEFAULT_SIZES[] = { 10000, 50000, 100000 };
+	const std::size_t NUM_EMPTY_OPERATIONS = 100;
+
+	class BenchmarkChangeTracker :
+		public IMapFileChangeTracker
+	{
+	private:
+		std::size_t _changes = 0;
+
+	public:
+		void save() override
+		{
+			_changes = 0;
+		}
+
+		bool saved() const override
+		{
+			return _changes == 0;
+		}
+
+		void changed() override
+		{
+			++_changes;
+		}
+
+		void setChangedCallback(const std::function<void()>& changed) override
+		{}
+
+		std::size_t changes() const override
+		{
+			return _changes;
+		}
+	};
+
+	// Stands in for a primitive, its state is a single vector
+	class BenchmarkUndoable :
+		public IUndoable
+	{
+	private:
+		Vector3 _origin;
+		IUndoStateSaver* _undoStateSaver;
+
+	public:
+		BenchmarkUndoable(UndoSystem& undoSystem, IMapFileChangeTracker& tracker) :
+			_origin(0, 0, 0),
+			_undoStateSaver(undoSystem.getStateSaver(*this, tracker))
+		{}
+
+		void translate(const Vector3& translation)
+		{
+			_undoStateSaver->save(*this);
+			_origin += translation;
+		}
+
+		IUndoMementoPtr exportState() const override
+		{
+			return IUndoMementoPtr(new BasicUndoMemento<Vector3>(_origin));
+		}
+
+		void importState(const IUndoMementoPtr& state) override
+		{
+			_undoStateSaver->save(*this);
+			_origin = std::static_pointer_cast<BasicUndoMemento<Vector3>>(state)->data();
+		}
+	};
+
+	void runBenchmark(std::size_t numUndoables)
+	{
+		UndoSystem undoSystem;
+		BenchmarkChangeTracker tracker;
+
+		util::Stopwatch timer;
+
+		std::vector<std::unique_ptr<BenchmarkUndoable>> undoables;
+		undoables.reserve(numUndoables);
+
+		for (std::size_t i = 0; i < numUndoables; ++i)
+		{
+			undoables.emplace_back(new BenchmarkUndoable(undoSystem, tracker));
+		}
+
+		double registerTime = timer.getMilliseconds();
+
+		// Operations not touching any Undoable
+		timer.restart();
+
+		for (std::size_t i = 0; i < NUM_EMPTY_OPERATIONS; ++i)
+		{
+			undoSystem.start();
+			undoSystem.finish("BenchmarkEmpty");
+		}
+
+		double emptyTime = timer.getMilliseconds() / NUM_EMPTY_OPERATIONS;
+
+		timer.restart();
+
+		undoSystem.start();
+
+		for (const std::unique_ptr<BenchmarkUndoable>& undoable : undoables)
+		{
+			undoable->translate(Vector3(8, 0, 0));
+		}
+
+		undoSystem.finish("BenchmarkTranslate");
+
+		double operationTime = timer.getMilliseconds();
+
+		timer.restart();
+		undoSystem.undo();
+		double undoTime = timer.getMilliseconds();
+
+		timer.restart();
+		undoSystem.redo();
+		double redoTime = timer.getMilliseconds();
+
+		timer.restart();
+		undoSystem.clear();
+
+		for (const std::unique_ptr<BenchmarkUndoable>& undoable : undoables)
+		{
+			undoSystem.releaseStateSaver(*undoable);
+		}
+
+		double releaseTime = timer.getMilliseconds();
+
+		rMessage() << fmt::format("{0} undoables: register {1:.2f} ms, empty start/finish {2:.3f} ms, "
+			"operation {3:.2f} ms, undo {4:.2f} ms, redo {5:.2f} ms, release {6:.2f} ms",
+			numUndoables, registerTime, emptyTime, operationTime, undoTime, redoTime, releaseTime) << std::endl;
+	}
+}
+
+void benchmarkUndo(const cmd::ArgumentList& args)
+{
+	if (!args.empty() && args[0].getInt() > 0)
+	{
+		runBenchmark(static_cast<std::size_t>(args[0].getInt()));
+		return;
+	}
+
+	for (std::size_t numUndoables : DEFAULT_SIZES)
+	{
+		runBenchmark(numUndoables);
+	}
+}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "icommandsystem.h"
+
+namespace undo
+{
+
+/**
+ * BenchmarkUndo [numUndoables]: measures the undo system with synthetic
+ * Undoables, running a few sizes unless a number is given. For each size a
+ * private UndoSystem instance is used, the user's undo history is not touched.
+ * Starting and finishing empty operations, saving all Undoables into a single
+ * operation and undoing and redoing that operation are timed.
+ * The private instances don't log the operations and don't notify the
+ * scene graph, neither the timings nor the user's scene are affected by it.
+ */
+void benchmarkUndo(const cmd::ArgumentList& args);
+
+}
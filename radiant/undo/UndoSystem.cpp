@@ -8,12 +8,16 @@
 #include "iscenegraph.h"
 
 #include <iostream>
+#include <iterator>
+#include <unordered_set>
+#include <fmt/format.h>
 
 #include "registry/registry.h"
 #include "modulesystem/StaticModule.h"
 #include "SnapShot.h"
 #include "Operation.h"
 #include "StackFiller.h"
+#include "UndoBenchmark.h"
 
 namespace undo 
 {
@@ -21,12 +25,42 @@ namespace undo
 namespace
 {
 	const std::string RKEY_UNDO_QUEUE_SIZE = "user/ui/undo/queueSize";
+	const std::string RKEY_UNDO_MEMORY_LIMIT = "user/ui/undo/memoryLimit";
 	const std::size_t MAX_UNDO_LEVELS = 16384;
+
+	std::string formatMemorySize(std::size_t bytes)
+	{
+		return fmt::format("{0:.1f} KB", bytes / 1024.0);
+	}
+
+	// Prints the memory used by the given operation. Shared data is charged to
+	// the oldest operation holding it, the blocks charged so far are collected.
+	void printOperationMemoryUsage(const Operation& operation, std::unordered_set<const void*>& chargedData)
+	{
+		std::size_t memoryUsage = operation.getMemoryUsage();
+
+		operation.foreachSharedData([&](const void* data, std::size_t size)
+		{
+			if (chargedData.insert(data).second)
+			{
+				memoryUsage += size;
+			}
+		});
+
+		rMessage() << "  " << operation.getName() << ": " << operation.getNumSavedStates()
+			<< " states, " << formatMemorySize(memoryUsage)
+			<< (operation.isSpilled() ? ", " + formatMemorySize(operation.getSpilledSize()) + " on disk" : std::string())
+			<< std::endl;
+	}
 }
 
 // Constructor
 UndoSystem::UndoSystem() :
-	_undoLevels(64)
+	_undoStack(_sharedData, _spillFile),
+	_redoStack(_sharedData, _spillFile),
+	_undoLevels(64),
+	_memoryLimit(0),
+	_isModuleInstance(false)
 {}
 
 UndoSystem::~UndoSystem()
@@ -37,11 +71,14 @@ UndoSystem::~UndoSystem()
 void UndoSystem::keyChanged()
 {
 	_undoLevels = registry::getValue<int>(RKEY_UNDO_QUEUE_SIZE);
+	_memoryLimit = static_cast<std::size_t>(registry::getValue<int>(RKEY_UNDO_MEMORY_LIMIT)) * 1024 * 1024;
+
+	applyMemoryLimit();
 }
 
 IUndoStateSaver* UndoSystem::getStateSaver(IUndoable& undoable, IMapFileChangeTracker& tracker)
 {
-    auto result = _undoables.insert(std::make_pair(&undoable, UndoStackFiller(tracker)));
+    auto result = _undoables.insert(std::make_pair(&undoable, UndoStackFiller(_activeOperation, tracker)));
     return &(result.first->second);
 }
 
@@ -79,7 +116,12 @@ void UndoSystem::cancel()
 void UndoSystem::finish(const std::string& command)
 {
 	if (finishUndo(command)) {
-		rMessage() << command << std::endl;
+		if (_isModuleInstance)
+		{
+			rMessage() << command << std::endl;
+		}
+
+		applyMemoryLimit();
 	}
 }
 
@@ -92,24 +134,28 @@ void UndoSystem::undo()
 	}
 		
 	const OperationPtr& operation = _undoStack.back();
-	rMessage() << "Undo: " << operation->getName() << std::endl;
+
+	if (_isModuleInstance)
+	{
+		rMessage() << "Undo: " << operation->getName() << std::endl;
+	}
 
 	startRedo();
 	trackersUndo();
-	operation->restoreSnapshot();
+
+	if (!_undoStack.restore(*operation))
+	{
+		rError() << "Undo: could not restore " << operation->getName() << std::endl;
+	}
+
 	finishRedo(operation->getName());
 	_undoStack.pop_back();
 
-	_signalPostUndo.emit();
+	applyMemoryLimit();
 
-	// Trigger the onPostUndo event on all scene nodes
-	GlobalSceneGraph().foreachNode([&] (const scene::INodePtr& node)->bool
-	{
-		node->onPostUndo();
-		return true;
-	});
+	_signalPostUndo.emit();
 
-	GlobalSceneGraph().sceneChanged();
+	notifyScene(true);
 }
 
 void UndoSystem::redo()
@@ -121,24 +167,28 @@ void UndoSystem::redo()
 	}
 		
 	const OperationPtr& operation = _redoStack.back();
-	rMessage() << "Redo: " << operation->getName() << std::endl;
+
+	if (_isModuleInstance)
+	{
+		rMessage() << "Redo: " << operation->getName() << std::endl;
+	}
 
 	startUndo();
 	trackersRedo();
-	operation->restoreSnapshot();
+
+	if (!_redoStack.restore(*operation))
+	{
+		rError() << "Redo: could not restore " << operation->getName() << std::endl;
+	}
+
 	finishUndo(operation->getName());
 	_redoStack.pop_back();
 
-	_signalPostRedo.emit();
+	applyMemoryLimit();
 
-	// Trigger the onPostRedo event on all scene nodes
-	GlobalSceneGraph().foreachNode([&] (const scene::INodePtr& node)->bool
-	{
-		node->onPostRedo();
-		return true;
-	});
+	_signalPostRedo.emit();
 
-	GlobalSceneGraph().sceneChanged();
+	notifyScene(false);
 }
 
 void UndoSystem::clear()
@@ -202,20 +252,27 @@ void UndoSystem::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << "UndoSystem::initialiseModule called" << std::endl;
 
+	_isModuleInstance = true;
+
 	// Add commands for console input
 	GlobalCommandSystem().addCommand("Undo", std::bind(&UndoSystem::undoCmd, this, std::placeholders::_1));
 	GlobalCommandSystem().addCommand("Redo", std::bind(&UndoSystem::redoCmd, this, std::placeholders::_1));
+	GlobalCommandSystem().addCommand("BenchmarkUndo", benchmarkUndo, cmd::ARGTYPE_INT|cmd::ARGTYPE_OPTIONAL);
+	GlobalCommandSystem().addCommand("PrintUndoMemoryUsage", std::bind(&UndoSystem::printMemoryUsageCmd, this, std::placeholders::_1));
 
 	// Bind events to commands
 	GlobalEventManager().addCommand("Undo", "Undo");
 	GlobalEventManager().addCommand("Redo", "Redo");
 
-	_undoLevels = registry::getValue<int>(RKEY_UNDO_QUEUE_SIZE);
+	keyChanged();
 
 	// Add self to the key observers to get notified on change
 	GlobalRegistry().signalForKey(RKEY_UNDO_QUEUE_SIZE).connect(
         sigc::mem_fun(this, &UndoSystem::keyChanged)
     );
+	GlobalRegistry().signalForKey(RKEY_UNDO_MEMORY_LIMIT).connect(
+        sigc::mem_fun(this, &UndoSystem::keyChanged)
+    );
 
 	// add the preference settings
 	constructPreferences();
@@ -235,6 +292,32 @@ void UndoSystem::redoCmd(const cmd::ArgumentList& args)
 	redo();
 }
 
+void UndoSystem::printMemoryUsageCmd(const cmd::ArgumentList& args)
+{
+	std::unordered_set<const void*> chargedData;
+
+	// Walk the history from the oldest operation to the most distant redo
+	rMessage() << "Undo: " << _undoStack.size() << " operations" << std::endl;
+
+	for (const OperationPtr& operation : _undoStack)
+	{
+		printOperationMemoryUsage(*operation, chargedData);
+	}
+
+	rMessage() << "Redo: " << _redoStack.size() << " operations" << std::endl;
+
+	for (auto i = _redoStack.rbegin(); i != _redoStack.rend(); ++i)
+	{
+		printOperationMemoryUsage(**i, chargedData);
+	}
+
+	rMessage() << "Total undo memory: " << formatMemorySize(getMemoryUsage())
+		<< (_memoryLimit > 0 ? " (limit " + formatMemorySize(_memoryLimit) + ")" : std::string()) << std::endl;
+
+	rMessage() << "Undo states on disk: " << formatMemorySize(static_cast<std::size_t>(_spillFile.getSize()))
+		<< std::endl;
+}
+
 void UndoSystem::onMapEvent(IMap::MapEvent ev)
 {
 	if (ev == IMap::MapUnloaded)
@@ -263,6 +346,88 @@ std::size_t UndoSystem::getLevels() const
 	return _undoLevels;
 }
 
+std::size_t UndoSystem::getMemoryUsage() const
+{
+	return _undoStack.getMemoryUsage() + _redoStack.getMemoryUsage() + _sharedData.getMemoryUsage();
+}
+
+void UndoSystem::applyMemoryLimit()
+{
+	if (_memoryLimit == 0) return;
+
+	std::size_t numSpilled = 0;
+
+	// The back of the undo stack is the most recent operation, it stays in memory
+	if (!_undoStack.empty())
+	{
+		for (auto i = _undoStack.begin(); std::next(i) != _undoStack.end() && getMemoryUsage() > _memoryLimit; ++i)
+		{
+			if (_undoStack.spill(**i))
+			{
+				++numSpilled;
+			}
+		}
+	}
+
+	// The front of the redo stack is the operation furthest from the current state
+	for (auto i = _redoStack.begin(); i != _redoStack.end() && getMemoryUsage() > _memoryLimit; ++i)
+	{
+		if (_redoStack.spill(**i))
+		{
+			++numSpilled;
+		}
+	}
+
+	if (numSpilled > 0)
+	{
+		rMessage() << "Undo: moved the states of " << numSpilled << " operations to disk" << std::endl;
+	}
+
+	// The remaining states refer to scene objects, remove whole operations as last resort
+	std::size_t numRemoved = 0;
+
+	while (_undoStack.size() > 1 && getMemoryUsage() > _memoryLimit)
+	{
+		_undoStack.pop_front();
+		++numRemoved;
+	}
+
+	while (!_redoStack.empty() && getMemoryUsage() > _memoryLimit)
+	{
+		_redoStack.pop_front();
+		++numRemoved;
+	}
+
+	if (numRemoved > 0)
+	{
+		rMessage() << "Undo: removed " << numRemoved << " operations exceeding the memory limit of "
+			<< formatMemorySize(_memoryLimit) << std::endl;
+	}
+}
+
+void UndoSystem::notifyScene(bool undo)
+{
+	// The scene belongs to the module instance, not to private ones
+	if (!_isModuleInstance) return;
+
+	// Trigger the onPostUndo/onPostRedo event on all scene nodes
+	GlobalSceneGraph().foreachNode([&] (const scene::INodePtr& node)->bool
+	{
+		if (undo)
+		{
+			node->onPostUndo();
+		}
+		else
+		{
+			node->onPostRedo();
+		}
+
+		return true;
+	});
+
+	GlobalSceneGraph().sceneChanged();
+}
+
 void UndoSystem::startUndo()
 {
 	_undoStack.start("unnamedCommand");
@@ -289,12 +454,14 @@ bool UndoSystem::finishRedo(const std::string& command)
 	return changed;
 }
 
-// Assigns the given stack to all of the Undoables listed in the map
+// Directs the Undoables to the given stack, starting a new operation unless the stack is NULL
 void UndoSystem::setActiveUndoStack(UndoStack* stack)
 {
-	for (UndoablesMap::value_type& pair : _undoables)
+	_activeOperation.stack = stack;
+
+	if (stack != nullptr)
 	{
-		pair.second.setStack(stack);
+		++_activeOperation.id;
 	}
 }
 
@@ -330,6 +497,7 @@ void UndoSystem::constructPreferences()
 {
 	IPreferencePage& page = GlobalPreferenceSystem().getPage(_("Settings/Undo System"));
 	page.appendSpinner(_("Undo Queue Size"), RKEY_UNDO_QUEUE_SIZE, 0, 1024, 1);
+	page.appendSpinner(_("Undo Memory Limit (MB, 0 = unlimited)"), RKEY_UNDO_MEMORY_LIMIT, 0, 65536, 1);
 }
 
 // Static module instance
@@ -1,13 +1,14 @@
 #pragma once
 
-#include <map>
 #include <set>
+#include <unordered_map>
 #include <functional>
 
 #include "iundo.h"
 #include "icommandsystem.h"
 #include "imap.h"
 
+#include "SpillFile.h"
 #include "Stack.h"
 #include "StackFiller.h"
 
@@ -26,21 +27,37 @@ class UndoSystem :
 	public IUndoSystem
 {
 private:
+	// The data shared by the saved states, counted once for both stacks
+	SharedDataTracker _sharedData;
+
+	// Receives the states of old operations exceeding the memory limit
+	SpillFile _spillFile;
+
 	// The undo and redo stacks
 	UndoStack _undoStack;
 	UndoStack _redoStack;
 
-	typedef std::map<IUndoable*, UndoStackFiller> UndoablesMap;
+	typedef std::unordered_map<IUndoable*, UndoStackFiller> UndoablesMap;
 	UndoablesMap _undoables;
 
+	// The operation the Undoables are currently saved to
+	ActiveOperation _activeOperation;
+
 	std::size_t _undoLevels;
 
+	// The maximum memory used by the undo history in bytes, 0 for unlimited
+	std::size_t _memoryLimit;
+
 	typedef std::set<Tracker*> Trackers;
 	Trackers _trackers;
 
 	sigc::signal<void> _signalPostUndo;
 	sigc::signal<void> _signalPostRedo;
 
+	// Set when this instance is initialised as module. Private instances (like
+	// the ones of BenchmarkUndo) don't log operations and don't notify the scene.
+	bool _isModuleInstance;
+
 public:
 	// Constructor
 	UndoSystem();
@@ -86,6 +103,9 @@ private:
 	// This is connected to the CommandSystem
 	void redoCmd(const cmd::ArgumentList& args);
 
+	// Prints the memory used by each operation on the undo and redo stacks
+	void printMemoryUsageCmd(const cmd::ArgumentList& args);
+
 	// Gets called as soon as the observed registry key is changed
 	void keyChanged();
 
@@ -96,13 +116,26 @@ private:
 
 	std::size_t getLevels() const;
 
+	// The memory used by the operations of both stacks, including the shared data
+	std::size_t getMemoryUsage() const;
+
+	// Moves the states of the oldest undo operations, then the ones of the most
+	// distant redo operations to the spill file, until the history fits into the
+	// memory limit. The states referring to scene objects can't be moved, if
+	// these alone exceed the limit, the oldest operations are removed. The most
+	// recent undo operation is always kept in memory.
+	void applyMemoryLimit();
+
+	// Lets the scene nodes refresh their state after an undo or redo
+	void notifyScene(bool undo);
+
 	void startUndo();
 	bool finishUndo(const std::string& command);
 
 	void startRedo();
 	bool finishRedo(const std::string& command);
 
-	// Assigns the given stack to all of the Undoables listed in the map
+	// Directs the Undoables to the given stack, starting a new operation unless the stack is NULL
 	void setActiveUndoStack(UndoStack* stack);
 
 	void foreachTracker(const std::function<void(Tracker&)>& functor) const;
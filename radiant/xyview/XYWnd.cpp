@@ -8,6 +8,7 @@
 #include "ientity.h"
 #include "igrid.h"
 #include "iuimanager.h"
+#include "iprofiler.h"
 
 #include "wxutil/MouseButton.h"
 #include "wxutil/GLWidget.h"
@@ -26,6 +27,7 @@
 #include "selection/algorithm/General.h"
 #include "selection/algorithm/Primitives.h"
 #include "registry/registry.h"
+#include "registry/KeyHandle.h"
 #include "selection/Device.h"
 #include "selection/SelectionTest.h"
 #include "util/ScopedBoolLock.h"
@@ -191,7 +193,8 @@ int XYWnd::getHeight() const {
 
 SelectionTestPtr XYWnd::createSelectionTestForPoint(const Vector2& point)
 {
-    float selectEpsilon = registry::getValue<float>(RKEY_SELECT_EPSILON);
+    static registry::KeyHandle<float> selectEpsilonKey(RKEY_SELECT_EPSILON);
+    float selectEpsilon = selectEpsilonKey.get();
 
     // Generate the epsilon
     Vector2 deviceEpsilon(selectEpsilon / getWidth(), selectEpsilon / getHeight());
@@ -1262,6 +1265,8 @@ void XYWnd::updateModelview() {
 
 void XYWnd::draw()
 {
+    PROFILE_ZONE("XYWnd::draw");
+
     // clear
     glViewport(0, 0, _width, _height);
     Vector3 colourGridBack = ColourSchemes().getColour("grid_background");